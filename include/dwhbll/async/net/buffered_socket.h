@@ -2,20 +2,14 @@
 
 #include <dwhbll/async/net/decorated_socket.h>
 #include <dwhbll/async/net/socket.h>
+#include <dwhbll/collections/io_buffer.h>
 
-// TODO: make a templated IO buffer to use instead of reimplementing.
 namespace dwhbll::async::net {
     class buffered_socket : public decorated_socket {
-        constexpr static std::size_t BUFFER_SIZE = 4096;
-        constexpr static std::size_t HIGH_WATERMARK = (BUFFER_SIZE / 4 * 3);
+        /// writes at least this big go out directly once the buffered bytes are flushed
+        constexpr static std::size_t HIGH_WATERMARK = collections::io_buffer_pool::SEGMENT_SIZE / 4 * 3;
 
-        std::array<std::uint8_t, BUFFER_SIZE> inbound_buffer{};
-        size_t inbound_head = 0, inbound_size = 0;
-
-        std::array<std::uint8_t, BUFFER_SIZE> outbound_buffer{};
-        size_t outbound_head = 0, outbound_size = 0;
-
-        ssize_t read_from_buffer(std::span<std::uint8_t> buffer);
+        collections::io_buffer inbound, outbound;
 
     public:
         // Promoting constructor.
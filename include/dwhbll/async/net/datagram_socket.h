@@ -0,0 +1,173 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/network/address.h>
+#include <dwhbll/sanify/types.hpp>
+#include <dwhbll/stl_ext/result.h>
+
+namespace dwhbll::async::net {
+    /**
+     * @brief A datagram received into a datagram_batch, valid until the batch is received into again.
+     */
+    struct datagram {
+        std::span<const sanify::u8> data;
+        network::address source;
+        /// with GRO on, `data` may be several datagrams of this size back to back (the last one may be shorter)
+        std::uint16_t segment_size = 0;
+    };
+
+    /**
+     * @brief A datagram to send, the data is not copied and must stay alive until the send completes.
+     */
+    struct outgoing_datagram {
+        std::span<const sanify::u8> data;
+        /// nullptr sends to the connected peer
+        const network::address *destination = nullptr;
+    };
+
+    /**
+     * @brief Storage for receiving up to `capacity()` datagrams with a single recvmmsg.
+     */
+    class datagram_batch {
+        struct control_slot {
+            alignas(cmsghdr) char data[CMSG_SPACE(sizeof(int))];
+        };
+
+        std::size_t slot_size_;
+        std::unique_ptr<sanify::u8[]> storage;
+        std::vector<mmsghdr> headers;
+        std::vector<iovec> vectors;
+        std::vector<sockaddr_storage> sources;
+        std::vector<control_slot> controls;
+        std::size_t size_ = 0;
+
+        friend class datagram_socket;
+
+        /**
+         * @brief Reset the headers the kernel overwrote during the last receive.
+         */
+        void prepare() noexcept;
+
+    public:
+        /**
+         * @param capacity datagrams received per call at most.
+         * @param slot_size bytes per datagram, anything longer is truncated. Use 65535 with GRO on.
+         */
+        explicit datagram_batch(std::size_t capacity = 64, std::size_t slot_size = 2048);
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return headers.size(); }
+
+        [[nodiscard]] std::size_t slot_size() const noexcept { return slot_size_; }
+
+        /**
+         * @return datagrams received by the last receive.
+         */
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        [[nodiscard]] datagram operator[](std::size_t index) const;
+
+        /**
+         * @return whether the datagram at `index` was longer than a slot and got cut.
+         */
+        [[nodiscard]] bool truncated(std::size_t index) const;
+    };
+
+    /**
+     * @brief UDP socket moving many datagrams per system call.
+     *
+     * io_uring has no recvmmsg/sendmmsg, so the batched calls try the syscall without blocking first and only go
+     * through the reactor to wait for readiness, after which a single call drains everything that is queued. The
+     * single datagram calls go through io_uring like the stream sockets do.
+     */
+    class datagram_socket {
+        int fd{-1};
+
+        std::vector<mmsghdr> send_headers;
+        std::vector<iovec> send_vectors;
+        std::vector<sockaddr_storage> send_targets;
+
+        static stl_ext::Result<std::unique_ptr<datagram_socket>, int> open(sa_family_t family);
+
+    public:
+        datagram_socket();
+
+        explicit datagram_socket(int fd);
+
+        ~datagram_socket();
+
+        datagram_socket(const datagram_socket &other) = delete;
+
+        datagram_socket(datagram_socket &&other) noexcept;
+
+        datagram_socket & operator=(const datagram_socket &other) = delete;
+
+        datagram_socket & operator=(datagram_socket &&other) noexcept;
+
+        [[nodiscard]] bool has_socket() const noexcept;
+
+        void close() noexcept;
+
+        /**
+         * @brief Stop receiving and sending, the receives waiting on the socket complete with zero datagrams.
+         */
+        void shutdown() noexcept;
+
+        /**
+         * @brief Socket receiving on `endpoint`, port 0 picks a free one.
+         */
+        [[nodiscard]] static stl_ext::Result<std::unique_ptr<datagram_socket>, int> bind(const network::address &endpoint);
+
+        /**
+         * @brief Socket sending to and only receiving from `endpoint`.
+         */
+        [[nodiscard]] static stl_ext::Result<std::unique_ptr<datagram_socket>, int> connect(const network::address &endpoint);
+
+        /**
+         * @brief The bound address, useful after binding to port 0.
+         */
+        [[nodiscard]] stl_ext::Result<network::address, int> local_address() const;
+
+        /**
+         * @brief Have the kernel coalesce datagrams of a flow into one buffer, see `datagram::segment_size`.
+         */
+        [[nodiscard]] stl_ext::Result<stl_ext::UNIT, int> set_gro(bool state) noexcept;
+
+        /**
+         * @brief Have the kernel split every send into datagrams of `segment_size`, 0 turns it off.
+         */
+        [[nodiscard]] stl_ext::Result<stl_ext::UNIT, int> set_gso(std::uint16_t segment_size) noexcept;
+
+        [[nodiscard]] stl_ext::Result<stl_ext::UNIT, int> set_buffer_sizes(int receive, int send) noexcept;
+
+        /**
+         * @brief Wait for datagrams and receive as many as are queued, up to the batch capacity.
+         * @return number of datagrams received, at least one unless the socket was shut down.
+         */
+        [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<std::size_t, int>> receive(datagram_batch &batch);
+
+        /**
+         * @brief Send all of `datagrams`, as few sendmmsg calls as the socket buffer allows.
+         * @note on error, the datagrams before the failing one were sent.
+         */
+        [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<stl_ext::UNIT, int>> send(std::span<const outgoing_datagram> datagrams);
+
+        /**
+         * @brief Receive one datagram.
+         * @return the datagram length, which is larger than `buffer` if it got truncated, 0 after a shutdown.
+         */
+        [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<std::size_t, int>> receive_from(std::span<sanify::u8> buffer, network::address &source);
+
+        /**
+         * @brief Send one datagram, nullptr sends to the connected peer.
+         */
+        [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<stl_ext::UNIT, int>> send_to(std::span<const sanify::u8> data, const network::address *destination = nullptr);
+    };
+}
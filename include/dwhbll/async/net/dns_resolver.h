@@ -0,0 +1,146 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/network/address.h>
+#include <dwhbll/network/dns/dns.h>
+#include <dwhbll/stl_ext/result.h>
+
+namespace dwhbll::async::net {
+    /**
+     * @brief Stub resolver running on the reactor, asking recursive nameservers for A and AAAA records.
+     *
+     * Every query goes to all nameservers at once and the first usable answer wins. Answers are cached for their
+     * TTL, and so are NXDOMAIN and empty answers for the TTL of the SOA record that comes with them (RFC 2308).
+     * Concurrent lookups of a name share one query. Names from the hosts file are answered without a query.
+     *
+     * Queries advertise a UDP payload size with EDNS (RFC 6891). An answer truncated anyway is asked again over TCP,
+     * on a connection kept open per nameserver.
+     */
+    class dns_resolver {
+    public:
+        struct options {
+            /// empty reads the nameservers of /etc/resolv.conf, falling back to 127.0.0.1
+            std::vector<network::address> nameservers;
+            /// time to wait for an answer before the query is sent again
+            std::chrono::milliseconds timeout{1000};
+            int attempts = 2;
+            /// cap on the TTLs of answers, so a bogus one does not stick forever
+            std::chrono::seconds max_ttl{3600};
+            /// TTL of negative answers that come without a SOA record, and the longest a truncated answer is kept
+            /// when asking again over TCP failed
+            std::chrono::seconds negative_ttl{30};
+            /// empty reads /etc/hosts
+            std::string hosts_file;
+            bool use_hosts_file = true;
+            /// largest UDP answer to ask for, 0 sends queries without EDNS
+            std::uint16_t udp_payload_size = network::dns::DEFAULT_EDNS_PAYLOAD_SIZE;
+        };
+
+        struct statistics {
+            std::size_t queries_sent = 0;
+            std::size_t cache_hits = 0;
+            std::size_t coalesced = 0;
+            /// UDP answers that were truncated and asked again over TCP
+            std::size_t truncated = 0;
+            std::size_t stream_queries = 0;
+            std::size_t streams_opened = 0;
+        };
+
+    private:
+        struct cache_entry {
+            /// with port 0, empty for a negative answer
+            std::vector<network::address> addresses;
+            std::chrono::steady_clock::time_point expires;
+        };
+
+        struct flight;
+
+        struct stream;
+
+        /**
+         * @brief An answer and the index of the nameserver it came from.
+         */
+        struct reply {
+            std::vector<std::uint8_t> message;
+            std::size_t server;
+        };
+
+        options opts;
+        statistics stats;
+        std::mt19937 ids;
+
+        std::unordered_map<std::string, std::vector<network::address>> hosts;
+        std::unordered_map<std::string, cache_entry> cache;
+        std::unordered_map<std::string, std::shared_ptr<flight>> inflight;
+        /// a TCP connection for each nameserver, opened the first time it truncates an answer
+        std::vector<std::shared_ptr<stream>> streams;
+
+        void load_hosts(const std::string &path);
+
+        /**
+         * @brief Cached or coalesced lookup of one record type.
+         * @return the addresses with port 0, empty for a negative answer.
+         */
+        concurrency::coroutine::task<stl_ext::Result<std::vector<network::address>, int>> lookup(std::string name, network::dns::QTYPE type);
+
+        /**
+         * @brief `lookup` storing its result in `into`, to run next to another one.
+         */
+        concurrency::coroutine::task<> lookup_into(std::string name, network::dns::QTYPE type, std::shared_ptr<flight> into);
+
+        /**
+         * @brief Ask the nameservers, retrying on timeouts, and cache what they say.
+         */
+        concurrency::coroutine::task<stl_ext::Result<std::vector<network::address>, int>> query(std::string name, network::dns::QTYPE type);
+
+        /**
+         * @brief One round of asking every nameserver at once.
+         * @param edns whether to send the OPT record, EPROTO is returned if a nameserver rejected it.
+         * @return the first answer that is not a server failure, a well formed message. ETIMEDOUT if none came in time.
+         */
+        concurrency::coroutine::task<stl_ext::Result<reply, int>> ask(const std::string &name, network::dns::QTYPE type, bool edns);
+
+        /**
+         * @brief Ask one nameserver over its TCP connection, replacing the connection if it went stale.
+         * @return ETIMEDOUT if the exchange took longer than the timeout.
+         */
+        concurrency::coroutine::task<stl_ext::Result<std::vector<std::uint8_t>, int>> ask_stream(const std::string &name, network::dns::QTYPE type, std::size_t server, bool edns);
+
+    public:
+        dns_resolver();
+
+        explicit dns_resolver(options opts);
+
+        dns_resolver(const dns_resolver &other) = delete;
+
+        dns_resolver & operator=(const dns_resolver &other) = delete;
+
+        /**
+         * @brief The calling thread's resolver, with the system configuration.
+         */
+        static dns_resolver& local();
+
+        /**
+         * @brief Resolve `host` to its IPv6 and IPv4 addresses with `port`, IPv6 first. IP literals are returned as is.
+         * @return the addresses, never empty, EHOSTUNREACH if the name has none or is not a valid host name and
+         * ETIMEDOUT if no nameserver answered.
+         */
+        [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<std::vector<network::address>, int>> resolve(std::string host, std::uint16_t port);
+
+        /**
+         * @brief Drop the cached answers for `host`.
+         */
+        void forget(const std::string &host);
+
+        [[nodiscard]] const statistics& stat() const noexcept { return stats; }
+
+        [[nodiscard]] const std::vector<network::address>& nameservers() const noexcept { return opts.nameservers; }
+    };
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dwhbll/async/net/socket.h>
+#include <dwhbll/concurrency/coroutine/async_semaphore.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/network/address.h>
+#include <dwhbll/network/http/message.h>
+#include <dwhbll/network/http/response_parser.h>
+#include <dwhbll/stl_ext/result.h>
+
+namespace dwhbll::async::net {
+    struct http_client_options {
+        /// connections open at once per host, further requests wait for one to free up
+        std::size_t max_connections_per_host = 8;
+        /// requests written back to back on one connection by `pipeline()`
+        std::size_t max_pipeline_depth = 16;
+        /// idle connections older than this are closed instead of reused
+        std::chrono::steady_clock::duration idle_timeout = std::chrono::seconds(30);
+        std::size_t max_response_size = 64 * 1024 * 1024;
+    };
+
+    struct http_client_stats {
+        std::uint64_t connections_opened = 0;
+        std::uint64_t connections_reused = 0;
+        std::uint64_t requests = 0;
+        /// requests resent because a pooled connection turned out to be closed
+        std::uint64_t retries = 0;
+    };
+
+    /**
+     * @brief HTTP/1.1 client keeping a pool of keep-alive connections per host.
+     *
+     * Requests check a connection out of the host's pool for their whole exchange, so a connection never carries
+     * two requests from different callers at once. `pipeline()` writes a batch of requests in one go and reads the
+     * responses in order. A request that fails on a reused connection before any response byte arrived is retried
+     * once on a fresh connection if its method is idempotent, and so is what is left of a pipelined batch when the
+     * connection drops partway through, if all of it is idempotent.
+     *
+     * @note Not thread safe, use one client per reactor.
+     */
+    class http_client {
+        struct connection {
+            std::unique_ptr<socket> sock;
+            std::vector<std::uint8_t> inbound;
+            std::size_t inbound_head = 0, inbound_size = 0;
+            std::chrono::steady_clock::time_point last_used;
+            bool reused = false;
+            network::http::response_parser parser;
+            std::string outbound;
+        };
+
+        struct host_pool {
+            network::address endpoint;
+            std::string host_header;
+            concurrency::coroutine::async_semaphore slots;
+            /// most recently used last, it is the one most likely to still be open
+            std::vector<std::unique_ptr<connection>> idle;
+
+            host_pool(const network::address &endpoint, std::size_t max_connections);
+        };
+
+        http_client_options options_;
+        http_client_stats stats_;
+        std::unordered_map<std::string, std::unique_ptr<host_pool>> hosts;
+
+        host_pool& pool_for(const network::address &endpoint);
+
+        concurrency::coroutine::task<stl_ext::Result<std::unique_ptr<connection>, int>> checkout(host_pool &pool);
+
+        void checkin(host_pool &pool, std::unique_ptr<connection> conn, bool reusable);
+
+        /**
+         * @brief Read one response into `conn.parser`.
+         * @return Err(-1) if the connection closed before any byte of it arrived.
+         */
+        concurrency::coroutine::task<stl_ext::Result<stl_ext::UNIT, int>> read_response(connection &conn, bool head_request);
+
+        /**
+         * @brief Send `requests` on one connection and collect the responses into `responses`.
+         * @return Ok once every request is answered, or once the server announced it closes the connection after
+         * a response, in which case it did not process the requests after it. Otherwise the error that stopped the
+         * batch, which may come after some responses: Err(-1) if the connection closed before any byte of the next
+         * response arrived, on a reused connection or after earlier responses.
+         */
+        concurrency::coroutine::task<stl_ext::Result<stl_ext::UNIT, int>> exchange(host_pool &pool, std::span<const network::http_request> requests, std::vector<network::http_response> &responses);
+
+    public:
+        explicit http_client(http_client_options options = {});
+
+        http_client(const http_client &other) = delete;
+
+        http_client & operator=(const http_client &other) = delete;
+
+        /**
+         * @brief Send one request and wait for its response.
+         * @return the response, or an errno value.
+         */
+        [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<network::http_response, int>> request(network::address endpoint, network::http_request request);
+
+        /**
+         * @brief Send several requests pipelined on as few connections as possible.
+         * @return the responses in request order, or an errno value.
+         */
+        [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<std::vector<network::http_response>, int>> pipeline(network::address endpoint, std::vector<network::http_request> requests);
+
+        /**
+         * @brief Close idle connections older than the idle timeout.
+         * @return number of connections closed.
+         */
+        std::size_t evict_idle();
+
+        [[nodiscard]] std::size_t idle_connections() const;
+
+        [[nodiscard]] const http_client_stats& stats() const noexcept;
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <dwhbll/async/net/socket.h>
+#include <dwhbll/async/net/tcp_listener.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/network/address.h>
+#include <dwhbll/stl_ext/result.h>
+
+namespace dwhbll::async::net {
+    /**
+     * @brief One SO_REUSEPORT listener per reactor thread on the same endpoint.
+     *
+     * Every thread accepts from its own queue, so threads never contend on a shared accept queue and a connection
+     * stays on the thread that accepted it. With CPU steering, thread `i` is pinned to CPU `i` and gets the
+     * connections whose packets arrived on that CPU.
+     */
+    class listener_group {
+    public:
+        using handler = std::function<concurrency::coroutine::task<>(std::unique_ptr<socket>)>;
+
+        struct options {
+            /// 0 takes one thread per hardware thread
+            std::size_t threads = 0;
+            int backlog = 4096;
+            /// pin the threads and steer connections to the listener of the CPU they arrived on
+            bool steer_by_cpu = false;
+        };
+
+    private:
+        options opts;
+        std::vector<std::unique_ptr<tcp_listener>> listeners;
+        std::vector<std::thread> workers;
+        std::atomic_bool running{false};
+        handler on_connection;
+
+        concurrency::coroutine::task<> accept_loop(tcp_listener &listener);
+
+    public:
+        listener_group();
+
+        explicit listener_group(options opts);
+
+        ~listener_group();
+
+        listener_group(const listener_group &other) = delete;
+
+        listener_group & operator=(const listener_group &other) = delete;
+
+        /**
+         * @brief Bind one listener per thread to `endpoint`.
+         *
+         * With port 0 the first listener picks the port and the others join it there.
+         * @return Ok on success or errno on Err, no listener is left open on failure.
+         */
+        [[nodiscard]] stl_ext::Result<stl_ext::UNIT, int> listen(const network::address &endpoint);
+
+        /**
+         * @brief Start a reactor per listener, each spawning `on_connection` for the connections it accepts.
+         */
+        void start(handler on_connection);
+
+        /**
+         * @brief Stop accepting and wait for the connections in progress to be handled.
+         */
+        void stop();
+
+        [[nodiscard]] std::size_t size() const noexcept { return listeners.size(); }
+
+        [[nodiscard]] const tcp_listener &listener(std::size_t index) const { return *listeners.at(index); }
+    };
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/network/address.h>
+#include <dwhbll/stl_ext/result.h>
+
+namespace dwhbll::async::net {
+    /**
+     * @brief Resolve `host` to its IPv6 and IPv4 addresses with `port`, IPv6 first.
+     *
+     * Goes through the calling thread's `dns_resolver`, so answers are cached for their TTL per thread.
+     * @return the addresses, never empty, EHOSTUNREACH if the name does not resolve and ETIMEDOUT if no nameserver
+     * answered.
+     */
+    [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<std::vector<network::address>, int>> resolve(std::string host, std::uint16_t port);
+
+    /**
+     * @brief Forget the cached addresses of `host`, after they all failed to connect for instance.
+     */
+    void forget_resolved(const std::string &host);
+}
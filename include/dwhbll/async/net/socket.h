@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <dwhbll/async/net/isocket.h>
 #include <dwhbll/concurrency/coroutine/task.h>
@@ -14,9 +15,22 @@ namespace dwhbll::async::net {
         bool shutdown {false};
         bool nodelay_ {false};
 
-        static concurrency::coroutine::task<stl_ext::Result<std::unique_ptr<socket>, int>> connect_internal(bool use_ipv6, const network::address &endpoint, int socktype);
+        std::chrono::steady_clock::duration read_timeout{}, write_timeout{};
+        std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
+
+        /**
+         * @brief When an operation given `timeout` has to be done by, `time_point::max()` for never.
+         */
+        [[nodiscard]] std::chrono::steady_clock::time_point op_deadline(std::chrono::steady_clock::duration timeout) const noexcept;
+
+        static concurrency::coroutine::task<stl_ext::Result<std::unique_ptr<socket>, int>> connect_internal(bool use_ipv6, network::address endpoint, int socktype);
 
     public:
+        /**
+         * @brief Head start a connection attempt gets before the next address is tried as well (RFC 8305).
+         */
+        constexpr static auto CONNECTION_ATTEMPT_DELAY = std::chrono::milliseconds(250);
+
         socket();
 
         explicit socket(int fd);
@@ -43,8 +57,31 @@ namespace dwhbll::async::net {
 
         [[nodiscard]] const network::address& get_address() const noexcept override;
 
+        /**
+         * @brief How long a read may wait for the peer before it fails with ETIMEDOUT, zero to wait forever.
+         *
+         * The reactor cancels the pending receive once the time is up, nothing polls.
+         */
+        void set_read_timeout(std::chrono::steady_clock::duration timeout) noexcept;
+
+        /**
+         * @brief How long a write may wait for the peer to take data before it fails with ETIMEDOUT, zero to wait
+         * forever.
+         */
+        void set_write_timeout(std::chrono::steady_clock::duration timeout) noexcept;
+
+        /**
+         * @brief A point no read or write waits past whatever their timeouts, so a peer trickling data in cannot
+         * stretch a whole exchange such as a request head. `time_point::max()` clears it.
+         */
+        void set_deadline(std::chrono::steady_clock::time_point deadline) noexcept;
+
         /**
          * @brief Connect TCP Socket
+         *
+         * A domain is resolved and its addresses are raced happy eyeballs style: families alternate, every attempt
+         * gets `CONNECTION_ATTEMPT_DELAY` or until it fails before the next one starts, and the first connection
+         * wins while the handshakes still in flight are aborted.
          * @param use_ipv6 Whether to use IPv6, if the endpoint is specified as v4 ip it doesn't matter, if DNS resolves to only v4 it also doesn't matter
          * @param endpoint Address to connect to, or domain, domain will be resolved
          * @return Socket if connected
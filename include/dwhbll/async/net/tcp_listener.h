@@ -17,6 +17,7 @@ namespace dwhbll::async::net {
 
         bool shutdown {false};
         bool want_reuseaddr {false};
+        bool want_reuseport {false};
 
     public:
         tcp_listener();
@@ -38,6 +39,31 @@ namespace dwhbll::async::net {
 
         [[nodiscard]] concurrency::coroutine::task<stl_ext::Result<std::unique_ptr<socket>, int>> accept() const noexcept;
 
+        /**
+         * @brief The bound address, useful after binding to port 0.
+         */
+        [[nodiscard]] stl_ext::Result<network::address, int> local_address() const;
+
         void set_reuseaddr() noexcept;
+
+        /**
+         * @brief Let several listeners bind the same endpoint, the kernel spreads incoming connections over them.
+         * @note like set_reuseaddr, this has to be called before listen.
+         */
+        void set_reuseport() noexcept;
+
+        /**
+         * @brief Hand each connection to the listener of the SO_REUSEPORT group whose index is the CPU the
+         * connection arrived on, listeners get their index in the order they were bound.
+         *
+         * Attaching to any listener of the group steers the whole group. Connections arriving on a CPU without a
+         * listener of that index fall back to the default hashing.
+         */
+        [[nodiscard]] stl_ext::Result<stl_ext::UNIT, int> attach_cpu_steering() const noexcept;
+
+        /**
+         * @brief Wake up pending accepts with an error and refuse new connections, without closing the socket.
+         */
+        void stop_accepting() const noexcept;
     };
 }
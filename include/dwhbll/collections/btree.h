@@ -0,0 +1,1020 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dwhbll/collections/container_traits.h>
+
+namespace dwhbll::collections {
+    /**
+     * @brief Tag for building a B-tree from a range that is sorted already, without duplicates unless the tree
+     * allows them.
+     */
+    struct sorted_input_t {
+        explicit sorted_input_t() = default;
+    };
+
+    inline constexpr sorted_input_t sorted_input{};
+
+    namespace detail {
+        /**
+         * @brief The B+ tree behind `btree_set`, `btree_multiset` and `btree_map`.
+         *
+         * Entries are kept sorted in leaves of about 256 bytes, linked to each other for iteration, and internal
+         * nodes hold copies of keys to find the right leaf, so a lookup touches a few cache lines per level of a
+         * tree only a few levels deep. Every node but the root is kept at least half full: an insert into a full
+         * leaf splits it in two, an erase that leaves a node under half full takes an entry from a sibling or
+         * merges with it.
+         *
+         * Inserting or erasing moves entries between nodes, which invalidates references and iterators to them.
+         */
+        template <typename Policy, typename Compare, bool Multi>
+        class btree {
+        public:
+            using key_type = typename Policy::key_type;
+            using value_type = typename Policy::value_type;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using key_compare = Compare;
+
+        protected:
+            template <typename Q>
+            using key_arg = typename key_arg_of<transparent<Compare>>::template type<Q, key_type>;
+
+            struct internal_node;
+
+            struct node_base {
+                internal_node* parent = nullptr;
+                /// index among the children of the parent
+                std::uint16_t position = 0;
+                /// entries of a leaf, keys of an internal node
+                std::uint16_t count = 0;
+                bool leaf;
+
+                explicit node_base(bool leaf) noexcept : leaf(leaf) {}
+            };
+
+            static constexpr std::size_t TARGET_NODE_SIZE = 256;
+
+            static constexpr std::size_t LEAF_SLOTS = std::max<std::size_t>(
+                4, (TARGET_NODE_SIZE - sizeof(node_base) - 2 * sizeof(void*)) / sizeof(value_type));
+
+            static constexpr std::size_t INTERNAL_KEYS = std::max<std::size_t>(
+                4, (TARGET_NODE_SIZE - sizeof(node_base)) / (sizeof(key_type) + sizeof(void*)));
+
+            static_assert(LEAF_SLOTS <= UINT16_MAX && INTERNAL_KEYS < UINT16_MAX);
+
+            struct leaf_node : node_base {
+                leaf_node* prev = nullptr;
+                leaf_node* next = nullptr;
+                alignas(value_type) std::byte storage[LEAF_SLOTS * sizeof(value_type)];
+
+                leaf_node() noexcept : node_base(true) {}
+
+                value_type* values() noexcept { return std::launder(reinterpret_cast<value_type*>(storage)); }
+            };
+
+            struct internal_node : node_base {
+                /// one more than fits, a node overflows for a moment before it is split
+                node_base* children[INTERNAL_KEYS + 2];
+                alignas(key_type) std::byte storage[(INTERNAL_KEYS + 1) * sizeof(key_type)];
+
+                internal_node() noexcept : node_base(false) {}
+
+                key_type* keys() noexcept { return std::launder(reinterpret_cast<key_type*>(storage)); }
+
+                void adopt(std::size_t i, node_base* child) noexcept {
+                    children[i] = child;
+                    child->parent = this;
+                    child->position = static_cast<std::uint16_t>(i);
+                }
+            };
+
+            node_base* root = nullptr;
+            leaf_node* leftmost = nullptr;
+            leaf_node* rightmost = nullptr;
+            std::size_t used = 0;
+            [[no_unique_address]] Compare comp;
+
+            static void move_key(key_type* to, key_type* from) {
+                set_policy<key_type>::transfer(to, from);
+            }
+
+            /**
+             * @brief Shift the entries from `i` on one slot right, leaving `i` uninitialised.
+             */
+            static void open_gap(leaf_node* leaf, std::size_t i) {
+                auto* values = leaf->values();
+                for (std::size_t j = leaf->count; j > i; j--)
+                    Policy::transfer(values + j, values + j - 1);
+            }
+
+            /**
+             * @brief Shift the entries after the uninitialised `i` one slot left.
+             */
+            static void close_gap(leaf_node* leaf, std::size_t i) {
+                auto* values = leaf->values();
+                for (std::size_t j = i; j + 1 < leaf->count; j++)
+                    Policy::transfer(values + j, values + j + 1);
+            }
+
+            static void free_node(node_base* n) noexcept {
+                if (n->leaf) {
+                    auto* leaf = static_cast<leaf_node*>(n);
+                    std::destroy_n(leaf->values(), leaf->count);
+                    delete leaf;
+                    return;
+                }
+
+                auto* in = static_cast<internal_node*>(n);
+                std::destroy_n(in->keys(), in->count);
+                for (std::size_t i = 0; i <= in->count; i++)
+                    free_node(in->children[i]);
+                delete in;
+            }
+
+            template <typename Q>
+            [[nodiscard]] std::size_t keys_below(internal_node* in, const Q& key) const {
+                return std::partition_point(in->keys(), in->keys() + in->count,
+                                            [&](const key_type& k) { return comp(k, key); }) - in->keys();
+            }
+
+            template <typename Q>
+            [[nodiscard]] std::size_t keys_not_above(internal_node* in, const Q& key) const {
+                return std::partition_point(in->keys(), in->keys() + in->count,
+                                            [&](const key_type& k) { return !comp(key, k); }) - in->keys();
+            }
+
+            /**
+             * @brief The leaf slot of the first entry not ordered before `key`, which may be one past the end of
+             * its leaf. The tree must not be empty.
+             */
+            template <typename Q>
+            [[nodiscard]] std::pair<leaf_node*, std::size_t> lower_bound_slot(const Q& key) const {
+                auto* n = root;
+                while (!n->leaf) {
+                    auto* in = static_cast<internal_node*>(n);
+                    n = in->children[keys_below(in, key)];
+                }
+
+                auto* leaf = static_cast<leaf_node*>(n);
+                auto* values = leaf->values();
+                const auto i = std::partition_point(values, values + leaf->count, [&](const value_type& v) {
+                    return comp(Policy::key(v), key);
+                }) - values;
+                return {leaf, static_cast<std::size_t>(i)};
+            }
+
+            /**
+             * @brief The leaf slot of the first entry ordered after `key`, see `lower_bound_slot`.
+             */
+            template <typename Q>
+            [[nodiscard]] std::pair<leaf_node*, std::size_t> upper_bound_slot(const Q& key) const {
+                auto* n = root;
+                while (!n->leaf) {
+                    auto* in = static_cast<internal_node*>(n);
+                    n = in->children[keys_not_above(in, key)];
+                }
+
+                auto* leaf = static_cast<leaf_node*>(n);
+                auto* values = leaf->values();
+                const auto i = std::partition_point(values, values + leaf->count, [&](const value_type& v) {
+                    return !comp(key, Policy::key(v));
+                }) - values;
+                return {leaf, static_cast<std::size_t>(i)};
+            }
+
+            /**
+             * @brief Hang `right` after `left` under their parent with `separator` between them, making a new root
+             * above `left` if it was the root.
+             */
+            void add_sibling(node_base* left, key_type&& separator, node_base* right) {
+                auto* parent = left->parent;
+
+                if (parent == nullptr) {
+                    auto* top = new internal_node;
+                    ::new (top->keys()) key_type(std::move(separator));
+                    top->count = 1;
+                    top->adopt(0, left);
+                    top->adopt(1, right);
+                    root = top;
+                    return;
+                }
+
+                const std::size_t i = left->position;
+                auto* keys = parent->keys();
+                for (std::size_t j = parent->count; j > i; j--)
+                    move_key(keys + j, keys + j - 1);
+                ::new (keys + i) key_type(std::move(separator));
+
+                for (std::size_t j = parent->count + 1; j > i + 1; j--)
+                    parent->adopt(j, parent->children[j - 1]);
+                parent->adopt(i + 1, right);
+
+                if (++parent->count > INTERNAL_KEYS)
+                    split_internal(parent);
+            }
+
+            void split_internal(internal_node* in) {
+                auto* right = new internal_node;
+                const std::size_t mid = in->count / 2;
+                auto* keys = in->keys();
+
+                for (std::size_t j = mid + 1; j < in->count; j++)
+                    move_key(right->keys() + (j - mid - 1), keys + j);
+                for (std::size_t j = mid + 1; j <= in->count; j++)
+                    right->adopt(j - mid - 1, in->children[j]);
+
+                right->count = static_cast<std::uint16_t>(in->count - mid - 1);
+                in->count = static_cast<std::uint16_t>(mid);
+
+                key_type separator(std::move(keys[mid]));
+                std::destroy_at(keys + mid);
+                add_sibling(in, std::move(separator), right);
+            }
+
+            /**
+             * @brief Construct an entry from `args` in slot `i` of `leaf`, splitting the leaf first if it is full.
+             */
+            template <typename... Args>
+            std::pair<leaf_node*, std::size_t> insert_slot(leaf_node* leaf, std::size_t i, Args&&... args) {
+                if (root == nullptr) {
+                    leaf = new leaf_node;
+                    root = leftmost = rightmost = leaf;
+                    i = 0;
+                }
+
+                if (leaf->count < LEAF_SLOTS) {
+                    open_gap(leaf, i);
+                    try {
+                        ::new (leaf->values() + i) value_type(std::forward<Args>(args)...);
+                    } catch (...) {
+                        close_gap(leaf, i);
+                        if (used == 0) {
+                            delete leaf;
+                            root = leftmost = rightmost = nullptr;
+                        }
+                        throw;
+                    }
+                    leaf->count++;
+                    used++;
+                    return {leaf, i};
+                }
+
+                auto* right = new leaf_node;
+                right->prev = leaf;
+                right->next = leaf->next;
+                (leaf->next ? leaf->next->prev : rightmost) = right;
+                leaf->next = right;
+
+                // appending to the last leaf leaves it full, so that ascending inserts fill the leaves
+                const bool appending = i == LEAF_SLOTS && right->next == nullptr;
+                const std::size_t mid = appending ? LEAF_SLOTS : LEAF_SLOTS / 2;
+
+                for (std::size_t j = mid; j < LEAF_SLOTS; j++)
+                    Policy::transfer(right->values() + (j - mid), leaf->values() + j);
+                right->count = static_cast<std::uint16_t>(LEAF_SLOTS - mid);
+                leaf->count = static_cast<std::uint16_t>(mid);
+
+                if (!appending)
+                    add_sibling(leaf, key_type(Policy::key(right->values()[0])), right);
+
+                auto* target = leaf;
+                if (i > mid || appending) {
+                    target = right;
+                    i -= mid;
+                }
+
+                open_gap(target, i);
+                try {
+                    ::new (target->values() + i) value_type(std::forward<Args>(args)...);
+                } catch (...) {
+                    close_gap(target, i);
+                    if (appending) {
+                        leaf->next = nullptr;
+                        rightmost = leaf;
+                        delete right;
+                    }
+                    throw;
+                }
+                target->count++;
+                used++;
+
+                if (appending)
+                    add_sibling(leaf, key_type(Policy::key(right->values()[0])), right);
+
+                return {target, i};
+            }
+
+            /**
+             * @brief Take child `c` and the key before it out of `in`, then fix `in` up if that left it too small.
+             */
+            void remove_child(internal_node* in, std::size_t c) {
+                auto* keys = in->keys();
+                std::destroy_at(keys + c - 1);
+                for (std::size_t j = c - 1; j + 1 < in->count; j++)
+                    move_key(keys + j, keys + j + 1);
+                for (std::size_t j = c; j < in->count; j++)
+                    in->adopt(j, in->children[j + 1]);
+                in->count--;
+
+                if (in == root) {
+                    if (in->count == 0) {
+                        root = in->children[0];
+                        root->parent = nullptr;
+                        root->position = 0;
+                        delete in;
+                    }
+                } else if (in->count < INTERNAL_KEYS / 2) {
+                    rebalance_internal(in);
+                }
+            }
+
+            void merge_internal(internal_node* left, internal_node* right) {
+                auto* parent = left->parent;
+                const std::size_t base = left->count;
+
+                ::new (left->keys() + base) key_type(std::move(parent->keys()[left->position]));
+                for (std::size_t j = 0; j < right->count; j++)
+                    move_key(left->keys() + base + 1 + j, right->keys() + j);
+                for (std::size_t j = 0; j <= right->count; j++)
+                    left->adopt(base + 1 + j, right->children[j]);
+
+                left->count = static_cast<std::uint16_t>(base + 1 + right->count);
+                const std::size_t c = right->position;
+                delete right;
+                remove_child(parent, c);
+            }
+
+            void rebalance_internal(internal_node* in) {
+                auto* parent = in->parent;
+                const std::size_t pos = in->position;
+                auto* keys = in->keys();
+
+                if (pos > 0) {
+                    auto* left = static_cast<internal_node*>(parent->children[pos - 1]);
+                    if (left->count <= INTERNAL_KEYS / 2)
+                        return merge_internal(left, in);
+
+                    // rotate the last child of the left sibling over through the parent
+                    for (std::size_t j = in->count; j > 0; j--)
+                        move_key(keys + j, keys + j - 1);
+                    for (std::size_t j = in->count + 1; j > 0; j--)
+                        in->adopt(j, in->children[j - 1]);
+
+                    auto& separator = parent->keys()[pos - 1];
+                    ::new (keys) key_type(std::move(separator));
+                    separator = std::move(left->keys()[left->count - 1]);
+                    std::destroy_at(left->keys() + left->count - 1);
+                    in->adopt(0, left->children[left->count]);
+
+                    left->count--;
+                    in->count++;
+                    return;
+                }
+
+                auto* right = static_cast<internal_node*>(parent->children[pos + 1]);
+                if (right->count <= INTERNAL_KEYS / 2)
+                    return merge_internal(in, right);
+
+                // rotate the first child of the right sibling over through the parent
+                auto& separator = parent->keys()[pos];
+                ::new (keys + in->count) key_type(std::move(separator));
+                separator = std::move(right->keys()[0]);
+                in->adopt(in->count + 1, right->children[0]);
+                in->count++;
+
+                std::destroy_at(right->keys());
+                for (std::size_t j = 0; j + 1 < right->count; j++)
+                    move_key(right->keys() + j, right->keys() + j + 1);
+                for (std::size_t j = 0; j < right->count; j++)
+                    right->adopt(j, right->children[j + 1]);
+                right->count--;
+            }
+
+            void merge_leaves(leaf_node* left, leaf_node* right) {
+                for (std::size_t j = 0; j < right->count; j++)
+                    Policy::transfer(left->values() + left->count + j, right->values() + j);
+                left->count = static_cast<std::uint16_t>(left->count + right->count);
+
+                left->next = right->next;
+                (right->next ? right->next->prev : rightmost) = left;
+
+                const std::size_t c = right->position;
+                auto* parent = right->parent;
+                delete right;
+                remove_child(parent, c);
+            }
+
+            /**
+             * @brief Refill `leaf` from a sibling, following the entry at slot `i` wherever that moves it.
+             */
+            void rebalance_leaf(leaf_node*& leaf, std::size_t& i) {
+                auto* parent = leaf->parent;
+                const std::size_t pos = leaf->position;
+
+                if (pos > 0) {
+                    auto* left = static_cast<leaf_node*>(parent->children[pos - 1]);
+
+                    if (left->count <= LEAF_SLOTS / 2) {
+                        i += left->count;
+                        merge_leaves(left, leaf);
+                        leaf = left;
+                        return;
+                    }
+
+                    open_gap(leaf, 0);
+                    Policy::transfer(leaf->values(), left->values() + left->count - 1);
+                    left->count--;
+                    leaf->count++;
+                    parent->keys()[pos - 1] = Policy::key(leaf->values()[0]);
+                    i++;
+                    return;
+                }
+
+                auto* right = static_cast<leaf_node*>(parent->children[pos + 1]);
+
+                if (right->count <= LEAF_SLOTS / 2)
+                    return merge_leaves(leaf, right);
+
+                Policy::transfer(leaf->values() + leaf->count, right->values());
+                close_gap(right, 0);
+                right->count--;
+                leaf->count++;
+                parent->keys()[pos] = Policy::key(right->values()[0]);
+            }
+
+            template <bool Const>
+            class basic_iterator {
+                friend class btree;
+
+                leaf_node* leaf = nullptr;
+                std::size_t index = 0;
+
+                basic_iterator(leaf_node* leaf, std::size_t index) noexcept : leaf(leaf), index(index) {}
+
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type = typename Policy::value_type;
+                using difference_type = std::ptrdiff_t;
+                using reference = std::conditional_t<Const || !Policy::mutable_values, const value_type&, value_type&>;
+                using pointer = std::add_pointer_t<reference>;
+
+                basic_iterator() = default;
+
+                // a const_iterator from an iterator
+                template <bool OtherConst>
+                requires (Const && !OtherConst)
+                basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+                    : leaf(other.leaf), index(other.index) {}
+
+                reference operator*() const noexcept { return leaf->values()[index]; }
+
+                pointer operator->() const noexcept { return leaf->values() + index; }
+
+                basic_iterator& operator++() noexcept {
+                    if (++index == leaf->count && leaf->next) {
+                        leaf = leaf->next;
+                        index = 0;
+                    }
+                    return *this;
+                }
+
+                basic_iterator operator++(int) noexcept {
+                    auto copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                basic_iterator& operator--() noexcept {
+                    if (index == 0) {
+                        leaf = leaf->prev;
+                        index = leaf->count;
+                    }
+                    index--;
+                    return *this;
+                }
+
+                basic_iterator operator--(int) noexcept {
+                    auto copy = *this;
+                    --*this;
+                    return copy;
+                }
+
+                template <bool OtherConst>
+                bool operator==(const basic_iterator<OtherConst>& other) const noexcept {
+                    return leaf == other.leaf && index == other.index;
+                }
+
+                friend class basic_iterator<!Const>;
+            };
+
+        public:
+            using iterator = basic_iterator<false>;
+            using const_iterator = basic_iterator<true>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+            /// what inserting returns, whether the entry was new only matters without duplicates
+            using insert_return_type = std::conditional_t<Multi, iterator, std::pair<iterator, bool>>;
+
+        protected:
+            /**
+             * @brief The iterator to slot `i` of `leaf`, moved to the next leaf if that is one past its end.
+             */
+            iterator iterator_at(leaf_node* leaf, std::size_t i) const noexcept {
+                if (i == leaf->count && leaf->next)
+                    return iterator(leaf->next, 0);
+                return iterator(leaf, i);
+            }
+
+            /**
+             * @brief Insert an entry for `key` constructed from `args`, unless the tree has no duplicates and
+             * `key` is there already.
+             */
+            template <typename Q, typename... Args>
+            insert_return_type emplace_key(const Q& key, Args&&... args) {
+                if constexpr (Multi) {
+                    // `args` may be an entry of this tree, which opening the gap or splitting the leaf moves away
+                    value_type value(std::forward<Args>(args)...);
+
+                    if (root == nullptr) {
+                        auto [leaf, i] = insert_slot(nullptr, 0, std::move(value));
+                        return iterator(leaf, i);
+                    }
+
+                    // after the entries with the same key, like std::multiset
+                    auto [at, slot] = upper_bound_slot(key);
+                    auto [leaf, i] = insert_slot(at, slot, std::move(value));
+                    return iterator(leaf, i);
+                } else {
+                    if (root == nullptr) {
+                        auto [leaf, i] = insert_slot(nullptr, 0, std::forward<Args>(args)...);
+                        return {iterator(leaf, i), true};
+                    }
+
+                    auto [at, slot] = lower_bound_slot(key);
+                    if (auto found = iterator_at(at, slot); found != end() && !comp(key, Policy::key(*found)))
+                        return {found, false};
+
+                    auto [leaf, i] = insert_slot(at, slot, std::forward<Args>(args)...);
+                    return {iterator(leaf, i), true};
+                }
+            }
+
+            /**
+             * @brief Build the tree out of `count` sorted entries, every node as full as the count allows.
+             */
+            template <typename It>
+            void build_sorted(It first, std::size_t count) {
+                if (count == 0)
+                    return;
+
+                std::vector<node_base*> level;
+                std::vector<internal_node*> built;
+                // the first key under every node of the level
+                std::vector<const key_type*> firsts;
+
+                try {
+                    const std::size_t leaves = (count + LEAF_SLOTS - 1) / LEAF_SLOTS;
+                    for (std::size_t l = 0; l < leaves; l++) {
+                        auto* leaf = new leaf_node;
+                        leaf->prev = rightmost;
+                        (rightmost ? rightmost->next : leftmost) = leaf;
+                        rightmost = leaf;
+
+                        const std::size_t take = count / leaves + (l < count % leaves);
+                        for (; leaf->count < take; ++first) {
+                            ::new (leaf->values() + leaf->count) value_type(*first);
+                            leaf->count++;
+                        }
+
+                        level.push_back(leaf);
+                        firsts.push_back(&Policy::key(leaf->values()[0]));
+                    }
+
+                    while (level.size() > 1) {
+                        const std::size_t nodes = (level.size() + INTERNAL_KEYS) / (INTERNAL_KEYS + 1);
+                        std::vector<node_base*> above;
+                        std::vector<const key_type*> above_firsts;
+
+                        for (std::size_t n = 0, c = 0; n < nodes; n++) {
+                            auto* in = new internal_node;
+                            built.push_back(in);
+
+                            const std::size_t take = level.size() / nodes + (n < level.size() % nodes);
+                            above.push_back(in);
+                            above_firsts.push_back(firsts[c]);
+
+                            in->adopt(0, level[c++]);
+                            for (std::size_t j = 1; j < take; j++, c++) {
+                                ::new (in->keys() + in->count) key_type(*firsts[c]);
+                                in->count++;
+                                in->adopt(j, level[c]);
+                            }
+                        }
+
+                        level = std::move(above);
+                        firsts = std::move(above_firsts);
+                    }
+                } catch (...) {
+                    for (auto* in : built) {
+                        std::destroy_n(in->keys(), in->count);
+                        delete in;
+                    }
+                    for (auto* leaf = leftmost; leaf;) {
+                        auto* next = leaf->next;
+                        std::destroy_n(leaf->values(), leaf->count);
+                        delete leaf;
+                        leaf = next;
+                    }
+                    leftmost = rightmost = nullptr;
+                    throw;
+                }
+
+                root = level[0];
+                used = count;
+            }
+
+        public:
+            btree() = default;
+
+            explicit btree(const Compare& comp) : comp(comp) {}
+
+            /**
+             * @brief Build the tree from `[first, last)` in linear time, which has to be sorted and, unless the tree
+             * allows duplicates, free of them.
+             */
+            template <std::forward_iterator It>
+            btree(sorted_input_t, It first, It last, const Compare& comp = Compare()) : comp(comp) {
+                build_sorted(first, std::distance(first, last));
+            }
+
+            template <std::input_iterator It>
+            btree(It first, It last, const Compare& comp = Compare()) : comp(comp) {
+                insert(first, last);
+            }
+
+            btree(std::initializer_list<value_type> values, const Compare& comp = Compare()) : comp(comp) {
+                insert(values);
+            }
+
+            btree(const btree& other) : comp(other.comp) {
+                build_sorted(other.begin(), other.size());
+            }
+
+            btree(btree&& other) noexcept
+                : root(std::exchange(other.root, nullptr)), leftmost(std::exchange(other.leftmost, nullptr)),
+                  rightmost(std::exchange(other.rightmost, nullptr)), used(std::exchange(other.used, 0)),
+                  comp(std::move(other.comp)) {}
+
+            btree& operator=(const btree& other) {
+                if (this != &other) {
+                    btree copy(other);
+                    swap(copy);
+                }
+                return *this;
+            }
+
+            btree& operator=(btree&& other) noexcept {
+                if (this != &other) {
+                    btree moved(std::move(other));
+                    swap(moved);
+                }
+                return *this;
+            }
+
+            ~btree() {
+                clear();
+            }
+
+            void swap(btree& other) noexcept {
+                std::swap(root, other.root);
+                std::swap(leftmost, other.leftmost);
+                std::swap(rightmost, other.rightmost);
+                std::swap(used, other.used);
+                std::swap(comp, other.comp);
+            }
+
+            iterator begin() noexcept { return iterator(leftmost, 0); }
+
+            const_iterator begin() const noexcept { return const_iterator(leftmost, 0); }
+
+            const_iterator cbegin() const noexcept { return begin(); }
+
+            iterator end() noexcept { return iterator(rightmost, rightmost ? rightmost->count : 0); }
+
+            const_iterator end() const noexcept { return const_iterator(rightmost, rightmost ? rightmost->count : 0); }
+
+            const_iterator cend() const noexcept { return end(); }
+
+            reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+
+            const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+            reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+
+            const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+            [[nodiscard]] bool empty() const noexcept { return used == 0; }
+
+            [[nodiscard]] std::size_t size() const noexcept { return used; }
+
+            [[nodiscard]] key_compare key_comp() const { return comp; }
+
+            void clear() noexcept {
+                if (root)
+                    free_node(root);
+                root = leftmost = rightmost = nullptr;
+                used = 0;
+            }
+
+            /**
+             * @brief Replace the contents with the sorted `[first, last)`, see the `sorted_input` constructor.
+             */
+            template <std::forward_iterator It>
+            void assign_sorted(It first, It last) {
+                clear();
+                build_sorted(first, std::distance(first, last));
+            }
+
+            insert_return_type insert(const value_type& value) {
+                return emplace_key(Policy::key(value), value);
+            }
+
+            insert_return_type insert(value_type&& value) {
+                return emplace_key(Policy::key(value), std::move(value));
+            }
+
+            template <std::input_iterator It>
+            void insert(It first, It last) {
+                for (; first != last; ++first)
+                    insert(*first);
+            }
+
+            void insert(std::initializer_list<value_type> values) {
+                insert(values.begin(), values.end());
+            }
+
+            template <typename... Args>
+            insert_return_type emplace(Args&&... args) {
+                value_type value(std::forward<Args>(args)...);
+                return insert(std::move(value));
+            }
+
+            template <typename Q = key_type>
+            iterator lower_bound(const key_arg<Q>& key) {
+                if (root == nullptr)
+                    return end();
+                auto [leaf, i] = lower_bound_slot(key);
+                return iterator_at(leaf, i);
+            }
+
+            template <typename Q = key_type>
+            const_iterator lower_bound(const key_arg<Q>& key) const {
+                return const_cast<btree*>(this)->template lower_bound<Q>(key);
+            }
+
+            template <typename Q = key_type>
+            iterator upper_bound(const key_arg<Q>& key) {
+                if (root == nullptr)
+                    return end();
+                auto [leaf, i] = upper_bound_slot(key);
+                return iterator_at(leaf, i);
+            }
+
+            template <typename Q = key_type>
+            const_iterator upper_bound(const key_arg<Q>& key) const {
+                return const_cast<btree*>(this)->template upper_bound<Q>(key);
+            }
+
+            template <typename Q = key_type>
+            std::pair<iterator, iterator> equal_range(const key_arg<Q>& key) {
+                return {lower_bound<Q>(key), upper_bound<Q>(key)};
+            }
+
+            template <typename Q = key_type>
+            std::pair<const_iterator, const_iterator> equal_range(const key_arg<Q>& key) const {
+                return {lower_bound<Q>(key), upper_bound<Q>(key)};
+            }
+
+            template <typename Q = key_type>
+            iterator find(const key_arg<Q>& key) {
+                auto found = lower_bound<Q>(key);
+                if (found != end() && !comp(key, Policy::key(*found)))
+                    return found;
+                return end();
+            }
+
+            template <typename Q = key_type>
+            const_iterator find(const key_arg<Q>& key) const {
+                return const_cast<btree*>(this)->template find<Q>(key);
+            }
+
+            template <typename Q = key_type>
+            [[nodiscard]] bool contains(const key_arg<Q>& key) const {
+                return find<Q>(key) != end();
+            }
+
+            template <typename Q = key_type>
+            [[nodiscard]] std::size_t count(const key_arg<Q>& key) const {
+                if constexpr (Multi) {
+                    auto [first, last] = equal_range<Q>(key);
+                    return std::distance(first, last);
+                } else {
+                    return contains<Q>(key);
+                }
+            }
+
+            /**
+             * @return the iterator to the entry after the erased one.
+             */
+            iterator erase(const_iterator pos) {
+                auto* leaf = pos.leaf;
+                auto i = pos.index;
+
+                std::destroy_at(leaf->values() + i);
+                close_gap(leaf, i);
+                leaf->count--;
+                used--;
+
+                if (leaf == root) {
+                    if (leaf->count == 0) {
+                        delete leaf;
+                        root = leftmost = rightmost = nullptr;
+                        return end();
+                    }
+                } else if (leaf->count < LEAF_SLOTS / 2) {
+                    rebalance_leaf(leaf, i);
+                }
+
+                return iterator_at(leaf, i);
+            }
+
+            iterator erase(iterator pos) {
+                return erase(const_iterator(pos));
+            }
+
+            iterator erase(const_iterator first, const_iterator last) {
+                // erasing moves the entries around, the range is followed by its length
+                auto n = std::distance(first, last);
+                iterator it(first.leaf, first.index);
+                for (; n > 0; n--)
+                    it = erase(it);
+                return it;
+            }
+
+            template <typename Q = key_type>
+            std::size_t erase(const key_arg<Q>& key) {
+                auto [first, last] = equal_range<Q>(key);
+                const auto n = static_cast<std::size_t>(std::distance(first, last));
+                erase(first, last);
+                return n;
+            }
+
+            /**
+             * @brief Erase the entries `pred` holds for.
+             * @return how many were erased.
+             */
+            template <typename Pred>
+            std::size_t erase_if(Pred pred) {
+                const auto before = used;
+                for (auto it = begin(); it != end();)
+                    it = pred(*it) ? erase(it) : std::next(it);
+                return before - used;
+            }
+
+            friend bool operator==(const btree& a, const btree& b) {
+                return std::equal(a.begin(), a.end(), b.begin(), b.end());
+            }
+        };
+    }
+
+    /**
+     * @brief A sorted set in a B+ tree of cache line sized nodes, see `detail::btree`.
+     */
+    template <typename K, typename Compare = std::less<K>>
+    class btree_set : public detail::btree<detail::set_policy<K>, Compare, false> {
+        using base = detail::btree<detail::set_policy<K>, Compare, false>;
+
+    public:
+        using base::base;
+    };
+
+    /**
+     * @brief A sorted multiset in a B+ tree, which also takes the interface of `SortedLinkedList`.
+     */
+    template <typename K, typename Compare = std::less<K>>
+    class btree_multiset : public detail::btree<detail::set_policy<K>, Compare, true> {
+        using base = detail::btree<detail::set_policy<K>, Compare, true>;
+
+    public:
+        using typename base::iterator;
+
+        using base::base;
+        using base::insert;
+
+        iterator insert(std::size_t count, const K& value) {
+            if (count == 0)
+                return this->upper_bound(value);
+
+            // `value` may be an entry of this tree, which the first insert can move to another leaf
+            const K copy(value);
+            for (std::size_t i = 0; i < count; i++)
+                insert(copy);
+            // inserting may have moved the first copy, the copies are all equal so the first of them will do
+            return this->lower_bound(copy);
+        }
+
+        [[nodiscard]] const K& front() const { return *this->begin(); }
+
+        [[nodiscard]] const K& back() const { return *std::prev(this->end()); }
+
+        void pop_front() { this->erase(this->begin()); }
+
+        void pop_back() { this->erase(std::prev(this->end())); }
+
+        /**
+         * @return how many copies of `value` were erased.
+         */
+        std::size_t remove(const K& value) { return this->erase(value); }
+
+        template <typename Pred>
+        std::size_t remove_if(Pred pred) { return this->erase_if(std::move(pred)); }
+    };
+
+    /**
+     * @brief A sorted map in a B+ tree of cache line sized nodes, see `detail::btree`.
+     */
+    template <typename K, typename V, typename Compare = std::less<K>>
+    class btree_map : public detail::btree<detail::map_policy<K, V>, Compare, false> {
+        using base = detail::btree<detail::map_policy<K, V>, Compare, false>;
+
+    public:
+        using mapped_type = V;
+        using typename base::iterator;
+
+        using base::base;
+
+        /**
+         * @brief Insert `V(args...)` under `key` unless the key is there already, in which case nothing is
+         * constructed.
+         */
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+            return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                     std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+            // the key is only moved from once the slot for it is found
+            return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                     std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(const K& key, M&& value) {
+            auto result = try_emplace(key, std::forward<M>(value));
+            if (!result.second)
+                result.first->second = std::forward<M>(value);
+            return result;
+        }
+
+        V& operator[](const K& key) {
+            return try_emplace(key).first->second;
+        }
+
+        V& operator[](K&& key) {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        /**
+         * @throws std::out_of_range when the key is not in the map.
+         */
+        template <typename Q = K>
+        V& at(const typename base::template key_arg<Q>& key) {
+            auto found = this->template find<Q>(key);
+            if (found == this->end())
+                throw std::out_of_range("btree_map::at: key not found");
+            return found->second;
+        }
+
+        template <typename Q = K>
+        const V& at(const typename base::template key_arg<Q>& key) const {
+            auto found = this->template find<Q>(key);
+            if (found == this->end())
+                throw std::out_of_range("btree_map::at: key not found");
+            return found->second;
+        }
+    };
+}
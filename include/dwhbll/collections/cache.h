@@ -1,74 +1,416 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
-#include <dwhbll/memory/pool.h>
-
-bool cache_test(std::optional<std::string> test_to_run);
+#include <dwhbll/collections/hashing.h>
+#include <dwhbll/collections/timer_wheel.h>
 
 namespace dwhbll::collections {
-    class generic_cache {
-        std::mutex cache_lock;
-
-        std::chrono::system_clock::time_point first_expire_time;
-        std::list<std::pair<std::chrono::system_clock::time_point, std::pair<void*, void*>>> entries;
-
-        friend generic_cache* getNextExpire();
-        friend void cacheCleanupWorker();
-
-    public:
-        generic_cache();
+    namespace detail {
+        /**
+         * @brief Approximate access counts of recently seen keys, a count-min sketch of 4 bit counters.
+         *
+         * All counters are halved once every ten accesses per entry of the cache, so keys that were popular a long
+         * time ago stop looking popular.
+         */
+        class frequency_sketch {
+            /// 16 counters in each word
+            std::vector<std::uint64_t> table;
+            std::uint64_t counter_mask;
+            std::size_t additions = 0, sample_size;
 
-        virtual ~generic_cache();
+            [[nodiscard]] std::uint64_t counter_of(std::uint64_t hash, int row) const noexcept;
 
-        generic_cache(const generic_cache &other);
+            void age() noexcept;
 
-        generic_cache(generic_cache &&other) noexcept;
+        public:
+            explicit frequency_sketch(std::size_t capacity);
 
-        generic_cache & operator=(const generic_cache &other);
+            void increment(std::uint64_t hash) noexcept;
 
-        generic_cache & operator=(generic_cache &&other) noexcept;
+            [[nodiscard]] std::uint32_t frequency(std::uint64_t hash) const noexcept;
+        };
+    }
 
-        void addEntry(std::chrono::system_clock::time_point expire_time, void* key, void* value);
+    struct cache_stats {
+        std::uint64_t hits = 0, misses = 0;
+        /// entries dropped to stay within capacity, including new ones the policy did not admit
+        std::uint64_t evictions = 0;
+        /// entries dropped because they were found expired
+        std::uint64_t expirations = 0;
 
-        void* getEntry(void* key);
+        [[nodiscard]] double hit_ratio() const noexcept {
+            const auto total = hits + misses;
+            return total == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(total);
+        }
 
-    protected:
-        virtual void return_values(void* key, void* value) = 0;
+        cache_stats& operator+=(const cache_stats& other) noexcept {
+            hits += other.hits;
+            misses += other.misses;
+            evictions += other.evictions;
+            expirations += other.expirations;
+            return *this;
+        }
     };
 
     /**
-     * @brief a simple cache class that... probably works?
+     * @brief A bounded cache safe to share between threads.
+     *
+     * Keys are spread over shards with a lock each. Every shard evicts by W-TinyLFU: new entries go through a small
+     * LRU window, and leaving it they only displace the least recent entry of the main space if they were accessed
+     * more often, which keeps one-off scans from flushing out the popular keys. The main space is a segmented LRU
+     * where entries hit a second time are protected from the next evictions.
+     *
+     * Expired entries are dropped when they are read. Every shard also keeps the deadlines in a timing wheel that
+     * writes advance, so entries nobody reads again are dropped at a cost proportional to their number, without a
+     * thread scanning the cache.
      */
-    template <typename K, typename V>
+    template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
     requires std::copy_constructible<K> && std::copy_constructible<V>
-    class cache : generic_cache {
-        memory::Pool<K> keys;
-        memory::Pool<V> values;
+    class cache {
+    public:
+        using clock = std::chrono::system_clock;
+
+    private:
+        enum class segment : std::uint8_t {
+            WINDOW,
+            PROBATION,
+            PROTECTED,
+        };
+
+        struct entry;
+
+        using list_type = std::list<entry>;
+        using list_iterator = typename list_type::iterator;
+        using wheel_type = timer_wheel<list_iterator>;
+
+        struct entry {
+            K key;
+            V value;
+            clock::time_point expires;
+            std::uint64_t hash;
+            segment where;
+            /// empty for entries that never expire
+            std::optional<typename wheel_type::handle> timer;
+        };
+
+        static std::uint64_t nanos(clock::time_point time) noexcept {
+            const auto since = time.time_since_epoch();
+            return since.count() <= 0 ? 0 : std::chrono::duration_cast<std::chrono::nanoseconds>(since).count();
+        }
+
+        struct alignas(64) shard {
+            std::mutex lock;
+            /// the most recent entry first
+            list_type window, probation, protected_;
+            std::unordered_map<K, list_iterator, Hash, KeyEqual> index;
+            detail::frequency_sketch sketch;
+            wheel_type wheel{nanos(clock::now())};
+            std::size_t window_capacity, main_capacity, protected_capacity;
+            cache_stats stats;
+
+            explicit shard(std::size_t capacity)
+                : sketch(capacity),
+                  window_capacity(std::max<std::size_t>(1, capacity / 100)),
+                  main_capacity(capacity - window_capacity),
+                  protected_capacity(main_capacity * 4 / 5) {}
+
+            list_type& list_of(segment where) noexcept {
+                switch (where) {
+                    case segment::WINDOW:
+                        return window;
+                    case segment::PROBATION:
+                        return probation;
+                    default:
+                        return protected_;
+                }
+            }
 
-        friend bool ::cache_test(std::optional<std::string> test_to_run);
+            void remove(list_iterator it) {
+                if (it->timer)
+                    wheel.cancel(*it->timer);
+                index.erase(it->key);
+                list_of(it->where).erase(it);
+            }
+
+            void schedule(list_iterator it) {
+                if (it->timer) {
+                    wheel.cancel(*it->timer);
+                    it->timer.reset();
+                }
+
+                if (it->expires != never)
+                    it->timer = wheel.schedule(it, nanos(it->expires));
+            }
+
+            /**
+             * @brief Drop the entries that expired by `now`.
+             */
+            void expire(clock::time_point now) {
+                wheel.advance(nanos(now), [this](list_iterator it) {
+                    it->timer.reset();
+                    remove(it);
+                    stats.expirations++;
+                });
+            }
+
+            /**
+             * @brief Account for a hit on `it`, a second hit in probation protects the entry.
+             */
+            void touch(list_iterator it) {
+                switch (it->where) {
+                    case segment::WINDOW:
+                        window.splice(window.begin(), window, it);
+                        return;
+                    case segment::PROTECTED:
+                        protected_.splice(protected_.begin(), protected_, it);
+                        return;
+                    case segment::PROBATION:
+                        break;
+                }
+
+                it->where = segment::PROTECTED;
+                protected_.splice(protected_.begin(), probation, it);
+
+                if (protected_.size() > protected_capacity) {
+                    auto demoted = std::prev(protected_.end());
+                    demoted->where = segment::PROBATION;
+                    probation.splice(probation.begin(), protected_, demoted);
+                }
+            }
+
+            /**
+             * @brief Move what overflows the window into probation, dropping whichever of it and the oldest entry
+             * there was accessed less often while the main space is over capacity.
+             */
+            void evict() {
+                while (window.size() > window_capacity) {
+                    auto candidate = std::prev(window.end());
+                    candidate->where = segment::PROBATION;
+                    probation.splice(probation.begin(), window, candidate);
+
+                    if (probation.size() + protected_.size() <= main_capacity)
+                        continue;
+
+                    auto victim = std::prev(probation.end());
+                    // ties go to the resident, so a scan of new keys cannot push out ones seen as often
+                    if (victim != candidate && sketch.frequency(candidate->hash) > sketch.frequency(victim->hash))
+                        remove(victim);
+                    else
+                        remove(candidate);
+
+                    stats.evictions++;
+                }
+            }
+
+            [[nodiscard]] std::size_t size() const noexcept {
+                return index.size();
+            }
+        };
+
+        std::vector<std::unique_ptr<shard>> shards;
+        std::uint64_t shard_mask;
+        std::size_t max_entries;
+        [[no_unique_address]] Hash hasher;
+
+        shard& shard_of(std::uint64_t hash) noexcept {
+            // the sketch indexes with the low bits, the shards take the high ones
+            return *shards[(hash >> 40) & shard_mask];
+        }
+
+        static bool expired(const entry& e, clock::time_point now) noexcept {
+            return e.expires <= now;
+        }
 
     public:
-        cache() = default;
+        static constexpr auto never = clock::time_point::max();
+
+        /**
+         * @param capacity the most entries held at once
+         * @param shard_count how many locks the entries are spread over, rounded to a power of two. 0 picks four
+         * per hardware thread.
+         */
+        explicit cache(std::size_t capacity = 1 << 16, std::size_t shard_count = 0) : max_entries(capacity) {
+            if (capacity == 0)
+                throw std::invalid_argument("a cache has to hold at least one entry.");
 
-        void* addEntry(std::chrono::system_clock::time_point expire_time, K key, V value) {
-            auto* k = keys.acquire(key).disown();
-            generic_cache::addEntry(expire_time, k, values.acquire(value).disown());
-            return k;
+            if (shard_count == 0)
+                shard_count = std::max(1u, std::thread::hardware_concurrency()) * 4;
+
+            // every shard holds a few entries at least, otherwise the policy has nothing to choose from
+            shard_count = std::bit_ceil(shard_count);
+            while (shard_count > 1 && capacity / shard_count < 16)
+                shard_count /= 2;
+
+            shard_mask = shard_count - 1;
+            for (std::size_t i = 0; i < shard_count; i++)
+                shards.push_back(std::make_unique<shard>((capacity + i) / shard_count));
+        }
+
+        cache(const cache&) = delete;
+        cache& operator=(const cache&) = delete;
+
+        cache(cache&&) noexcept = default;
+        cache& operator=(cache&&) noexcept = default;
+
+        /**
+         * @brief Insert or replace the entry of `key`. A new entry may be dropped right away if the cache is full
+         * of keys accessed more often.
+         */
+        void addEntry(clock::time_point expire_time, K key, V value) {
+            const auto hash = detail::spread(hasher(key));
+            const auto now = clock::now();
+            auto& s = shard_of(hash);
+            std::unique_lock _(s.lock);
+
+            s.expire(now);
+            s.sketch.increment(hash);
+
+            if (auto found = s.index.find(key); found != s.index.end()) {
+                found->second->value = std::move(value);
+                found->second->expires = expire_time;
+                s.schedule(found->second);
+                s.touch(found->second);
+                return;
+            }
+
+            s.window.push_front(entry{key, std::move(value), expire_time, hash, segment::WINDOW, std::nullopt});
+            s.index.emplace(std::move(key), s.window.begin());
+            s.schedule(s.window.begin());
+            s.evict();
         }
 
-        V& getEntry(const K& key) {
-            auto* r = static_cast<V*>(generic_cache::getEntry(keys.find(key)));
-            if (r == nullptr)
+        void addEntry(K key, V value) {
+            addEntry(never, std::move(key), std::move(value));
+        }
+
+        /**
+         * @brief Look `key` up, counting a hit or a miss.
+         * @return a copy of the value, the entry may be evicted by another thread right after.
+         */
+        std::optional<V> findEntry(const K& key) {
+            const auto hash = detail::spread(hasher(key));
+            auto& s = shard_of(hash);
+            std::unique_lock _(s.lock);
+
+            s.sketch.increment(hash);
+
+            auto found = s.index.find(key);
+            if (found == s.index.end()) {
+                s.stats.misses++;
+                return std::nullopt;
+            }
+
+            auto it = found->second;
+            if (it->expires != never) {
+                const auto now = clock::now();
+
+                if (expired(*it, now)) {
+                    s.remove(it);
+                    s.stats.expirations++;
+                    s.stats.misses++;
+                    return std::nullopt;
+                }
+
+                // the clock was read anyway, it may as well reclaim what expired around this entry
+                s.expire(now);
+            }
+
+            s.touch(it);
+            s.stats.hits++;
+            return it->value;
+        }
+
+        /**
+         * @throws std::out_of_range when the key is not cached.
+         */
+        V getEntry(const K& key) {
+            auto value = findEntry(key);
+            if (!value)
                 throw std::out_of_range("key not found (probably expired)");
-            return *r;
+            return std::move(*value);
+        }
+
+        /**
+         * @return false if `key` was not cached.
+         */
+        bool removeEntry(const K& key) {
+            const auto hash = detail::spread(hasher(key));
+            auto& s = shard_of(hash);
+            std::unique_lock _(s.lock);
+
+            auto found = s.index.find(key);
+            if (found == s.index.end())
+                return false;
+
+            s.remove(found->second);
+            return true;
+        }
+
+        void clear() {
+            for (auto& s : shards) {
+                std::unique_lock _(s->lock);
+                s->index.clear();
+                s->window.clear();
+                s->probation.clear();
+                s->protected_.clear();
+                s->wheel.clear();
+            }
+        }
+
+        /**
+         * @brief Drop every expired entry now, instead of when the shards it is in are next written to.
+         */
+        void cleanUp() {
+            const auto now = clock::now();
+            for (auto& s : shards) {
+                std::unique_lock _(s->lock);
+                s->expire(now);
+            }
+        }
+
+        /**
+         * @brief Entries held, expired ones that were not dropped yet count too.
+         */
+        [[nodiscard]] std::size_t size() const {
+            std::size_t total = 0;
+            for (auto& s : shards) {
+                std::unique_lock _(s->lock);
+                total += s->size();
+            }
+            return total;
+        }
+
+        [[nodiscard]] std::size_t capacity() const noexcept {
+            return max_entries;
+        }
+
+        [[nodiscard]] std::size_t shard_count() const noexcept {
+            return shards.size();
         }
 
-    protected:
-        void return_values(void *key, void *value) override {
-            keys.offer(static_cast<K*>(key));
-            values.offer(static_cast<V*>(value));
+        /**
+         * @brief The counters summed over the shards, each shard is read at a different instant.
+         */
+        [[nodiscard]] cache_stats stats() const {
+            cache_stats total;
+            for (auto& s : shards) {
+                std::unique_lock _(s->lock);
+                total += s->stats;
+            }
+            return total;
         }
     };
 }
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace dwhbll::collections::detail {
+    template <typename T>
+    concept transparent = requires { typename T::is_transparent; };
+
+    /// an alias straight to `Q` or `Key`, so that `Q` can still be deduced through it
+    template <bool Transparent>
+    struct key_arg_of {
+        template <typename Q, typename Key>
+        using type = Q;
+    };
+
+    template <>
+    struct key_arg_of<false> {
+        template <typename Q, typename Key>
+        using type = Key;
+    };
+
+    /**
+     * @brief How a container of `std::pair<const K, V>` entries reads their keys and moves them between slots.
+     */
+    template <typename K, typename V>
+    struct map_policy {
+        using key_type = K;
+        using value_type = std::pair<const K, V>;
+        static constexpr bool mutable_values = true;
+
+        static const K& key(const value_type& slot) noexcept { return slot.first; }
+
+        /**
+         * @brief Move the entry in `from` to the uninitialised `to` and destroy what is left.
+         */
+        static void transfer(value_type* to, value_type* from) {
+            // the key is moved out of a slot that is destroyed right after, nothing sees it moved from
+            ::new (to) value_type(std::move(const_cast<K&>(from->first)), std::move(from->second));
+            std::destroy_at(from);
+        }
+    };
+
+    /**
+     * @brief How a container of bare keys reads them and moves them between slots.
+     */
+    template <typename K>
+    struct set_policy {
+        using key_type = K;
+        using value_type = K;
+        static constexpr bool mutable_values = false;
+
+        static const K& key(const value_type& slot) noexcept { return slot; }
+
+        static void transfer(value_type* to, value_type* from) {
+            ::new (to) value_type(std::move(*from));
+            std::destroy_at(from);
+        }
+    };
+}
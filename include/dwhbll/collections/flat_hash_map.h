@@ -0,0 +1,725 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <dwhbll/collections/container_traits.h>
+#include <dwhbll/collections/hashing.h>
+
+namespace dwhbll::collections {
+    namespace detail {
+        /// a full slot holds the low 7 bits of its hash, the other states have the high bit set
+        using ctrl_t = std::int8_t;
+
+        inline constexpr ctrl_t CTRL_EMPTY = -128;
+        /// a tombstone, probes for other keys may have passed over it
+        inline constexpr ctrl_t CTRL_DELETED = -2;
+
+        /**
+         * @brief The slots of a group that matched, as a bit per slot `Shift` bits apart.
+         */
+        template <int Width, int Shift>
+        class group_mask {
+            std::uint64_t bits;
+
+        public:
+            explicit group_mask(std::uint64_t bits) noexcept : bits(bits) {}
+
+            explicit operator bool() const noexcept { return bits != 0; }
+
+            /**
+             * @brief Offset of the first slot that matched, the mask must not be empty.
+             */
+            [[nodiscard]] std::size_t lowest() const noexcept { return std::countr_zero(bits) >> Shift; }
+
+            void next() noexcept { bits &= bits - 1; }
+
+            /// slots before the first match
+            [[nodiscard]] std::size_t trailing_zeros() const noexcept {
+                return bits == 0 ? Width : std::countr_zero(bits) >> Shift;
+            }
+
+            /// slots after the last match
+            [[nodiscard]] std::size_t leading_zeros() const noexcept {
+                return (std::countl_zero(bits) - (64 - (Width << Shift))) >> Shift;
+            }
+        };
+
+#if defined(__SSE2__)
+        /**
+         * @brief 16 control bytes compared at once.
+         */
+        struct group {
+            static constexpr std::size_t WIDTH = 16;
+            using mask = group_mask<16, 0>;
+
+            __m128i ctrl;
+
+            explicit group(const ctrl_t* pos) noexcept
+                : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+            [[nodiscard]] mask match(std::uint8_t h2) const noexcept {
+                const auto eq = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(h2)), ctrl);
+                return mask(static_cast<std::uint16_t>(_mm_movemask_epi8(eq)));
+            }
+
+            [[nodiscard]] mask match_empty() const noexcept {
+                const auto eq = _mm_cmpeq_epi8(_mm_set1_epi8(CTRL_EMPTY), ctrl);
+                return mask(static_cast<std::uint16_t>(_mm_movemask_epi8(eq)));
+            }
+
+            [[nodiscard]] mask match_empty_or_deleted() const noexcept {
+                return mask(static_cast<std::uint16_t>(_mm_movemask_epi8(ctrl)));
+            }
+        };
+#else
+        /**
+         * @brief 8 control bytes compared at once in a 64 bit word.
+         */
+        struct group {
+            static constexpr std::size_t WIDTH = 8;
+            using mask = group_mask<8, 3>;
+
+            static constexpr std::uint64_t LSBS = 0x0101010101010101ULL;
+            static constexpr std::uint64_t MSBS = 0x8080808080808080ULL;
+
+            std::uint64_t ctrl;
+
+            explicit group(const ctrl_t* pos) noexcept {
+                std::memcpy(&ctrl, pos, sizeof(ctrl));
+                if constexpr (std::endian::native == std::endian::big)
+                    ctrl = std::byteswap(ctrl);
+            }
+
+            /// may report a slot right above a real match too, the keys are compared anyway
+            [[nodiscard]] mask match(std::uint8_t h2) const noexcept {
+                const auto x = ctrl ^ (LSBS * h2);
+                return mask((x - LSBS) & ~x & MSBS);
+            }
+
+            [[nodiscard]] mask match_empty() const noexcept {
+                // only empty bytes have the high bit set and bit 1 clear
+                return mask(ctrl & ~(ctrl << 6) & MSBS);
+            }
+
+            [[nodiscard]] mask match_empty_or_deleted() const noexcept {
+                // empty and deleted bytes have the high bit set and bit 0 clear
+                return mask(ctrl & ~(ctrl << 7) & MSBS);
+            }
+        };
+#endif
+
+        /**
+         * @brief The open addressing table behind `flat_hash_map` and `flat_hash_set`.
+         *
+         * Entries live in one array of slots, next to an array of control bytes that holds 7 bits of the hash of
+         * every full slot. A lookup compares a whole group of control bytes with the hash of the key at once and only
+         * compares keys where they matched, moving to another group only when the group has no empty slot. The
+         * control bytes of the first group are repeated after the last one, so that a group can start at any slot.
+         *
+         * The table holds at most 7/8 of its capacity, which is a power of two.
+         */
+        template <typename Policy, typename Hash, typename KeyEqual>
+        class raw_hash_table {
+        public:
+            using key_type = typename Policy::key_type;
+            using value_type = typename Policy::value_type;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using hasher = Hash;
+            using key_equal = KeyEqual;
+
+        protected:
+            static constexpr std::size_t WIDTH = group::WIDTH;
+            static constexpr std::size_t npos = -1;
+
+            /// the type of keys lookups take, anything the hash and equality accept if both are transparent
+            template <typename Q>
+            using key_arg = typename key_arg_of<transparent<Hash> && transparent<KeyEqual>>::template type<Q, key_type>;
+
+            ctrl_t* ctrl = nullptr;
+            value_type* slots = nullptr;
+            std::size_t cap = 0, used = 0;
+            /// inserts into empty slots left before the table has to grow
+            std::size_t growth_left = 0;
+            [[no_unique_address]] Hash hash_fn;
+            [[no_unique_address]] KeyEqual eq_fn;
+
+            static constexpr std::size_t max_load(std::size_t capacity) noexcept {
+                return capacity - capacity / 8;
+            }
+
+            /**
+             * @brief The smallest capacity holding `n` entries.
+             */
+            static std::size_t capacity_for(std::size_t n) noexcept {
+                if (n == 0)
+                    return 0;
+                return std::max(WIDTH, std::bit_ceil(n + (n + 6) / 7));
+            }
+
+            template <typename Q>
+            [[nodiscard]] std::uint64_t hash_of(const Q& key) const {
+                return spread(hash_fn(key));
+            }
+
+            static std::uint8_t h2(std::uint64_t hash) noexcept { return hash & 0x7f; }
+
+            void set_ctrl(std::size_t i, ctrl_t c) noexcept {
+                ctrl[i] = c;
+                if (i < WIDTH)
+                    ctrl[cap + i] = c;
+            }
+
+            template <typename Q>
+            [[nodiscard]] std::size_t find_index(const Q& key, std::uint64_t hash) const {
+                if (cap == 0)
+                    return npos;
+
+                const auto mask = cap - 1;
+                auto pos = (hash >> 7) & mask;
+
+                for (std::size_t step = WIDTH;; step += WIDTH) {
+                    group g(ctrl + pos);
+                    for (auto m = g.match(h2(hash)); m; m.next()) {
+                        const auto i = (pos + m.lowest()) & mask;
+                        if (eq_fn(Policy::key(slots[i]), key))
+                            return i;
+                    }
+
+                    if (g.match_empty())
+                        return npos;
+
+                    // triangular steps over the groups reach every one of them
+                    pos = (pos + step) & mask;
+                }
+            }
+
+            [[nodiscard]] std::size_t find_first_non_full(std::uint64_t hash) const noexcept {
+                const auto mask = cap - 1;
+                auto pos = (hash >> 7) & mask;
+
+                for (std::size_t step = WIDTH;; step += WIDTH) {
+                    if (auto m = group(ctrl + pos).match_empty_or_deleted())
+                        return (pos + m.lowest()) & mask;
+
+                    pos = (pos + step) & mask;
+                }
+            }
+
+            /**
+             * @brief Reserve a slot for a new entry of `hash`, the caller constructs it.
+             */
+            std::size_t prepare_insert(std::uint64_t hash) {
+                auto target = cap == 0 ? npos : find_first_non_full(hash);
+
+                if (target == npos || (growth_left == 0 && ctrl[target] != CTRL_DELETED)) {
+                    // mostly tombstones is cleaned up in place, anything else doubles the table
+                    resize(cap != 0 && used <= max_load(cap) / 2 ? cap : std::max(WIDTH, cap * 2));
+                    target = find_first_non_full(hash);
+                }
+
+                if (ctrl[target] == CTRL_EMPTY)
+                    growth_left--;
+                set_ctrl(target, static_cast<ctrl_t>(h2(hash)));
+                used++;
+                return target;
+            }
+
+            /**
+             * @brief Give back a slot `prepare_insert` reserved that could not be constructed.
+             */
+            void cancel_insert(std::size_t i) noexcept {
+                set_ctrl(i, CTRL_DELETED);
+                used--;
+            }
+
+            void erase_at(std::size_t i) {
+                std::destroy_at(slots + i);
+                used--;
+
+                // a probe only passes over a slot in a run of at least a group of slots that are not empty, if
+                // this one was never in one nobody needs a tombstone to keep looking past it
+                const auto empty_after = group(ctrl + i).match_empty();
+                const auto empty_before = group(ctrl + ((i - WIDTH) & (cap - 1))).match_empty();
+                const bool was_never_full = empty_before && empty_after &&
+                                            empty_after.trailing_zeros() + empty_before.leading_zeros() < WIDTH;
+
+                set_ctrl(i, was_never_full ? CTRL_EMPTY : CTRL_DELETED);
+                if (was_never_full)
+                    growth_left++;
+            }
+
+            /**
+             * @brief Move every entry into a table of `capacity` slots, which drops the tombstones.
+             */
+            void resize(std::size_t capacity) {
+                auto* old_ctrl = ctrl;
+                auto* old_slots = slots;
+                const auto old_cap = cap;
+
+                if (capacity == 0) {
+                    ctrl = nullptr;
+                    slots = nullptr;
+                } else {
+                    auto new_ctrl = std::make_unique<ctrl_t[]>(capacity + WIDTH);
+                    std::fill_n(new_ctrl.get(), capacity + WIDTH, CTRL_EMPTY);
+                    slots = std::allocator<value_type>().allocate(capacity);
+                    ctrl = new_ctrl.release();
+                }
+
+                cap = capacity;
+                growth_left = max_load(capacity) - used;
+
+                for (std::size_t i = 0; i < old_cap; i++) {
+                    if (old_ctrl[i] < 0)
+                        continue;
+
+                    const auto hash = hash_of(Policy::key(old_slots[i]));
+                    const auto target = find_first_non_full(hash);
+                    set_ctrl(target, static_cast<ctrl_t>(h2(hash)));
+                    Policy::transfer(slots + target, old_slots + i);
+                }
+
+                if (old_cap != 0) {
+                    std::allocator<value_type>().deallocate(old_slots, old_cap);
+                    delete[] old_ctrl;
+                }
+            }
+
+            void destroy_all() noexcept {
+                if constexpr (!std::is_trivially_destructible_v<value_type>) {
+                    for (std::size_t i = 0; i < cap; i++)
+                        if (ctrl[i] >= 0)
+                            std::destroy_at(slots + i);
+                }
+            }
+
+            /**
+             * @brief Insert an entry constructed from `args` unless `key` is there already.
+             */
+            template <typename Q, typename... Args>
+            std::pair<std::size_t, bool> emplace_key(const Q& key, Args&&... args) {
+                const auto hash = hash_of(key);
+                if (const auto i = find_index(key, hash); i != npos)
+                    return {i, false};
+
+                const auto i = prepare_insert(hash);
+                try {
+                    ::new (slots + i) value_type(std::forward<Args>(args)...);
+                } catch (...) {
+                    cancel_insert(i);
+                    throw;
+                }
+                return {i, true};
+            }
+
+            template <bool Const>
+            class basic_iterator {
+                friend class raw_hash_table;
+
+                using table_type = std::conditional_t<Const, const raw_hash_table, raw_hash_table>;
+
+                table_type* table = nullptr;
+                std::size_t index = 0;
+
+                basic_iterator(table_type* table, std::size_t index) noexcept : table(table), index(index) {}
+
+                void skip_empty() noexcept {
+                    while (index < table->cap && table->ctrl[index] < 0)
+                        index++;
+                }
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename Policy::value_type;
+                using difference_type = std::ptrdiff_t;
+                using reference = std::conditional_t<Const || !Policy::mutable_values, const value_type&, value_type&>;
+                using pointer = std::add_pointer_t<reference>;
+
+                basic_iterator() = default;
+
+                // a const_iterator from an iterator
+                template <bool OtherConst>
+                requires (Const && !OtherConst)
+                basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+                    : table(other.table), index(other.index) {}
+
+                reference operator*() const noexcept { return table->slots[index]; }
+
+                pointer operator->() const noexcept { return table->slots + index; }
+
+                basic_iterator& operator++() noexcept {
+                    index++;
+                    skip_empty();
+                    return *this;
+                }
+
+                basic_iterator operator++(int) noexcept {
+                    auto copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                template <bool OtherConst>
+                bool operator==(const basic_iterator<OtherConst>& other) const noexcept {
+                    return index == other.index;
+                }
+
+                friend class basic_iterator<!Const>;
+            };
+
+        public:
+            using iterator = basic_iterator<false>;
+            using const_iterator = basic_iterator<true>;
+
+        protected:
+            iterator iterator_at(std::size_t i) noexcept {
+                return iterator(this, i);
+            }
+
+        public:
+
+            raw_hash_table() = default;
+
+            explicit raw_hash_table(std::size_t capacity, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+                : hash_fn(hash), eq_fn(equal) {
+                reserve(capacity);
+            }
+
+            raw_hash_table(const raw_hash_table& other) : hash_fn(other.hash_fn), eq_fn(other.eq_fn) {
+                reserve(other.used);
+                for (const auto& value : other)
+                    emplace_key(Policy::key(value), value);
+            }
+
+            raw_hash_table(raw_hash_table&& other) noexcept
+                : ctrl(std::exchange(other.ctrl, nullptr)), slots(std::exchange(other.slots, nullptr)),
+                  cap(std::exchange(other.cap, 0)), used(std::exchange(other.used, 0)),
+                  growth_left(std::exchange(other.growth_left, 0)), hash_fn(std::move(other.hash_fn)),
+                  eq_fn(std::move(other.eq_fn)) {}
+
+            raw_hash_table& operator=(const raw_hash_table& other) {
+                if (this != &other) {
+                    raw_hash_table copy(other);
+                    swap(copy);
+                }
+                return *this;
+            }
+
+            raw_hash_table& operator=(raw_hash_table&& other) noexcept {
+                if (this != &other) {
+                    raw_hash_table moved(std::move(other));
+                    swap(moved);
+                }
+                return *this;
+            }
+
+            ~raw_hash_table() {
+                destroy_all();
+                resize_to_nothing();
+            }
+
+            void swap(raw_hash_table& other) noexcept {
+                std::swap(ctrl, other.ctrl);
+                std::swap(slots, other.slots);
+                std::swap(cap, other.cap);
+                std::swap(used, other.used);
+                std::swap(growth_left, other.growth_left);
+                std::swap(hash_fn, other.hash_fn);
+                std::swap(eq_fn, other.eq_fn);
+            }
+
+            iterator begin() noexcept {
+                iterator it(this, 0);
+                it.skip_empty();
+                return it;
+            }
+
+            const_iterator begin() const noexcept {
+                const_iterator it(this, 0);
+                it.skip_empty();
+                return it;
+            }
+
+            const_iterator cbegin() const noexcept { return begin(); }
+
+            iterator end() noexcept { return iterator(this, cap); }
+
+            const_iterator end() const noexcept { return const_iterator(this, cap); }
+
+            const_iterator cend() const noexcept { return end(); }
+
+            [[nodiscard]] bool empty() const noexcept { return used == 0; }
+
+            [[nodiscard]] std::size_t size() const noexcept { return used; }
+
+            /**
+             * @brief Slots allocated, of which at most 7/8 are used before the table grows.
+             */
+            [[nodiscard]] std::size_t capacity() const noexcept { return cap; }
+
+            [[nodiscard]] float load_factor() const noexcept {
+                return cap == 0 ? 0 : static_cast<float>(used) / static_cast<float>(cap);
+            }
+
+            [[nodiscard]] static constexpr float max_load_factor() noexcept { return 0.875f; }
+
+            [[nodiscard]] hasher hash_function() const { return hash_fn; }
+
+            [[nodiscard]] key_equal key_eq() const { return eq_fn; }
+
+            /**
+             * @brief Make room for `n` entries in all, so that inserting up to that many does not rehash.
+             */
+            void reserve(std::size_t n) {
+                if (n > used + growth_left)
+                    resize(capacity_for(std::max(n, used)));
+            }
+
+            /**
+             * @brief Rebuild the table with room for `n` entries at least and without tombstones. `rehash(0)`
+             * shrinks it to what its entries need.
+             */
+            void rehash(std::size_t n) {
+                const auto capacity = capacity_for(std::max(n, used));
+                if (capacity != cap || growth_left != max_load(cap) - used)
+                    resize(capacity);
+            }
+
+            /**
+             * @brief Drop every entry, keeping the slots.
+             */
+            void clear() noexcept {
+                destroy_all();
+                if (cap != 0)
+                    std::fill_n(ctrl, cap + WIDTH, CTRL_EMPTY);
+                used = 0;
+                growth_left = max_load(cap);
+            }
+
+            template <typename Q = key_type>
+            iterator find(const key_arg<Q>& key) {
+                const auto i = find_index(key, hash_of(key));
+                return i == npos ? end() : iterator(this, i);
+            }
+
+            template <typename Q = key_type>
+            const_iterator find(const key_arg<Q>& key) const {
+                const auto i = find_index(key, hash_of(key));
+                return i == npos ? end() : const_iterator(this, i);
+            }
+
+            template <typename Q = key_type>
+            [[nodiscard]] bool contains(const key_arg<Q>& key) const {
+                return find_index(key, hash_of(key)) != npos;
+            }
+
+            template <typename Q = key_type>
+            [[nodiscard]] std::size_t count(const key_arg<Q>& key) const {
+                return contains<Q>(key);
+            }
+
+            std::pair<iterator, bool> insert(const value_type& value) {
+                auto [i, inserted] = emplace_key(Policy::key(value), value);
+                return {iterator(this, i), inserted};
+            }
+
+            std::pair<iterator, bool> insert(value_type&& value) {
+                auto [i, inserted] = emplace_key(Policy::key(value), std::move(value));
+                return {iterator(this, i), inserted};
+            }
+
+            template <typename It>
+            void insert(It first, It last) {
+                for (; first != last; ++first)
+                    insert(*first);
+            }
+
+            void insert(std::initializer_list<value_type> values) {
+                insert(values.begin(), values.end());
+            }
+
+            /**
+             * @brief Construct an entry from `args` and keep it unless its key is there already.
+             */
+            template <typename... Args>
+            std::pair<iterator, bool> emplace(Args&&... args) {
+                value_type value(std::forward<Args>(args)...);
+                return insert(std::move(value));
+            }
+
+            /**
+             * @return the iterator to the entry after the erased one.
+             */
+            iterator erase(const_iterator pos) {
+                erase_at(pos.index);
+                iterator next(this, pos.index);
+                next.skip_empty();
+                return next;
+            }
+
+            iterator erase(iterator pos) {
+                return erase(const_iterator(pos));
+            }
+
+            template <typename Q = key_type>
+            std::size_t erase(const key_arg<Q>& key) {
+                const auto i = find_index(key, hash_of(key));
+                if (i == npos)
+                    return 0;
+                erase_at(i);
+                return 1;
+            }
+
+        private:
+            void resize_to_nothing() noexcept {
+                if (cap != 0) {
+                    std::allocator<value_type>().deallocate(slots, cap);
+                    delete[] ctrl;
+                }
+                ctrl = nullptr;
+                slots = nullptr;
+                cap = used = growth_left = 0;
+            }
+        };
+    }
+
+    /**
+     * @brief A hash map keeping its entries in one array, probed with SIMD compares of 16 hash bytes at once.
+     *
+     * Faster than `std::unordered_map` for lookups and inserts and much lighter on memory, but inserting or
+     * rehashing moves the entries, which invalidates references and iterators to them. Lookups take anything the
+     * hash and the equality accept when both declare `is_transparent`, a `std::string_view` for `std::string` keys
+     * for instance.
+     */
+    template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    class flat_hash_map : public detail::raw_hash_table<detail::map_policy<K, V>, Hash, KeyEqual> {
+        using base = detail::raw_hash_table<detail::map_policy<K, V>, Hash, KeyEqual>;
+
+    public:
+        using mapped_type = V;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        using base::base;
+
+        flat_hash_map(std::initializer_list<typename base::value_type> values) {
+            this->reserve(values.size());
+            this->insert(values);
+        }
+
+        /**
+         * @brief Insert `V(args...)` under `key` unless the key is there already, in which case nothing is
+         * constructed.
+         */
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+            auto [i, inserted] = this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                                   std::forward_as_tuple(std::forward<Args>(args)...));
+            return {this->iterator_at(i), inserted};
+        }
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+            // the key is only moved from once the slot for it is found
+            auto [i, inserted] = this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                                   std::forward_as_tuple(std::forward<Args>(args)...));
+            return {this->iterator_at(i), inserted};
+        }
+
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(const K& key, M&& value) {
+            auto result = try_emplace(key, std::forward<M>(value));
+            if (!result.second)
+                result.first->second = std::forward<M>(value);
+            return result;
+        }
+
+        template <typename M>
+        std::pair<iterator, bool> insert_or_assign(K&& key, M&& value) {
+            auto result = try_emplace(std::move(key), std::forward<M>(value));
+            if (!result.second)
+                result.first->second = std::forward<M>(value);
+            return result;
+        }
+
+        V& operator[](const K& key) {
+            return try_emplace(key).first->second;
+        }
+
+        V& operator[](K&& key) {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        /**
+         * @throws std::out_of_range when the key is not in the map.
+         */
+        template <typename Q = K>
+        V& at(const typename base::template key_arg<Q>& key) {
+            auto found = this->template find<Q>(key);
+            if (found == this->end())
+                throw std::out_of_range("flat_hash_map::at: key not found");
+            return found->second;
+        }
+
+        template <typename Q = K>
+        const V& at(const typename base::template key_arg<Q>& key) const {
+            auto found = this->template find<Q>(key);
+            if (found == this->end())
+                throw std::out_of_range("flat_hash_map::at: key not found");
+            return found->second;
+        }
+
+        friend bool operator==(const flat_hash_map& a, const flat_hash_map& b) {
+            if (a.size() != b.size())
+                return false;
+            for (const auto& [key, value] : a) {
+                auto found = b.find(key);
+                if (found == b.end() || !(found->second == value))
+                    return false;
+            }
+            return true;
+        }
+
+    };
+
+    /**
+     * @brief A hash set keeping its keys in one array, see `flat_hash_map`.
+     */
+    template <typename K, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    class flat_hash_set : public detail::raw_hash_table<detail::set_policy<K>, Hash, KeyEqual> {
+        using base = detail::raw_hash_table<detail::set_policy<K>, Hash, KeyEqual>;
+
+    public:
+        using base::base;
+
+        flat_hash_set(std::initializer_list<K> values) {
+            this->reserve(values.size());
+            this->insert(values);
+        }
+
+        friend bool operator==(const flat_hash_set& a, const flat_hash_set& b) {
+            if (a.size() != b.size())
+                return false;
+            for (const auto& key : a)
+                if (!b.contains(key))
+                    return false;
+            return true;
+        }
+    };
+}
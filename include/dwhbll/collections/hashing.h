@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dwhbll::collections::detail {
+    /**
+     * @brief Mix the bits of a `std::hash`, which is the identity for integers on most standard libraries.
+     */
+    constexpr std::uint64_t spread(std::uint64_t hash) noexcept {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+}
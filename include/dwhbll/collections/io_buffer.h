@@ -0,0 +1,167 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <dwhbll/concurrency/spinlock.h>
+#include <dwhbll/sanify/types.hpp>
+
+namespace dwhbll::collections {
+    class io_buffer;
+
+    /**
+     * @brief Recycles the fixed size segments io_buffers are made of.
+     *
+     * Segments are carved out of slabs of `SEGMENTS_PER_SLAB` and go back to the pool they came from once a buffer
+     * is done with them, so a connection or file that comes and goes does not touch the allocator. Each thread (so
+     * each reactor) has its own pool through `local()`, the lock only matters when a buffer is destroyed on another
+     * thread than the one that filled it.
+     */
+    class io_buffer_pool {
+    public:
+        constexpr static std::size_t SEGMENT_SIZE = 16 * 1024;
+        constexpr static std::size_t SEGMENTS_PER_SLAB = 16;
+
+        struct segment {
+            segment *next = nullptr;
+            io_buffer_pool *owner = nullptr;
+            /// readable bytes are [head, tail), writable ones [tail, SEGMENT_SIZE)
+            std::uint32_t head = 0, tail = 0;
+            sanify::u8 *data = nullptr;
+        };
+
+    private:
+        struct slab {
+            std::unique_ptr<sanify::u8[]> memory;
+            segment segments[SEGMENTS_PER_SLAB];
+        };
+
+        concurrency::spinlock lock;
+        std::vector<std::unique_ptr<slab>> slabs;
+        segment *free_list = nullptr;
+        std::size_t outstanding = 0;
+        /// the owning thread exited, the pool deletes itself once its last segment comes back
+        bool orphaned = false;
+
+        friend struct local_pool_holder;
+
+        void retire();
+
+    public:
+        io_buffer_pool() = default;
+
+        io_buffer_pool(const io_buffer_pool &other) = delete;
+
+        io_buffer_pool & operator=(const io_buffer_pool &other) = delete;
+
+        /**
+         * @brief The calling thread's pool.
+         */
+        static io_buffer_pool& local();
+
+        segment* acquire();
+
+        void release(segment *seg);
+
+        /**
+         * @return segments handed out and not released yet.
+         */
+        [[nodiscard]] std::size_t in_use();
+
+        /**
+         * @return segments allocated so far, in use or not.
+         */
+        [[nodiscard]] std::size_t capacity();
+    };
+
+    /**
+     * @brief Byte queue made of a chain of pooled segments.
+     *
+     * Grows by chaining segments rather than reallocating, so nothing that was written is ever moved. Readers and
+     * writers work on the segments in place through `readable()`/`consume()` and `writable()`/`commit()`, which
+     * map directly onto `read`/`write` calls, and `gather()` onto `readv`/`writev`.
+     */
+    class io_buffer {
+        using segment = io_buffer_pool::segment;
+
+        /// nullptr takes segments from the pool of whichever thread is writing
+        io_buffer_pool *pool;
+        segment *head_ = nullptr, *tail_ = nullptr;
+        std::size_t size_ = 0;
+
+        void pop_front_segment();
+
+    public:
+        io_buffer();
+
+        /**
+         * @brief Buffer taking its segments from `pool` instead of the writing thread's pool.
+         */
+        explicit io_buffer(io_buffer_pool &pool);
+
+        ~io_buffer();
+
+        io_buffer(const io_buffer &other) = delete;
+
+        io_buffer(io_buffer &&other) noexcept;
+
+        io_buffer & operator=(const io_buffer &other) = delete;
+
+        io_buffer & operator=(io_buffer &&other) noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        /**
+         * @brief The first contiguous run of readable bytes, empty only if the buffer is.
+         */
+        [[nodiscard]] std::span<const sanify::u8> readable() const noexcept;
+
+        /**
+         * @brief Drop the first `count` readable bytes, segments emptied on the way go back to the pool.
+         */
+        void consume(std::size_t count);
+
+        /**
+         * @brief Contiguous free space at the end, a new segment is chained if the last one is full.
+         */
+        [[nodiscard]] std::span<sanify::u8> writable();
+
+        /**
+         * @brief Mark the first `count` bytes of the last `writable()` span as written.
+         */
+        void commit(std::size_t count);
+
+        void append(std::span<const sanify::u8> data);
+
+        /**
+         * @brief Copy up to `out.size()` bytes out and consume them.
+         * @return number of bytes copied.
+         */
+        std::size_t read(std::span<sanify::u8> out);
+
+        /**
+         * @brief Copy up to `out.size()` bytes starting `offset` bytes in, without consuming anything.
+         * @return number of bytes copied.
+         */
+        std::size_t peek(std::span<sanify::u8> out, std::size_t offset = 0) const;
+
+        [[nodiscard]] sanify::u8 operator[](std::size_t index) const;
+
+        /**
+         * @brief Describe the readable bytes as iovecs, for writev and friends.
+         * @return number of entries filled, the readable bytes may need more than `out` holds.
+         */
+        std::size_t gather(std::span<iovec> out) const noexcept;
+
+        /**
+         * @brief Drop everything, the segments go back to the pool.
+         */
+        void clear();
+    };
+}
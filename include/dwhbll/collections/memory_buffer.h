@@ -2,7 +2,7 @@
 
 #include <span>
 
-#include <dwhbll/collections/ring.h>
+#include <dwhbll/collections/io_buffer.h>
 #include <dwhbll/concurrency/spinlock.h>
 #include <dwhbll/concurrency/coroutine/task.h>
 #include <dwhbll/sanify/types.hpp>
@@ -13,7 +13,7 @@ namespace dwhbll::collections {
      */
     class MemBuf {
     protected:
-        Ring<sanify::u8> buffer;
+        io_buffer buffer;
 
         std::unique_ptr<concurrency::spinlock> _lock;
 
@@ -26,6 +26,9 @@ namespace dwhbll::collections {
 
         explicit MemBuf(std::span<const sanify::u8> buffer);
 
+        /**
+         * @brief kept for compatibility, the storage grows in pooled segments so there is nothing to reserve.
+         */
         explicit MemBuf(std::size_t reserved_size);
 
         MemBuf(const MemBuf &other) = delete;
@@ -36,9 +39,6 @@ namespace dwhbll::collections {
 
         MemBuf & operator=(MemBuf &&other) noexcept;
 
-        /**
-         * @brief if no data is given, the buffer is set to a size of 1024 by default.
-         */
         MemBuf();
 
         /**
@@ -99,6 +99,6 @@ namespace dwhbll::collections {
 
         virtual concurrency::coroutine::task<> refill_buffer_async();
 
-        Ring<sanify::u8>& get_raw_buffer();
+        io_buffer& get_raw_buffer();
     };
 }
@@ -1,638 +1,509 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
+#include <memory>
+#include <span>
 #include <stdexcept>
-#include <vector>
+#include <type_traits>
+#include <utility>
 
 namespace dwhbll::collections {
+    /**
+     * @brief Whether moving a `T` to another address and forgetting the old one is the same as copying its bytes.
+     *
+     * True for trivially copyable types, specialise it for types that are not but still hold no pointers into
+     * themselves.
+     */
+    template <typename T>
+    struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+    // std::pair has its own assignment operators, which make it non trivially copyable even over pointers
+    template <typename A, typename B>
+    struct is_trivially_relocatable<std::pair<A, B>>
+        : std::bool_constant<is_trivially_relocatable<A>::value && is_trivially_relocatable<B>::value> {};
+
+    template <typename T>
+    constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    namespace detail {
+        template <typename T, std::size_t N>
+        struct ring_inline_storage {
+            alignas(T) std::byte bytes[N * sizeof(T)];
+
+            T* data() noexcept {
+                return reinterpret_cast<T*>(bytes);
+            }
+        };
+
+        template <typename T>
+        struct ring_inline_storage<T, 0> {
+            T* data() noexcept {
+                return nullptr;
+            }
+        };
+    }
+
     /**
      * @brief A simple ring buffer
+     *
+     * Slots past the elements are left uninitialised, only what is pushed gets constructed. Growing relocates the
+     * elements with memcpy when `T` is trivially relocatable and moves them one by one otherwise.
      * @tparam T The inner type
+     * @tparam InlineCapacity elements held inside the ring itself before it allocates, so tiny queues never touch
+     * the heap
      * @note emplace operations will invalidate
      */
-    template <typename T>
+    template <typename T, std::size_t InlineCapacity = 0>
     class Ring {
-        // these hold the information on the current front and backs.
-        // head holds the first index
-        // tail holds the first index past
-        // head == tail means the buffer is full (or entire thing is empty);
-        std::size_t head{}, tail{};
-        std::size_t sz{};
-        std::vector<T> _M_data;
-        bool needsResize{false};
-
-        void inc_tail() {
-            tail++;
-            if (tail >= _M_data.size()) {
-                tail = 0; // wrap around
-            }
-            if (tail == head) {
-                // next insertion is going to run the head into the tail.
-                needsResize = true;
-            }
+        // head is the slot of the first element, the elements wrap around the end of the buffer.
+        std::size_t head{}, sz{}, cap{};
+        T* _M_data = nullptr;
+        [[no_unique_address]] detail::ring_inline_storage<T, InlineCapacity> local;
+
+        [[nodiscard]] bool is_inline() const noexcept {
+            return InlineCapacity != 0 && _M_data == const_cast<Ring*>(this)->local.data();
         }
 
-        void dec_tail() {
-            if (tail == 0)
-                tail = _M_data.size() - 1;
-            else
-                tail--;
-            if (needsResize) {
-                // we needed more space, now we don't
-                needsResize = false;
-            }
+        /**
+         * @return the slot of the `index`th element.
+         */
+        [[nodiscard]] std::size_t slot(std::size_t index) const noexcept {
+            index += head;
+            return index >= cap ? index - cap : index;
         }
 
-        void inc_head() {
-            head++;
-            if (head >= _M_data.size()) {
-                head = 0; // wrap around
-            }
-            if (needsResize) {
-                // we needed more space, now we don't
-                needsResize = false;
+        void release() noexcept {
+            if (_M_data && !is_inline())
+                std::allocator<T>{}.deallocate(_M_data, cap);
+            _M_data = nullptr;
+            cap = 0;
+        }
+
+        /**
+         * @brief Move the elements in order into a buffer of `target` slots, `target` has to hold them all.
+         */
+        void relocate(std::size_t target) {
+            const bool to_inline = target <= InlineCapacity && !is_inline();
+            T* fresh = to_inline ? local.data() : target == 0 ? nullptr : std::allocator<T>{}.allocate(target);
+
+            auto [first, second] = segments();
+
+            if constexpr (is_trivially_relocatable_v<T>) {
+                if (!first.empty())
+                    std::memcpy(static_cast<void*>(fresh), first.data(), first.size() * sizeof(T));
+                if (!second.empty())
+                    std::memcpy(static_cast<void*>(fresh + first.size()), second.data(), second.size() * sizeof(T));
+            } else {
+                std::size_t i = 0;
+                for (const auto segment : {first, second}) {
+                    for (T& element : segment) {
+                        ::new (static_cast<void*>(fresh + i++)) T(std::move(element));
+                        element.~T();
+                    }
+                }
             }
+
+            release();
+            _M_data = fresh;
+            cap = to_inline ? InlineCapacity : target;
+            head = 0;
         }
 
-        void dec_head() {
-            if (head == 0)
-                head = _M_data.size() - 1;
-            else
-                head--;
-            if (tail == head) {
-                // next insertion is going to run the head into the tail.
-                needsResize = true;
+        void grow_for(std::size_t count) {
+            if (sz + count > cap)
+                relocate(std::max(sz + count, cap == 0 ? 2 : cap * 2));
+        }
+
+        void destroy_front(std::size_t count) noexcept {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (std::size_t i = 0; i < count; i++)
+                    _M_data[slot(i)].~T();
             }
         }
 
-        void resize() {
-            std::vector<T> newData;
-            if (_M_data.size() == 0)
-                newData.resize(2);
-            else
-                newData.resize(_M_data.size() * 2); // double size
-            // put it all in order
-            if (tail >= head) {
-                // it's actually already in order.
-                std::memcpy(newData.data(), _M_data.data() + head, sz * sizeof(T));
+    public:
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        explicit Ring(std::size_t defaultSize) {
+            if (defaultSize <= InlineCapacity) {
+                _M_data = local.data();
+                cap = InlineCapacity;
             } else {
-                // it's not quite in order
-                std::memcpy(newData.data(), _M_data.data() + head, (_M_data.size() - head) * sizeof(T));
-                std::memcpy(newData.data() + (_M_data.size() - head), _M_data.data(), tail * sizeof(T));
+                _M_data = std::allocator<T>{}.allocate(defaultSize);
+                cap = defaultSize;
+            }
+        }
+
+        Ring() : Ring(InlineCapacity != 0 ? InlineCapacity : 16) {}
+
+        Ring(const Ring& other) : Ring(other.sz) {
+            for (const auto segment : other.segments())
+                push_back(segment);
+        }
+
+        Ring(Ring&& other) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+            take(std::move(other));
+        }
+
+        Ring& operator=(const Ring& other) {
+            if (this == &other)
+                return *this;
+
+            clear();
+            for (const auto segment : other.segments())
+                push_back(segment);
+            return *this;
+        }
+
+        Ring& operator=(Ring&& other) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+            if (this == &other)
+                return *this;
+
+            clear();
+            release();
+            take(std::move(other));
+            return *this;
+        }
+
+        ~Ring() {
+            clear();
+            release();
+        }
+
+    private:
+        /**
+         * @brief Take the elements of `other`, stealing its buffer unless it is held inline.
+         */
+        void take(Ring&& other) {
+            if (!other.is_inline()) {
+                _M_data = std::exchange(other._M_data, nullptr);
+                head = std::exchange(other.head, 0);
+                sz = std::exchange(other.sz, 0);
+                cap = std::exchange(other.cap, 0);
+                return;
             }
-            _M_data = std::move(newData);
+
+            _M_data = local.data();
+            cap = InlineCapacity;
             head = 0;
-            tail = sz;
-            needsResize = false;
+            sz = 0;
+
+            for (std::size_t i = 0; i < other.sz; i++)
+                ::new (static_cast<void*>(_M_data + i)) T(std::move(other[i]));
+            sz = other.sz;
+            other.clear();
         }
 
     public:
-        using value_type = typename std::vector<T>::value_type;
-        using reference = typename std::vector<T>::reference;
-        using const_reference = typename std::vector<T>::const_reference;
-        using pointer = typename std::vector<T>::pointer;
-
-        explicit Ring(std::size_t defaultSize) : _M_data(defaultSize) {}
+        template <typename... Args>
+        reference emplace_back(Args&&... args) {
+            grow_for(1);
+            T* element = ::new (static_cast<void*>(_M_data + slot(sz))) T(std::forward<Args>(args)...);
+            sz++;
+            return *element;
+        }
 
-        Ring() : _M_data(16) {}
+        template <typename... Args>
+        reference emplace_front(Args&&... args) {
+            grow_for(1);
+            const std::size_t at = head == 0 ? cap - 1 : head - 1;
+            T* element = ::new (static_cast<void*>(_M_data + at)) T(std::forward<Args>(args)...);
+            head = at;
+            sz++;
+            return *element;
+        }
 
         void push_back(T data) {
-            if (needsResize)
-                resize();
-            this->_M_data[tail] = data;
-            inc_tail();
-            sz++;
+            emplace_back(std::move(data));
         }
 
         void move_back(T&& data) {
-            if (needsResize)
-                resize();
-            this->_M_data[tail] = std::move(data);
-            inc_tail();
-            sz++;
+            emplace_back(std::move(data));
         }
 
         void pop_back() {
             if (sz == 0)
                 throw std::out_of_range("size is already zero.");
-            dec_tail();
             sz--;
+            _M_data[slot(sz)].~T();
         }
 
         void push_front(T data) {
-            if (needsResize)
-                resize();
-            dec_head();
-            this->_M_data[head] = data;
-            sz++;
+            emplace_front(std::move(data));
         }
 
         void pop_front() {
             if (sz == 0)
                 throw std::out_of_range("size is already zero.");
-            inc_head();
-            sz--;
+            discard(1);
         }
 
         void clear() {
+            destroy_front(sz);
             head = 0;
-            tail = 0;
             sz = 0;
         }
 
+        /**
+         * @brief Make room for `count` elements without growing again.
+         */
+        void reserve(std::size_t count) {
+            if (count > cap)
+                relocate(count);
+        }
+
+        /**
+         * @brief Append `items` with at most two copies, growing the buffer once if they do not fit.
+         */
+        void push_back(std::span<const T> items) {
+            if (items.empty())
+                return;
+
+            grow_for(items.size());
+
+            const std::size_t at = slot(sz);
+            const std::size_t first = std::min(items.size(), cap - at);
+            std::uninitialized_copy_n(items.begin(), first, _M_data + at);
+            std::uninitialized_copy(items.begin() + first, items.end(), _M_data);
+
+            sz += items.size();
+        }
+
+        /**
+         * @brief Move up to `out.size()` elements off the front into `out`.
+         * @return the number of elements moved.
+         */
+        std::size_t pop_front_into(std::span<T> out) {
+            const std::size_t count = std::min(out.size(), sz);
+            auto [first, second] = segments();
+
+            const std::size_t from_first = std::min(count, first.size());
+            std::move(first.begin(), first.begin() + from_first, out.begin());
+            std::move(second.begin(), second.begin() + (count - from_first), out.begin() + from_first);
+
+            discard(count);
+            return count;
+        }
+
+        /**
+         * @brief Drop the first `count` elements.
+         * @throws std::out_of_range when fewer than `count` are held.
+         */
+        void discard(std::size_t count) {
+            if (count > sz)
+                throw std::out_of_range("discarding more than the ring holds.");
+
+            if (count == 0)
+                return;
+
+            destroy_front(count);
+            sz -= count;
+
+            // an empty ring starts over at the front, so the next writes stay in one segment
+            head = sz == 0 ? 0 : slot(count);
+        }
+
+        /**
+         * @brief The elements in order as up to two contiguous spans, the second one is empty unless they wrap
+         * around the end of the buffer. For byte rings they can be handed to `writev` as they are.
+         */
+        [[nodiscard]] std::array<std::span<T>, 2> segments() noexcept {
+            const std::size_t first = std::min(sz, cap - head);
+            return {std::span<T>{_M_data + head, first}, std::span<T>{_M_data, sz - first}};
+        }
+
+        [[nodiscard]] std::array<std::span<const T>, 2> segments() const noexcept {
+            const std::size_t first = std::min(sz, cap - head);
+            return {std::span<const T>{_M_data + head, first}, std::span<const T>{_M_data, sz - first}};
+        }
+
         /**
          * Rebuild the buffer such that the data inside is now continuous
          */
         void make_cont() {
-            if (tail >= head && head == 0)
+            if (head == 0)
                 return;
 
-            std::vector<T> newData;
-            newData.resize(_M_data.size());
-
-            // put it all in order
-            if (tail >= head) {
-                // it's actually already in order.
-                std::memcpy(newData.data(), _M_data.data() + head, sz * sizeof(T));
-            } else {
-                // it's not quite in order
-                std::memcpy(newData.data(), _M_data.data() + head, (_M_data.size() - head) * sizeof(T));
-                std::memcpy(newData.data() + (_M_data.size() - head), _M_data.data(), tail * sizeof(T));
-            }
-            _M_data = std::move(newData);
-            head = 0;
-            tail = sz;
+            // an inline buffer cannot be rearranged into itself, it moves out to the heap
+            relocate(cap);
         }
 
         template <typename IterType>
         void assign(IterType start, IterType end) {
-            sz = end - start;
-            _M_data.resize(sz);
-            std::copy(start, end, _M_data.begin());
-            head = 0;
-            tail = end - start;
+            clear();
+            reserve(static_cast<std::size_t>(std::distance(start, end)));
+            for (; start != end; ++start)
+                emplace_back(*start);
         }
 
+        /**
+         * @brief Change the capacity to `target`, the elements that do not fit are dropped from the back.
+         */
         void resize(std::size_t target) {
-            std::vector<T> newData;
-            newData.resize(target);
-            if (target > _M_data.size()) {
-                // put it all in order
-                if (tail >= head) {
-                    // it's actually already in order.
-                    std::memcpy(newData.data(), _M_data.data() + head, sz * sizeof(T));
-                } else {
-                    // it's not quite in order
-                    std::memcpy(newData.data(), _M_data.data() + head, (_M_data.size() - head) * sizeof(T));
-                    std::memcpy(newData.data() + (_M_data.size() - head), _M_data.data(), tail * sizeof(T));
-                }
-            } else {
-                // we gonna run out of space, chop off the end
-                if (tail >= head) {
-                    // it's actually already in order.
-                    std::memcpy(newData.data(), _M_data.data() + head, target * sizeof(T));
-                } else {
-                    // it's not quite in order
-                    std::memcpy(newData.data(), _M_data.data() + head, std::min((_M_data.size() - head), target) * sizeof(T));
-                    if (target > _M_data.size() - head)
-                        std::memcpy(newData.data() + (_M_data.size() - head), _M_data.data(), (target - (_M_data.size() - head)) * sizeof(T));
-                }
-            }
-            _M_data = std::move(newData);
-            head = 0;
-            tail = sz;
-            needsResize = false;
+            while (sz > target)
+                pop_back();
+            relocate(target);
         }
 
+        /**
+         * @brief Take the first `count` slots of `data()` as the elements, after they were written through it.
+         */
         void used(std::size_t count) {
-            if (count > _M_data.size()) {
-                resize(count);
-            }
-            tail = count;
+            static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_default_constructible_v<T>,
+                          "only rings of plain data can be written through data()");
+
+            if (count > cap)
+                relocate(count);
+            head = 0;
             sz = count;
-            if (sz == _M_data.size())
-                needsResize = true;
         }
 
-        std::vector<T>& data() {
+        /**
+         * @brief The storage, it starts with the first element after `make_cont()`.
+         */
+        pointer data() noexcept {
+            return _M_data;
+        }
+
+        const_pointer data() const noexcept {
             return _M_data;
         }
 
         [[nodiscard]] std::size_t size() const {
             return sz;
-            //if (tail > head)
-            //    return tail - head;
-            //return data.size() - head + tail;
         }
 
         [[nodiscard]] std::size_t capacity() const {
-            return _M_data.size();
+            return cap;
         }
 
-        class iterator {
-            Ring* parent;
-            long long index;
+        template <bool Const>
+        class basic_iterator {
+            using ring_type = std::conditional_t<Const, const Ring, Ring>;
+
+            ring_type* parent = nullptr;
+            /// position from the front, not the slot, so the end of a full ring differs from its beginning
+            std::size_t index = 0;
 
-            iterator(Ring* parent, const long long index) : parent(parent), index(index) {}
+            basic_iterator(ring_type* parent, std::size_t index) : parent(parent), index(index) {}
 
             friend class Ring;
 
         public:
-            using value_type = typename std::vector<T>::value_type;
+            using value_type = T;
             using difference_type = std::ptrdiff_t;
-            using reference = typename std::vector<T>::reference;
-            using pointer = typename std::vector<T>::pointer;
+            using reference = std::conditional_t<Const, const T&, T&>;
+            using pointer = std::conditional_t<Const, const T*, T*>;
             using iterator_category = std::random_access_iterator_tag;
 
-            iterator operator+(long long count) {
-                iterator n = *this;
-                n.index += count;
-                if (n.index < 0)
-                    n.index += parent->_M_data.size();
-                if (n.index > parent->_M_data.size())
-                    n.index -= parent->_M_data.size();
-                return n;
-            }
+            basic_iterator() = default;
 
-            iterator operator-(const long long count) {
-                return operator+(-count);
+            operator basic_iterator<true>() const noexcept requires (!Const) {
+                return {parent, index};
             }
 
-            difference_type operator-(const iterator& other) {
-#ifdef DWHBLL_HARDEN
-                if (parent != other.parent) {
-                    throw std::invalid_argument("taking the difference between iterators from different objects make no sense.");
-                }
-#endif
-                if (parent->tail > parent->head)
-                    return index - other.index;
-
-                // flatten out the indices.
-                std::size_t ia = index;
-                std::size_t ib = other.index;
-                if (ia < parent->head)
-                    ia += parent->_M_data.size();
-                if (ib < parent->head)
-                    ib += parent->_M_data.size();
-                return static_cast<long>(ia - ib);
+            reference operator*() const {
+                return (*parent)[index];
             }
 
-            reference operator*() {
-                return parent->_M_data[index];
+            pointer operator->() const {
+                return &(*parent)[index];
             }
 
-            pointer operator->() {
-                return parent->_M_data.data() + index;
+            reference operator[](difference_type offset) const {
+                return (*parent)[index + offset];
             }
 
-            iterator& operator++() {
-                index += 1;
-                if (index >= parent->_M_data.size())
-                    index -= parent->_M_data.size();
+            basic_iterator& operator++() {
+                index++;
                 return *this;
             }
 
-            iterator operator++(int) {
-                iterator tmp = *this;
-                index += 1;
-                if (index >= parent->_M_data.size())
-                    index -= parent->_M_data.size();
+            basic_iterator operator++(int) {
+                basic_iterator tmp = *this;
+                index++;
                 return tmp;
             }
 
-            iterator& operator--() {
-                index -= 1;
-                if (index < 0)
-                    index += parent->_M_data.size();
+            basic_iterator& operator--() {
+                index--;
                 return *this;
             }
 
-            iterator operator--(int) {
-                iterator tmp = *this;
-                index -= 1;
-                if (index < 0)
-                    index += parent->_M_data.size();
+            basic_iterator operator--(int) {
+                basic_iterator tmp = *this;
+                index--;
                 return tmp;
             }
 
-            friend bool operator==(const iterator &lhs, const iterator &rhs) {
-                return lhs.parent == rhs.parent
-                       && lhs.index == rhs.index;
-            }
-
-            friend bool operator!=(const iterator &lhs, const iterator &rhs) {
-                return !(lhs == rhs);
-            }
-        };
-
-        class reverse_iterator {
-            Ring* parent;
-            long long index;
-
-            reverse_iterator(Ring* parent, const long long index) : parent(parent), index(index) {}
-
-            friend class Ring;
-
-        public:
-            using value_type = typename std::vector<T>::value_type;
-            using difference_type = std::ptrdiff_t;
-            using reference = typename std::vector<T>::reference;
-            using pointer = typename std::vector<T>::pointer;
-            using iterator_category = std::random_access_iterator_tag;
-
-            reverse_iterator operator-(long long count) {
-                reverse_iterator n = *this;
-                n.index += count;
-                if (n.index < 0)
-                    n.index += parent->_M_data.size();
-                if (n.index > parent->_M_data.size())
-                    n.index -= parent->_M_data.size();
-                return n;
-            }
-
-            reverse_iterator operator+(const long long count) {
-                return operator-(-count);
-            }
-
-            // TODO: taking the difference between reverse iterators :xdd:
-//             difference_type operator-(const reverse_iterator& other) {
-// #ifdef DWHBLL_HARDEN
-//                 if (parent != other.parent) {
-//                     throw std::invalid_argument("taking the difference between iterators from different objects make no sense.");
-//                 }
-// #endif
-//                 if (parent->tail > parent->head)
-//                     return index - other.index;
-//
-//                 // flatten out the indices.
-//                 std::size_t ia = index;
-//                 std::size_t ib = other.index;
-//                 if (ia < parent->head)
-//                     ia += parent->data.size();
-//                 if (ib < parent->head)
-//                     ib += parent->data.size();
-//                 return ia - ib;
-//             }
-
-            reference operator*() {
-                return parent->_M_data[index];
-            }
-
-            pointer operator->() {
-                return parent->_M_data.data() + index;
-            }
-
-            reverse_iterator& operator--() {
-                index += 1;
-                if (index >= parent->_M_data.size())
-                    index -= parent->_M_data.size();
+            basic_iterator& operator+=(difference_type count) {
+                index += count;
                 return *this;
             }
 
-            reverse_iterator operator--(int) {
-                reverse_iterator tmp = *this;
-                index += 1;
-                if (index >= parent->_M_data.size())
-                    index -= parent->_M_data.size();
-                return tmp;
-            }
-
-            reverse_iterator& operator++() {
-                index -= 1;
-                if (index < 0)
-                    index += parent->_M_data.size();
+            basic_iterator& operator-=(difference_type count) {
+                index -= count;
                 return *this;
             }
 
-            reverse_iterator operator++(int) {
-                reverse_iterator tmp = *this;
-                index -= 1;
-                if (index < 0)
-                    index += parent->_M_data.size();
-                return tmp;
-            }
-
-            friend bool operator==(const reverse_iterator &lhs, const reverse_iterator &rhs) {
-                return lhs.parent == rhs.parent
-                       && lhs.index == rhs.index;
-            }
-
-            friend bool operator!=(const reverse_iterator &lhs, const reverse_iterator &rhs) {
-                return !(lhs == rhs);
+            friend basic_iterator operator+(basic_iterator it, difference_type count) {
+                return it += count;
             }
-        };
-
-        class const_iterator {
-            Ring* parent;
-            long long index;
-
-            const_iterator(Ring* parent, const long long index) : parent(parent), index(index) {}
-
-            friend class Ring;
 
-        public:
-            using value_type = typename std::vector<T>::value_type;
-            using difference_type = std::ptrdiff_t;
-            using reference = typename std::vector<T>::reference;
-            using pointer = typename std::vector<T>::pointer;
-            using const_pointer = typename std::vector<T>::const_pointer;
-            using iterator_category = std::random_access_iterator_tag;
-
-            const_iterator operator+(long long count) {
-                const_iterator n = *this;
-                n.index += count;
-                if (n.index < 0)
-                    n.index += parent->_M_data.size();
-                if (n.index > parent->_M_data.size())
-                    n.index -= parent->_M_data.size();
-                return n;
+            friend basic_iterator operator+(difference_type count, basic_iterator it) {
+                return it += count;
             }
 
-            const_iterator operator-(const long long count) {
-                return operator+(-count);
+            friend basic_iterator operator-(basic_iterator it, difference_type count) {
+                return it -= count;
             }
 
-            difference_type operator-(const const_iterator& other) {
+            friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) {
 #ifdef DWHBLL_HARDEN
-                if (parent != other.parent) {
+                if (lhs.parent != rhs.parent) {
                     throw std::invalid_argument("taking the difference between iterators from different objects make no sense.");
                 }
 #endif
-                if (parent->tail > parent->head)
-                    return index - other.index;
-
-                // flatten out the indices.
-                std::size_t ia = index;
-                std::size_t ib = other.index;
-                if (ia < parent->head)
-                    ia += parent->_M_data.size();
-                if (ib < parent->head)
-                    ib += parent->_M_data.size();
-                return static_cast<long>(ia - ib);
-            }
-
-            const_reference operator*() const {
-                return parent->_M_data[index];
+                return static_cast<difference_type>(lhs.index) - static_cast<difference_type>(rhs.index);
             }
 
-            const_pointer operator->() const {
-                return parent->_M_data.data() + index;
+            friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) {
+                return lhs.parent == rhs.parent && lhs.index == rhs.index;
             }
 
-            const_iterator& operator++() {
-                index += 1;
-                if (index >= parent->_M_data.size())
-                    index -= parent->_M_data.size();
-                return *this;
-            }
-
-            const_iterator operator++(int) {
-                const_iterator tmp = *this;
-                index += 1;
-                if (index >= parent->_M_data.size())
-                    index -= parent->_M_data.size();
-                return tmp;
-            }
-
-            const_iterator& operator--() {
-                index -= 1;
-                if (index < 0)
-                    index += parent->_M_data.size();
-                return *this;
-            }
-
-            const_iterator operator--(int) {
-                const_iterator tmp = *this;
-                index -= 1;
-                if (index < 0)
-                    index += parent->_M_data.size();
-                return tmp;
-            }
-
-            friend bool operator==(const const_iterator &lhs, const const_iterator &rhs) {
-                return lhs.parent == rhs.parent
-                       && lhs.index == rhs.index;
-            }
-
-            friend bool operator!=(const const_iterator &lhs, const const_iterator &rhs) {
-                return !(lhs == rhs);
+            friend auto operator<=>(const basic_iterator& lhs, const basic_iterator& rhs) {
+                return lhs.index <=> rhs.index;
             }
         };
 
-        class const_reverse_iterator {
-            Ring* parent;
-            long long index;
-
-            const_reverse_iterator(Ring* parent, const long long index) : parent(parent), index(index) {}
-
-            friend class Ring;
-
-        public:
-            using value_type = typename std::vector<T>::value_type;
-            using difference_type = std::ptrdiff_t;
-            using reference = typename std::vector<T>::reference;
-            using pointer = typename std::vector<T>::pointer;
-            using const_pointer = typename std::vector<T>::const_pointer;
-            using iterator_category = std::random_access_iterator_tag;
-
-            const_reverse_iterator operator-(long long count) {
-                const_reverse_iterator n = *this;
-                n.index += count;
-                if (n.index < 0)
-                    n.index += parent->_M_data.size();
-                if (n.index > parent->_M_data.size())
-                    n.index -= parent->_M_data.size();
-                return n;
-            }
-
-            const_reverse_iterator operator+(const long long count) {
-                return operator-(-count);
-            }
-
-            // TODO: taking the difference between reverse iterators :xdd:
-//             difference_type operator-(const const_reverse_iterator& other) {
-// #ifdef DWHBLL_HARDEN
-//                 if (parent != other.parent) {
-//                     throw std::invalid_argument("taking the difference between iterators from different objects make no sense.");
-//                 }
-// #endif
-//                 if (parent->tail > parent->head)
-//                     return index - other.index;
-//
-//                 // flatten out the indices.
-//                 std::size_t ia = index;
-//                 std::size_t ib = other.index;
-//                 if (ia < parent->head)
-//                     ia += parent->data.size();
-//                 if (ib < parent->head)
-//                     ib += parent->data.size();
-//                 return ia - ib;
-//             }
-
-            const_reference operator*() const {
-                return parent->_M_data[index];
-            }
-
-            const_pointer operator->() {
-                return parent->_M_data.data() + index;
-            }
-
-            const_reverse_iterator& operator--() {
-                index += 1;
-                if (index >= parent->_M_data.size())
-                    index -= parent->_M_data.size();
-                return *this;
-            }
-
-            const_reverse_iterator operator--(int) {
-                const_reverse_iterator tmp = *this;
-                index += 1;
-                if (index >= parent->_M_data.size())
-                    index -= parent->_M_data.size();
-                return tmp;
-            }
-
-            const_reverse_iterator& operator++() {
-                index -= 1;
-                if (index < 0)
-                    index += parent->_M_data.size();
-                return *this;
-            }
-
-            const_reverse_iterator operator++(int) {
-                const_reverse_iterator tmp = *this;
-                index -= 1;
-                if (index < 0)
-                    index += parent->_M_data.size();
-                return tmp;
-            }
-
-            friend bool operator==(const const_reverse_iterator &lhs, const const_reverse_iterator &rhs) {
-                return lhs.parent == rhs.parent
-                       && lhs.index == rhs.index;
-            }
-
-            friend bool operator!=(const const_reverse_iterator &lhs, const const_reverse_iterator &rhs) {
-                return !(lhs == rhs);
-            }
-        };
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
         reference operator[](std::size_t index)
 #ifndef DWHBLL_HARDEN
             noexcept
 #endif
         {
-            // compute the index
-            index += head;
-            if (index > _M_data.size())
-                index -= _M_data.size();
 #ifdef DWHBLL_HARDEN
             // bounds check
-            if (index >= tail)
+            if (index >= sz)
                 throw std::out_of_range("index is out of range.");
 #endif
-            return _M_data[index];
+            return _M_data[slot(index)];
         }
 
         const_reference operator[](std::size_t index) const
@@ -640,16 +511,12 @@ namespace dwhbll::collections {
             noexcept
 #endif
         {
-            // compute the index
-            index += head;
-            if (index > _M_data.size())
-                index -= _M_data.size();
 #ifdef DWHBLL_HARDEN
             // bounds check
-            if (index >= tail)
+            if (index >= sz)
                 throw std::out_of_range("index is out of range.");
 #endif
-            return _M_data[index];
+            return _M_data[slot(index)];
         }
 
         /**
@@ -659,14 +526,10 @@ namespace dwhbll::collections {
          * @return reference to the data.
          */
         reference at(std::size_t index) {
-            // compute the index
-            index += head;
-            if (index > _M_data.size())
-                index -= _M_data.size();
             // bounds check
-            if (index >= tail)
+            if (index >= sz)
                 throw std::out_of_range("index is out of range.");
-            return _M_data[index];
+            return _M_data[slot(index)];
         }
 
         /**
@@ -676,14 +539,10 @@ namespace dwhbll::collections {
          * @return reference to the data.
          */
         const_reference at(std::size_t index) const {
-            // compute the index
-            index += head;
-            if (index > _M_data.size())
-                index -= _M_data.size();
             // bounds check
-            if (index >= tail)
+            if (index >= sz)
                 throw std::out_of_range("index is out of range.");
-            return _M_data[index];
+            return _M_data[slot(index)];
         }
 
         [[nodiscard]] bool empty() const noexcept {
@@ -723,7 +582,7 @@ namespace dwhbll::collections {
             if (empty())
                 throw std::out_of_range("ring buffer is empty.");
 #endif
-            return _M_data[tail == 0 ? _M_data.size() - 1 : tail - 1];
+            return _M_data[slot(sz - 1)];
         }
 
         const_reference back() const
@@ -735,33 +594,47 @@ namespace dwhbll::collections {
             if (empty())
                 throw std::out_of_range("ring buffer is empty.");
 #endif
-            return _M_data[tail == 0 ? _M_data.size() - 1 : tail - 1];
+            return _M_data[slot(sz - 1)];
         }
 
-        constexpr iterator begin() noexcept {
-            return iterator(this, head);
+        iterator begin() noexcept {
+            return iterator(this, 0);
         }
 
-        constexpr const_iterator begin() const noexcept {
-            return const_iterator(this, head);
+        const_iterator begin() const noexcept {
+            return const_iterator(this, 0);
         }
 
-        constexpr const_iterator cbegin() const noexcept {
-            return const_iterator(this, head);
+        const_iterator cbegin() const noexcept {
+            return const_iterator(this, 0);
         }
 
-        constexpr iterator end() noexcept {
-            return iterator(this, tail);
+        iterator end() noexcept {
+            return iterator(this, sz);
         }
 
-        constexpr const_iterator end() const noexcept {
-            return const_iterator(this, tail);
+        const_iterator end() const noexcept {
+            return const_iterator(this, sz);
         }
 
-        constexpr const_iterator cend() const noexcept {
-            return const_iterator(this, tail);
+        const_iterator cend() const noexcept {
+            return const_iterator(this, sz);
         }
 
-        // TODO: reverse iterators are not yet provided.
+        reverse_iterator rbegin() noexcept {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend() noexcept {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept {
+            return const_reverse_iterator(begin());
+        }
     };
 }
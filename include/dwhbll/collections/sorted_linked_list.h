@@ -6,6 +6,7 @@ namespace dwhbll::collections {
     /**
      * @brief A sorted linked list,
      * @tparam T The type stored by this linked list, the type needs to be orderable.
+     * @note every insert walks the list, `btree_multiset` offers the same operations in O(log n).
      */
     template <typename T, class Allocator = std::allocator<T>>
     class SortedLinkedList : protected std::list<T, Allocator> {
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <list>
+
+namespace dwhbll::collections {
+    /**
+     * @brief A hierarchical timing wheel, deadlines are bucketed by how far off they are so advancing the time only
+     * looks at the buckets it passed.
+     *
+     * Each of the 4 levels has 64 buckets, a bucket spans 2^26 ns (about 67 ms) on the lowest one and 64 times as
+     * much on every next one. Deadlines further off than the highest level reaches are kept in its buckets and
+     * looked at again each time it wraps. Times are in nanoseconds from any fixed point and never go backwards.
+     * @tparam T what is handed back once its deadline passes, cheap to copy
+     */
+    template <typename T>
+    class timer_wheel {
+        static constexpr int LEVELS = 4;
+        static constexpr int BUCKETS = 64;
+        static constexpr std::array<int, LEVELS> SHIFTS = {26, 32, 38, 44};
+
+        struct timer {
+            T value;
+            std::uint64_t deadline;
+            std::uint8_t level, bucket;
+        };
+
+        using bucket_type = std::list<timer>;
+
+        std::array<std::array<bucket_type, BUCKETS>, LEVELS> wheel;
+        std::uint64_t now = 0;
+        std::size_t count = 0;
+
+        bucket_type& bucket_of(const timer& t) noexcept {
+            return wheel[t.level][t.bucket];
+        }
+
+        /**
+         * @brief Pick the bucket of `t` from how far off its deadline is.
+         */
+        void place(timer& t) const noexcept {
+            // a deadline already passed goes where the next tick looks first
+            const std::uint64_t deadline = t.deadline < now ? now : t.deadline;
+            const std::uint64_t delta = deadline - now;
+
+            int level = 0;
+            while (level < LEVELS - 1 && delta >= (std::uint64_t{BUCKETS} << SHIFTS[level]))
+                level++;
+
+            t.level = level;
+            t.bucket = (deadline >> SHIFTS[level]) & (BUCKETS - 1);
+        }
+
+    public:
+        using handle = typename bucket_type::iterator;
+
+        explicit timer_wheel(std::uint64_t start = 0) : now(start) {}
+
+        timer_wheel(const timer_wheel&) = delete;
+        timer_wheel& operator=(const timer_wheel&) = delete;
+
+        timer_wheel(timer_wheel&&) noexcept = default;
+        timer_wheel& operator=(timer_wheel&&) noexcept = default;
+
+        /**
+         * @return a handle to `cancel` the timer with, valid until it fires.
+         */
+        handle schedule(T value, std::uint64_t deadline) {
+            timer t{std::move(value), deadline, 0, 0};
+            place(t);
+
+            auto& bucket = wheel[t.level][t.bucket];
+            bucket.push_front(std::move(t));
+            count++;
+            return bucket.begin();
+        }
+
+        void cancel(handle h) noexcept {
+            bucket_of(*h).erase(h);
+            count--;
+        }
+
+        /**
+         * @brief Move the time to `time`, calling `on_expired(T)` for every timer whose deadline is not after it.
+         *
+         * Only the buckets the time passed on each level are looked at, timers in them that are not due yet move
+         * to a lower level. `on_expired` must not cancel timers, the buckets it could be in are taken apart.
+         */
+        template <typename F>
+        void advance(std::uint64_t time, F&& on_expired) {
+            if (time <= now)
+                return;
+
+            const std::uint64_t previous = now;
+            now = time;
+
+            if (count == 0)
+                return;
+
+            for (int level = 0; level < LEVELS; level++) {
+                const std::uint64_t from = previous >> SHIFTS[level], to = time >> SHIFTS[level];
+                if (from == to)
+                    break;
+
+                // the bucket the time is in now holds deadlines up to the end of it, so it is looked at as well
+                const std::uint64_t buckets = std::min<std::uint64_t>(to - from + 1, BUCKETS);
+
+                for (std::uint64_t tick = from; tick < from + buckets; tick++) {
+                    bucket_type pending;
+                    pending.splice(pending.end(), wheel[level][tick & (BUCKETS - 1)]);
+
+                    while (!pending.empty()) {
+                        auto it = pending.begin();
+
+                        if (it->deadline <= time) {
+                            T value = std::move(it->value);
+                            pending.erase(it);
+                            count--;
+                            on_expired(std::move(value));
+                            continue;
+                        }
+
+                        place(*it);
+                        bucket_of(*it).splice(bucket_of(*it).begin(), pending, it);
+                    }
+                }
+            }
+        }
+
+        void clear() noexcept {
+            for (auto& level : wheel)
+                for (auto& bucket : level)
+                    bucket.clear();
+            count = 0;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return count;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return count == 0;
+        }
+    };
+}
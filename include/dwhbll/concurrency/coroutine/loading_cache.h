@@ -0,0 +1,210 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+#include <dwhbll/collections/cache.h>
+#include <dwhbll/concurrency/coroutine/async_semaphore.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/console/debug.hpp>
+
+namespace dwhbll::concurrency::coroutine {
+    /**
+     * @brief A cache that loads what it misses on the reactor, once per key however many coroutines miss it at once.
+     *
+     * A miss while the key is being loaded waits for that load instead of starting another, and gets what it loaded
+     * or rethrows what it threw. Values are served for `ttl`. Past `refresh_after` a read still gets the cached
+     * value but starts a reload in the background, so a popular key is replaced before it expires instead of being
+     * missed by everyone together. Keys the loader found nothing for are remembered for `negative_ttl`, failed loads
+     * are not remembered at all.
+     *
+     * An instance belongs to the reactor thread it is first used on, nothing in it is synchronised and debug builds
+     * panic when another thread uses it. Use one cache per reactor. The cache has to outlive the refreshes it
+     * started.
+     */
+    template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    class loading_cache {
+    public:
+        struct options {
+            std::size_t capacity = 1 << 16;
+            /// how long a loaded value is served
+            std::chrono::milliseconds ttl{60000};
+            /// age from which a read reloads the value in the background, 0 to load on misses only
+            std::chrono::milliseconds refresh_after{0};
+            /// how long a key the loader found nothing for is remembered, 0 to ask the loader every time
+            std::chrono::milliseconds negative_ttl{0};
+        };
+
+        struct statistics {
+            std::size_t hits = 0;
+            /// hits on keys remembered to have no value
+            std::size_t negative_hits = 0;
+            std::size_t misses = 0;
+            /// misses that waited for a load of the key already running
+            std::size_t coalesced = 0;
+            std::size_t loads = 0;
+            std::size_t refreshes = 0;
+            std::size_t load_failures = 0;
+        };
+
+    private:
+        using clock = std::chrono::system_clock;
+        static constexpr auto never = clock::time_point::max();
+
+        struct slot {
+            /// empty if the loader found nothing
+            std::optional<V> value;
+            clock::time_point refresh_at;
+        };
+
+        struct flight {
+            /// released once the load is done, every waiter passes the permit on
+            async_semaphore done{0};
+            std::optional<V> result;
+            std::exception_ptr error;
+        };
+
+        options opts;
+        statistics stats;
+        collections::cache<K, slot, Hash, KeyEqual> store;
+        std::unordered_map<K, std::shared_ptr<flight>, Hash, KeyEqual> inflight;
+#ifndef NDEBUG
+        std::atomic<std::thread::id> owner{};
+#endif
+
+        void check_thread() {
+#ifndef NDEBUG
+            std::thread::id expected{};
+            const auto self = std::this_thread::get_id();
+
+            if (!owner.compare_exchange_strong(expected, self))
+                ASSERT(expected == self, "loading_cache used from a thread other than its reactor's");
+#endif
+        }
+
+        /**
+         * @brief Announce a load of `key`, before anything suspends so no other miss can start one too.
+         */
+        std::shared_ptr<flight> take_off(const K &key) {
+            auto shared = std::make_shared<flight>();
+            inflight.emplace(key, shared);
+            stats.loads++;
+            return shared;
+        }
+
+        /**
+         * @brief Run `loader` for `key` as the load `shared` announced, and cache what it found.
+         */
+        template <typename Loader>
+        task<std::optional<V>> load(K key, Loader loader, std::shared_ptr<flight> shared) {
+            try {
+                shared->result = co_await loader(key);
+            } catch (...) {
+                shared->error = std::current_exception();
+            }
+
+            // the loader may have resumed somewhere else
+            check_thread();
+            inflight.erase(key);
+
+            const auto now = clock::now();
+
+            if (shared->error)
+                stats.load_failures++;
+            else if (shared->result)
+                store.addEntry(now + opts.ttl, key,
+                               slot{shared->result, opts.refresh_after.count() == 0 ? never : now + opts.refresh_after});
+            else if (opts.negative_ttl.count() != 0)
+                store.addEntry(now + opts.negative_ttl, key, slot{std::nullopt, never});
+            else
+                // a refresh finding the key gone does not leave the old value behind
+                store.removeEntry(key);
+
+            shared->done.release();
+
+            if (shared->error)
+                std::rethrow_exception(shared->error);
+
+            co_return shared->result;
+        }
+
+        template <typename Loader>
+        task<> refresh(K key, Loader loader, std::shared_ptr<flight> shared) {
+            try {
+                co_await load(std::move(key), std::move(loader), std::move(shared));
+            } catch (...) {
+                // the value that was there is served until it expires, the next read after tries again
+            }
+        }
+
+    public:
+        loading_cache() : loading_cache(options{}) {}
+
+        explicit loading_cache(options opts) : opts(opts), store(opts.capacity) {}
+
+        loading_cache(const loading_cache &other) = delete;
+
+        loading_cache & operator=(const loading_cache &other) = delete;
+
+        /**
+         * @brief The cached value of `key`, loaded with `co_await loader(key)` if there is none.
+         * @param loader called with the key, returns a `task<std::optional<V>>`, empty if the key has no value.
+         * It is copied into background refreshes.
+         * @return empty if the key has no value. Rethrows what the loader threw, for every coroutine that waited.
+         */
+        template <typename Loader>
+        [[nodiscard]] task<std::optional<V>> get_or_load(K key, Loader loader) {
+            check_thread();
+
+            if (auto cached = store.findEntry(key)) {
+                (cached->value ? stats.hits : stats.negative_hits)++;
+
+                if (cached->refresh_at != never && cached->refresh_at <= clock::now() && !inflight.contains(key)) {
+                    stats.refreshes++;
+                    reactor::get_thread_reactor()->spawn(refresh(key, loader, take_off(key)));
+                }
+
+                co_return std::move(cached->value);
+            }
+
+            stats.misses++;
+
+            if (auto it = inflight.find(key); it != inflight.end()) {
+                auto shared = it->second;
+                stats.coalesced++;
+
+                co_await shared->done.acquire();
+                shared->done.release();
+
+                if (shared->error)
+                    std::rethrow_exception(shared->error);
+
+                co_return shared->result;
+            }
+
+            auto shared = take_off(key);
+            co_return co_await load(std::move(key), std::move(loader), std::move(shared));
+        }
+
+        /**
+         * @brief Drop the cached value of `key`, a load already running still caches what it finds.
+         */
+        void invalidate(const K &key) {
+            check_thread();
+            store.removeEntry(key);
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return store.size();
+        }
+
+        [[nodiscard]] const statistics& stat() const noexcept { return stats; }
+    };
+}
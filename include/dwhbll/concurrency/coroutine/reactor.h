@@ -3,10 +3,12 @@
 #include <chrono>
 #include <coroutine>
 #include <future>
+#include <limits>
 #include <unordered_set>
+#include <vector>
 
 #include <dwhbll/collections/ring.h>
-#include <dwhbll/collections/sorted_linked_list.h>
+#include <dwhbll/memory/pool.h>
 #include <dwhbll/concurrency/coroutine/task.h>
 #include <dwhbll/concurrency/coroutine/detached_task.h>
 
@@ -27,15 +29,16 @@ namespace dwhbll::concurrency::coroutine {
         struct job;
         struct user_data;
 
+        /**
+         * @brief A sleeper to wake up, or a uring operation to cancel, at `time`.
+         */
         struct timer_task {
             std::chrono::steady_clock::time_point time;
             user_data* data;
-
-            auto operator<=>(const timer_task& other) const {
-                return time <=> other.time;
-            }
         };
 
+        static constexpr std::size_t NO_TIMER = std::numeric_limits<std::size_t>::max();
+
         /**
          * @brief structure stored in an iouring completion request.
          */
@@ -44,6 +47,8 @@ namespace dwhbll::concurrency::coroutine {
             cancellable_base* promise = nullptr;
             std::coroutine_handle<> handle;
             bool is_uring = false;
+            /// index of its timer in `time_tasks`, so it can be taken out early
+            std::size_t timer_slot = NO_TIMER;
         };
 
         /**
@@ -65,7 +70,21 @@ namespace dwhbll::concurrency::coroutine {
 
         std::optional<std::chrono::steady_clock::time_point> get_first_time_expire();
 
-        collections::SortedLinkedList<timer_task> time_tasks;
+        void timer_insert(timer_task task);
+
+        void timer_erase(std::size_t slot);
+
+        void timer_sift_up(std::size_t slot);
+
+        void timer_sift_down(std::size_t slot);
+
+        /**
+         * @brief Cancel a uring operation whose deadline passed, it then completes with -ECANCELED.
+         */
+        void cancel_expired(user_data* data);
+
+        /// binary min-heap on time, arming and disarming a timer is O(log n) however many are armed
+        std::vector<timer_task> time_tasks;
         collections::Ring<user_data*> ready_queue;
         collections::Ring<user_data*> sqe_waiters;
 
@@ -159,6 +178,13 @@ namespace dwhbll::concurrency::coroutine {
 
         io_uring_sqe *get_sqe(uring_promise& h);
 
+        /**
+         * @brief Like `get_sqe(h)`, the operation is cancelled if it has not completed by `deadline`.
+         *
+         * It then completes with -ECANCELED, the timer goes away with the completion otherwise.
+         */
+        io_uring_sqe *get_sqe(uring_promise& h, std::chrono::steady_clock::time_point deadline);
+
         void submit();
 
         void process_cqe(io_uring_cqe* cqe);
@@ -2,7 +2,7 @@
 
 #include <filesystem>
 #include <string>
-#include <dwhbll/collections/memory_buffer.h>
+#include <dwhbll/collections/io_buffer.h>
 #include <dwhbll/concurrency/coroutine/task.h>
 
 namespace dwhbll::concurrency::coroutine::wrappers {
@@ -12,13 +12,11 @@ namespace dwhbll::concurrency::coroutine::wrappers {
      * fine, if one wants true async behavior, await the static open, and per instance close() before destructor.
      */
     class file {
-        constexpr static int batch_read_count = 65536; // read 65536 bytes at a time.
-
         int fd = -1;
 
         off_t read_head{0}, write_head{0};
         bool eof_ = false;
-        collections::MemBuf rdbuf, wrbuf;
+        collections::io_buffer rdbuf, wrbuf;
 
         static int compute_openmode_flags(std::ios::openmode mode);
 
@@ -3,6 +3,8 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include <chrono>
+
 #include <dwhbll/concurrency/coroutine/task.h>
 #include <dwhbll/sanify/types.hpp>
 
@@ -25,6 +27,22 @@ namespace dwhbll::concurrency::coroutine::wrappers::calls {
 
     task<stl_ext::Result<ssize_t, int>> recv(int fd, void* buf, size_t len, int flags);
 
+    /**
+     * @brief send that fails with ETIMEDOUT if it has not completed by `deadline`.
+     */
+    task<stl_ext::Result<ssize_t, int>> send(int fd, const void* buf, size_t len, int flags,
+                                             std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief recv that fails with ETIMEDOUT if nothing came in by `deadline`.
+     */
+    task<stl_ext::Result<ssize_t, int>> recv(int fd, void* buf, size_t len, int flags,
+                                             std::chrono::steady_clock::time_point deadline);
+
+    task<stl_ext::Result<ssize_t, int>> sendmsg(int fd, const ::msghdr* msg, int flags);
+
+    task<stl_ext::Result<ssize_t, int>> recvmsg(int fd, ::msghdr* msg, int flags);
+
     task<int> statx(int dirfd, const char* path, int flags, int mask, struct statx* statxbuf);
 
     task<stl_ext::Result<int, int>> accept(int fd, sockaddr* addr, socklen_t* addrlen, int flags);
@@ -27,6 +27,8 @@ namespace dwhbll::cryptography {
 
         void initialize();
 
+        void reset() override;
+
         void update(const std::span<const std::uint8_t> &in) override;
 
         void finalize(std::span<std::uint8_t> output) override;
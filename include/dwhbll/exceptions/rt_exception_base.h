@@ -8,6 +8,7 @@
 #include <stacktrace>
 #endif
 
+#include <format>
 #include <stdexcept>
 
 namespace dwhbll::exceptions {
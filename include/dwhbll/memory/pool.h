@@ -4,8 +4,8 @@
 #include <list>
 #include <mutex>
 #include <stdexcept>
-#include <unordered_map>
 
+#include <dwhbll/collections/flat_hash_map.h>
 #include <dwhbll/concurrency/spinlock.h>
 
 namespace dwhbll::memory {
@@ -28,7 +28,7 @@ namespace dwhbll::memory {
 		std::size_t available = 0, size = 0;
 		concurrency::spinlock _lock;
 	    // TODO: this is probably avoidable.
-		std::unordered_map<T*, std::pair<Obj*, std::size_t>> returning;
+		collections::flat_hash_map<T*, std::pair<Obj*, std::size_t>> returning;
 
 		Obj* makeNew() {
 			Obj* obj = new Obj;
@@ -174,12 +174,12 @@ namespace dwhbll::memory {
 		void offer(T* object) {
 			if (object != nullptr) {
 				auto _dfd = _lock.lock();
-				if (returning.contains(object)) {
-					auto& [obj, index] = returning[object];
+				if (auto found = returning.find(object); found != returning.end()) {
+					auto [obj, index] = found->second;
 					obj->used[index] = false;
 					obj->object[index].~T();
 					++obj->blockAvailable;
-					returning.erase(object);
+					returning.erase(found);
 					available++;
 				} else {
 					throw std::runtime_error("Object was not allocated in the pool!");
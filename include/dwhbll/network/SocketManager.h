@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <span>
 #include <vector>
 
@@ -125,14 +129,86 @@ namespace dwhbll::network {
         concurrency::coroutine::task<Socket> accept() const;
     };
 
-    // TODO: this class is not multithread safe
-    // TODO: this class could give the same socket to multiple concurrent users!!!
+    /**
+     * @brief Hands out sockets, keeping idle TCP connections per endpoint so they can be checked out again.
+     *
+     * Safe to share between threads. Idle connections sit in a fixed number of slots per endpoint that are filled and
+     * emptied with single atomic operations, so finding an idle connection or parking one takes no lock and a
+     * connection is never handed to two users. Wrapping the fd in a `socket_t` and releasing that wrapper still go
+     * through the spinlock of the `memory::Pool` the sockets live in. A connection is checked for having been closed by
+     * the peer before it is reused.
+     */
     class SocketManager {
+    public:
+        using socket_t = memory::Pool<Socket>::ObjectWrapper;
+
+        struct options {
+            /// idle connections kept per endpoint, more are closed when checked in
+            std::size_t max_idle_per_endpoint = 8;
+            /// idle connections older than this are closed instead of reused
+            std::chrono::milliseconds idle_timeout{30000};
+        };
+
+        struct statistics {
+            std::atomic_size_t connected{0};
+            std::atomic_size_t reused{0};
+            /// idle connections closed because they expired, were closed by the peer or did not fit
+            std::atomic_size_t discarded{0};
+        };
+
+    private:
+        /// endpoints idle connections are kept for, the table does not grow
+        static constexpr std::size_t MAX_ENDPOINTS = 64;
+
         memory::Pool<Socket> pool;
+        options opts;
+        statistics stats;
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        /// address and port of the endpoint owning each row of slots, 0 while the row is free
+        std::array<std::atomic_uint64_t, MAX_ENDPOINTS> endpoints{};
+        /// `max_idle_per_endpoint` slots per endpoint, holding the milliseconds since `epoch` the connection went idle
+        /// in the upper half and its fd plus one in the lower half, 0 when empty
+        std::unique_ptr<std::atomic_uint64_t[]> idle;
+
+        [[nodiscard]] std::uint32_t now_ms() const noexcept;
+
+        /**
+         * @return the row of `endpoint`, claimed if `claim` is set. MAX_ENDPOINTS if there is none.
+         */
+        std::size_t find_endpoint(std::uint64_t endpoint, bool claim) noexcept;
+
+        /**
+         * @brief Take a healthy idle connection to `addr`, closing the unusable ones on the way.
+         * @return the fd, -1 if there is none.
+         */
+        int checkout(in_addr addr, unsigned short port) noexcept;
+
+        /**
+         * @return whether the idle connection in `slot` is expired or closed by the peer.
+         */
+        [[nodiscard]] bool stale(std::uint64_t slot, std::uint32_t now) const noexcept;
 
     public:
-        using socket_t = memory::Pool<Socket>::ObjectWrapper;
+        SocketManager();
+
+        explicit SocketManager(options opts);
+
+        SocketManager(const SocketManager &other) = delete;
+
+        SocketManager & operator=(const SocketManager &other) = delete;
+
+        ~SocketManager();
 
+        /**
+         * @brief The manager shared by everything that does not bring its own.
+         */
+        static SocketManager& shared();
+
+        /**
+         * @brief An idle connection to the endpoint, or a new one.
+         * @throws std::runtime_error when a new connection fails.
+         */
         socket_t getIPv4TCPSocket(in_addr addr, unsigned short port);
 
         concurrency::coroutine::task<socket_t> getIPv4TCPSocket_async(in_addr addr, unsigned short port);
@@ -143,10 +219,24 @@ namespace dwhbll::network {
 
         socket_t listenTCP(in_addr_t addr, unsigned short port);
 
+        /**
+         * @brief Keep a connected TCP socket to be checked out again for the same endpoint.
+         * @note only for connections with nothing left to read, like after a complete response. The socket is closed
+         * if there is no room for it.
+         */
+        void checkin(socket_t &&socket);
+
+        /**
+         * @brief Close the idle connections that expired or were closed by the peer.
+         */
+        void prune() noexcept;
+
         /**
          * @brief Return the socket back to the manager
          * @param s the socket to return
          */
         void offer(Socket* s);
+
+        [[nodiscard]] const statistics& stat() const noexcept { return stats; }
     };
 }
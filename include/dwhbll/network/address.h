@@ -1,5 +1,7 @@
 #pragma once
 
+#include <sys/socket.h>
+
 #include <array>
 #include <cstdint>
 #include <string>
@@ -41,4 +43,17 @@ namespace dwhbll::network {
 
         address & operator=(address &&other) noexcept;
     };
+
+    namespace conv {
+        /**
+         * @brief Fill `out` with the socket address of an IPv4 or IPv6 endpoint, panics on domains.
+         * @return the length of the socket address written.
+         */
+        socklen_t to_sockaddr(const address &endpoint, sockaddr_storage &out);
+
+        /**
+         * @brief The endpoint of an AF_INET or AF_INET6 socket address, an empty address for other families.
+         */
+        address from_sockaddr(const sockaddr_storage &addr);
+    }
 }
@@ -1,16 +1,14 @@
 #pragma once
 
 #include <cstdint>
-#include <expected>
-#include <format>
 #include <optional>
+#include <span>
 #include <string>
-#include <variant>
+#include <unordered_set>
 #include <vector>
 
 #include <netinet/ip.h>
 
-#include <dwhbll/collections/ring.h>
 #include <dwhbll/network/SocketManager.h>
 
 namespace dwhbll::network::dns {
@@ -35,168 +33,6 @@ namespace dwhbll::network::dns {
 
     std::optional<in_addr> query_dns(const std::string& domain);
 
-    struct MemoryStream {
-        collections::Ring<char> data;
-        std::int64_t current_head{0};
-
-        std::uint8_t get_uint8();
-
-        std::uint16_t get_uint16();
-
-        std::uint32_t get_uint32();
-
-        std::vector<std::uint8_t> get_array(std::size_t length);
-
-        void write_uint8(std::uint8_t value);
-
-        void write_uint16(std::uint16_t value);
-
-        void write_uint32(std::uint32_t value);
-
-        void write_array(const std::span<std::uint8_t>& data);
-    };
-
-    // TODO: move domain parsing to a separate header or library.
-    class Domain {
-        std::vector<std::string> labels;
-
-    public:
-        enum class parse_errors;
-
-    private:
-        static std::expected<std::string, parse_errors> try_parse_label(const std::string& domain, std::size_t& start);
-
-    public:
-        enum class parse_errors {
-            INVALID_LABEL_START, ///< Label start is not a letter
-            INVALID_LABEL_END, ///< Label end is not a letter or digit.
-        };
-
-        static Domain parse(const std::string& domain);
-
-        static Domain unpack(MemoryStream& stream);
-
-        static void pack(const Domain& domain, MemoryStream& stream);
-
-        [[nodiscard]] std::string to_string() const;
-
-        friend bool operator==(const Domain &lhs, const Domain &rhs) {
-            if (lhs.labels.size() != rhs.labels.size())
-                return false;
-            for (int i = 0; i < lhs.labels.size(); i++) {
-                if (lhs.labels[i] != rhs.labels[i])
-                    return false;
-            }
-            return true;
-        }
-
-        friend bool operator!=(const Domain &lhs, const Domain &rhs) {
-            return !operator==(lhs, rhs);
-        }
-    };
-
-    namespace ResourceRecordInner {
-        // covers: CNAME, MB, MD, MF, MG, MR, NS, PTR records
-        struct DOMAIN_RECORD {
-            Domain name;
-
-            void unpack(MemoryStream& stream);
-
-            void pack(MemoryStream& stream) const;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-
-        struct HINFO {
-            std::string cpu, os;
-
-            void unpack(MemoryStream& stream);
-
-            void pack(MemoryStream& stream) const;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-
-        struct MINFO {
-            Domain rmailbx, emailbx;
-
-            void unpack(MemoryStream& stream);
-
-            void pack(MemoryStream& stream) const;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-
-        struct MX {
-            std::int16_t preference;
-            Domain exchange;
-
-            void unpack(MemoryStream& stream);
-
-            void pack(MemoryStream& stream) const;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-
-        /**
-         * very special record, literally just a vector with data, it personally doesn't even know its own size while
-         * parsing. This record ends up getting filled by the unpack records of the ResourceRecord class
-         */
-        struct NUL {
-            std::vector<char> data;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-
-        struct SOA {
-            Domain mname;
-            Domain rname;
-            std::uint32_t serial;
-            std::int32_t refresh;
-            std::int32_t retry;
-            std::int32_t expire;
-            std::int32_t minimum;
-
-            void unpack(MemoryStream& stream);
-
-            void pack(MemoryStream& stream) const;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-
-        /**
-         * another special record, literally just a vector with strings, it personally doesn't even know its own size
-         * while parsing. This record ends up getting filled by the unpack records of the ResourceRecord class
-         */
-        struct TXT {
-            std::vector<std::string> txt;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-
-        struct A {
-            std::uint32_t address;
-
-            void unpack(MemoryStream& stream);
-
-            void pack(MemoryStream& stream) const;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-
-        /**
-         * another special record, this one has a variable size, it ends up getting filled by the unpack records of
-         * the ResourceRecord class. This is because the ResourceRecord class would know how long the bitmap is.
-         */
-        struct WKS {
-            std::int32_t address;
-            std::int8_t protocol;
-            std::vector<bool> map;
-
-            [[nodiscard]] std::string to_string() const;
-        };
-    }
-
     enum class QTYPE {
         A=1,
         NS=2,
@@ -214,6 +50,8 @@ namespace dwhbll::network::dns {
         MINFO=14,
         MX=15,
         TXT=16,
+        AAAA=28,
+        OPT=41, ///< EDNS pseudo record, RFC 6891
 
         AXFR=252,
         MAILB=253,
@@ -230,38 +68,36 @@ namespace dwhbll::network::dns {
         STAR=255,
     };
 
-    struct ResourceRecord {
-        Domain name;
-
-        QTYPE type;
-
-        QCLASS clazz;
+    [[nodiscard]] std::string to_string(QTYPE type);
 
-        std::int32_t ttl;
-        std::uint16_t rdlength;
+    [[nodiscard]] std::string to_string(QCLASS clazz);
 
-        std::variant<
-            ResourceRecordInner::A,
-            ResourceRecordInner::DOMAIN_RECORD,
-            ResourceRecordInner::HINFO,
-            ResourceRecordInner::MX,
-            ResourceRecordInner::MINFO,
-            ResourceRecordInner::TXT,
-            ResourceRecordInner::SOA,
-            ResourceRecordInner::WKS,
-            ResourceRecordInner::NUL,
-            std::monostate
-        > rdata;
+    /// largest message over UDP without EDNS, RFC 1035 section 4.2.1
+    constexpr std::uint16_t MAX_PLAIN_UDP_PAYLOAD_SIZE = 512;
 
-        void unpack(MemoryStream& stream);
+    /// advertised by default, small enough to not be fragmented on any common path (DNS flag day 2020)
+    constexpr std::uint16_t DEFAULT_EDNS_PAYLOAD_SIZE = 1232;
 
-        void pack(MemoryStream& stream) const;
-
-        [[nodiscard]] static std::string to_string(QTYPE type);
+    /**
+     * @brief EDNS(0) parameters, carried by the OPT pseudo record of the additional section (RFC 6891).
+     *
+     * The record has the root as its name, the UDP payload size as its class and the extended rcode, version and
+     * flags as its TTL.
+     */
+    struct Edns {
+        /// largest UDP message the sender can receive, smaller values mean 512
+        std::uint16_t udp_payload_size = DEFAULT_EDNS_PAYLOAD_SIZE;
+        /// upper 8 bits of the 12 bit rcode, the header has the lower 4
+        std::uint8_t extended_rcode = 0;
+        std::uint8_t version = 0;
+        bool dnssec_ok = false;
 
-        [[nodiscard]] static std::string to_string(QCLASS clazz);
+        /**
+         * @brief The extended rcode, version and flags packed the way they go into the TTL field.
+         */
+        [[nodiscard]] std::uint32_t packed_ttl() const noexcept;
 
-        [[nodiscard]] std::string to_string() const;
+        static Edns unpack(std::uint16_t clazz, std::uint32_t ttl) noexcept;
     };
 
     enum class OPCODE {
@@ -296,10 +132,6 @@ namespace dwhbll::network::dns {
         std::uint16_t nscount;
         std::uint16_t arcount;
 
-        void unpack(MemoryStream& stream);
-
-        void pack(MemoryStream& stream) const;
-
         [[nodiscard]] static std::string to_string(OPCODE code);
 
         [[nodiscard]] static std::string to_string(RCODE code);
@@ -307,49 +139,58 @@ namespace dwhbll::network::dns {
         [[nodiscard]] std::string to_string() const;
     };
 
-    struct MessageQuestion {
-        Domain qname;
-        QTYPE type;
-        QCLASS clazz;
-
-        void unpack(MemoryStream& stream);
-
-        void pack(MemoryStream& stream) const;
-
-        [[nodiscard]] std::string to_string() const;
-    };
-
-    struct Message {
-        MessageHeader header;
-
-        std::vector<MessageQuestion> questions;
-        std::vector<ResourceRecord> answers, authorities, additionals;
-
-        void unpack(MemoryStream& stream);
-
-        void pack(MemoryStream& stream) const;
-
-        [[nodiscard]] std::string to_string() const;
-    };
-
     [[nodiscard]] std::string addr_to_string(std::uint32_t address);
 
     /**
      * RFC 1035 compliant DNS resolver class
+     *
+     * Queries advertise a UDP payload size with EDNS (RFC 6891), so large answers come back over UDP in one go.
+     * Answers that are truncated anyway are asked again over TCP, on connections kept idle by the SocketManager.
      */
     class Resolver {
-        SocketManager socketMGR;
+    public:
+        struct statistics {
+            std::size_t queries = 0;
+            /// UDP answers that were truncated and asked again over TCP
+            std::size_t truncated = 0;
+            std::size_t tcp_queries = 0;
+        };
+
+    private:
+        SocketManager &socketMGR;
 
         static std::uint16_t queryID;
 
-        std::optional<in_addr> get_from_msg(const Message &msg, const Domain& domain);
+        /// 0 sends queries without EDNS
+        std::uint16_t udp_payload_size;
+        statistics stats;
 
-        std::optional<in_addr> query_dns(std::uint32_t addr, const Domain& domain);
+        /// nameservers that rejected EDNS, asked without it from then on
+        std::unordered_set<std::uint32_t> no_edns;
+
+        /**
+         * @return the answer to `id` from `addr`, a well formed message.
+         */
+        std::optional<std::vector<char>> exchange_udp(std::uint32_t addr, std::span<char> query, std::size_t limit, std::uint16_t id);
+
+        /**
+         * @brief Ask over an idle connection to `addr` or a new one, the connection is kept for the next time.
+         * @return the answer to `id`, a well formed message.
+         */
+        std::optional<std::vector<char>> exchange_tcp(std::uint32_t addr, std::span<char> query, std::uint16_t id);
 
     public:
+        /**
+         * @param udp_payload_size largest UDP answer to ask for, 0 to not use EDNS and stay within 512 bytes.
+         * @param sockets where the sockets come from, may be shared with other threads.
+         */
+        explicit Resolver(std::uint16_t udp_payload_size = DEFAULT_EDNS_PAYLOAD_SIZE, SocketManager &sockets = SocketManager::shared());
+
         std::optional<in_addr> query_dns(std::uint32_t addr, const std::string& domain);
 
         std::optional<in_addr> query_dns(const std::string& domain);
+
+        [[nodiscard]] const statistics& stat() const noexcept { return stats; }
     };
 
     extern Resolver default_resolver;
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <dwhbll/network/dns/dns.h>
+
+/*
+ * Allocation free DNS message codec, working on the packet in place.
+ *
+ * A MessageView checks the whole packet once when it is made, names, record bounds and the names inside known
+ * records included, so reading it afterwards cannot fail. Names stay offsets into the packet until they are compared
+ * or turned into a string, and records are decoded one at a time while iterating over a section.
+ */
+namespace dwhbll::network::dns {
+    /// longest name on the wire, RFC 1035 section 2.3.4
+    constexpr std::size_t MAX_NAME_LENGTH = 255;
+
+    /// size of the message header on the wire
+    constexpr std::size_t HEADER_LENGTH = 12;
+
+    /**
+     * @brief A name inside a checked packet, compression pointers are followed when it is read.
+     */
+    class NameView {
+        std::span<const std::uint8_t> packet;
+        std::uint16_t offset = 0;
+
+    public:
+        NameView() = default;
+
+        NameView(std::span<const std::uint8_t> packet, std::uint16_t offset) : packet(packet), offset(offset) {}
+
+        /**
+         * @brief Call `visit` with every label in order, without the empty root label.
+         */
+        template <typename F>
+        void for_each_label(F &&visit) const {
+            std::size_t pos = offset;
+
+            while (packet[pos] != 0) {
+                if ((packet[pos] & 0xC0) == 0xC0) {
+                    pos = (packet[pos] & 0x3F) << 8 | packet[pos + 1];
+                    continue;
+                }
+
+                visit(std::string_view(reinterpret_cast<const char *>(packet.data()) + pos + 1, packet[pos]));
+                pos += 1 + packet[pos];
+            }
+        }
+
+        /**
+         * @brief Case insensitive comparison with a dotted name, the trailing dot is optional.
+         */
+        [[nodiscard]] bool equals(std::string_view dotted) const noexcept;
+
+        /**
+         * @brief Append the dotted name with a trailing dot, or "." for the root.
+         */
+        void append_to(std::string &out) const;
+
+        [[nodiscard]] std::string to_string() const;
+
+        /**
+         * @brief Case insensitive, like names are compared in DNS.
+         */
+        friend bool operator==(const NameView &lhs, const NameView &rhs) noexcept;
+    };
+
+    struct QuestionView {
+        NameView qname;
+        QTYPE type;
+        QCLASS clazz;
+
+        /**
+         * @brief Decode the checked question at `pos`, `next` is set to the position after it.
+         */
+        static QuestionView read(std::span<const std::uint8_t> packet, std::uint16_t pos, std::uint16_t &next) noexcept;
+    };
+
+    struct SOAView {
+        NameView mname;
+        NameView rname;
+        std::uint32_t serial;
+        std::uint32_t refresh;
+        std::uint32_t retry;
+        std::uint32_t expire;
+        std::uint32_t minimum;
+    };
+
+    struct RecordView {
+        NameView name;
+        QTYPE type;
+        QCLASS clazz;
+        std::uint32_t ttl;
+        std::span<const std::uint8_t> rdata;
+
+        /// the whole packet, names inside the rdata may point anywhere in it
+        std::span<const std::uint8_t> packet;
+
+        /**
+         * @brief Decode the checked record at `pos`, `next` is set to the position after it.
+         */
+        static RecordView read(std::span<const std::uint8_t> packet, std::uint16_t pos, std::uint16_t &next) noexcept;
+
+        /**
+         * @return the address of an A record.
+         */
+        [[nodiscard]] std::optional<std::array<std::uint8_t, 4>> a() const noexcept;
+
+        /**
+         * @return the address of an AAAA record.
+         */
+        [[nodiscard]] std::optional<std::array<std::uint8_t, 16>> aaaa() const noexcept;
+
+        /**
+         * @return the name a CNAME, NS or PTR record points to.
+         */
+        [[nodiscard]] std::optional<NameView> target() const noexcept;
+
+        [[nodiscard]] std::optional<SOAView> soa() const noexcept;
+    };
+
+    /**
+     * @brief The entries of one section of a MessageView.
+     */
+    template <typename T>
+    class SectionView {
+        std::span<const std::uint8_t> packet;
+        std::uint16_t first = 0;
+        std::uint16_t count = 0;
+
+    public:
+        class iterator {
+            std::span<const std::uint8_t> packet;
+            std::uint16_t next = 0;
+            std::uint16_t remaining = 0;
+            T current{};
+
+            void decode() noexcept {
+                if (remaining > 0)
+                    current = T::read(packet, next, next);
+            }
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = T;
+
+            iterator() = default;
+
+            iterator(std::span<const std::uint8_t> packet, std::uint16_t pos, std::uint16_t remaining)
+                : packet(packet), next(pos), remaining(remaining) {
+                decode();
+            }
+
+            const T& operator*() const noexcept { return current; }
+
+            const T* operator->() const noexcept { return &current; }
+
+            iterator & operator++() noexcept {
+                remaining--;
+                decode();
+                return *this;
+            }
+
+            iterator operator++(int) noexcept {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            friend bool operator==(const iterator &lhs, const iterator &rhs) noexcept {
+                return lhs.remaining == rhs.remaining;
+            }
+        };
+
+        SectionView() = default;
+
+        SectionView(std::span<const std::uint8_t> packet, std::uint16_t first, std::uint16_t count)
+            : packet(packet), first(first), count(count) {}
+
+        [[nodiscard]] iterator begin() const { return {packet, first, count}; }
+
+        [[nodiscard]] iterator end() const { return {packet, 0, 0}; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return count; }
+
+        [[nodiscard]] bool empty() const noexcept { return count == 0; }
+    };
+
+    /**
+     * @brief A received message, read in place. The packet must outlive the view and everything read from it.
+     */
+    class MessageView {
+        std::span<const std::uint8_t> packet;
+        MessageHeader header_{};
+        /// where the questions, answers, authorities and additionals start
+        std::array<std::uint16_t, 4> sections{};
+        std::optional<Edns> edns_;
+
+    public:
+        /**
+         * @throws exceptions::rt_exception_base if the packet is not a well formed message.
+         */
+        explicit MessageView(std::span<const std::uint8_t> packet);
+
+        [[nodiscard]] const MessageHeader& header() const noexcept { return header_; }
+
+        [[nodiscard]] SectionView<QuestionView> questions() const noexcept;
+
+        [[nodiscard]] SectionView<RecordView> answers() const noexcept;
+
+        [[nodiscard]] SectionView<RecordView> authorities() const noexcept;
+
+        [[nodiscard]] SectionView<RecordView> additionals() const noexcept;
+
+        /**
+         * @return the parameters of the OPT record, none if the sender does not speak EDNS.
+         */
+        [[nodiscard]] const std::optional<Edns>& edns() const noexcept { return edns_; }
+    };
+
+    /**
+     * @brief Writes a message into a caller supplied buffer, compressing names against the ones already written.
+     *
+     * Entries must be added section by section, questions first. An entry that does not fit is left out entirely and
+     * reported, so a response can be cut short and flagged as truncated.
+     */
+    class MessageBuilder {
+    public:
+        enum class SECTION {
+            QUESTION,
+            ANSWER,
+            AUTHORITY,
+            ADDITIONAL,
+        };
+
+    private:
+        /// names remembered as pointer targets, later ones are written out in full
+        static constexpr std::size_t MAX_COMPRESSION_TARGETS = 32;
+
+        std::span<std::uint8_t> buffer;
+        std::size_t size_ = HEADER_LENGTH;
+        MessageHeader header_;
+        SECTION current = SECTION::QUESTION;
+
+        /**
+         * @brief A name suffix already in the message, the length and hash of its dotted form skip most comparisons.
+         */
+        struct compression_target {
+            std::uint16_t offset;
+            std::uint16_t length;
+            std::uint32_t hash;
+        };
+
+        std::array<compression_target, MAX_COMPRESSION_TARGETS> targets{};
+        std::size_t target_count = 0;
+
+        bool write_u16(std::uint16_t value) noexcept;
+
+        bool write_u32(std::uint32_t value) noexcept;
+
+        bool write_name(std::string_view dotted) noexcept;
+
+        /**
+         * @brief Whether the name written at `offset` is the same as `dotted`, ignoring case.
+         */
+        [[nodiscard]] bool written_name_equals(std::uint16_t offset, std::string_view dotted) const noexcept;
+
+        bool enter(SECTION section);
+
+        /**
+         * @brief Start a record, the rdata length is filled in by `end_record`.
+         * @return where the rdata length goes, 0 if the record did not fit.
+         */
+        std::size_t begin_record(SECTION section, std::string_view name, QTYPE type, std::uint32_t ttl, QCLASS clazz);
+
+        bool end_record(std::size_t length_at) noexcept;
+
+        /**
+         * @brief Forget everything written after `size`.
+         */
+        void rollback(std::size_t size, std::size_t targets) noexcept;
+
+    public:
+        /**
+         * @param buffer where the message goes, the counts of `header` are ignored.
+         */
+        MessageBuilder(std::span<std::uint8_t> buffer, const MessageHeader &header);
+
+        /**
+         * @return false if the question did not fit or the name is invalid.
+         */
+        [[nodiscard]] bool add_question(std::string_view name, QTYPE type, QCLASS clazz = QCLASS::IN);
+
+        /**
+         * @return false if the record did not fit or the name is invalid, nothing of it is written then.
+         */
+        [[nodiscard]] bool add_record(SECTION section, std::string_view name, QTYPE type, std::uint32_t ttl,
+                                      std::span<const std::uint8_t> rdata, QCLASS clazz = QCLASS::IN);
+
+        [[nodiscard]] bool add_a(SECTION section, std::string_view name, std::uint32_t ttl, std::array<std::uint8_t, 4> address);
+
+        [[nodiscard]] bool add_aaaa(SECTION section, std::string_view name, std::uint32_t ttl, std::array<std::uint8_t, 16> address);
+
+        /**
+         * @brief A CNAME, NS or PTR record, `target` is compressed as well.
+         */
+        [[nodiscard]] bool add_name_record(SECTION section, std::string_view name, QTYPE type, std::uint32_t ttl, std::string_view target);
+
+        [[nodiscard]] bool add_soa(SECTION section, std::string_view name, std::uint32_t ttl, std::string_view mname,
+                                   std::string_view rname, std::uint32_t serial, std::uint32_t refresh,
+                                   std::uint32_t retry, std::uint32_t expire, std::uint32_t minimum);
+
+        /**
+         * @brief Add the OPT record to the additional section, once per message.
+         */
+        [[nodiscard]] bool add_edns(const Edns &edns);
+
+        /**
+         * @brief Set the truncation flag, for a response that had to leave records out.
+         */
+        void set_truncated(bool truncated = true) noexcept { header_.tc = truncated; }
+
+        /**
+         * @brief Write the header with the final counts.
+         * @return the message, a view into the buffer.
+         */
+        std::span<const std::uint8_t> build() noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    };
+}
+
+/// sections are views into a packet, their iterators stay valid after the section is gone
+template <typename T>
+inline constexpr bool std::ranges::enable_borrowed_range<dwhbll::network::dns::SectionView<T>> = true;
@@ -2,40 +2,14 @@
 
 #include <dwhbll/network/buffered_socket.h>
 #include <dwhbll/network/SocketManager.h>
-#include <dwhbll/network/http/methods.h>
+#include <dwhbll/network/http/message.h>
 
 namespace dwhbll::network {
-    struct http_request {
-        http::HTTP_METHOD method;
-
-        std::string path;
-
-        std::unordered_map<std::string, std::string> headers;
-
-        std::vector<sanify::u8> body;
-    };
-
-    struct http_response {
-        struct status_line {
-            std::int32_t http_major, http_minor;
-            std::uint32_t status_code;
-            std::string status_info;
-
-            [[nodiscard]] std::string to_string() const;
-        } status;
-
-        std::unordered_map<std::string, std::string> headers;
-
-        std::vector<sanify::u8> body;
-
-        [[nodiscard]] std::string to_string() const;
-    };
-
     class HTTP {
         buffered_socket socket;
 
         /// Base socket manager, can use a different one if necessary (functionality todo)
-        static SocketManager socketManager;
+        static SocketManager& socketManager;
 
     public:
         HTTP(in_addr addr, unsigned short port = 80);
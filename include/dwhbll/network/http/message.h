@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dwhbll/network/http/methods.h>
+#include <dwhbll/sanify/types.hpp>
+
+namespace dwhbll::network {
+    struct http_request {
+        http::HTTP_METHOD method;
+
+        std::string path;
+
+        std::unordered_map<std::string, std::string> headers;
+
+        std::vector<sanify::u8> body;
+    };
+
+    struct http_response {
+        struct status_line {
+            std::int32_t http_major, http_minor;
+            std::uint32_t status_code;
+            std::string status_info;
+
+            [[nodiscard]] std::string to_string() const;
+        } status;
+
+        std::unordered_map<std::string, std::string> headers;
+
+        std::vector<sanify::u8> body;
+
+        [[nodiscard]] std::string to_string() const;
+    };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include <dwhbll/network/http/message.h>
+#include <dwhbll/network/http_server/chunked.h>
+
+namespace dwhbll::network::http {
+    /**
+     * @brief Incremental HTTP/1.x response parser.
+     *
+     * Fed straight from a connection buffer, it consumes only the bytes of the current response so pipelined
+     * responses can be parsed back to back from the same buffer. Header names are lower cased.
+     */
+    class response_parser {
+    public:
+        enum class state {
+            HEAD,
+            BODY_LENGTH,
+            BODY_CHUNKED,
+            BODY_UNTIL_CLOSE,
+            DONE,
+            ERROR,
+        };
+
+        constexpr static std::size_t MAX_HEAD_SIZE = 64 * 1024;
+
+    private:
+        http_response response_;
+        state state_ = state::HEAD;
+        bool head_request = false;
+        bool keep_body = true;
+        bool keep_alive_ = true;
+        std::size_t max_body_size = std::numeric_limits<std::size_t>::max();
+        std::uint64_t remaining = 0;
+        std::uint64_t body_size_ = 0;
+        http_server::ChunkedDecoder decoder;
+
+        std::size_t parse_head(std::span<const std::uint8_t> in);
+
+        void append_body(std::span<const std::uint8_t> data);
+
+    public:
+        /**
+         * @brief Get ready for the next response.
+         * @param head_request the request was a HEAD, the response has no body whatever its headers say.
+         * @param keep_body store the body in the response, otherwise it is only counted.
+         */
+        void reset(bool head_request = false, bool keep_body = true,
+                   std::size_t max_body_size = std::numeric_limits<std::size_t>::max());
+
+        /**
+         * @brief Parse as much of `in` as belongs to the current response.
+         * @return number of bytes consumed, 0 while the head is incomplete.
+         */
+        std::size_t feed(std::span<const std::uint8_t> in);
+
+        /**
+         * @brief The peer closed the connection, completes bodies delimited by the close.
+         */
+        void on_close();
+
+        [[nodiscard]] state get_state() const noexcept { return state_; }
+
+        [[nodiscard]] bool done() const noexcept { return state_ == state::DONE; }
+
+        [[nodiscard]] bool failed() const noexcept { return state_ == state::ERROR; }
+
+        /**
+         * @brief Whether the connection can carry another request after this response.
+         */
+        [[nodiscard]] bool keep_alive() const noexcept { return keep_alive_; }
+
+        [[nodiscard]] std::uint64_t body_size() const noexcept { return body_size_; }
+
+        [[nodiscard]] http_response& response() noexcept { return response_; }
+    };
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <dwhbll/network/address.h>
+#include <dwhbll/network/http/message.h>
+#include <dwhbll/network/http/methods.h>
+
+namespace dwhbll::network::http {
+    [[nodiscard]] std::string_view method_name(HTTP_METHOD method);
+
+    /**
+     * @brief Value of the host field for requests to `endpoint`, the port is left out when it is 80.
+     */
+    [[nodiscard]] std::string host_field(const address &endpoint);
+
+    /**
+     * @brief Append `request` to `out` as an HTTP/1.1 request.
+     *
+     * A host field is added from `host` unless the request has one, and a content-length whenever there is a body
+     * or the method expects one.
+     */
+    void serialize_request(const http_request &request, std::string_view host, std::string &out);
+}
@@ -1,57 +1,55 @@
 #pragma once
 
 #include <cerrno>
+#include <fcntl.h>
 #include <netinet/in.h>
 #include <sys/poll.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <sys/socket.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 #include <concepts>
+#include <deque>
 
 #include <dwhbll/network/http/methods.h>
+#include <dwhbll/network/http_server/admission.h>
+#include <dwhbll/network/http_server/chunked.h>
+#include <dwhbll/network/http_server/hpack.h>
+#include <dwhbll/network/http_server/http2.h>
+#include <dwhbll/network/http_server/open_file.h>
+#include <dwhbll/network/http_server/router.h>
+#include <dwhbll/network/http_server/serializer.h>
+#include <dwhbll/network/http_server/websocket.h>
+#include <dwhbll/console/debug.hpp>
 #include <dwhbll/console/Logging.h>
 
 namespace dwhbll::network::http_server {
 enum class Version {
   V_11,
-  // TODO V2, V3, maybe V_10
+  /// prior knowledge h2c
+  V_2,
+  // TODO V3, maybe V_10
 };
-
-struct Request {
-  http::HTTP_METHOD method;
-  std::string uri;
-  Version version;
-  std::unordered_map<std::string, std::string> fields;
-  std::vector<std::byte> body;
-
-  void reset() {
-    fields.clear();
-    body.clear();
-  }
-};
-
-struct Response {
-  Version version;
-  std::string code;
-  std::string reason;
-  std::unordered_map<std::string, std::string> fields;
-  std::vector<std::byte> body;
-
-  void reset() {
-    code.clear();
-    reason.clear();
-    fields.clear();
-    body.clear();
-  }
-};
-
 }; // namespace dwhbll::network::http_server
 
-namespace {
+namespace dwhbll::network::http_server::detail {
 
 struct string_hash {
   using hash_type = std::hash<std::string_view>;
@@ -167,10 +165,25 @@ public:
 };
 
 class Socket {
+public:
+  /// how long a read waits for the peer by default
+  static constexpr std::chrono::milliseconds DEFAULT_RECV_TIMEOUT{3000};
+  /// how long a write waits for the peer to take more by default
+  static constexpr std::chrono::milliseconds DEFAULT_SEND_TIMEOUT{10000};
+
+private:
   int socket;
   std::array<std::byte, 4096> recv_buffer;
   size_t recv_readpos = 0, recv_size = 0;
   pollfd recv_event;
+  std::chrono::milliseconds recv_timeout = DEFAULT_RECV_TIMEOUT;
+  /// no read waits past this, however often the peer sends a byte
+  std::chrono::steady_clock::time_point recv_deadline =
+      std::chrono::steady_clock::time_point::max();
+  std::chrono::milliseconds send_timeout = DEFAULT_SEND_TIMEOUT;
+  bool timed_out_ = false;
+  /// kernel receive time of the bytes read last, see `since_arrival()`
+  std::chrono::system_clock::time_point arrival{};
 
   std::array<std::byte, 4096> send_buffer;
   size_t send_size = 0;
@@ -178,7 +191,6 @@ class Socket {
 
 public:
   void assign_socket(int socket) {
-    dwhbll::console::info("assign socket");
     this->socket = socket;
 
     int value;
@@ -189,22 +201,170 @@ public:
 
     recv_readpos = 0;
     recv_size = 0;
+    recv_timeout = DEFAULT_RECV_TIMEOUT;
+    recv_deadline = std::chrono::steady_clock::time_point::max();
+    send_timeout = DEFAULT_SEND_TIMEOUT;
+    arrival = {};
+  }
+
+  /**
+   * @brief How long each read waits for the peer, 0 to wait forever.
+   */
+  void set_recv_timeout(std::chrono::milliseconds timeout) {
+    recv_timeout = timeout;
+  }
+
+  /**
+   * @brief Stop reading at `deadline` even while the peer keeps sending, a
+   * client trickling in a byte at a time cannot hold on past it. Cleared
+   * with `time_point::max()`.
+   */
+  void set_recv_deadline(std::chrono::steady_clock::time_point deadline) {
+    recv_deadline = deadline;
+  }
+
+  /**
+   * @brief How long a write waits for the peer to take more, 0 to wait
+   * forever. A slow reader is not cut off as long as it makes progress.
+   */
+  void set_send_timeout(std::chrono::milliseconds timeout) {
+    send_timeout = timeout;
+  }
+
+  /**
+   * @brief Whether the last read that came back empty did so because the
+   * peer stayed quiet, rather than because it closed the connection.
+   */
+  [[nodiscard]] bool timed_out() const { return timed_out_; }
+
+  /**
+   * @brief How long ago the kernel received the bytes read last, which
+   * includes the time the connection waited to be accepted.
+   *
+   * Needs SO_TIMESTAMPNS on the listening socket, zero without it.
+   */
+  [[nodiscard]] std::chrono::steady_clock::duration since_arrival() const {
+    if (arrival == std::chrono::system_clock::time_point{}) {
+      return {};
+    }
+
+    return std::max(std::chrono::system_clock::now() - arrival,
+                    std::chrono::system_clock::duration::zero());
+  }
+
+  /**
+   * @brief How long the next read may wait in milliseconds, the shorter of
+   * the timeout and what is left until the deadline, -1 for forever.
+   */
+  [[nodiscard]] int recv_wait() const {
+    using namespace std::chrono;
+    milliseconds wait = recv_timeout.count() == 0 ? milliseconds::max()
+                                                  : recv_timeout;
+
+    if (recv_deadline != steady_clock::time_point::max()) {
+      // rounded up, waking a little early would just wait again
+      const auto left =
+          std::chrono::ceil<milliseconds>(recv_deadline - steady_clock::now());
+      wait = std::clamp(left, milliseconds::zero(), wait);
+    }
+
+    return wait == milliseconds::max()
+               ? -1
+               : static_cast<int>(std::min<milliseconds::rep>(
+                     wait.count(), std::numeric_limits<int>::max()));
+  }
+
+  /**
+   * @brief Wait for the peer and read what is available into `into`.
+   * @return number of bytes read, 0 on EOF, error or timeout.
+   */
+  size_t receive_some(std::byte *into, size_t size) {
+    timed_out_ = false;
+    const int ready = ::poll(&recv_event, 1, recv_wait());
+
+    if (ready != 1) {
+      timed_out_ = ready == 0;
+      return 0;
+    }
+
+    alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(timespec))> control;
+    iovec vec{into, size};
+    msghdr message{};
+    message.msg_iov = &vec;
+    message.msg_iovlen = 1;
+    message.msg_control = control.data();
+    message.msg_controllen = control.size();
+
+    const ssize_t temp = ::recvmsg(socket, &message, 0);
+    if (temp <= 0) {
+      return 0;
+    }
+
+    for (cmsghdr *header = CMSG_FIRSTHDR(&message); header != nullptr;
+         header = CMSG_NXTHDR(&message, header)) {
+      if (header->cmsg_level == SOL_SOCKET &&
+          header->cmsg_type == SCM_TIMESTAMPNS) {
+        timespec stamp;
+        std::memcpy(&stamp, CMSG_DATA(header), sizeof(stamp));
+        arrival = std::chrono::system_clock::time_point{
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::seconds{stamp.tv_sec} +
+                std::chrono::nanoseconds{stamp.tv_nsec})};
+      }
+    }
+
+    return temp;
   }
 
   void refill_buffer() {
     recv_readpos = 0;
-    dwhbll::console::info("refilling buffer");
+    // a timeout must not replay the previous buffer
+    recv_size = 0;
 
-    if (::poll(&recv_event, 1, 3000) == 1) {
-      ssize_t temp = ::read(socket, recv_buffer.data(), recv_buffer.max_size());
-      if (temp == -1) {
-        recv_size = 0;
-      } else {
-        recv_size = temp;
+    recv_size = receive_some(recv_buffer.data(), recv_buffer.size());
+
+    dwhbll::console::debug("read {} bytes", recv_size);
+  }
+
+  /**
+   * @brief Whether a read would not block, bytes are either buffered or
+   * waiting in the socket.
+   */
+  bool has_pending() {
+    return recv_readpos < recv_size || ::poll(&recv_event, 1, 0) == 1;
+  }
+
+  /**
+   * @brief Make sure `byte_count` unread bytes are buffered back to back, the
+   * unread bytes are moved to the front of the buffer to make room.
+   * @return false on EOF or timeout, or if the buffer cannot hold that many.
+   */
+  bool fill(size_t byte_count) {
+    if (recv_size - recv_readpos >= byte_count) {
+      return true;
+    }
+
+    if (byte_count > recv_buffer.size()) {
+      return false;
+    }
+
+    std::copy(recv_buffer.begin() + recv_readpos,
+              recv_buffer.begin() + recv_size, recv_buffer.begin());
+    recv_size -= recv_readpos;
+    recv_readpos = 0;
+
+    while (recv_size < byte_count) {
+      const size_t count = receive_some(recv_buffer.data() + recv_size,
+                                        recv_buffer.size() - recv_size);
+
+      if (count == 0) {
+        return false;
       }
+
+      recv_size += count;
     }
 
-    dwhbll::console::info(std::format("read {} bytes", recv_size));
+    return true;
   }
 
   bool check_buffer() {
@@ -236,6 +396,21 @@ public:
     return result;
   }
 
+  /**
+   * @brief Bytes already received but not consumed yet, refills the buffer
+   * when it is empty.
+   * @return empty span on EOF or timeout.
+   */
+  std::span<const std::byte> buffered() {
+    if (!check_buffer()) {
+      return {};
+    }
+
+    return {recv_buffer.data() + recv_readpos, recv_size - recv_readpos};
+  }
+
+  void consume(size_t byte_count) { recv_readpos += byte_count; }
+
   void read_bytes(std::vector<std::byte> &buf, size_t byte_count) {
     for (size_t byte_read = 0; byte_read < byte_count; byte_read++) {
       if (!check_buffer()) {
@@ -246,64 +421,139 @@ public:
     }
   }
 
+  /**
+   * @brief Stage `content` in the send buffer, content that does not fit is
+   * sent directly along with what is already staged instead of being copied.
+   */
+  void write(std::span<const std::byte> content) {
+    if (content.size() > send_buffer.size() - send_size) {
+      std::span<const std::byte> parts[] = {content};
+      write_vectored(parts);
+      return;
+    }
+
+    std::copy_n(content.begin(), content.size(), send_buffer.begin() + send_size);
+    send_size += content.size();
+  }
+
+  void write(std::string_view content) {
+    write(std::as_bytes(std::span{content.data(), content.size()}));
+  }
+
   void write(const std::vector<std::byte> &content) {
-    dwhbll::console::info(std::format("current buffer size: {} bytes", send_size));
-    // the std has nothing for this op?
-    for (auto it = content.begin(); it != content.end(); ++it) {
-      send_buffer[send_size++] = *it;
+    write(std::span<const std::byte>{content});
+  }
 
-      if (send_size >= send_buffer.max_size()) {
-        flush();
-      }
+  /**
+   * @brief Wait for the peer to take more of what is being sent.
+   * @return false if it took nothing for the send timeout.
+   */
+  bool wait_writable() {
+    const int ready = ::poll(&send_event, 1,
+                             send_timeout.count() == 0
+                                 ? -1
+                                 : static_cast<int>(send_timeout.count()));
+
+    if (ready == 0) {
+      dwhbll::console::warn("peer took nothing for {}ms, dropping the response",
+                            send_timeout.count());
     }
+
+    return ready == 1;
   }
 
-  void write(const std::string &content) {
-    dwhbll::console::info(std::format("current buffer size: {} bytes", send_size));
-    for (auto it = content.begin(); it != content.end(); ++it) {
-      send_buffer[send_size++] = std::byte(*it);
+  /**
+   * @brief Send the staged bytes followed by `parts` with a single `writev`
+   * (more only on partial writes), nothing in `parts` is copied.
+   * @return false if the peer stopped accepting data.
+   */
+  bool write_vectored(std::span<const std::span<const std::byte>> parts) {
+    constexpr size_t MAX_PARTS = 8;
+    std::array<iovec, MAX_PARTS + 1> iov;
+    size_t count = 0;
+
+    if (parts.size() > MAX_PARTS) {
+      debug::panic("write_vectored supports at most {} parts", MAX_PARTS);
+    }
+
+    if (send_size != 0) {
+      iov[count++] = {send_buffer.data(), send_size};
+    }
 
-      if (send_size >= send_buffer.max_size()) {
-        flush();
+    for (const auto &part : parts) {
+      if (!part.empty()) {
+        iov[count++] = {const_cast<std::byte *>(part.data()), part.size()};
       }
     }
-  }
 
-  void write(const char *content) {
-    dwhbll::console::info(std::format("current buffer size: {} bytes", send_size));
-    while (*content != '\0') {
-      send_buffer[send_size++] = std::byte(*(content++));
+    // the staged bytes are either sent or lost with the connection
+    send_size = 0;
+
+    size_t first = 0;
+    while (first < count) {
+      const ssize_t status = ::writev(socket, &iov[first], count - first);
 
-      if (send_size >= send_buffer.max_size()) {
-        flush();
+      if (status == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && wait_writable()) {
+          continue;
+        }
+
+        return false;
+      }
+
+      size_t sent = status;
+      while (first < count && sent >= iov[first].iov_len) {
+        sent -= iov[first++].iov_len;
+      }
+
+      if (first < count) {
+        iov[first].iov_base = static_cast<std::byte *>(iov[first].iov_base) + sent;
+        iov[first].iov_len -= sent;
       }
     }
+
+    return true;
   }
 
-  void flush() {
-    dwhbll::console::info(std::format("flushing {} bytes to socket", send_size));
-    size_t send_pos = 0;
+  bool flush() { return write_vectored({}); }
+
+  /**
+   * @brief Send `length` bytes of `fd` from `offset` with sendfile, after
+   * whatever is staged. The file never passes through user space.
+   * @return false if the peer stopped accepting data or the file shrank.
+   */
+  bool send_file(int fd, off_t offset, size_t length) {
+    if (!flush()) {
+      return false;
+    }
+
+    while (length != 0) {
+      const ssize_t status = ::sendfile(socket, fd, &offset, length);
 
-    while (send_pos < send_size) {
-      if (::poll(&send_event, 1, 1000) == 1) {
-        ssize_t status =
-            ::write(socket, &send_buffer[send_pos], send_size - send_pos);
+      if (status == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
 
-        if (status == -1) {
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && wait_writable()) {
           continue;
         }
 
-        send_pos += status;
-        dwhbll::console::info(std::format("sent {} bytes", status));
+        return false;
+      }
+
+      if (status == 0) {
+        return false;
       }
 
-      // Timed out trying to write
-      // TODO: figure out what to do..?
-      send_size = 0;
-      return;
+      length -= status;
     }
 
-    send_size = 0;
+    return true;
   }
 };
 
@@ -341,229 +591,2033 @@ static std::string to_lower_case(const std::string_view &str) {
   return out;
 }
 
-// TODO: switch to error enum for caller to build response
-static bool build_request(dwhbll::network::http_server::Request &request,
-                          Socket &reader) {
-  request.reset();
+} // namespace dwhbll::network::http_server::detail
 
-  dwhbll::console::info("reading from socket");
-  const auto header = reader.read_until_crlf();
-  dwhbll::console::info(std::format("read line {}", header));
-  const auto section = split_string(header, ' ');
+namespace dwhbll::network::http_server {
+/**
+ * @brief Streams the request body straight out of the connection buffer.
+ *
+ * Nothing is buffered beyond the connection's receive buffer, so handlers can
+ * consume arbitrarily large uploads in fixed memory. Whatever the handler
+ * leaves unread is discarded before the next request is parsed.
+ */
+class BodyReader {
+public:
+  enum class Mode {
+    NONE,    ///< no body
+    LENGTH,  ///< body delimited by Content-Length
+    CHUNKED, ///< Transfer-Encoding: chunked
+  };
 
-  if (section.size() != 3) {
-    dwhbll::console::error("Request header does not have exactly 3 sections");
-    return false;
-  }
+private:
+  detail::Socket *socket = nullptr;
+  Mode mode = Mode::NONE;
+  size_t remaining = 0;
+  ChunkedDecoder decoder;
+  bool failed_ = false;
 
-  dwhbll::console::info("section size OK");
+public:
+  void reset(detail::Socket *socket = nullptr, Mode mode = Mode::NONE,
+             size_t length = 0) {
+    this->socket = socket;
+    this->mode = mode;
+    remaining = length;
+    decoder.reset();
+    failed_ = false;
+  }
 
-  {
-    auto method_ref = method_map.find(section[0]);
-    if (method_ref == method_map.end()) {
-      dwhbll::console::error("Unknown method name in header");
-      return false;
+  /**
+   * @brief Read the next part of the body into `out`.
+   * @return number of bytes read, 0 once the body is over (or on error, check
+   * `failed()`).
+   */
+  size_t read(std::span<std::byte> out) {
+    if (out.empty() || done()) {
+      return 0;
     }
-    request.method = method_ref->second;
-  }
 
-  // TODO: provide support for thing other than 1.1
-  if (section[2] != "HTTP/1.1") {
-    dwhbll::console::error("Unsupported HTTP version");
-    return false;
-  }
+    while (true) {
+      auto in = socket->buffered();
 
-  dwhbll::console::info("version OK");
+      if (in.empty()) {
+        // peer went away or timed out mid-body
+        failed_ = true;
+        return 0;
+      }
 
-  request.uri = std::string(section[1]);
-  request.version = dwhbll::network::http_server::Version::V_11;
-  size_t body_size = 0;
+      if (mode == Mode::LENGTH) {
+        size_t count = std::min({remaining, in.size(), out.size()});
+        std::copy_n(in.begin(), count, out.begin());
+        socket->consume(count);
+        remaining -= count;
+        return count;
+      }
 
-  bool has_length = false, is_chunked = false;
-  std::string field;
-  while ((field = reader.read_until_crlf()) != "") {
-    dwhbll::console::info(std::format("field {}", field));
-    auto field_part = split_string(field, ':');
-    // if (field_part.size() != 2) {
-    //   return false;
-    // }
-    trim_whitespace(field_part[1]);
+      auto [consumed, produced] = decoder.decode(in, out);
+      socket->consume(consumed);
 
-    // Surely the field name is ASCII-only
-    auto field_name = to_lower_case(field_part[0]);
+      if (decoder.failed()) {
+        failed_ = true;
+        return 0;
+      }
 
-    if (field_name == "content-length") {
-      has_length = true;
-      auto result = std::from_chars(field_part[1].data(),
-                                    field_part[1].data() + field_part[1].size(),
-                                    body_size);
-      if (result.ec != std::errc()) {
-        return false;
+      // only framing was available, go get more bytes
+      if (produced != 0 || decoder.done()) {
+        return produced;
       }
-      continue;
     }
+  }
 
-    if (field_name == "transfer-encoding" && field_part[1] == "chunked") {
-      is_chunked = true;
-    }
+  /**
+   * @brief Append the rest of the body to `out`.
+   * @param limit refuse to grow `out` past this many bytes.
+   * @return false if the body was malformed or larger than `limit`.
+   */
+  bool read_all(std::vector<std::byte> &out,
+                size_t limit = std::numeric_limits<size_t>::max()) {
+    std::array<std::byte, 4096> chunk;
 
-    request.fields.emplace(std::move(field_name), field_part[1]);
-  }
+    while (!done()) {
+      size_t count = read(chunk);
 
-  if (has_length) {
-    reader.read_bytes(request.body, body_size);
-    return true;
-  }
+      if (failed_) {
+        return false;
+      }
+
+      if (out.size() + count > limit) {
+        return false;
+      }
+
+      out.insert(out.end(), chunk.begin(), chunk.begin() + count);
+    }
 
-  if (is_chunked) {
-    // TODO: reading chunked data
-    // dwhbll::debug::unimplemented() when
-    throw std::runtime_error("unimplemented");
     return true;
   }
 
-  dwhbll::console::info("no size given?");
+  /**
+   * @brief Drop whatever is left of the body.
+   * @return false if the body was malformed.
+   */
+  bool discard() {
+    std::array<std::byte, 4096> sink;
 
-  return true;
-}
+    while (!done() && !failed_) {
+      read(sink);
+    }
 
-} // anonymous namespace
+    return !failed_;
+  }
 
-namespace dwhbll::network::http_server {
+  [[nodiscard]] bool done() const {
+    switch (mode) {
+    case Mode::NONE:
+      return true;
+    case Mode::LENGTH:
+      return remaining == 0 || failed_;
+    case Mode::CHUNKED:
+      return decoder.done() || failed_;
+    }
 
-template <typename H>
-concept Handler = requires(H handler, Request &req, Response &res) {
-  { handler.handle(req, res) } -> std::same_as<void>;
-};
+    return true;
+  }
 
-template <typename F>
-concept HandlerFactory = requires(F factory) {
-  { factory() } -> Handler;
-};
+  [[nodiscard]] bool failed() const { return failed_; }
 
-template <HandlerFactory F>
-static void executor(const int listen_socket,
-                     std::unordered_map<std::string, F> &rt) {
-  dwhbll::console::info("executor");
-  sockaddr inaddr_buf;
-  socklen_t inaddr_bufsize;
-  Socket socket;
-  Request request;
-  Response response;
+  [[nodiscard]] Mode get_mode() const { return mode; }
+};
 
-  // TODO: exiting the loop
-  while (true) {
-    const int com_sockfd =
-        ::accept4(listen_socket, &inaddr_buf, &inaddr_bufsize, SOCK_NONBLOCK);
+/**
+ * @brief Handed to `Response::body_producer` to emit the body piece by piece.
+ *
+ * Writes are framed as chunks unless the handler set a content-length, in
+ * which case they go to the connection as-is.
+ */
+class BodyWriter {
+  detail::Socket *socket = nullptr;
+  bool chunked = false;
+  std::function<void(std::span<const std::byte>)> sink;
 
-    if (com_sockfd == -1) {
-      continue;
+public:
+  BodyWriter(detail::Socket &socket, bool chunked)
+      : socket(&socket), chunked(chunked) {}
+
+  /**
+   * @brief Hand every write to `sink`, for protocols framing the body
+   * themselves.
+   */
+  explicit BodyWriter(std::function<void(std::span<const std::byte>)> sink)
+      : sink(std::move(sink)) {}
+
+  void write(std::span<const std::byte> data) {
+    if (data.empty()) {
+      // an empty chunk would terminate the body
+      return;
     }
 
-    socket.assign_socket(com_sockfd);
-
-    dwhbll::console::info("handling message");
-
-    if (!build_request(request, socket)) {
-      dwhbll::console::info("cannot build request");
-      // TODO: send back a malformed request or smth
-      // this need to be an enum return maybe.
-      continue;
+    if (sink) {
+      sink(data);
+      return;
     }
 
-    dwhbll::console::info("matching route");
-    auto route = rt.find(request.uri);
-    if (route == rt.end()) {
-      dwhbll::console::info("cannot match a route");
-      // TODO: send back a malformed request
-      continue;
+    if (chunked) {
+      std::array<char, MAX_CHUNK_HEADER> header;
+      size_t length = encode_chunk_header(data.size(), header);
+      socket->write(std::string_view{header.data(), length});
     }
 
-    dwhbll::console::info("handling request with route handler");
-    route->second().handle(request, response);
-    dwhbll::console::info("sending back response");
-
-    // wtf is this
-    dwhbll::console::info("writing header");
-    socket.write("HTTP/1.1 ");
-    socket.write(response.code);
-    socket.write(" ");
-    socket.write(response.reason);
-    socket.write("\r\n");
+    socket->write(data);
 
-    dwhbll::console::info("writing fields");
-    for (auto it = response.fields.cbegin(); it != response.fields.cend();
-         ++it) {
-      socket.write(it->first);
-      socket.write(": ");
-      socket.write(it->second);
-      socket.write("\r\n");
+    if (chunked) {
+      socket->write("\r\n");
     }
-
-    dwhbll::console::info("writing body");
-    socket.write("\r\n");
-    socket.write(response.body);
-    socket.flush();
-
-    ::close(com_sockfd);
-
-    response.reset();
   }
-}
 
-template <HandlerFactory F> class Server {
-private:
-  std::vector<std::thread> thread_pool;
-  std::unordered_map<std::string, F> route_table;
-  int server_fd = -1;
+  void write(std::string_view data) {
+    write(std::as_bytes(std::span{data.data(), data.size()}));
+  }
 
-public:
-  ~Server() {
-    if (server_fd != -1) {
-      ::close(server_fd);
+  /**
+   * @brief Terminate the body, called by the server once the producer returns.
+   */
+  void finish() {
+    if (chunked) {
+      socket->write("0\r\n\r\n");
     }
   }
+};
 
-  int listen_to(const uint32_t address, const uint16_t port) {
-    const bool enable_bool = 1;
-    int status;
-
-    if (server_fd != -1) {
-      console::error("Server already bound.");
-      return -1;
+/**
+ * @brief A connection switched to WebSocket, handed to the session set by
+ * `upgrade_to_websocket`.
+ *
+ * Only the session's thread receives, any thread may send, writes are
+ * serialised per connection. Pings are answered and fragmented messages put
+ * back together while receiving. Text payloads are not checked for UTF-8.
+ */
+class WebSocket {
+public:
+  struct Options {
+    /// larger messages close the connection with MESSAGE_TOO_BIG
+    size_t max_message = 1 << 20;
+    /// a quiet peer is pinged after this many milliseconds, and dropped if it
+    /// stays quiet as long again
+    int ping_interval = 30000;
+  };
+
+  struct Message {
+    websocket::Opcode opcode = websocket::Opcode::TEXT;
+    std::vector<std::byte> data;
+
+    [[nodiscard]] std::string_view text() const {
+      return {reinterpret_cast<const char *>(data.data()), data.size()};
     }
+  };
 
-    SocketBuilder sock;
-
-    if (sock.create_socket()) {
-      return -1;
+private:
+  detail::Socket &socket;
+  const std::atomic_bool *running;
+  Options options;
+  std::mutex write_lock;
+  /// set once a close frame went out or the connection broke
+  std::atomic_bool closed = false;
+  bool awaiting_pong = false;
+
+  bool write(std::span<const std::span<const std::byte>> parts) {
+    std::lock_guard guard(write_lock);
+
+    if (closed.load(std::memory_order_relaxed)) {
+      return false;
     }
 
-    if (sock.bind_addr(address, port)) {
-      return -1;
+    if (!socket.write_vectored(parts)) {
+      closed = true;
+      return false;
     }
 
-    server_fd = sock.get_fd();
+    return true;
+  }
+
+  /**
+   * @brief Wait for `byte_count` buffered bytes, a peer that stays quiet for
+   * the ping interval is pinged once before it is given up on.
+   */
+  bool fill(size_t byte_count) {
+    while (!socket.fill(byte_count)) {
+      if (!socket.timed_out() || awaiting_pong ||
+          (running && !running->load(std::memory_order_relaxed))) {
+        return false;
+      }
+
+      awaiting_pong = true;
+      if (!send(websocket::Opcode::PING, {})) {
+        return false;
+      }
+    }
+
+    awaiting_pong = false;
+    return true;
+  }
+
+  bool fail(websocket::CloseCode code) {
+    close(code);
+    return false;
+  }
+
+  bool lost() {
+    closed = true;
+    return false;
+  }
+
+  /**
+   * @brief Handle a ping, pong or close frame whose header was consumed.
+   * @return false once the connection is closed.
+   */
+  bool control(const websocket::FrameHeader &header) {
+    if (!fill(header.length)) {
+      return lost();
+    }
+
+    std::array<std::byte, websocket::MAX_CONTROL_PAYLOAD> payload;
+    if (header.length != 0) {
+      const auto in = socket.buffered().first(header.length);
+      std::copy(in.begin(), in.end(), payload.begin());
+      socket.consume(header.length);
+    }
+
+    const auto body = std::span{payload}.first(header.length);
+    websocket::apply_mask(body, header.mask);
+
+    switch (header.opcode) {
+    case websocket::Opcode::PING:
+      send(websocket::Opcode::PONG, body);
+      return true;
+
+    case websocket::Opcode::CLOSE: {
+      if (body.size() == 1) {
+        return fail(websocket::CloseCode::PROTOCOL_ERROR);
+      }
+
+      // echo the status code back, which ends the closing handshake
+      send(websocket::Opcode::CLOSE,
+           body.first(std::min<size_t>(body.size(), 2)));
+      closed = true;
+      return false;
+    }
+
+    default:
+      return true;
+    }
+  }
+
+public:
+  /**
+   * @param running the session gives up waiting for the peer once this is
+   * cleared.
+   */
+  WebSocket(detail::Socket &socket, const std::atomic_bool *running,
+            Options options)
+      : socket(socket), running(running), options(options) {
+    socket.set_recv_timeout(std::chrono::milliseconds(options.ping_interval));
+  }
+
+  explicit WebSocket(detail::Socket &socket)
+      : WebSocket(socket, nullptr, Options{}) {}
+
+  WebSocket(const WebSocket &) = delete;
+  WebSocket &operator=(const WebSocket &) = delete;
+
+  /**
+   * @brief Wait for the next text or binary message.
+   * @return false once the connection is closed, by either side.
+   */
+  bool receive(Message &message) {
+    message.data.clear();
+    bool in_message = false;
+
+    while (!closed.load(std::memory_order_relaxed)) {
+      websocket::FrameHeader header;
+      size_t header_size = 2;
+      auto status = websocket::FrameHeader::Status::INCOMPLETE;
+
+      while (status == websocket::FrameHeader::Status::INCOMPLETE) {
+        if (!fill(header_size)) {
+          return lost();
+        }
+
+        status = header.parse(socket.buffered(), header_size);
+      }
+
+      // clients must mask everything they send (RFC 6455 5.1)
+      if (status == websocket::FrameHeader::Status::MALFORMED ||
+          !header.masked) {
+        return fail(websocket::CloseCode::PROTOCOL_ERROR);
+      }
+
+      socket.consume(header_size);
+
+      if (websocket::is_control(header.opcode)) {
+        if (!control(header)) {
+          return false;
+        }
+        continue;
+      }
+
+      // a new message may only start once the previous one is complete
+      if ((header.opcode == websocket::Opcode::CONTINUATION) != in_message) {
+        return fail(websocket::CloseCode::PROTOCOL_ERROR);
+      }
+
+      if (!in_message) {
+        message.opcode = header.opcode;
+        in_message = true;
+      }
+
+      if (header.length > options.max_message - message.data.size()) {
+        return fail(websocket::CloseCode::MESSAGE_TOO_BIG);
+      }
+
+      const size_t start = message.data.size();
+      message.data.resize(start + header.length);
+
+      for (size_t copied = 0; copied < header.length;) {
+        if (!fill(1)) {
+          return lost();
+        }
+
+        const auto in = socket.buffered();
+        const size_t count = std::min<size_t>(in.size(), header.length - copied);
+        std::copy_n(in.begin(), count, message.data.begin() + start + copied);
+        socket.consume(count);
+        copied += count;
+      }
+
+      websocket::apply_mask(std::span{message.data}.subspan(start), header.mask);
+
+      if (header.fin) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * @brief Send a frame encoded once for many connections.
+   * @return false if the connection is closed.
+   */
+  bool send(const websocket::Frame &frame) {
+    std::span<const std::byte> parts[] = {frame.bytes()};
+    return write(parts);
+  }
+
+  /**
+   * @brief Frame and send `payload`, the payload is not copied.
+   */
+  bool send(websocket::Opcode opcode, std::span<const std::byte> payload) {
+    websocket::FrameHeader header;
+    header.opcode = opcode;
+    header.length = payload.size();
+
+    std::array<std::byte, websocket::MAX_FRAME_HEADER> encoded;
+    std::span<const std::byte> parts[] = {
+        std::span{encoded}.first(header.encode(encoded)), payload};
+    return write(parts);
+  }
+
+  bool send_text(std::string_view text) {
+    return send(websocket::Opcode::TEXT,
+                std::as_bytes(std::span{text.data(), text.size()}));
+  }
+
+  /**
+   * @brief Start the closing handshake, nothing can be sent afterwards.
+   */
+  void close(websocket::CloseCode code = websocket::CloseCode::NORMAL,
+             std::string_view reason = {}) {
+    send(websocket::Frame::close(code, reason));
+    closed = true;
+  }
+
+  [[nodiscard]] bool is_closed() const {
+    return closed.load(std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief Connections that get the same broadcasts, the subscribers of a topic
+ * for instance.
+ *
+ * A broadcast writes one encoded frame to every member, outside the group lock
+ * so a slow member does not hold up joining and leaving. Leaving waits for a
+ * send to that connection in progress to finish, so a session that left can
+ * end without the group touching its connection afterwards.
+ */
+class WebSocketGroup {
+  struct Member {
+    /// held while sending, cleared by `leave`
+    std::mutex sending;
+    WebSocket *websocket;
+
+    explicit Member(WebSocket *websocket) : websocket(websocket) {}
+  };
+
+  std::mutex lock;
+  std::vector<std::shared_ptr<Member>> members;
+
+public:
+  void join(WebSocket &websocket) {
+    std::lock_guard guard(lock);
+    members.push_back(std::make_shared<Member>(&websocket));
+  }
+
+  void leave(WebSocket &websocket) {
+    std::shared_ptr<Member> member;
+
+    {
+      std::lock_guard guard(lock);
+      auto it = std::find_if(members.begin(), members.end(), [&](const auto &m) {
+        return m->websocket == &websocket;
+      });
+
+      if (it == members.end()) {
+        return;
+      }
+
+      member = std::move(*it);
+      *it = std::move(members.back());
+      members.pop_back();
+    }
+
+    // a broadcast may have picked it up before it left
+    std::lock_guard guard(member->sending);
+    member->websocket = nullptr;
+  }
+
+  /**
+   * @return number of members the frame was sent to.
+   */
+  size_t broadcast(const websocket::Frame &frame) {
+    std::vector<std::shared_ptr<Member>> recipients;
+
+    {
+      std::lock_guard guard(lock);
+      recipients = members;
+    }
+
+    size_t sent = 0;
+
+    for (const auto &member : recipients) {
+      std::lock_guard guard(member->sending);
+
+      if (member->websocket) {
+        sent += member->websocket->send(frame);
+      }
+    }
+
+    return sent;
+  }
+
+  [[nodiscard]] size_t size() {
+    std::lock_guard guard(lock);
+    return members.size();
+  }
+};
+
+struct Request {
+  http::HTTP_METHOD method;
+  std::string uri;
+  /// `uri` split at the '?', both point into `uri`
+  std::string_view path, query;
+  /// filled by the router from the `{name}` segments of the matched route
+  RouteParams params;
+  Version version;
+  std::unordered_map<std::string, std::string> fields;
+  /// Only filled by `read_body()`, stream through `body_reader` for large bodies.
+  std::vector<std::byte> body;
+  BodyReader body_reader;
+
+  void reset() {
+    path = {};
+    query = {};
+    params.clear();
+    fields.clear();
+    body.clear();
+    body_reader.reset();
+  }
+
+  /**
+   * @brief Buffer the whole body into `body`.
+   * @return false if the body was malformed or larger than `limit`.
+   */
+  bool read_body(size_t limit = std::numeric_limits<size_t>::max()) {
+    return body_reader.read_all(body, limit);
+  }
+};
+
+struct Response {
+  Version version;
+  std::string code;
+  std::string reason;
+  std::unordered_map<std::string, std::string> fields;
+  std::vector<std::byte> body;
+  /**
+   * @brief Set to stream the body instead of filling `body`.
+   *
+   * The body is sent with `Transfer-Encoding: chunked` unless a
+   * `content-length` field is set.
+   */
+  std::function<void(BodyWriter &)> body_producer;
+  /// Set to send `file_length` bytes of `file` from `file_offset` with
+  /// sendfile instead of `body`.
+  std::shared_ptr<const OpenFile> file;
+  std::uint64_t file_offset = 0, file_length = 0;
+  /// Set by `upgrade_to_websocket`, runs on the connection once the head is
+  /// sent.
+  std::function<void(WebSocket &)> websocket_session;
+  WebSocket::Options websocket_options;
+
+  void reset() {
+    code.clear();
+    reason.clear();
+    fields.clear();
+    body.clear();
+    body_producer = nullptr;
+    file.reset();
+    file_offset = 0;
+    file_length = 0;
+    websocket_session = nullptr;
+    websocket_options = {};
+  }
+};
+} // namespace dwhbll::network::http_server
+
+namespace dwhbll::network::http_server::detail {
+/**
+ * @brief 1xx, 204 and 304 responses never carry a body.
+ */
+static bool is_bodiless(const Response &response) {
+  return response.code.starts_with('1') || response.code == "204" ||
+         response.code == "304";
+}
+
+/**
+ * @brief Serialise the status line and fields of `response` into `head`.
+ *
+ * `date`, `server` and the body framing are added unless the handler set
+ * them itself.
+ */
+static void serialize_head(HeaderArena &head, DateCache &date,
+                           const Response &response, bool chunked) {
+  head.clear();
+  head.status_line(response.code, response.reason);
+
+  for (const auto &[name, value] : response.fields) {
+    head.field(name, value);
+  }
+
+  if (!response.fields.contains("date")) {
+    head.append(date.get());
+  }
+
+  if (!response.fields.contains("server")) {
+    head.append("server: dwhbll\r\n");
+  }
+
+  const bool bodiless = is_bodiless(response);
+
+  if (chunked) {
+    head.append("transfer-encoding: chunked\r\n");
+  } else if (!bodiless && !response.body_producer &&
+             !response.fields.contains("content-length")) {
+    head.content_length(response.file ? response.file_length
+                                      : response.body.size());
+  }
+
+  head.end();
+}
+} // namespace dwhbll::network::http_server::detail
+
+namespace dwhbll::network::http_server::detail {
+
+/**
+ * @brief Set the uri of `request` and split it at the '?'.
+ */
+static void set_uri(Request &request, std::string_view uri) {
+  request.uri = std::string(uri);
+
+  const std::string_view view = request.uri;
+  const auto query_start = view.find('?');
+  request.path = view.substr(0, query_start);
+  if (query_start != std::string_view::npos) {
+    request.query = view.substr(query_start + 1);
+  }
+}
+
+// TODO: switch to error enum for caller to build response
+static bool build_request(Request &request, Socket &reader) {
+  request.reset();
+
+  const auto header = reader.read_until_crlf();
+
+  // the peer closed a kept-alive connection or went quiet
+  if (header.empty()) {
+    return false;
+  }
+
+  dwhbll::console::debug("request line {}", header);
+  const auto section = split_string(header, ' ');
+
+  if (section.size() != 3) {
+    dwhbll::console::error("Request header does not have exactly 3 sections");
+    return false;
+  }
+
+  {
+    auto method_ref = method_map.find(section[0]);
+    if (method_ref == method_map.end()) {
+      dwhbll::console::error("Unknown method name in header");
+      return false;
+    }
+    request.method = method_ref->second;
+  }
+
+  // TODO: provide support for thing other than 1.1
+  if (section[2] != "HTTP/1.1") {
+    dwhbll::console::error("Unsupported HTTP version");
+    return false;
+  }
+
+  set_uri(request, section[1]);
+  request.version = Version::V_11;
+  size_t body_size = 0;
+
+  bool has_length = false, is_chunked = false;
+  std::string field;
+  while ((field = reader.read_until_crlf()) != "") {
+    dwhbll::console::debug("field {}", field);
+    auto field_part = split_string(field, ':');
+    // if (field_part.size() != 2) {
+    //   return false;
+    // }
+    trim_whitespace(field_part[1]);
+
+    // Surely the field name is ASCII-only
+    auto field_name = to_lower_case(field_part[0]);
+
+    if (field_name == "content-length") {
+      has_length = true;
+      auto result = std::from_chars(field_part[1].data(),
+                                    field_part[1].data() + field_part[1].size(),
+                                    body_size);
+      if (result.ec != std::errc()) {
+        return false;
+      }
+      continue;
+    }
+
+    if (field_name == "transfer-encoding" && field_part[1] == "chunked") {
+      is_chunked = true;
+    }
+
+    request.fields.emplace(std::move(field_name), field_part[1]);
+  }
+
+  // chunked wins over content-length (RFC 9112 6.3)
+  if (is_chunked) {
+    request.body_reader.reset(&reader, BodyReader::Mode::CHUNKED);
+    return true;
+  }
+
+  if (has_length) {
+    request.body_reader.reset(&reader, BodyReader::Mode::LENGTH, body_size);
+    return true;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Whether the comma separated `list` holds `token`, ignoring case.
+ */
+static bool has_token(std::string_view list, std::string_view token) {
+  while (!list.empty()) {
+    const size_t end = std::min(list.find(','), list.size());
+    std::string_view item = list.substr(0, end);
+    trim_whitespace(item);
+
+    if (to_lower_case(item) == token) {
+      return true;
+    }
+
+    list.remove_prefix(std::min(end + 1, list.size()));
+  }
+
+  return false;
+}
+
+/**
+ * @brief Whether the connection can carry another request once this one is
+ * answered, HTTP/1.1 defaults to yes (RFC 9112 9.3).
+ */
+static bool wants_keep_alive(const Request &request) {
+  auto it = request.fields.find("connection");
+
+  if (it == request.fields.end()) {
+    return true;
+  }
+
+  return to_lower_case(it->second).find("close") == std::string::npos;
+}
+
+} // namespace dwhbll::network::http_server::detail
+
+namespace dwhbll::network::http_server {
+
+/**
+ * @brief Answer `request` with a switch to WebSocket (RFC 6455 4.2), `session`
+ * then runs on the connection's worker until it returns.
+ * @return false if `request` is not a WebSocket handshake, `response` then
+ * holds the error.
+ */
+inline bool upgrade_to_websocket(const Request &request, Response &response,
+                                 std::function<void(WebSocket &)> session,
+                                 WebSocket::Options options = {}) {
+  const auto field = [&](const char *name) -> std::string_view {
+    auto it = request.fields.find(name);
+    return it == request.fields.end() ? std::string_view{} : it->second;
+  };
+
+  // a base64 encoded 16 byte nonce
+  const auto key = field("sec-websocket-key");
+
+  if (request.method != http::HTTP_METHOD::GET ||
+      !detail::has_token(field("upgrade"), "websocket") ||
+      !detail::has_token(field("connection"), "upgrade") || key.size() != 24) {
+    response.code = "400";
+    response.reason = "Bad Request";
+    return false;
+  }
+
+  if (field("sec-websocket-version") != "13") {
+    response.code = "426";
+    response.reason = "Upgrade Required";
+    response.fields.emplace("sec-websocket-version", "13");
+    return false;
+  }
+
+  response.code = "101";
+  response.reason = "Switching Protocols";
+  response.fields.emplace("upgrade", "websocket");
+  response.fields.emplace("connection", "Upgrade");
+  response.fields.emplace("sec-websocket-accept", websocket::accept_key(key));
+  response.websocket_session = std::move(session);
+  response.websocket_options = options;
+  return true;
+}
+
+template <typename H>
+concept Handler = requires(H handler, Request &req, Response &res) {
+  { handler.handle(req, res) } -> std::same_as<void>;
+};
+
+template <typename F>
+concept HandlerFactory = requires(F factory) {
+  { factory() } -> Handler;
+};
+
+/**
+ * @brief Run the handler routed to `request`, or answer 404 / 405.
+ * @return false if the route is at its concurrency limit, nothing was
+ * answered then.
+ */
+template <HandlerFactory F>
+static bool dispatch(Router<F> &rt, Admission &admission, Request &request,
+                     Response &response) {
+  auto route = rt.match(request.method, request.path, request.params);
+  if (route.status == MatchStatus::FOUND) {
+    if (!admission.enter_route(route.index)) {
+      return false;
+    }
+
+    (*route.factory)().handle(request, response);
+    admission.leave_route(route.index);
+  } else {
+    dwhbll::console::debug("no route for {}", request.path);
+    if (route.status == MatchStatus::METHOD_NOT_ALLOWED) {
+      response.code = "405";
+      response.reason = "Method Not Allowed";
+    } else {
+      response.code = "404";
+      response.reason = "Not Found";
+    }
+  }
+
+  return true;
+}
+
+namespace detail {
+/**
+ * @brief The address bytes of `peer`, empty for families without one.
+ */
+static std::span<const std::byte> peer_address(const sockaddr_storage &peer) {
+  if (peer.ss_family == AF_INET) {
+    const auto &in = reinterpret_cast<const sockaddr_in &>(peer);
+    return std::as_bytes(std::span{&in.sin_addr, 1});
+  }
+
+  if (peer.ss_family == AF_INET6) {
+    const auto &in = reinterpret_cast<const sockaddr_in6 &>(peer);
+    return std::as_bytes(std::span{&in.sin6_addr, 1});
+  }
+
+  return {};
+}
+
+/**
+ * @brief Whether a connection is waiting in the accept queue of `listener`.
+ */
+static bool has_waiting_connection(int listener) {
+  pollfd event{.fd = listener, .events = POLLIN};
+  return ::poll(&event, 1, 0) == 1;
+}
+
+/**
+ * @brief Make `response` the answer to a request admission turned away.
+ */
+static void set_rejection(Response &response, Admission::Verdict verdict) {
+  if (verdict == Admission::Verdict::RATE_LIMITED) {
+    response.code = "429";
+    response.reason = "Too Many Requests";
+  } else {
+    response.code = "503";
+    response.reason = "Service Unavailable";
+  }
+
+  response.fields.insert_or_assign("retry-after", "1");
+}
+
+/// answers to turned away requests, around the date line, so rejecting
+/// serialises nothing
+static constexpr std::string_view OVERLOADED_STATUS =
+    "HTTP/1.1 503 Service Unavailable\r\n";
+static constexpr std::string_view RATE_LIMITED_STATUS =
+    "HTTP/1.1 429 Too Many Requests\r\n";
+static constexpr std::string_view REJECTION_FIELDS =
+    "server: dwhbll\r\nretry-after: 1\r\ncontent-length: 0\r\n"
+    "connection: close\r\n\r\n";
+
+/**
+ * @brief Answer a request admission turned away over HTTP/1.1, the
+ * connection has to be closed after, its request body is never read.
+ */
+static void reject(Socket &socket, DateCache &date,
+                   Admission::Verdict verdict) {
+  const auto bytes = [](std::string_view text) {
+    return std::as_bytes(std::span{text.data(), text.size()});
+  };
+
+  std::span<const std::byte> parts[] = {
+      bytes(verdict == Admission::Verdict::RATE_LIMITED ? RATE_LIMITED_STATUS
+                                                        : OVERLOADED_STATUS),
+      bytes(date.get()), bytes(REJECTION_FIELDS)};
+  socket.write_vectored(parts);
+}
+
+/**
+ * @brief Whether the client opened with the HTTP/2 connection preface.
+ *
+ * The preface starts with "PRI ", no HTTP/1.1 request line is shorter than
+ * that, so looking at it never waits for bytes an HTTP/1.1 client won't send.
+ */
+static bool is_http2_preface(Socket &socket) {
+  const auto starts_with_preface = [&](size_t length) {
+    const auto in = socket.buffered();
+    return std::equal(http2::CONNECTION_PREFACE.begin(),
+                      http2::CONNECTION_PREFACE.begin() + length, in.begin(),
+                      [](char c, std::byte b) { return c == static_cast<char>(b); });
+  };
+
+  return socket.fill(4) && starts_with_preface(4) &&
+         socket.fill(http2::CONNECTION_PREFACE.size()) &&
+         starts_with_preface(http2::CONNECTION_PREFACE.size());
+}
+
+/**
+ * @brief Serves one prior knowledge h2c connection (RFC 9113 3.3).
+ *
+ * Streams are multiplexed frame by frame: frames are read as long as they
+ * keep coming and complete requests are answered in the order they completed
+ * in between, so a client can keep many requests in flight on one
+ * connection. Handlers still run one at a time on the connection's worker.
+ * Request bodies arrive in `Request::body`, up to `MAX_BODY` bytes.
+ */
+template <HandlerFactory F> class Http2Connection {
+  static constexpr size_t MAX_CONCURRENT_STREAMS = 128;
+  /// window granted to every stream and to the connection
+  static constexpr uint32_t RECEIVE_WINDOW = 1 << 20;
+  static constexpr size_t MAX_HEADER_BLOCK = 64 * 1024;
+  static constexpr size_t MAX_BODY = 16 << 20;
+
+  struct Stream {
+    std::vector<hpack::HeaderField> fields;
+    std::vector<std::byte> body;
+    int64_t send_window = 0;
+    /// received bytes not given back with a WINDOW_UPDATE yet
+    uint32_t unacked = 0;
+    /// the request is complete and waits in `ready`
+    bool complete = false;
+    bool too_large = false;
+  };
+
+  Socket &socket;
+  Router<F> &router;
+  Admission &admission;
+  CoDel &shedder;
+  const std::span<const std::byte> client;
+  const std::atomic_bool &running;
+
+  hpack::Decoder decoder;
+  hpack::Encoder encoder;
+  DateCache date;
+  Request request;
+  Response response;
+
+  std::unordered_map<uint32_t, Stream> streams;
+  std::deque<uint32_t> ready;
+  uint32_t last_stream = 0;
+
+  uint32_t peer_initial_window = http2::DEFAULT_WINDOW;
+  uint32_t peer_max_frame = http2::DEFAULT_MAX_FRAME_SIZE;
+  int64_t send_window = http2::DEFAULT_WINDOW;
+  uint32_t unacked = 0;
+
+  /// the stream whose header block is being continued, 0 for none
+  uint32_t continuing = 0;
+  bool block_ends_stream = false;
+  std::vector<std::byte> header_block;
+
+  std::vector<std::byte> payload;
+  std::vector<std::byte> block_out;
+
+  bool alive = true;
+  bool peer_going_away = false;
+  http2::ErrorCode error = http2::ErrorCode::NO_ERROR;
+
+  bool connection_error(http2::ErrorCode code) {
+    error = code;
+    return alive = false;
+  }
+
+  void send_frame(http2::FrameType type, uint8_t flags, uint32_t stream,
+                  std::span<const std::byte> data) {
+    std::array<std::byte, http2::FRAME_HEADER_LENGTH> header;
+    http2::FrameHeader{static_cast<uint32_t>(data.size()), type, flags, stream}
+        .encode(header);
+    socket.write(std::span<const std::byte>{header});
+    socket.write(data);
+  }
+
+  void send_u32(http2::FrameType type, uint32_t stream, uint32_t value) {
+    std::array<std::byte, 4> data;
+    http2::write_u32(value, data);
+    send_frame(type, 0, stream, data);
+  }
+
+  void reset_stream(uint32_t stream, http2::ErrorCode code) {
+    send_u32(http2::FrameType::RST_STREAM, stream, static_cast<uint32_t>(code));
+    streams.erase(stream);
+  }
+
+  void send_settings() {
+    constexpr std::pair<http2::Setting, uint32_t> settings[] = {
+        {http2::Setting::MAX_CONCURRENT_STREAMS, MAX_CONCURRENT_STREAMS},
+        {http2::Setting::INITIAL_WINDOW_SIZE, RECEIVE_WINDOW},
+        {http2::Setting::ENABLE_PUSH, 0},
+    };
+
+    std::array<std::byte, std::size(settings) * 6> data;
+    for (size_t i = 0; i < std::size(settings); i++) {
+      const auto id = static_cast<uint16_t>(settings[i].first);
+      data[i * 6] = static_cast<std::byte>(id >> 8);
+      data[i * 6 + 1] = static_cast<std::byte>(id);
+      http2::write_u32(settings[i].second, std::span{data}.subspan(i * 6 + 2));
+    }
+
+    send_frame(http2::FrameType::SETTINGS, 0, 0, data);
+  }
+
+  /**
+   * @brief Read the next frame, its payload goes to `payload`. Whatever is
+   * staged is sent before waiting for the peer.
+   */
+  bool read_frame(http2::FrameHeader &header) {
+    if (!socket.has_pending() && !socket.flush()) {
+      return alive = false;
+    }
+
+    if (!socket.fill(http2::FRAME_HEADER_LENGTH)) {
+      return alive = false;
+    }
+
+    header = http2::FrameHeader::parse(
+        socket.buffered().first<http2::FRAME_HEADER_LENGTH>());
+    socket.consume(http2::FRAME_HEADER_LENGTH);
+
+    // nothing larger was allowed by the settings sent
+    if (header.length > http2::DEFAULT_MAX_FRAME_SIZE) {
+      return connection_error(http2::ErrorCode::FRAME_SIZE_ERROR);
+    }
+
+    payload.resize(header.length);
+    for (size_t copied = 0; copied < header.length;) {
+      if (!socket.fill(1)) {
+        return alive = false;
+      }
+
+      const auto in = socket.buffered();
+      const size_t count = std::min<size_t>(in.size(), header.length - copied);
+      std::copy_n(in.begin(), count, payload.begin() + copied);
+      socket.consume(count);
+      copied += count;
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief The frame payload without its padding.
+   */
+  bool unpadded(const http2::FrameHeader &header,
+                std::span<const std::byte> &data) {
+    data = payload;
+
+    if (!header.has(http2::flags::PADDED)) {
+      return true;
+    }
+
+    if (data.empty() || static_cast<size_t>(data[0]) >= data.size()) {
+      return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+    }
+
+    data = data.subspan(1, data.size() - 1 - static_cast<size_t>(data[0]));
+    return true;
+  }
+
+  bool on_settings(const http2::FrameHeader &header) {
+    if (header.stream != 0) {
+      return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+    }
+
+    if (header.has(http2::flags::ACK) ? header.length != 0
+                                      : header.length % 6 != 0) {
+      return connection_error(http2::ErrorCode::FRAME_SIZE_ERROR);
+    }
+
+    if (header.has(http2::flags::ACK)) {
+      return true;
+    }
+
+    for (size_t pos = 0; pos < payload.size(); pos += 6) {
+      const auto id = static_cast<http2::Setting>(
+          static_cast<uint16_t>(payload[pos]) << 8 |
+          static_cast<uint16_t>(payload[pos + 1]));
+      const uint32_t value = http2::read_u32(std::span{payload}.subspan(pos + 2));
+
+      switch (id) {
+      case http2::Setting::HEADER_TABLE_SIZE:
+        encoder.set_max_table_size(value);
+        break;
+
+      case http2::Setting::ENABLE_PUSH:
+        if (value > 1) {
+          return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+        }
+        break;
+
+      case http2::Setting::INITIAL_WINDOW_SIZE:
+        if (value > http2::MAX_WINDOW) {
+          return connection_error(http2::ErrorCode::FLOW_CONTROL_ERROR);
+        }
+
+        // applies to the windows of open streams too (RFC 9113 6.9.2)
+        for (auto &[id, stream] : streams) {
+          stream.send_window += static_cast<int64_t>(value) - peer_initial_window;
+
+          if (stream.send_window > http2::MAX_WINDOW) {
+            return connection_error(http2::ErrorCode::FLOW_CONTROL_ERROR);
+          }
+        }
+
+        peer_initial_window = value;
+        break;
+
+      case http2::Setting::MAX_FRAME_SIZE:
+        if (value < http2::DEFAULT_MAX_FRAME_SIZE ||
+            value > http2::MAX_FRAME_SIZE_LIMIT) {
+          return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+        }
+        peer_max_frame = value;
+        break;
+
+      default:
+        break;
+      }
+    }
+
+    send_frame(http2::FrameType::SETTINGS, http2::flags::ACK, 0, {});
+    return true;
+  }
+
+  bool on_window_update(const http2::FrameHeader &header) {
+    if (header.length != 4) {
+      return connection_error(http2::ErrorCode::FRAME_SIZE_ERROR);
+    }
+
+    const uint32_t increment = http2::read_u32(payload) & 0x7FFFFFFF;
+
+    if (header.stream == 0) {
+      send_window += increment;
+
+      if (increment == 0) {
+        return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+      }
+
+      if (send_window > http2::MAX_WINDOW) {
+        return connection_error(http2::ErrorCode::FLOW_CONTROL_ERROR);
+      }
+
+      return true;
+    }
+
+    // updates may still arrive for streams that were answered already
+    auto it = streams.find(header.stream);
+    if (it == streams.end()) {
+      return true;
+    }
+
+    it->second.send_window += increment;
+
+    if (increment == 0) {
+      reset_stream(header.stream, http2::ErrorCode::PROTOCOL_ERROR);
+    } else if (it->second.send_window > http2::MAX_WINDOW) {
+      reset_stream(header.stream, http2::ErrorCode::FLOW_CONTROL_ERROR);
+    }
+
+    return true;
+  }
+
+  bool on_data(const http2::FrameHeader &header) {
+    if (header.stream == 0) {
+      return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+    }
+
+    // flow control counts whole frames, padding included
+    if (header.length > RECEIVE_WINDOW - unacked) {
+      return connection_error(http2::ErrorCode::FLOW_CONTROL_ERROR);
+    }
+
+    unacked += header.length;
+    if (unacked >= RECEIVE_WINDOW / 2) {
+      send_u32(http2::FrameType::WINDOW_UPDATE, 0, unacked);
+      unacked = 0;
+    }
+
+    std::span<const std::byte> data;
+    if (!unpadded(header, data)) {
+      return false;
+    }
+
+    auto it = streams.find(header.stream);
+
+    if (it == streams.end() || it->second.complete) {
+      if (header.stream > last_stream) {
+        return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+      }
+
+      send_u32(http2::FrameType::RST_STREAM, header.stream,
+               static_cast<uint32_t>(http2::ErrorCode::STREAM_CLOSED));
+      return true;
+    }
+
+    Stream &stream = it->second;
+
+    if (header.length > RECEIVE_WINDOW - stream.unacked) {
+      reset_stream(header.stream, http2::ErrorCode::FLOW_CONTROL_ERROR);
+      return true;
+    }
+
+    // keep taking the body so the client gets its 413 once it is done
+    if (!stream.too_large && stream.body.size() + data.size() > MAX_BODY) {
+      stream.too_large = true;
+      stream.body = {};
+    }
+
+    if (!stream.too_large) {
+      stream.body.insert(stream.body.end(), data.begin(), data.end());
+    }
+
+    stream.unacked += header.length;
+
+    if (header.has(http2::flags::END_STREAM)) {
+      stream.complete = true;
+      ready.push_back(header.stream);
+    } else if (stream.unacked >= RECEIVE_WINDOW / 2) {
+      send_u32(http2::FrameType::WINDOW_UPDATE, header.stream, stream.unacked);
+      stream.unacked = 0;
+    }
+
+    return true;
+  }
+
+  bool on_headers(const http2::FrameHeader &header) {
+    if (header.stream == 0 || header.stream % 2 == 0) {
+      return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+    }
+
+    std::span<const std::byte> data;
+    if (!unpadded(header, data)) {
+      return false;
+    }
+
+    // priorities are advisory and ignored
+    if (header.has(http2::flags::PRIORITY)) {
+      if (data.size() < 5) {
+        return connection_error(http2::ErrorCode::FRAME_SIZE_ERROR);
+      }
+      data = data.subspan(5);
+    }
+
+    header_block.assign(data.begin(), data.end());
+    block_ends_stream = header.has(http2::flags::END_STREAM);
+    continuing = header.stream;
+
+    return header.has(http2::flags::END_HEADERS) ? end_header_block() : true;
+  }
+
+  bool on_continuation(const http2::FrameHeader &header) {
+    if (continuing == 0) {
+      return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+    }
+
+    if (header_block.size() + payload.size() > MAX_HEADER_BLOCK) {
+      return connection_error(http2::ErrorCode::ENHANCE_YOUR_CALM);
+    }
+
+    header_block.insert(header_block.end(), payload.begin(), payload.end());
+    return header.has(http2::flags::END_HEADERS) ? end_header_block() : true;
+  }
+
+  bool end_header_block() {
+    const uint32_t id = continuing;
+    continuing = 0;
+
+    // decoded even if the stream is refused, the table must stay in sync
+    std::vector<hpack::HeaderField> fields;
+    if (!decoder.decode(header_block, fields)) {
+      return connection_error(http2::ErrorCode::COMPRESSION_ERROR);
+    }
+
+    auto it = streams.find(id);
+
+    if (it != streams.end()) {
+      // trailers, they have to end the request and are dropped
+      if (it->second.complete || !block_ends_stream) {
+        return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+      }
+
+      it->second.complete = true;
+      ready.push_back(id);
+      return true;
+    }
+
+    if (id <= last_stream) {
+      return connection_error(http2::ErrorCode::STREAM_CLOSED);
+    }
+
+    last_stream = id;
+
+    if (streams.size() >= MAX_CONCURRENT_STREAMS ||
+        !running.load(std::memory_order_relaxed)) {
+      send_u32(http2::FrameType::RST_STREAM, id,
+               static_cast<uint32_t>(http2::ErrorCode::REFUSED_STREAM));
+      return true;
+    }
+
+    Stream &stream = streams[id];
+    stream.fields = std::move(fields);
+    stream.send_window = peer_initial_window;
+    stream.complete = block_ends_stream;
+
+    if (stream.complete) {
+      ready.push_back(id);
+    }
+
+    return true;
+  }
+
+  bool handle(const http2::FrameHeader &header) {
+    // nothing may come between the frames of a header block
+    if (continuing != 0 && (header.type != http2::FrameType::CONTINUATION ||
+                            header.stream != continuing)) {
+      return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+    }
+
+    switch (header.type) {
+    case http2::FrameType::DATA:
+      return on_data(header);
+
+    case http2::FrameType::HEADERS:
+      return on_headers(header);
+
+    case http2::FrameType::CONTINUATION:
+      return on_continuation(header);
+
+    case http2::FrameType::SETTINGS:
+      return on_settings(header);
+
+    case http2::FrameType::WINDOW_UPDATE:
+      return on_window_update(header);
+
+    case http2::FrameType::PRIORITY:
+      if (header.stream == 0) {
+        return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+      }
+      return true;
+
+    case http2::FrameType::RST_STREAM:
+      if (header.stream == 0 || header.stream > last_stream) {
+        return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+      }
+      if (header.length != 4) {
+        return connection_error(http2::ErrorCode::FRAME_SIZE_ERROR);
+      }
+      streams.erase(header.stream);
+      return true;
+
+    case http2::FrameType::PING:
+      if (header.stream != 0) {
+        return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+      }
+      if (header.length != 8) {
+        return connection_error(http2::ErrorCode::FRAME_SIZE_ERROR);
+      }
+      if (!header.has(http2::flags::ACK)) {
+        send_frame(http2::FrameType::PING, http2::flags::ACK, 0, payload);
+      }
+      return true;
+
+    case http2::FrameType::GOAWAY:
+      if (header.stream != 0) {
+        return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+      }
+      peer_going_away = true;
+      return true;
+
+    case http2::FrameType::PUSH_PROMISE:
+      // clients never push
+      return connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+    }
+
+    // unknown frame types are ignored
+    return true;
+  }
+
+  /**
+   * @brief Fill `request` from the header fields of `stream`.
+   * @return false if the request is malformed (RFC 9113 8.1.1).
+   */
+  bool build_request(Stream &stream) {
+    request.reset();
+    bool method = false, path = false, regular = false;
+
+    for (auto &field : stream.fields) {
+      if (field.name.starts_with(':')) {
+        // pseudo-headers come first
+        if (regular) {
+          return false;
+        }
+
+        if (field.name == ":method") {
+          auto it = method_map.find(field.value);
+          if (it == method_map.end()) {
+            return false;
+          }
+          request.method = it->second;
+          method = true;
+        } else if (field.name == ":path") {
+          if (field.value.empty()) {
+            return false;
+          }
+          set_uri(request, field.value);
+          path = true;
+        } else if (field.name == ":authority") {
+          request.fields.insert_or_assign("host", std::move(field.value));
+        } else if (field.name != ":scheme") {
+          return false;
+        }
+
+        continue;
+      }
+
+      regular = true;
+
+      if (std::any_of(field.name.begin(), field.name.end(),
+                      [](char c) { return c >= 'A' && c <= 'Z'; }) ||
+          field.name == "connection" || field.name == "keep-alive" ||
+          field.name == "proxy-connection" ||
+          field.name == "transfer-encoding" || field.name == "upgrade" ||
+          (field.name == "te" && field.value != "trailers")) {
+        return false;
+      }
+
+      // repeated fields are joined like HTTP/1.1 would have them in one line
+      auto [it, inserted] = request.fields.try_emplace(field.name, field.value);
+      if (!inserted) {
+        it->second += field.name == "cookie" ? "; " : ", ";
+        it->second += field.value;
+      }
+    }
+
+    request.version = Version::V_2;
+    request.body = std::move(stream.body);
+    return method && path;
+  }
+
+  /**
+   * @brief Wait for frames until `stream` may send again.
+   * @return false if the stream or the connection went away meanwhile.
+   */
+  bool await_window(uint32_t id) {
+    while (alive) {
+      auto it = streams.find(id);
+      if (it == streams.end()) {
+        return false;
+      }
+
+      if (send_window > 0 && it->second.send_window > 0) {
+        return true;
+      }
+
+      http2::FrameHeader header;
+      if (read_frame(header)) {
+        handle(header);
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * @brief Send `data` on `id` as the flow control windows allow.
+   * @return false if the stream or the connection went away.
+   */
+  bool send_data(uint32_t id, std::span<const std::byte> data,
+                 bool end_stream) {
+    do {
+      size_t count = std::min<size_t>(data.size(), peer_max_frame);
+
+      if (count != 0) {
+        if (!await_window(id)) {
+          return false;
+        }
+
+        count = std::min<int64_t>({static_cast<int64_t>(count), send_window,
+                                   streams[id].send_window});
+        send_window -= count;
+        streams[id].send_window -= count;
+      }
+
+      const bool last = end_stream && count == data.size();
+      send_frame(http2::FrameType::DATA, last ? http2::flags::END_STREAM : 0,
+                 id, data.first(count));
+      data = data.subspan(count);
+    } while (!data.empty());
+
+    return true;
+  }
+
+  void send_headers(uint32_t id, bool end_stream) {
+    std::span<const std::byte> block = block_out;
+    http2::FrameType type = http2::FrameType::HEADERS;
+    uint8_t flags = end_stream ? http2::flags::END_STREAM : 0;
+
+    do {
+      const size_t count = std::min<size_t>(block.size(), peer_max_frame);
+      const bool last = count == block.size();
+
+      send_frame(type, flags | (last ? http2::flags::END_HEADERS : 0), id,
+                 block.first(count));
+      block = block.subspan(count);
+      type = http2::FrameType::CONTINUATION;
+      flags = 0;
+    } while (!block.empty());
+  }
+
+  void send_response(uint32_t id, bool head_only) {
+    const bool bodiless = head_only || is_bodiless(response);
+    const bool end_stream = bodiless || (!response.body_producer &&
+                                         !response.file && response.body.empty());
+
+    block_out.clear();
+    encoder.begin(block_out);
+    encoder.encode(":status", response.code, block_out);
+
+    for (const auto &[name, value] : response.fields) {
+      // connection specific fields mean nothing in HTTP/2
+      if (name == "connection" || name == "keep-alive" ||
+          name == "transfer-encoding" || name == "upgrade") {
+        continue;
+      }
+
+      // lengths change with every response, an entry for them is wasted
+      encoder.encode(to_lower_case(name), value, block_out,
+                     name != "content-length");
+    }
+
+    if (!response.fields.contains("date")) {
+      // strip the "date: " and the line end
+      const auto line = date.get();
+      encoder.encode("date", line.substr(6, line.size() - 8), block_out);
+    }
+
+    if (!response.fields.contains("server")) {
+      encoder.encode("server", "dwhbll", block_out);
+    }
+
+    if (!bodiless && !response.body_producer &&
+        !response.fields.contains("content-length")) {
+      encoder.encode("content-length",
+                     std::to_string(response.file ? response.file_length
+                                                  : response.body.size()),
+                     block_out, false);
+    }
+
+    send_headers(id, end_stream);
+
+    if (end_stream) {
+      return;
+    }
+
+    if (response.body_producer) {
+      bool open = true;
+      BodyWriter writer([&](std::span<const std::byte> data) {
+        open = open && send_data(id, data, false);
+      });
+      response.body_producer(writer);
+
+      if (open) {
+        send_data(id, {}, true);
+      }
+    } else if (response.file) {
+      std::vector<std::byte> chunk(peer_max_frame);
+      off_t offset = response.file_offset;
+
+      for (uint64_t left = response.file_length; left != 0;) {
+        const ssize_t count =
+            ::pread(response.file->fd, chunk.data(),
+                    std::min<uint64_t>(left, chunk.size()), offset);
+
+        if (count <= 0) {
+          reset_stream(id, http2::ErrorCode::INTERNAL_ERROR);
+          return;
+        }
+
+        offset += count;
+        left -= count;
+
+        if (!send_data(id, std::span{chunk}.first(count), left == 0)) {
+          return;
+        }
+      }
+    } else {
+      send_data(id, response.body, true);
+    }
+  }
+
+  void respond(uint32_t id) {
+    auto it = streams.find(id);
+
+    // reset by the client while it waited
+    if (it == streams.end()) {
+      return;
+    }
+
+    if (!build_request(it->second)) {
+      reset_stream(id, http2::ErrorCode::PROTOCOL_ERROR);
+      return;
+    }
+
+    // the stream waited since its last frame arrived, answering a body that
+    // was too large is not worth an admission
+    const bool too_large = it->second.too_large;
+    const auto verdict =
+        too_large ? Admission::Verdict::ADMIT
+                  : admission.admit(shedder, socket.since_arrival(), client);
+
+    if (too_large) {
+      response.code = "413";
+      response.reason = "Content Too Large";
+    } else if (verdict != Admission::Verdict::ADMIT) {
+      set_rejection(response, verdict);
+    } else if (!dispatch(router, admission, request, response)) {
+      set_rejection(response, Admission::Verdict::OVERLOADED);
+    }
+
+    // RFC 8441 WebSocket over HTTP/2 is not supported
+    if (response.websocket_session) {
+      reset_stream(id, http2::ErrorCode::HTTP_1_1_REQUIRED);
+    } else {
+      send_response(id, request.method == http::HTTP_METHOD::HEAD);
+      streams.erase(id);
+    }
+
+    if (!too_large && verdict == Admission::Verdict::ADMIT) {
+      admission.release();
+    }
+
+    response.reset();
+  }
+
+public:
+  Http2Connection(Socket &socket, Router<F> &router, Admission &admission,
+                  CoDel &shedder, std::span<const std::byte> client,
+                  const std::atomic_bool &running)
+      : socket(socket), router(router), admission(admission),
+        shedder(shedder), client(client), running(running) {}
+
+  /**
+   * @brief Serve the connection until either side ends it, starting with the
+   * preface `is_http2_preface` found.
+   */
+  void serve() {
+    socket.consume(http2::CONNECTION_PREFACE.size());
+
+    send_settings();
+    send_u32(http2::FrameType::WINDOW_UPDATE, 0,
+             RECEIVE_WINDOW - http2::DEFAULT_WINDOW);
+
+    bool first = true;
+
+    while (alive) {
+      // answer a complete request once no frame is waiting anymore
+      if (!ready.empty() && continuing == 0 && !socket.has_pending()) {
+        const uint32_t id = ready.front();
+        ready.pop_front();
+        respond(id);
+        continue;
+      }
+
+      if (ready.empty() && (peer_going_away ||
+                            !running.load(std::memory_order_relaxed))) {
+        break;
+      }
+
+      http2::FrameHeader header;
+      if (!read_frame(header)) {
+        break;
+      }
+
+      // the client preface ends with its settings
+      if (first && header.type != http2::FrameType::SETTINGS) {
+        connection_error(http2::ErrorCode::PROTOCOL_ERROR);
+        break;
+      }
+
+      first = false;
+      handle(header);
+    }
+
+    std::array<std::byte, 8> goaway;
+    http2::write_u32(last_stream, goaway);
+    http2::write_u32(static_cast<uint32_t>(error), std::span{goaway}.subspan(4));
+    send_frame(http2::FrameType::GOAWAY, 0, 0, goaway);
+    socket.flush();
+  }
+};
+} // namespace detail
+
+/**
+ * @brief How long a connection may take over each part of an exchange before
+ * it is dropped, 0 to wait forever.
+ */
+struct Timeouts {
+  /// the request line and fields from when the connection or its first byte
+  /// came in, however slowly they trickle in
+  std::chrono::milliseconds header{10000};
+  /// between two reads of a request body
+  std::chrono::milliseconds body{30000};
+  /// a kept connection waiting for its next request, also between two
+  /// frames of an HTTP/2 connection
+  std::chrono::milliseconds idle{5000};
+  /// the peer taking nothing of a response
+  std::chrono::milliseconds write{10000};
+};
+
+namespace detail {
+/**
+ * @brief Give the peer `timeout` to send the rest of a request head.
+ */
+static void expect_head(Socket &socket, std::chrono::milliseconds timeout) {
+  socket.set_recv_timeout(timeout);
+  socket.set_recv_deadline(timeout.count() == 0
+                               ? std::chrono::steady_clock::time_point::max()
+                               : std::chrono::steady_clock::now() + timeout);
+}
+
+/**
+ * @brief Wait up to the idle timeout for a kept connection's next request.
+ * @return false if the peer closed the connection or stayed quiet.
+ */
+static bool await_next_request(Socket &socket, const Timeouts &timeouts) {
+  socket.set_recv_timeout(timeouts.idle);
+  socket.set_recv_deadline(std::chrono::steady_clock::time_point::max());
+  return socket.fill(1);
+}
+} // namespace detail
+
+template <HandlerFactory F>
+static void executor(const int listen_socket, Router<F> &rt,
+                     Admission &admission, const Timeouts timeouts,
+                     const std::atomic_bool &running) {
+  dwhbll::console::info("executor");
+  sockaddr_storage inaddr_buf;
+  socklen_t inaddr_bufsize;
+  detail::Socket socket;
+  Request request;
+  Response response;
+  HeaderArena head;
+  DateCache date;
+  CoDel shedder = admission.make_shedder();
+
+  while (running.load(std::memory_order_relaxed)) {
+    inaddr_bufsize = sizeof(inaddr_buf);
+    const int com_sockfd =
+        ::accept4(listen_socket, reinterpret_cast<sockaddr *>(&inaddr_buf),
+                  &inaddr_bufsize, SOCK_NONBLOCK);
+
+    if (com_sockfd == -1) {
+      continue;
+    }
+
+    socket.assign_socket(com_sockfd);
+    socket.set_send_timeout(timeouts.write);
+    detail::expect_head(socket, timeouts.header);
+    const auto client = detail::peer_address(inaddr_buf);
+
+    if (detail::is_http2_preface(socket)) {
+      socket.set_recv_timeout(timeouts.idle);
+      socket.set_recv_deadline(std::chrono::steady_clock::time_point::max());
+      detail::Http2Connection<F>(socket, rt, admission, shedder, client,
+                                 running)
+          .serve();
+      ::close(com_sockfd);
+      continue;
+    }
+
+    // keep-alive: serve requests off the same connection until either side
+    // asks to close, the receive buffer carries pipelined requests over
+    bool keep_alive = true;
+    for (bool first = true; keep_alive; first = false) {
+      // the head of a kept connection's next request is timed from its
+      // first byte, pipelined requests are there already
+      if (!first) {
+        if (!detail::await_next_request(socket, timeouts)) {
+          break;
+        }
+
+        detail::expect_head(socket, timeouts.header);
+      }
+
+      if (!detail::build_request(request, socket)) {
+        dwhbll::console::debug("cannot build request");
+        // TODO: send back a malformed request or smth
+        // this need to be an enum return maybe.
+        break;
+      }
+
+      socket.set_recv_timeout(timeouts.body);
+      socket.set_recv_deadline(std::chrono::steady_clock::time_point::max());
+
+      const auto verdict =
+          admission.admit(shedder, socket.since_arrival(), client);
+
+      if (verdict != Admission::Verdict::ADMIT) {
+        detail::reject(socket, date, verdict);
+        break;
+      }
+
+      // a kept connection holds its worker, while others wait to be accepted
+      // or requests are shed it is let go so the waiting ones get a turn
+      keep_alive = detail::wants_keep_alive(request) &&
+                   running.load(std::memory_order_relaxed) &&
+                   !(admission.sheds() &&
+                     (shedder.dropping() ||
+                      detail::has_waiting_connection(listen_socket)));
+
+      if (!dispatch(rt, admission, request, response)) {
+        admission.release();
+        detail::reject(socket, date, Admission::Verdict::OVERLOADED);
+        break;
+      }
+
+      // whatever the handler did not read is still in the socket, if it
+      // cannot be skipped the next request cannot be found either
+      if (!request.body_reader.discard()) {
+        keep_alive = false;
+      }
+
+      if (!keep_alive && !response.fields.contains("connection")) {
+        response.fields.emplace("connection", "close");
+      }
+
+      const bool chunked = response.body_producer &&
+                           !response.fields.contains("content-length");
+
+      detail::serialize_head(head, date, response, chunked);
+
+      bool sent;
+      if (request.method == http::HTTP_METHOD::HEAD) {
+        std::span<const std::byte> parts[] = {head.bytes()};
+        sent = socket.write_vectored(parts);
+      } else if (response.file) {
+        socket.write(head.bytes());
+        sent = socket.send_file(response.file->fd, response.file_offset,
+                                response.file_length);
+      } else if (response.body_producer) {
+        // the head stays staged and goes out with the first chunk
+        socket.write(head.bytes());
+        BodyWriter writer(socket, chunked);
+        response.body_producer(writer);
+        writer.finish();
+        sent = socket.flush();
+      } else {
+        std::span<const std::byte> parts[] = {head.bytes(), response.body};
+        sent = socket.write_vectored(parts);
+      }
+
+      keep_alive = keep_alive && sent;
+      admission.release();
+
+      // the connection is the session's now and is closed once it returns
+      if (sent && response.websocket_session) {
+        WebSocket websocket(socket, &running, response.websocket_options);
+        response.websocket_session(websocket);
+        websocket.close();
+        keep_alive = false;
+      }
+
+      response.reset();
+    }
+
+    ::close(com_sockfd);
+  }
+}
+
+template <HandlerFactory F> class Server {
+private:
+  std::vector<std::thread> thread_pool;
+  Router<F> route_table;
+  Admission admission;
+  Timeouts timeouts;
+  int server_fd = -1;
+  std::atomic_bool running = false;
+
+public:
+  ~Server() {
+    if (server_fd != -1) {
+      ::close(server_fd);
+    }
+  }
+
+  int listen_to(const uint32_t address, const uint16_t port) {
+    const bool enable_bool = 1;
+    int status;
+
+    if (server_fd != -1) {
+      console::error("Server already bound.");
+      return -1;
+    }
+
+    detail::SocketBuilder sock;
+
+    if (sock.create_socket()) {
+      return -1;
+    }
+
+    if (sock.bind_addr(address, port)) {
+      return -1;
+    }
+
+    server_fd = sock.get_fd();
     return 0;
   }
 
-  void add_route(const std::string route, F factory) {
-    route_table.insert(std::make_pair(route, factory));
+  /**
+   * @brief Route `route` to `factory` for every method.
+   *
+   * Segments written `{name}` match any single segment and are exposed
+   * through `Request::params`, a trailing `*` or `{*name}` matches the rest
+   * of the path.
+   *
+   * @param max_in_flight requests the route handles at once, more are
+   * answered with 503. 0 for no limit.
+   */
+  void add_route(const std::string route, F factory,
+                 const size_t max_in_flight = 0) {
+    // the router numbers its routes in the order they are added
+    admission.limit_route(route_table.size(), max_in_flight);
+    route_table.add(route, factory);
+  }
+
+  void add_route(http::HTTP_METHOD method, const std::string route,
+                 F factory, const size_t max_in_flight = 0) {
+    admission.limit_route(route_table.size(), max_in_flight);
+    route_table.add(method, route, factory);
+  }
+
+  /**
+   * @brief Set the limits requests are admitted under, before `listen()`.
+   *
+   * Turned away requests get a 503, or a 429 for clients over their rate,
+   * and their connection is closed.
+   */
+  void set_admission(const Admission::Options &options) {
+    admission.configure(options);
   }
 
+  /**
+   * @brief Set how long connections may take over each part of an exchange,
+   * before `listen()`. Connections that take longer are closed.
+   */
+  void set_timeouts(const Timeouts &timeouts) { this->timeouts = timeouts; }
+
   int listen(const size_t worker_count = std::thread::hardware_concurrency(),
              const uint32_t pending_queue_size = SOMAXCONN) {
-    const int status = ::listen(server_fd, 5);
+    // accepted sockets inherit the timestamping, which dates every request
+    // for the shedder
+    const int timestamps = admission.sheds();
+    if (::setsockopt(server_fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps,
+                     sizeof(timestamps)) == -1) {
+      console::error("Cannot timestamp what the socket receives");
+      return -1;
+    }
+
+    const int status = ::listen(server_fd, pending_queue_size);
 
     if (status == -1) {
       console::error("Cannot set socket to start listening");
       return -1;
     }
 
+    route_table.compile();
+    running = true;
+
     thread_pool.reserve(worker_count);
     for (size_t amount = 0; amount < worker_count; amount++) {
-      thread_pool.push_back(
-          std::thread(executor<F>, server_fd, std::ref(route_table)));
+      thread_pool.push_back(std::thread(executor<F>, server_fd,
+                                        std::ref(route_table),
+                                        std::ref(admission), timeouts,
+                                        std::cref(running)));
     }
 
     return 0;
@@ -573,8 +2627,22 @@ public:
     for (auto &thread_handle : thread_pool) {
       thread_handle.join();
     }
+
+    thread_pool.clear();
   }
 
-  void stop();
+  /**
+   * @brief Stop accepting connections and wait for the workers to return.
+   *
+   * Workers finish the request they are serving, a worker waiting on an idle
+   * keep-alive connection returns once the idle timeout passes.
+   */
+  void stop() {
+    running = false;
+
+    // wakes the workers blocked in accept
+    ::shutdown(server_fd, SHUT_RDWR);
+    wait_finish();
+  }
 };
 } // namespace dwhbll::network::http_server
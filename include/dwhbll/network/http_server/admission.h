@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Admission control, deciding before a handler runs whether a request is
+ * served or turned away while the server is overloaded.
+ */
+namespace dwhbll::network::http_server {
+/**
+ * @brief Counts requests in progress against a limit, shared by the workers.
+ */
+class ConcurrencyLimit {
+  std::atomic<std::size_t> active = 0;
+  const std::size_t limit;
+
+public:
+  explicit ConcurrencyLimit(std::size_t limit) : limit(limit) {}
+
+  /**
+   * @return false if `limit` requests are in progress already.
+   */
+  bool try_acquire() noexcept {
+    if (active.fetch_add(1, std::memory_order_acquire) >= limit) {
+      active.fetch_sub(1, std::memory_order_release);
+      return false;
+    }
+
+    return true;
+  }
+
+  void release() noexcept { active.fetch_sub(1, std::memory_order_release); }
+
+  [[nodiscard]] std::size_t in_flight() const noexcept {
+    return active.load(std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief Allows `rate` requests per second on average with bursts of up to
+ * `burst`, refilled lazily whenever a request comes in.
+ */
+class TokenBucket {
+  double tokens;
+  std::chrono::steady_clock::time_point last;
+
+public:
+  TokenBucket(double burst, std::chrono::steady_clock::time_point now)
+      : tokens(burst), last(now) {}
+
+  /**
+   * @brief Take a token for one request.
+   * @return false if the bucket is empty.
+   */
+  bool take(double rate, double burst,
+            std::chrono::steady_clock::time_point now) noexcept;
+
+  /**
+   * @brief Whether the bucket refilled completely, it is then no different
+   * from a fresh one.
+   */
+  [[nodiscard]] bool full(double rate, double burst,
+                          std::chrono::steady_clock::time_point now) const noexcept;
+};
+
+/**
+ * @brief A token bucket per client address.
+ *
+ * Addresses are spread over shards with a lock each, so workers only contend
+ * when their clients hash alike. Once a shard tracks its share of
+ * `max_clients`, buckets that refilled are forgotten; if none did, new clients
+ * are let through untracked rather than growing without bound.
+ */
+class ClientRateLimiter {
+public:
+  /// IPv4 addresses take the first 4 bytes
+  using Address = std::array<std::byte, 16>;
+
+private:
+  static constexpr std::size_t SHARDS = 16;
+
+  struct AddressHash {
+    std::size_t operator()(const Address &address) const noexcept;
+  };
+
+  struct alignas(64) Shard {
+    std::mutex lock;
+    std::unordered_map<Address, TokenBucket, AddressHash> buckets;
+  };
+
+  std::array<Shard, SHARDS> shards;
+  const double rate, burst;
+  const std::size_t max_clients_per_shard;
+
+public:
+  ClientRateLimiter(double rate, double burst, std::size_t max_clients = 1 << 16);
+
+  /**
+   * @brief Take a token from the bucket of `address`.
+   * @return false if the client is over its rate.
+   */
+  bool admit(std::span<const std::byte> address,
+             std::chrono::steady_clock::time_point now);
+};
+
+/**
+ * @brief CoDel (RFC 8289) applied to how long requests waited before a worker
+ * got to them.
+ *
+ * A queue that stays above `target` for a whole `interval` is a standing
+ * queue rather than a burst, requests are shed from then on at a rate that
+ * grows with the square root of the drops until the delay is back under
+ * `target`. Not thread safe, every worker owns one.
+ */
+class CoDel {
+  std::chrono::steady_clock::duration target, interval;
+  /// when the delay will have been above target for an interval, if it is
+  std::chrono::steady_clock::time_point first_above{};
+  std::chrono::steady_clock::time_point drop_next{};
+  std::uint32_t count = 0, last_count = 0;
+  bool dropping_ = false;
+
+  [[nodiscard]] std::chrono::steady_clock::time_point
+  control_law(std::chrono::steady_clock::time_point t) const noexcept;
+
+public:
+  CoDel(std::chrono::steady_clock::duration target,
+        std::chrono::steady_clock::duration interval)
+      : target(target), interval(interval) {}
+
+  /**
+   * @brief Account for a request that waited `sojourn`.
+   * @return true if the request should be shed.
+   */
+  bool should_drop(std::chrono::steady_clock::duration sojourn,
+                   std::chrono::steady_clock::time_point now) noexcept;
+
+  /**
+   * @brief Whether requests are being shed at the moment.
+   */
+  [[nodiscard]] bool dropping() const noexcept { return dropping_; }
+};
+
+/**
+ * @brief The limits a server applies to every request, in the order they are
+ * checked: the client's rate, the queueing delay, the server's and then the
+ * route's concurrency.
+ */
+class Admission {
+public:
+  struct Options {
+    /// requests handled at once over all workers, 0 for no limit
+    std::size_t max_in_flight = 0;
+    /// requests per second per client address, 0 for no limit
+    double client_rate = 0;
+    /// requests a client may send at once on top of its rate
+    double client_burst = 0;
+    /// queueing delay requests are shed above, 0 to never shed. Kept
+    /// connections are also let go while others wait to be accepted then.
+    std::chrono::milliseconds queue_target{0};
+    /// how long the delay has to stay above target before shedding starts
+    std::chrono::milliseconds queue_interval{100};
+  };
+
+  enum class Verdict {
+    ADMIT,
+    OVERLOADED,   ///< answered with 503
+    RATE_LIMITED, ///< answered with 429
+  };
+
+private:
+  Options options;
+  std::unique_ptr<ConcurrencyLimit> in_flight;
+  std::unique_ptr<ClientRateLimiter> clients;
+  /// by route index, null for routes without a limit
+  std::vector<std::unique_ptr<ConcurrencyLimit>> routes;
+
+public:
+  /**
+   * @brief Apply `options`, only before the workers start.
+   */
+  void configure(const Options &options);
+
+  /**
+   * @brief Limit the route registered `route`th to `max_in_flight` requests at
+   * once, only before the workers start.
+   */
+  void limit_route(std::size_t route, std::size_t max_in_flight);
+
+  /**
+   * @brief Whether the queueing delay is measured at all, the listening
+   * socket has to timestamp what it receives then.
+   */
+  [[nodiscard]] bool sheds() const noexcept {
+    return options.queue_target.count() != 0;
+  }
+
+  /**
+   * @brief A shedder for one worker.
+   */
+  [[nodiscard]] CoDel make_shedder() const {
+    return {options.queue_target, options.queue_interval};
+  }
+
+  /**
+   * @brief Decide on a request that waited `sojourn` to be read, before it is
+   * routed. An admitted request has to be `release()`d once answered.
+   * @param client the peer's address, empty if it has none.
+   */
+  Verdict admit(CoDel &shedder, std::chrono::steady_clock::duration sojourn,
+                std::span<const std::byte> client);
+
+  void release() noexcept;
+
+  /**
+   * @return false if the route is at its limit.
+   */
+  bool enter_route(std::size_t route) noexcept;
+
+  void leave_route(std::size_t route) noexcept;
+};
+} // namespace dwhbll::network::http_server
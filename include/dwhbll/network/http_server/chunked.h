@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dwhbll::network::http_server {
+/**
+ * @brief Incremental decoder for `Transfer-Encoding: chunked` bodies.
+ *
+ * The decoder keeps no buffer of its own, it only tracks where it is in the
+ * framing, so the caller decides how much memory a body may use. Chunk
+ * extensions and trailer fields are consumed and discarded.
+ */
+class ChunkedDecoder {
+public:
+  struct Result {
+    std::size_t consumed; ///< bytes eaten from the input
+    std::size_t produced; ///< body bytes written to the output
+  };
+
+private:
+  enum class State : std::uint8_t {
+    SIZE_START,
+    SIZE,
+    EXTENSION,
+    SIZE_LF,
+    DATA,
+    DATA_CR,
+    DATA_LF,
+    TRAILER_START,
+    TRAILER,
+    TRAILER_LF,
+    FINAL_LF,
+    DONE,
+    ERROR,
+  };
+
+  State state = State::SIZE_START;
+  std::uint64_t remaining = 0;
+
+public:
+  /**
+   * @brief Decode as much of `in` as possible into `out`.
+   * @note Stops early once `out` is full, or once the body has ended, the
+   * bytes after the end of the body are left for the caller.
+   */
+  Result decode(std::span<const std::byte> in, std::span<std::byte> out) noexcept;
+
+  [[nodiscard]] bool done() const noexcept { return state == State::DONE; }
+
+  [[nodiscard]] bool failed() const noexcept { return state == State::ERROR; }
+
+  void reset() noexcept {
+    state = State::SIZE_START;
+    remaining = 0;
+  }
+};
+
+/**
+ * @brief Longest chunk header `encode_chunk_header` can produce: 16 hex
+ * digits followed by CRLF.
+ */
+constexpr std::size_t MAX_CHUNK_HEADER = 18;
+
+/**
+ * @brief Write the `<hex-size>\r\n` line that starts a chunk.
+ * @return number of characters written.
+ */
+std::size_t encode_chunk_header(std::uint64_t size,
+                                std::span<char, MAX_CHUNK_HEADER> out) noexcept;
+} // namespace dwhbll::network::http_server
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * HPACK, the header compression of HTTP/2 (RFC 7541).
+ *
+ * Both sides keep a dynamic table of recently sent fields, so a Decoder must
+ * see every header block of its connection in order, including those of
+ * streams that end up refused.
+ */
+namespace dwhbll::network::http_server::hpack {
+/// dynamic table size both sides start with
+constexpr std::size_t DEFAULT_TABLE_SIZE = 4096;
+
+/// entries of the static table (RFC 7541 appendix A), dynamic ones follow
+constexpr std::size_t STATIC_TABLE_LENGTH = 61;
+
+struct HeaderField {
+  std::string name;
+  std::string value;
+
+  /**
+   * @brief What the field counts for in a table or header list, RFC 7541 4.1.
+   */
+  [[nodiscard]] std::size_t size() const noexcept {
+    return name.size() + value.size() + 32;
+  }
+};
+
+/**
+ * @brief Append `value` as an integer with a `prefix_bits` prefix, `flags`
+ * fill the bits of the first byte above the prefix.
+ */
+void encode_integer(std::uint64_t value, unsigned prefix_bits,
+                    std::uint8_t flags, std::vector<std::byte> &out);
+
+/**
+ * @brief Decode the integer at `pos`, `pos` is moved past it.
+ * @return false if `in` ends inside the integer or it does not fit 32 bits.
+ */
+bool decode_integer(std::span<const std::byte> in, std::size_t &pos,
+                    unsigned prefix_bits, std::uint64_t &value) noexcept;
+
+[[nodiscard]] std::size_t huffman_encoded_size(std::string_view text) noexcept;
+
+/**
+ * @brief Append `text` Huffman coded, padded with the start of EOS.
+ */
+void huffman_encode(std::string_view text, std::vector<std::byte> &out);
+
+/**
+ * @brief Append the decoded `in` to `out`.
+ * @return false on EOS or on padding longer than 7 bits or not all ones.
+ */
+bool huffman_decode(std::span<const std::byte> in, std::string &out);
+
+/**
+ * @brief Fields in the order they were added, the newest has index 0.
+ */
+class DynamicTable {
+  std::deque<HeaderField> entries;
+  std::size_t size_ = 0;
+  std::size_t max_size_ = DEFAULT_TABLE_SIZE;
+
+  void evict(std::size_t room) noexcept;
+
+public:
+  /**
+   * @brief Add a field, evicting the oldest ones to make room. A field larger
+   * than the whole table only empties it.
+   */
+  void add(std::string_view name, std::string_view value);
+
+  void set_max_size(std::size_t size) noexcept;
+
+  [[nodiscard]] const HeaderField &operator[](std::size_t index) const {
+    return entries[index];
+  }
+
+  [[nodiscard]] std::size_t count() const noexcept { return entries.size(); }
+
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  [[nodiscard]] std::size_t max_size() const noexcept { return max_size_; }
+};
+
+class Decoder {
+  DynamicTable table;
+  /// the SETTINGS_HEADER_TABLE_SIZE this side advertised
+  std::size_t size_limit = DEFAULT_TABLE_SIZE;
+
+  /**
+   * @brief The field at `index` of the static and dynamic table together.
+   * @return false if there is none.
+   */
+  bool lookup(std::uint64_t index, std::string_view &name,
+              std::string_view &value) const noexcept;
+
+  bool read_string(std::span<const std::byte> block, std::size_t &pos,
+                   std::string &out);
+
+public:
+  /**
+   * @brief Decode a whole header block into `out`.
+   * @param max_list_size fields past this many bytes fail the block, so a
+   * small block cannot expand into huge header lists.
+   * @return false if the block is malformed, which is a connection error.
+   */
+  bool decode(std::span<const std::byte> block, std::vector<HeaderField> &out,
+              std::size_t max_list_size = 64 * 1024);
+
+  [[nodiscard]] const DynamicTable &dynamic_table() const noexcept {
+    return table;
+  }
+};
+
+class Encoder {
+  DynamicTable table;
+  /// smallest and latest size the peer allowed since the last block
+  std::size_t smallest_update = 0, pending_update = 0;
+  bool update_pending = false;
+
+  void write_string(std::string_view text, std::vector<std::byte> &out);
+
+public:
+  /**
+   * @brief Apply the peer's SETTINGS_HEADER_TABLE_SIZE, signalled at the
+   * start of the next header block.
+   */
+  void set_max_table_size(std::size_t size);
+
+  /**
+   * @brief Start a header block.
+   */
+  void begin(std::vector<std::byte> &out);
+
+  /**
+   * @param index whether the field may enter the dynamic table, values that
+   * change with every message only evict useful entries.
+   */
+  void encode(std::string_view name, std::string_view value,
+              std::vector<std::byte> &out, bool index = true);
+
+  [[nodiscard]] const DynamicTable &dynamic_table() const noexcept {
+    return table;
+  }
+};
+} // namespace dwhbll::network::http_server::hpack
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+/*
+ * HTTP/2 framing (RFC 9113), shared by the server connection and its tests.
+ */
+namespace dwhbll::network::http_server::http2 {
+/// what a client sends first on a prior knowledge h2c connection
+constexpr std::string_view CONNECTION_PREFACE =
+    "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+constexpr std::size_t FRAME_HEADER_LENGTH = 9;
+
+/// window and frame size every connection starts with
+constexpr std::uint32_t DEFAULT_WINDOW = 65535;
+constexpr std::uint32_t DEFAULT_MAX_FRAME_SIZE = 16384;
+constexpr std::uint32_t MAX_FRAME_SIZE_LIMIT = (1 << 24) - 1;
+constexpr std::int64_t MAX_WINDOW = 0x7FFFFFFF;
+
+enum class FrameType : std::uint8_t {
+  DATA = 0x0,
+  HEADERS = 0x1,
+  PRIORITY = 0x2,
+  RST_STREAM = 0x3,
+  SETTINGS = 0x4,
+  PUSH_PROMISE = 0x5,
+  PING = 0x6,
+  GOAWAY = 0x7,
+  WINDOW_UPDATE = 0x8,
+  CONTINUATION = 0x9,
+};
+
+namespace flags {
+constexpr std::uint8_t END_STREAM = 0x1;
+constexpr std::uint8_t ACK = 0x1;
+constexpr std::uint8_t END_HEADERS = 0x4;
+constexpr std::uint8_t PADDED = 0x8;
+constexpr std::uint8_t PRIORITY = 0x20;
+} // namespace flags
+
+enum class ErrorCode : std::uint32_t {
+  NO_ERROR = 0x0,
+  PROTOCOL_ERROR = 0x1,
+  INTERNAL_ERROR = 0x2,
+  FLOW_CONTROL_ERROR = 0x3,
+  SETTINGS_TIMEOUT = 0x4,
+  STREAM_CLOSED = 0x5,
+  FRAME_SIZE_ERROR = 0x6,
+  REFUSED_STREAM = 0x7,
+  CANCEL = 0x8,
+  COMPRESSION_ERROR = 0x9,
+  CONNECT_ERROR = 0xA,
+  ENHANCE_YOUR_CALM = 0xB,
+  INADEQUATE_SECURITY = 0xC,
+  HTTP_1_1_REQUIRED = 0xD,
+};
+
+enum class Setting : std::uint16_t {
+  HEADER_TABLE_SIZE = 0x1,
+  ENABLE_PUSH = 0x2,
+  MAX_CONCURRENT_STREAMS = 0x3,
+  INITIAL_WINDOW_SIZE = 0x4,
+  MAX_FRAME_SIZE = 0x5,
+  MAX_HEADER_LIST_SIZE = 0x6,
+};
+
+inline std::uint32_t read_u32(std::span<const std::byte> in) noexcept {
+  return static_cast<std::uint32_t>(in[0]) << 24 |
+         static_cast<std::uint32_t>(in[1]) << 16 |
+         static_cast<std::uint32_t>(in[2]) << 8 |
+         static_cast<std::uint32_t>(in[3]);
+}
+
+inline void write_u32(std::uint32_t value, std::span<std::byte> out) noexcept {
+  out[0] = static_cast<std::byte>(value >> 24);
+  out[1] = static_cast<std::byte>(value >> 16);
+  out[2] = static_cast<std::byte>(value >> 8);
+  out[3] = static_cast<std::byte>(value);
+}
+
+struct FrameHeader {
+  std::uint32_t length = 0;
+  FrameType type = FrameType::DATA;
+  std::uint8_t flags = 0;
+  std::uint32_t stream = 0;
+
+  static FrameHeader
+  parse(std::span<const std::byte, FRAME_HEADER_LENGTH> in) noexcept {
+    FrameHeader header;
+    header.length = static_cast<std::uint32_t>(in[0]) << 16 |
+                    static_cast<std::uint32_t>(in[1]) << 8 |
+                    static_cast<std::uint32_t>(in[2]);
+    header.type = static_cast<FrameType>(in[3]);
+    header.flags = static_cast<std::uint8_t>(in[4]);
+    // the reserved bit is ignored on receipt
+    header.stream = read_u32(in.subspan(5)) & 0x7FFFFFFF;
+    return header;
+  }
+
+  void encode(std::span<std::byte, FRAME_HEADER_LENGTH> out) const noexcept {
+    out[0] = static_cast<std::byte>(length >> 16);
+    out[1] = static_cast<std::byte>(length >> 8);
+    out[2] = static_cast<std::byte>(length);
+    out[3] = static_cast<std::byte>(type);
+    out[4] = static_cast<std::byte>(flags);
+    write_u32(stream, out.subspan(5));
+  }
+
+  [[nodiscard]] bool has(std::uint8_t flag) const noexcept {
+    return flags & flag;
+  }
+};
+} // namespace dwhbll::network::http_server::http2
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+namespace dwhbll::network::http_server {
+/**
+ * @brief An open file along with the metadata needed to answer for it.
+ *
+ * Shared between the file cache and the responses currently sending it, the
+ * descriptor is closed once the last of them lets go.
+ */
+struct OpenFile {
+  int fd = -1;
+  std::uint64_t size = 0;
+  std::time_t modified = 0;
+  dev_t device = 0;
+  ino_t inode = 0;
+  /// quoted strong validator
+  std::string etag;
+  /// `modified` as an http date
+  std::string last_modified;
+  std::string_view content_type;
+
+  OpenFile() = default;
+
+  OpenFile(const OpenFile &other) = delete;
+
+  OpenFile &operator=(const OpenFile &other) = delete;
+
+  ~OpenFile() {
+    if (fd != -1) {
+      ::close(fd);
+    }
+  }
+};
+} // namespace dwhbll::network::http_server
@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/network/http/methods.h>
+
+namespace dwhbll::network::http_server {
+/**
+ * @brief Path parameters captured while matching a route.
+ *
+ * Fixed capacity so lookups never allocate, names point into the router and
+ * values point into the request uri.
+ */
+class RouteParams {
+public:
+  constexpr static std::size_t CAPACITY = 8;
+
+private:
+  std::array<std::pair<std::string_view, std::string_view>, CAPACITY> entries;
+  std::size_t count = 0;
+
+  template <typename F> friend class Router;
+
+  void push(std::string_view name, std::string_view value) {
+    entries[count++] = {name, value};
+  }
+
+  void pop() { count--; }
+
+public:
+  [[nodiscard]] std::optional<std::string_view>
+  get(std::string_view name) const {
+    for (std::size_t i = 0; i < count; i++) {
+      if (entries[i].first == name) {
+        return entries[i].second;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  [[nodiscard]] std::size_t size() const { return count; }
+
+  [[nodiscard]] bool empty() const { return count == 0; }
+
+  void clear() { count = 0; }
+
+  [[nodiscard]] auto begin() const { return entries.begin(); }
+
+  [[nodiscard]] auto end() const { return entries.begin() + count; }
+};
+
+enum class MatchStatus {
+  FOUND,
+  NOT_FOUND,          ///< no route for this path
+  METHOD_NOT_ALLOWED, ///< the path exists but not for this method
+};
+
+/**
+ * @brief Segment trie mapping request paths to handler factories.
+ *
+ * Patterns are split on '/', a segment is either literal, a `{name}`
+ * parameter or a trailing `*` (or `{*name}`) that swallows the rest of the
+ * path. Literals win over parameters which win over wildcards, with
+ * backtracking when a more specific branch dead ends.
+ *
+ * `compile()` flattens the literal edges of every node into one sorted array
+ * so a lookup is a binary search per segment with no allocation.
+ *
+ * @tparam F handler factory type stored per route
+ */
+template <typename F> class Router {
+  constexpr static std::size_t METHOD_COUNT = 9;
+  constexpr static std::size_t ANY_METHOD = METHOD_COUNT;
+  constexpr static std::int32_t NONE = -1;
+
+  struct Edge {
+    std::string segment;
+    std::uint32_t child;
+  };
+
+  struct Node {
+    /// literal children, only valid once compiled
+    std::uint32_t edges_begin = 0, edges_count = 0;
+    std::int32_t param_child = NONE;
+    std::int32_t wildcard_child = NONE;
+    /// name of the parameter this node captures, if it is a param/wildcard node
+    std::string param_name;
+    std::array<std::int32_t, METHOD_COUNT + 1> handlers;
+    bool has_handler = false;
+
+    Node() { handlers.fill(NONE); }
+  };
+
+  std::vector<Node> nodes{1};
+  std::vector<Edge> edges;
+  std::vector<F> factories;
+
+  /// per node literal children while building, flattened into `edges`
+  std::vector<std::vector<Edge>> pending_edges{1};
+  bool compiled = false;
+
+  static bool next_segment(std::string_view &rest, bool &at_end,
+                           std::string_view &segment) {
+    if (at_end) {
+      return false;
+    }
+
+    const auto pos = rest.find('/');
+
+    if (pos == std::string_view::npos) {
+      segment = rest;
+      rest = {};
+      at_end = true;
+    } else {
+      segment = rest.substr(0, pos);
+      rest = rest.substr(pos + 1);
+    }
+
+    return true;
+  }
+
+  std::uint32_t make_node() {
+    nodes.emplace_back();
+    pending_edges.emplace_back();
+    return nodes.size() - 1;
+  }
+
+  std::uint32_t param_node(std::uint32_t parent, std::int32_t Node::*slot,
+                           std::string_view name) {
+    if (nodes[parent].*slot == NONE) {
+      const auto child = make_node();
+      nodes[parent].*slot = child;
+      nodes[child].param_name = name;
+      return child;
+    }
+
+    const auto child = nodes[parent].*slot;
+
+    if (nodes[child].param_name != name) {
+      debug::panic("route parameter {{{}}} conflicts with {{{}}}", name,
+                   nodes[child].param_name);
+    }
+
+    return child;
+  }
+
+  std::uint32_t literal_node(std::uint32_t parent, std::string_view segment) {
+    for (const auto &edge : pending_edges[parent]) {
+      if (edge.segment == segment) {
+        return edge.child;
+      }
+    }
+
+    const auto child = make_node();
+    pending_edges[parent].push_back({std::string(segment), child});
+    return child;
+  }
+
+  std::int32_t pick(const Node &node, std::size_t method,
+                    bool &path_found) const {
+    if (!node.has_handler) {
+      return NONE;
+    }
+
+    path_found = true;
+
+    if (node.handlers[method] != NONE) {
+      return node.handlers[method];
+    }
+
+    return node.handlers[ANY_METHOD];
+  }
+
+  std::int32_t match_node(std::uint32_t index, std::string_view rest,
+                          bool at_end, std::size_t method, RouteParams &params,
+                          bool &path_found) const {
+    const Node &node = nodes[index];
+    std::string_view segment;
+    const std::string_view whole = rest;
+
+    if (!next_segment(rest, at_end, segment)) {
+      if (auto found = pick(node, method, path_found); found != NONE) {
+        return found;
+      }
+
+      // a trailing wildcard also matches nothing at all
+      if (node.wildcard_child != NONE) {
+        const Node &wildcard = nodes[node.wildcard_child];
+        if (auto found = pick(wildcard, method, path_found); found != NONE) {
+          params.push(wildcard.param_name, {});
+          return found;
+        }
+      }
+
+      return NONE;
+    }
+
+    if (node.edges_count != 0) {
+      const auto first = edges.begin() + node.edges_begin;
+      const auto last = first + node.edges_count;
+      const auto it = std::lower_bound(
+          first, last, segment, [](const Edge &edge, std::string_view value) {
+            return std::string_view(edge.segment) < value;
+          });
+
+      if (it != last && it->segment == segment) {
+        if (auto found =
+                match_node(it->child, rest, at_end, method, params, path_found);
+            found != NONE) {
+          return found;
+        }
+      }
+    }
+
+    if (node.param_child != NONE && !segment.empty() &&
+        params.size() < RouteParams::CAPACITY) {
+      params.push(nodes[node.param_child].param_name, segment);
+
+      if (auto found = match_node(node.param_child, rest, at_end, method,
+                                  params, path_found);
+          found != NONE) {
+        return found;
+      }
+
+      params.pop();
+    }
+
+    if (node.wildcard_child != NONE && params.size() < RouteParams::CAPACITY) {
+      const Node &wildcard = nodes[node.wildcard_child];
+      if (auto found = pick(wildcard, method, path_found); found != NONE) {
+        params.push(wildcard.param_name, whole);
+        return found;
+      }
+    }
+
+    return NONE;
+  }
+
+public:
+  struct Match {
+    MatchStatus status;
+    F *factory;
+    /// how many routes were registered before this one, for state kept
+    /// per route outside the router
+    std::size_t index = 0;
+  };
+
+  /**
+   * @brief Register a route for one method.
+   * @note Must be called before `compile()`.
+   */
+  void add(http::HTTP_METHOD method, std::string_view pattern, F factory) {
+    add_internal(static_cast<std::size_t>(method), pattern, std::move(factory));
+  }
+
+  /**
+   * @brief Register a route answering every method that has no dedicated
+   * handler on the same path.
+   */
+  void add(std::string_view pattern, F factory) {
+    add_internal(ANY_METHOD, pattern, std::move(factory));
+  }
+
+  /**
+   * @brief Flatten the trie for lookups, no routes can be added afterwards.
+   */
+  void compile() {
+    if (compiled) {
+      return;
+    }
+
+    edges.clear();
+
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+      auto &children = pending_edges[i];
+
+      std::ranges::sort(children, {}, &Edge::segment);
+
+      nodes[i].edges_begin = edges.size();
+      nodes[i].edges_count = children.size();
+
+      std::ranges::move(children, std::back_inserter(edges));
+    }
+
+    pending_edges.clear();
+    pending_edges.shrink_to_fit();
+    compiled = true;
+  }
+
+  /**
+   * @brief Find the factory for `path` (without query string).
+   * @param params filled with the captured parameters on success.
+   */
+  Match match(http::HTTP_METHOD method, std::string_view path,
+              RouteParams &params) {
+    params.clear();
+
+    if (!compiled) {
+      debug::panic("router has to be compiled before matching");
+    }
+
+    if (path.empty() || path.front() != '/') {
+      return {MatchStatus::NOT_FOUND, nullptr};
+    }
+
+    path.remove_prefix(1);
+
+    bool path_found = false;
+    const auto found =
+        match_node(0, path, path.empty(), static_cast<std::size_t>(method),
+                   params, path_found);
+
+    if (found != NONE) {
+      return {MatchStatus::FOUND, &factories[found],
+              static_cast<std::size_t>(found)};
+    }
+
+    params.clear();
+    return {path_found ? MatchStatus::METHOD_NOT_ALLOWED
+                       : MatchStatus::NOT_FOUND,
+            nullptr};
+  }
+
+  [[nodiscard]] std::size_t size() const { return factories.size(); }
+
+private:
+  void add_internal(std::size_t method, std::string_view pattern, F factory) {
+    if (compiled) {
+      debug::panic("cannot add route {} to a compiled router", pattern);
+    }
+
+    if (pattern.empty() || pattern.front() != '/') {
+      debug::panic("route {} does not start with '/'", pattern);
+    }
+
+    pattern.remove_prefix(1);
+
+    std::uint32_t current = 0;
+    std::size_t param_count = 0;
+    bool at_end = pattern.empty();
+    std::string_view segment;
+
+    while (next_segment(pattern, at_end, segment)) {
+      const bool is_wildcard =
+          segment == "*" || (segment.starts_with("{*") && segment.ends_with('}'));
+
+      if (is_wildcard) {
+        if (!at_end) {
+          debug::panic("wildcard has to be the last segment of a route");
+        }
+
+        const auto name =
+            segment == "*" ? segment : segment.substr(2, segment.size() - 3);
+        current = param_node(current, &Node::wildcard_child, name);
+        param_count++;
+      } else if (segment.size() > 2 && segment.front() == '{' &&
+                 segment.back() == '}') {
+        current = param_node(current, &Node::param_child,
+                             segment.substr(1, segment.size() - 2));
+        param_count++;
+      } else {
+        current = literal_node(current, segment);
+      }
+    }
+
+    if (param_count > RouteParams::CAPACITY) {
+      debug::panic("route has more than {} parameters", RouteParams::CAPACITY);
+    }
+
+    auto &node = nodes[current];
+
+    if (node.handlers[method] != NONE) {
+      debug::panic("route registered twice");
+    }
+
+    node.handlers[method] = factories.size();
+    node.has_handler = true;
+    factories.push_back(std::move(factory));
+  }
+};
+} // namespace dwhbll::network::http_server
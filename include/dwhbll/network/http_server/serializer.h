@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace dwhbll::network::http_server {
+/**
+ * @brief Length of an IMF-fixdate, `Sun, 06 Nov 1994 08:49:37 GMT`.
+ */
+constexpr std::size_t HTTP_DATE_LENGTH = 29;
+
+/**
+ * @brief Format `time` as an IMF-fixdate (RFC 9110 5.6.7).
+ */
+void format_http_date(std::time_t time, std::span<char, HTTP_DATE_LENGTH> out);
+
+/**
+ * @brief Keeps the `date` header line of the current second.
+ *
+ * Formatting a date is a few hundred nanoseconds, doing it once per second
+ * instead of once per response takes it off the hot path. Not thread safe,
+ * every executor owns one.
+ */
+class DateCache {
+  std::time_t current = -1;
+  std::array<char, 48> line;
+  std::size_t length = 0;
+
+public:
+  /**
+   * @brief The full `date: <IMF-fixdate>\r\n` line for the current second.
+   */
+  std::string_view get();
+};
+
+/**
+ * @brief Reusable buffer the response head is serialised into.
+ *
+ * `clear()` keeps the capacity, so after the first few responses building a
+ * head does not allocate anymore.
+ */
+class HeaderArena {
+  std::vector<char> buffer;
+
+public:
+  HeaderArena() { buffer.reserve(1024); }
+
+  void clear() { buffer.clear(); }
+
+  void append(std::string_view data) {
+    buffer.insert(buffer.end(), data.begin(), data.end());
+  }
+
+  void status_line(std::string_view code, std::string_view reason);
+
+  void field(std::string_view name, std::string_view value);
+
+  void content_length(std::uint64_t length);
+
+  /**
+   * @brief Close the head with the empty line.
+   */
+  void end() { append("\r\n"); }
+
+  [[nodiscard]] std::span<const std::byte> bytes() const {
+    return std::as_bytes(std::span{buffer.data(), buffer.size()});
+  }
+};
+} // namespace dwhbll::network::http_server
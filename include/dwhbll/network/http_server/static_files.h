@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <dwhbll/network/http_server.hpp>
+#include <dwhbll/network/http_server/open_file.h>
+
+namespace dwhbll::network::http_server {
+/**
+ * @brief LRU cache of open file descriptors and their stat results.
+ *
+ * An entry is trusted for `validity` after it was last checked, then the
+ * path is stat'ed again and the file reopened if it changed on disk. Shared
+ * by all executors.
+ */
+class FileCache {
+  struct Entry {
+    std::string path;
+    std::shared_ptr<const OpenFile> file;
+    std::chrono::steady_clock::time_point checked;
+  };
+
+  std::mutex lock;
+  std::list<Entry> entries;
+  /// keys point into `Entry::path`, list nodes never move
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+
+  std::size_t capacity;
+  std::chrono::steady_clock::duration validity;
+
+  void insert(const std::string &path, std::shared_ptr<const OpenFile> file,
+              std::chrono::steady_clock::time_point now);
+
+  void erase(const std::string &path);
+
+public:
+  explicit FileCache(std::size_t capacity = 1024,
+                     std::chrono::steady_clock::duration validity =
+                         std::chrono::seconds(1));
+
+  /**
+   * @brief Get the regular file at `path`, opening it if needed.
+   * @return nullptr if it does not exist or is not a regular file.
+   */
+  std::shared_ptr<const OpenFile> open(const std::string &path);
+
+  [[nodiscard]] std::size_t size();
+};
+
+/**
+ * @brief A byte range selected by a `Range` header.
+ */
+struct ByteRange {
+  std::uint64_t first;
+  std::uint64_t length;
+};
+
+enum class RangeStatus {
+  IGNORED,       ///< no usable range, send the whole file
+  SATISFIABLE,   ///< send the range
+  UNSATISFIABLE, ///< answer 416
+};
+
+/**
+ * @brief Parse a `Range` header against a file of `size` bytes.
+ * @note Only single ranges are supported, multiple ranges are ignored which
+ * RFC 9110 allows.
+ */
+RangeStatus parse_range(std::string_view header, std::uint64_t size,
+                        ByteRange &range);
+
+/**
+ * @brief Serves the files below a root directory.
+ *
+ * Bodies are sent with sendfile, conditional requests are answered with 304
+ * (`If-Modified-Since` is compared exactly against the `Last-Modified` we
+ * sent, like nginx does by default) and single `Range` requests with 206.
+ */
+class StaticFiles {
+  std::string root;
+  FileCache cache;
+
+public:
+  explicit StaticFiles(const std::filesystem::path &root,
+                       std::size_t cache_capacity = 1024);
+
+  /**
+   * @brief Answer `request` with the file at `relative` below the root.
+   *
+   * Paths ending in '/' serve their `index.html`, paths with `..` segments
+   * are refused.
+   */
+  void serve(const Request &request, Response &response,
+             std::string_view relative);
+
+  /**
+   * @brief Serve the path captured by a `{*path}` route, or the whole
+   * request path if there is none.
+   */
+  void serve(const Request &request, Response &response) {
+    serve(request, response, request.params.get("path").value_or(request.path));
+  }
+};
+
+struct StaticFileHandler {
+  StaticFiles *files;
+
+  void handle(Request &request, Response &response) {
+    files->serve(request, response);
+  }
+};
+
+/**
+ * @brief Handler factory for routes that only serve files, e.g.
+ * `server.add_route("/assets/{*path}", StaticFileFactory{files})`.
+ */
+struct StaticFileFactory {
+  std::shared_ptr<StaticFiles> files;
+
+  StaticFileHandler operator()() const { return {files.get()}; }
+};
+} // namespace dwhbll::network::http_server
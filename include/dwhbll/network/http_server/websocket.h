@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * RFC 6455 frame codec, independent of any connection.
+ *
+ * Frames sent by a server are never masked, so one encoded Frame can be written
+ * to any number of connections as-is.
+ */
+namespace dwhbll::network::http_server::websocket {
+enum class Opcode : std::uint8_t {
+  CONTINUATION = 0x0,
+  TEXT = 0x1,
+  BINARY = 0x2,
+  CLOSE = 0x8,
+  PING = 0x9,
+  PONG = 0xA,
+};
+
+/**
+ * @brief Status codes carried by close frames (RFC 6455 7.4.1).
+ */
+enum class CloseCode : std::uint16_t {
+  NORMAL = 1000,
+  GOING_AWAY = 1001,
+  PROTOCOL_ERROR = 1002,
+  UNSUPPORTED_DATA = 1003,
+  NO_STATUS = 1005,
+  INVALID_PAYLOAD = 1007,
+  POLICY_VIOLATION = 1008,
+  MESSAGE_TOO_BIG = 1009,
+  INTERNAL_ERROR = 1011,
+};
+
+/// longest frame header: 2 bytes, a 64-bit length and the masking key
+constexpr std::size_t MAX_FRAME_HEADER = 14;
+
+/// control frames carry at most this much payload (RFC 6455 5.5)
+constexpr std::size_t MAX_CONTROL_PAYLOAD = 125;
+
+[[nodiscard]] constexpr bool is_control(Opcode opcode) noexcept {
+  return static_cast<std::uint8_t>(opcode) & 0x8;
+}
+
+struct FrameHeader {
+  bool fin = true;
+  Opcode opcode = Opcode::TEXT;
+  bool masked = false;
+  std::array<std::byte, 4> mask{};
+  std::uint64_t length = 0;
+
+  enum class Status {
+    DONE,
+    INCOMPLETE, ///< `in` ends before the header does
+    MALFORMED,  ///< reserved bits or opcodes, or a control frame breaking the rules
+  };
+
+  /**
+   * @brief Decode the header at the start of `in`, `size` is set to its length.
+   */
+  Status parse(std::span<const std::byte> in, std::size_t &size) noexcept;
+
+  /**
+   * @return number of bytes written to `out`.
+   */
+  std::size_t encode(std::span<std::byte, MAX_FRAME_HEADER> out) const noexcept;
+};
+
+/**
+ * @brief XOR `data` with the masking key, `offset` is the position of
+ * `data` within the payload so a payload can be unmasked piece by piece.
+ *
+ * Works on 32 bytes at a time with AVX2, 16 with SSE2 or NEON, and falls back
+ * to 8 byte words elsewhere.
+ */
+void apply_mask(std::span<std::byte> data, std::array<std::byte, 4> mask,
+                std::size_t offset = 0) noexcept;
+
+/**
+ * @brief Byte by byte `apply_mask`, the reference the vector version is
+ * checked and measured against.
+ */
+void apply_mask_scalar(std::span<std::byte> data, std::array<std::byte, 4> mask,
+                       std::size_t offset = 0) noexcept;
+
+/**
+ * @brief The `Sec-WebSocket-Accept` value answering `key` (RFC 6455 4.2.2).
+ */
+std::string accept_key(std::string_view key);
+
+/**
+ * @brief A complete unmasked frame, encoded once and sent to any number of
+ * connections.
+ */
+class Frame {
+  std::vector<std::byte> data;
+
+public:
+  Frame() = default;
+
+  Frame(Opcode opcode, std::span<const std::byte> payload, bool fin = true);
+
+  Frame(Opcode opcode, std::string_view payload, bool fin = true)
+      : Frame(opcode, std::as_bytes(std::span{payload.data(), payload.size()}),
+              fin) {}
+
+  /**
+   * @brief A close frame with `code` and a reason, cut to fit a control frame.
+   */
+  static Frame close(CloseCode code, std::string_view reason = {});
+
+  [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+    return data;
+  }
+};
+} // namespace dwhbll::network::http_server::websocket
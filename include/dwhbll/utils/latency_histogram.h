@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dwhbll::utils {
+    /**
+     * @brief HDR style histogram of latencies (or any non negative integer).
+     *
+     * Values are kept with a fixed number of significant decimal digits over the whole range: buckets double in
+     * width every power of two, and each is split in enough linear sub-buckets to keep the precision. Recording is
+     * a couple of shifts and an increment, percentiles walk the counts.
+     *
+     * Values above the highest trackable one are recorded as that value.
+     */
+    class latency_histogram {
+        std::uint64_t highest_trackable;
+        unsigned sub_bucket_bits;
+        std::uint64_t sub_bucket_half;
+
+        std::vector<std::uint64_t> counts;
+        std::uint64_t total = 0;
+        std::uint64_t min_ = UINT64_MAX, max_ = 0;
+        /// sum of the recorded values, long double so an hour of nanoseconds does not round away the mean
+        long double sum = 0;
+
+        [[nodiscard]] std::size_t index_of(std::uint64_t value) const noexcept;
+
+        [[nodiscard]] std::uint64_t lowest_of(std::size_t index) const noexcept;
+
+    public:
+        /**
+         * @param highest_trackable largest value told apart from the others, one hour in nanoseconds by default.
+         * @param significant_digits decimal digits kept for every value, 1 to 5.
+         */
+        explicit latency_histogram(std::uint64_t highest_trackable = 3'600'000'000'000, int significant_digits = 3);
+
+        void record(std::uint64_t value, std::uint64_t count = 1) noexcept;
+
+        /**
+         * @brief Add the counts of `other`, which must have been built with the same parameters.
+         */
+        void merge(const latency_histogram &other);
+
+        void reset() noexcept;
+
+        [[nodiscard]] std::uint64_t count() const noexcept { return total; }
+
+        [[nodiscard]] std::uint64_t min() const noexcept { return total == 0 ? 0 : min_; }
+
+        [[nodiscard]] std::uint64_t max() const noexcept { return max_; }
+
+        [[nodiscard]] double mean() const noexcept;
+
+        /**
+         * @brief Smallest recorded value that `percentile` percent of the values are at or below.
+         * @param percentile between 0 and 100.
+         * @return the highest value equivalent to it at the histogram's precision, 0 if nothing was recorded.
+         */
+        [[nodiscard]] std::uint64_t value_at(double percentile) const noexcept;
+
+        /**
+         * @brief One line summary, count, mean and the usual percentiles with values divided by `scale`.
+         * @param unit appended to every value, e.g. "us" with a scale of 1000 for nanosecond samples.
+         */
+        [[nodiscard]] std::string summary(std::uint64_t scale = 1, std::string_view unit = "") const;
+    };
+}
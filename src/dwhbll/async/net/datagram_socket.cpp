@@ -0,0 +1,312 @@
+#include <dwhbll/async/net/datagram_socket.h>
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <dwhbll/concurrency/coroutine/wrappers/syscall_wrappers.h>
+#include <dwhbll/sanify/coroutines.hpp>
+#include <dwhbll/sanify/stl_ext.h>
+
+// older libc headers only have these in linux/udp.h
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace dwhbll::async::net {
+    datagram_batch::datagram_batch(std::size_t capacity, std::size_t slot_size) : slot_size_(slot_size),
+        storage(std::make_unique_for_overwrite<sanify::u8[]>(capacity * slot_size)),
+        headers(capacity), vectors(capacity), sources(capacity), controls(capacity) {
+        if (capacity == 0 || slot_size == 0)
+            debug::panic("datagram_batch needs room for at least one byte of one datagram");
+
+        for (std::size_t i = 0; i < capacity; i++)
+            vectors[i] = {storage.get() + i * slot_size, slot_size};
+
+        // every header starts out as if it had been used
+        size_ = capacity;
+        prepare();
+    }
+
+    void datagram_batch::prepare() noexcept {
+        // the kernel only writes to the headers it filled
+        for (std::size_t i = 0; i < size_; i++) {
+            auto &hdr = headers[i].msg_hdr;
+            hdr.msg_name = &sources[i];
+            hdr.msg_namelen = sizeof(sockaddr_storage);
+            hdr.msg_iov = &vectors[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = controls[i].data;
+            hdr.msg_controllen = sizeof(control_slot::data);
+            hdr.msg_flags = 0;
+            headers[i].msg_len = 0;
+        }
+
+        size_ = 0;
+    }
+
+    datagram datagram_batch::operator[](std::size_t index) const {
+        if (index >= size_)
+            debug::panic("datagram {} out of a batch of {}", index, size_);
+
+        auto &hdr = headers[index].msg_hdr;
+        datagram result{
+            {storage.get() + index * slot_size_, std::min<std::size_t>(headers[index].msg_len, slot_size_)},
+            network::conv::from_sockaddr(sources[index])
+        };
+
+        auto *msg = const_cast<msghdr *>(&hdr);
+        for (auto *cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                int segment;
+                std::memcpy(&segment, CMSG_DATA(cmsg), sizeof(segment));
+                result.segment_size = static_cast<std::uint16_t>(segment);
+            }
+        }
+
+        return result;
+    }
+
+    bool datagram_batch::truncated(std::size_t index) const {
+        if (index >= size_)
+            debug::panic("datagram {} out of a batch of {}", index, size_);
+
+        return (headers[index].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+
+    datagram_socket::datagram_socket() = default;
+
+    datagram_socket::datagram_socket(int fd) : fd(fd) {}
+
+    datagram_socket::~datagram_socket() {
+        close();
+    }
+
+    datagram_socket::datagram_socket(datagram_socket &&other) noexcept : fd(other.fd) {
+        other.fd = -1;
+    }
+
+    datagram_socket & datagram_socket::operator=(datagram_socket &&other) noexcept {
+        if (this == &other)
+            return *this;
+        close();
+        fd = other.fd;
+        other.fd = -1;
+        return *this;
+    }
+
+    bool datagram_socket::has_socket() const noexcept {
+        return fd != -1;
+    }
+
+    void datagram_socket::close() noexcept {
+        if (fd == -1)
+            return;
+
+        ::close(fd);
+        fd = -1;
+    }
+
+    void datagram_socket::shutdown() noexcept {
+        if (fd == -1)
+            return;
+
+        // fails with ENOTCONN on an unconnected socket, but wakes the waiting receives all the same
+        ::shutdown(fd, SHUT_RDWR);
+    }
+
+    Result<std::unique_ptr<datagram_socket>, int> datagram_socket::open(sa_family_t family) {
+        auto sock = ::socket(family, SOCK_DGRAM, 0);
+
+        if (sock < 0)
+            return Err(errno);
+
+        return Ok(std::make_unique<datagram_socket>(sock));
+    }
+
+    Result<std::unique_ptr<datagram_socket>, int> datagram_socket::bind(const network::address &endpoint) {
+        sockaddr_storage addr;
+        const auto addrlen = network::conv::to_sockaddr(endpoint, addr);
+
+        auto sock = open(addr.ss_family);
+
+        if (sock.is_err())
+            return sock;
+
+        if (::bind(sock.unwrap_unchecked()->fd, reinterpret_cast<sockaddr *>(&addr), addrlen) < 0)
+            return Err(errno);
+
+        return sock;
+    }
+
+    Result<std::unique_ptr<datagram_socket>, int> datagram_socket::connect(const network::address &endpoint) {
+        sockaddr_storage addr;
+        const auto addrlen = network::conv::to_sockaddr(endpoint, addr);
+
+        auto sock = open(addr.ss_family);
+
+        if (sock.is_err())
+            return sock;
+
+        // nothing goes over the wire, this only fixes the peer
+        if (::connect(sock.unwrap_unchecked()->fd, reinterpret_cast<sockaddr *>(&addr), addrlen) < 0)
+            return Err(errno);
+
+        return sock;
+    }
+
+    Result<network::address, int> datagram_socket::local_address() const {
+        sockaddr_storage addr{};
+        socklen_t addrlen = sizeof(addr);
+
+        if (getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &addrlen) < 0)
+            return Err(errno);
+
+        return Ok(network::conv::from_sockaddr(addr));
+    }
+
+    Result<UNIT, int> datagram_socket::set_gro(bool state) noexcept {
+        int val = state;
+
+        if (setsockopt(fd, SOL_UDP, UDP_GRO, &val, sizeof(val)) < 0)
+            return Err(errno);
+
+        return Ok();
+    }
+
+    Result<UNIT, int> datagram_socket::set_gso(std::uint16_t segment_size) noexcept {
+        int val = segment_size;
+
+        if (setsockopt(fd, SOL_UDP, UDP_SEGMENT, &val, sizeof(val)) < 0)
+            return Err(errno);
+
+        return Ok();
+    }
+
+    Result<UNIT, int> datagram_socket::set_buffer_sizes(int receive, int send) noexcept {
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive, sizeof(receive)) < 0)
+            return Err(errno);
+
+        if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &send, sizeof(send)) < 0)
+            return Err(errno);
+
+        return Ok();
+    }
+
+    task<Result<std::size_t, int>> datagram_socket::receive(datagram_batch &batch) {
+        if (!has_socket())
+            debug::panic();
+
+        while (true) {
+            batch.prepare();
+
+            const auto count = ::recvmmsg(fd, batch.headers.data(), batch.headers.size(), MSG_DONTWAIT, nullptr);
+
+            if (count >= 0) {
+                batch.size_ = count;
+                co_return Ok(static_cast<std::size_t>(count));
+            }
+
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                co_return Err(errno);
+
+            co_await calls::poll(fd, POLLIN);
+        }
+    }
+
+    task<Result<UNIT, int>> datagram_socket::send(std::span<const outgoing_datagram> datagrams) {
+        if (!has_socket())
+            debug::panic();
+
+        while (!datagrams.empty()) {
+            // the kernel takes at most UIO_MAXIOV messages per call
+            const auto count = std::min<std::size_t>(datagrams.size(), 1024);
+
+            if (send_headers.size() < count) {
+                send_headers.resize(count);
+                send_vectors.resize(count);
+                send_targets.resize(count);
+            }
+
+            // filled right before every call, another coroutine may have used the scratch space while we waited
+            for (std::size_t i = 0; i < count; i++) {
+                const auto &dgram = datagrams[i];
+                auto &hdr = send_headers[i].msg_hdr;
+
+                send_vectors[i] = {const_cast<sanify::u8 *>(dgram.data.data()), dgram.data.size()};
+
+                hdr = {};
+                hdr.msg_iov = &send_vectors[i];
+                hdr.msg_iovlen = 1;
+
+                if (dgram.destination != nullptr) {
+                    hdr.msg_name = &send_targets[i];
+                    hdr.msg_namelen = network::conv::to_sockaddr(*dgram.destination, send_targets[i]);
+                }
+            }
+
+            const auto sent = ::sendmmsg(fd, send_headers.data(), count, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+            if (sent < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    co_return Err(errno);
+
+                co_await calls::poll(fd, POLLOUT);
+                continue;
+            }
+
+            datagrams = datagrams.subspan(sent);
+        }
+
+        co_return Ok();
+    }
+
+    task<Result<std::size_t, int>> datagram_socket::receive_from(std::span<sanify::u8> buffer, network::address &source) {
+        if (!has_socket())
+            debug::panic();
+
+        sockaddr_storage addr{};
+        iovec vec{buffer.data(), buffer.size()};
+        msghdr msg{};
+        msg.msg_name = &addr;
+        msg.msg_namelen = sizeof(addr);
+        msg.msg_iov = &vec;
+        msg.msg_iovlen = 1;
+
+        // MSG_TRUNC has the real length of a datagram returned even if it did not fit
+        auto r = co_await calls::recvmsg(fd, &msg, MSG_TRUNC);
+
+        if (r.is_err())
+            co_return Err(r.unwrap_err_unchecked());
+
+        source = network::conv::from_sockaddr(addr);
+        co_return Ok(static_cast<std::size_t>(r.unwrap_unchecked()));
+    }
+
+    task<Result<UNIT, int>> datagram_socket::send_to(std::span<const sanify::u8> data, const network::address *destination) {
+        if (!has_socket())
+            debug::panic();
+
+        sockaddr_storage addr{};
+        iovec vec{const_cast<sanify::u8 *>(data.data()), data.size()};
+        msghdr msg{};
+        msg.msg_iov = &vec;
+        msg.msg_iovlen = 1;
+
+        if (destination != nullptr) {
+            msg.msg_name = &addr;
+            msg.msg_namelen = network::conv::to_sockaddr(*destination, addr);
+        }
+
+        co_return (co_await calls::sendmsg(fd, &msg, MSG_NOSIGNAL)).map(TO_UNIT);
+    }
+}
@@ -0,0 +1,657 @@
+#include <dwhbll/async/net/dns_resolver.h>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <sstream>
+
+#include <dwhbll/async/net/datagram_socket.h>
+#include <dwhbll/async/net/socket.h>
+#include <dwhbll/concurrency/coroutine/async_semaphore.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/sleep_task.h>
+#include <dwhbll/exceptions/rt_exception_base.h>
+#include <dwhbll/network/dns/wire.h>
+#include <dwhbll/sanify/coroutines.hpp>
+#include <dwhbll/sanify/stl_ext.h>
+
+namespace dwhbll::async::net {
+    namespace {
+        using clock_type = std::chrono::steady_clock;
+
+        /// a query is one question and the OPT record, this is plenty
+        constexpr std::size_t MAX_QUERY_MESSAGE = 512;
+
+        /// longest CNAME chain followed within one answer
+        constexpr int MAX_CNAME_HOPS = 8;
+
+        std::string lower(std::string name) {
+            std::ranges::transform(name, name.begin(), [](unsigned char c) { return std::tolower(c); });
+            return name;
+        }
+
+        /**
+         * @brief RFC 1123 host name, anything else is not looked up.
+         */
+        bool valid_host_name(const std::string &name) {
+            if (name.empty() || name.size() > 253)
+                return false;
+
+            std::size_t label = 0;
+            for (std::size_t i = 0; i <= name.size(); i++) {
+                if (i == name.size() || name[i] == '.') {
+                    if (label == 0 || label > 63 || name[i - 1] == '-' || name[i - label] == '-')
+                        return false;
+                    label = 0;
+                    continue;
+                }
+
+                if (!std::isalnum(static_cast<unsigned char>(name[i])) && name[i] != '-')
+                    return false;
+                label++;
+            }
+
+            return true;
+        }
+
+        std::optional<network::address> parse_literal(const std::string &text, std::uint16_t port) {
+            std::array<std::uint8_t, 16> bytes;
+
+            if (inet_pton(AF_INET, text.c_str(), bytes.data()) == 1)
+                return network::address(std::array<std::uint8_t, 4>{bytes[0], bytes[1], bytes[2], bytes[3]}, port);
+
+            // brackets are how an IPv6 address is written next to a port
+            auto bare = text;
+            if (bare.size() > 2 && bare.front() == '[' && bare.back() == ']')
+                bare = bare.substr(1, bare.size() - 2);
+
+            if (inet_pton(AF_INET6, bare.c_str(), bytes.data()) == 1) {
+                std::array<std::uint16_t, 8> groups;
+                for (std::size_t i = 0; i < groups.size(); i++)
+                    groups[i] = bytes[i * 2] << 8 | bytes[i * 2 + 1];
+                return network::address(groups, port);
+            }
+
+            return std::nullopt;
+        }
+
+        std::vector<network::address> system_nameservers() {
+            std::vector<network::address> servers;
+            std::ifstream conf("/etc/resolv.conf");
+            std::string line;
+
+            while (std::getline(conf, line)) {
+                std::istringstream fields(line);
+                std::string keyword, server;
+
+                if (fields >> keyword >> server && keyword == "nameserver") {
+                    // a scope id like fe80::1%eth0 cannot be connected to without the interface, skip those
+                    if (auto addr = parse_literal(server, 53))
+                        servers.push_back(std::move(*addr));
+                }
+            }
+
+            // what the libc resolver does without a configuration as well
+            if (servers.empty())
+                servers.emplace_back(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 53);
+
+            return servers;
+        }
+
+        std::vector<network::address> with_port(std::vector<network::address> addresses, std::uint16_t port) {
+            for (auto &addr : addresses)
+                addr.port = port;
+            return addresses;
+        }
+
+        /**
+         * @brief State of one round of questions, shared with the coroutines listening for the answers.
+         */
+        struct exchange {
+            std::uint16_t id = 0;
+            std::string name;
+            network::dns::QTYPE type;
+            std::vector<sanify::u8> query;
+            bool edns = false;
+            /// largest answer that was asked for
+            std::size_t answer_size = network::dns::MAX_PLAIN_UDP_PAYLOAD_SIZE;
+
+            /// one connected socket per nameserver, the kernel drops datagrams from anywhere else
+            std::vector<std::unique_ptr<datagram_socket>> sockets;
+            /// the index of the nameserver of each socket
+            std::vector<std::size_t> servers;
+            std::size_t answered_by = 0;
+            /// released once per listener that finished
+            async_semaphore events{0};
+            std::optional<reactor::reactor_job> timer;
+            /// a well formed answer to the question
+            std::optional<std::vector<sanify::u8>> answer;
+            std::size_t running = 0;
+            int last_error = ETIMEDOUT;
+        };
+
+        /**
+         * @brief Build the query for `name` into `out`.
+         * @return the size of the query.
+         */
+        std::size_t build_query(std::span<sanify::u8> out, std::uint16_t id, const std::string &name, network::dns::QTYPE type,
+                                std::uint16_t udp_payload_size) {
+            using namespace network::dns;
+
+            MessageBuilder builder(out, {id, false, OPCODE::QUERY, false, false, true, false, 0, RCODE::NONE, 0, 0, 0, 0});
+
+            // checked by resolve, a valid host name always fits
+            if (!builder.add_question(name, type))
+                return 0;
+
+            if (udp_payload_size != 0 && !builder.add_edns({std::max(udp_payload_size, MAX_PLAIN_UDP_PAYLOAD_SIZE)}))
+                return 0;
+
+            return builder.build().size();
+        }
+
+        /**
+         * @brief Whether `data` is the answer to question `id`, and not a server failure.
+         * @param edns whether the question had an OPT record.
+         * @param error set to EAGAIN for a server failure, EPROTO if the server does not understand EDNS.
+         */
+        bool is_answer(std::uint16_t id, const std::string &name, network::dns::QTYPE type, bool edns,
+                       std::span<const sanify::u8> data, int &error) {
+            try {
+                const network::dns::MessageView msg(data);
+                const auto &header = msg.header();
+
+                // anything else is late, a duplicate or spoofed
+                if (!header.qr || header.id != id || msg.questions().size() != 1)
+                    return false;
+
+                const auto &question = *msg.questions().begin();
+                if (question.type != type || question.clazz != network::dns::QCLASS::IN || !question.qname.equals(name))
+                    return false;
+
+                // servers without EDNS answer FORMERR without an OPT record, RFC 6891 section 7
+                if (edns && header.rcode == network::dns::RCODE::FMTERR && !msg.edns()) {
+                    error = EPROTO;
+                    return false;
+                }
+
+                // the other servers may well know better
+                if (header.rcode != network::dns::RCODE::NONE && header.rcode != network::dns::RCODE::NAMEERR) {
+                    error = EAGAIN;
+                    return false;
+                }
+
+                return true;
+            } catch (const exceptions::rt_exception_base &) {
+                return false;
+            }
+        }
+
+        task<> listen_for_answer(std::shared_ptr<exchange> state, std::size_t index) {
+            auto &sock = *state->sockets[index];
+            std::vector<sanify::u8> buffer(state->answer_size);
+
+            auto sent = co_await sock.send_to(state->query);
+
+            if (sent.is_err())
+                state->last_error = sent.unwrap_err_unchecked();
+
+            while (sent.is_ok() && !state->answer) {
+                network::address source;
+                auto received = co_await sock.receive_from(buffer, source);
+
+                // an ICMP unreachable surfaces here as ECONNREFUSED, zero means the round is over
+                if (received.is_err()) {
+                    state->last_error = received.unwrap_err_unchecked();
+                    break;
+                }
+
+                if (received.unwrap_unchecked() == 0)
+                    break;
+
+                const auto length = std::min(received.unwrap_unchecked(), buffer.size());
+                const std::span data(buffer.data(), length);
+                int error = 0;
+
+                if (is_answer(state->id, state->name, state->type, state->edns, data, error)) {
+                    if (!state->answer) {
+                        state->answer.emplace(data.begin(), data.end());
+                        state->answered_by = state->servers[index];
+                    }
+                    break;
+                }
+
+                if (error != 0) {
+                    state->last_error = error;
+                    break;
+                }
+            }
+
+            state->running--;
+            state->events.release();
+        }
+
+        task<> expire(std::shared_ptr<exchange> state, clock_type::time_point due) {
+            co_await sleep_task{due};
+
+            // a cancelled timer never gets here, the listeners see the shutdown as an empty receive
+            state->timer.reset();
+            for (auto &sock : state->sockets)
+                sock->shutdown();
+        }
+
+        /**
+         * @brief Send a query with its length prefix over a stream and read the message that comes back, RFC 1035
+         * section 4.2.2.
+         */
+        task<Result<std::vector<sanify::u8>, int>> exchange_framed(socket &sock, std::span<const sanify::u8> framed) {
+            auto sent = co_await sock.write(framed);
+            if (sent.is_err())
+                co_return Err(sent.unwrap_err_unchecked());
+
+            std::array<sanify::u8, 2> length{};
+            auto received = co_await sock.read(length);
+
+            std::vector<sanify::u8> message(length[0] << 8 | length[1]);
+            if (received.is_ok())
+                received = co_await sock.read(message);
+
+            // the peer closing the connection is -1
+            if (received.is_err())
+                co_return Err(received.unwrap_err_unchecked() < 0 ? ECONNRESET : received.unwrap_err_unchecked());
+
+            co_return Ok(std::move(message));
+        }
+
+        /**
+         * @brief Addresses of `type` for the question of `msg`, following CNAMEs.
+         * @param ttl set to the smallest TTL of the records used.
+         */
+        std::vector<network::address> extract(const network::dns::MessageView &msg, network::dns::QTYPE type, std::int64_t &ttl) {
+            using namespace network::dns;
+
+            std::array<NameView, MAX_CNAME_HOPS + 1> chain{msg.questions().begin()->qname};
+            std::size_t chain_length = 1;
+
+            while (chain_length < chain.size()) {
+                auto cname = std::ranges::find_if(msg.answers(), [&](const RecordView &rr) {
+                    return rr.type == QTYPE::CNAME && rr.name == chain[chain_length - 1];
+                });
+
+                if (cname == msg.answers().end())
+                    break;
+
+                const auto alias = *cname->target();
+                if (std::ranges::find(chain.begin(), chain.begin() + chain_length, alias) != chain.begin() + chain_length)
+                    break;
+
+                ttl = std::min<std::int64_t>(ttl, cname->ttl);
+                chain[chain_length++] = alias;
+            }
+
+            std::vector<network::address> addresses;
+            for (const auto &rr : msg.answers()) {
+                if (rr.type != type || std::ranges::find(chain.begin(), chain.begin() + chain_length, rr.name) == chain.begin() + chain_length)
+                    continue;
+
+                if (auto a = rr.a()) {
+                    addresses.emplace_back(*a, 0);
+                } else if (auto aaaa = rr.aaaa()) {
+                    std::array<std::uint16_t, 8> groups;
+                    for (std::size_t i = 0; i < groups.size(); i++)
+                        groups[i] = (*aaaa)[i * 2] << 8 | (*aaaa)[i * 2 + 1];
+                    addresses.emplace_back(groups, 0);
+                } else {
+                    continue;
+                }
+
+                ttl = std::min<std::int64_t>(ttl, rr.ttl);
+            }
+
+            return addresses;
+        }
+
+        /**
+         * @brief How long a negative answer may be cached, RFC 2308 section 5.
+         */
+        std::optional<std::int64_t> negative_ttl(const network::dns::MessageView &msg) {
+            for (const auto &rr : msg.authorities()) {
+                if (auto soa = rr.soa())
+                    return std::min<std::int64_t>(rr.ttl, soa->minimum);
+            }
+
+            return std::nullopt;
+        }
+    }
+
+    struct dns_resolver::flight {
+        /// released once the query is done, every waiter passes the permit on
+        async_semaphore done{0};
+        std::optional<Result<std::vector<network::address>, int>> result;
+    };
+
+    struct dns_resolver::stream {
+        std::unique_ptr<socket> sock;
+        /// one question at a time, answers would have to be matched out of order otherwise
+        async_semaphore lock{1};
+    };
+
+    dns_resolver::dns_resolver() : dns_resolver(options{}) {}
+
+    dns_resolver::dns_resolver(options opts) : opts(std::move(opts)), ids(std::random_device{}()) {
+        if (this->opts.nameservers.empty())
+            this->opts.nameservers = system_nameservers();
+
+        if (this->opts.attempts < 1)
+            debug::panic("dns_resolver needs at least one attempt per query");
+
+        if (this->opts.use_hosts_file)
+            load_hosts(this->opts.hosts_file.empty() ? "/etc/hosts" : this->opts.hosts_file);
+
+        for (std::size_t i = 0; i < this->opts.nameservers.size(); i++)
+            streams.push_back(std::make_shared<stream>());
+    }
+
+    dns_resolver & dns_resolver::local() {
+        thread_local dns_resolver resolver;
+        return resolver;
+    }
+
+    void dns_resolver::load_hosts(const std::string &path) {
+        std::ifstream file(path);
+        std::string line;
+
+        while (std::getline(file, line)) {
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream fields(line);
+            std::string ip, name;
+
+            if (!(fields >> ip))
+                continue;
+
+            auto addr = parse_literal(ip, 0);
+            if (!addr)
+                continue;
+
+            while (fields >> name)
+                hosts[lower(name)].push_back(*addr);
+        }
+
+        for (auto &[name, addresses] : hosts)
+            std::ranges::stable_partition(addresses, [](const auto &addr) { return addr.type == network::address::IPV6; });
+    }
+
+    task<Result<std::vector<network::address>, int>> dns_resolver::resolve(std::string host, std::uint16_t port) {
+        if (auto literal = parse_literal(host, port))
+            co_return Ok(std::vector{std::move(*literal)});
+
+        auto name = lower(std::move(host));
+        if (name.ends_with('.'))
+            name.pop_back();
+
+        if (auto it = hosts.find(name); it != hosts.end())
+            co_return Ok(with_port(it->second, port));
+
+        if (!valid_host_name(name))
+            co_return Err(EHOSTUNREACH);
+
+        // both families at once, a slow AAAA answer should not be waited for twice
+        auto v6 = std::make_shared<flight>();
+        reactor::get_thread_reactor()->spawn(lookup_into(name, network::dns::QTYPE::AAAA, v6));
+
+        auto v4 = co_await lookup(name, network::dns::QTYPE::A);
+        co_await v6->done.acquire();
+
+        auto &v6_result = *v6->result;
+
+        if (v4.is_err() && v6_result.is_err())
+            co_return Err(v4.unwrap_err_unchecked());
+
+        std::vector<network::address> addresses;
+
+        if (v6_result.is_ok())
+            addresses = with_port(v6_result.unwrap_unchecked(), port);
+
+        if (v4.is_ok()) {
+            for (auto &addr : v4.unwrap_unchecked()) {
+                addresses.push_back(addr);
+                addresses.back().port = port;
+            }
+        }
+
+        if (addresses.empty())
+            co_return Err(EHOSTUNREACH);
+
+        co_return Ok(std::move(addresses));
+    }
+
+    void dns_resolver::forget(const std::string &host) {
+        auto name = lower(host);
+        if (name.ends_with('.'))
+            name.pop_back();
+
+        for (auto type : {network::dns::QTYPE::A, network::dns::QTYPE::AAAA})
+            cache.erase(std::format("{}/{}", name, static_cast<int>(type)));
+    }
+
+    task<Result<std::vector<network::address>, int>> dns_resolver::lookup(std::string name, network::dns::QTYPE type) {
+        const auto key = std::format("{}/{}", name, static_cast<int>(type));
+
+        if (auto it = cache.find(key); it != cache.end()) {
+            if (it->second.expires > clock_type::now()) {
+                stats.cache_hits++;
+                co_return Ok(it->second.addresses);
+            }
+
+            cache.erase(it);
+        }
+
+        if (auto it = inflight.find(key); it != inflight.end()) {
+            auto shared = it->second;
+            stats.coalesced++;
+
+            co_await shared->done.acquire();
+            shared->done.release();
+
+            co_return *shared->result;
+        }
+
+        auto shared = std::make_shared<flight>();
+        inflight.emplace(key, shared);
+
+        auto result = co_await query(name, type);
+
+        inflight.erase(key);
+        shared->result = result;
+        shared->done.release();
+
+        co_return result;
+    }
+
+    task<> dns_resolver::lookup_into(std::string name, network::dns::QTYPE type, std::shared_ptr<flight> into) {
+        into->result = co_await lookup(std::move(name), type);
+        into->done.release();
+    }
+
+    task<Result<std::vector<network::address>, int>> dns_resolver::query(std::string name, network::dns::QTYPE type) {
+        int error = ETIMEDOUT;
+        bool edns = opts.udp_payload_size != 0;
+
+        for (int attempt = 0; attempt < opts.attempts; attempt++) {
+            auto answer = co_await ask(name, type, edns);
+
+            if (answer.is_err()) {
+                error = answer.unwrap_err_unchecked();
+
+                // asked again the way every server understands
+                if (error == EPROTO)
+                    edns = false;
+                continue;
+            }
+
+            auto &[message, server] = answer.unwrap_unchecked();
+            bool truncated = network::dns::MessageView(message).header().tc;
+
+            if (truncated) {
+                stats.truncated++;
+
+                // the truncated answer is still better than none
+                if (auto full = co_await ask_stream(name, type, server, edns); full.is_ok()) {
+                    message = std::move(full.unwrap_unchecked());
+                    truncated = false;
+                }
+            }
+
+            // checked by the listener already
+            const network::dns::MessageView msg(message);
+            std::int64_t ttl = std::chrono::seconds(opts.max_ttl).count();
+            std::vector<network::address> addresses;
+
+            if (msg.header().rcode == network::dns::RCODE::NONE)
+                addresses = extract(msg, type, ttl);
+
+            // NXDOMAIN, or the name exists without records of this type
+            if (addresses.empty())
+                ttl = std::min<std::int64_t>(ttl, negative_ttl(msg).value_or(std::chrono::seconds(opts.negative_ttl).count()));
+
+            // part of the records is missing, the next lookup soon should get them over TCP
+            if (truncated)
+                ttl = std::min<std::int64_t>(ttl, std::chrono::seconds(opts.negative_ttl).count());
+
+            ttl = std::max<std::int64_t>(ttl, 0);
+            cache.insert_or_assign(std::format("{}/{}", name, static_cast<int>(type)),
+                                   cache_entry{addresses, clock_type::now() + std::chrono::seconds(ttl)});
+
+            co_return Ok(std::move(addresses));
+        }
+
+        co_return Err(error);
+    }
+
+    task<Result<dns_resolver::reply, int>> dns_resolver::ask(const std::string &name, network::dns::QTYPE type, bool edns) {
+        auto state = std::make_shared<exchange>();
+        state->id = std::uniform_int_distribution<std::uint16_t>()(ids);
+        state->name = name;
+        state->type = type;
+        state->edns = edns;
+
+        if (edns)
+            state->answer_size = std::max(opts.udp_payload_size, network::dns::MAX_PLAIN_UDP_PAYLOAD_SIZE);
+
+        state->query.resize(MAX_QUERY_MESSAGE);
+        state->query.resize(build_query(state->query, state->id, name, type, edns ? opts.udp_payload_size : 0));
+
+        if (state->query.empty())
+            co_return Err(EINVAL);
+
+        for (std::size_t i = 0; i < opts.nameservers.size(); i++) {
+            auto sock = datagram_socket::connect(opts.nameservers[i]);
+
+            if (sock.is_err()) {
+                state->last_error = sock.unwrap_err_unchecked();
+                continue;
+            }
+
+            state->sockets.push_back(std::move(sock.unwrap_unchecked()));
+            state->servers.push_back(i);
+        }
+
+        if (state->sockets.empty())
+            co_return Err(state->last_error);
+
+        auto *r = reactor::get_thread_reactor();
+        state->running = state->sockets.size();
+        stats.queries_sent += state->sockets.size();
+
+        for (std::size_t i = 0; i < state->sockets.size(); i++)
+            r->spawn(listen_for_answer(state, i));
+
+        state->timer = r->spawn(expire(state, clock_type::now() + opts.timeout));
+
+        while (state->running > 0 && !state->answer)
+            co_await state->events.acquire();
+
+        if (state->timer) {
+            state->timer->cancel();
+            state->timer.reset();
+        }
+
+        // wakes the listeners still waiting, they own the sockets from here on
+        for (auto &sock : state->sockets)
+            sock->shutdown();
+
+        if (!state->answer)
+            co_return Err(state->last_error);
+
+        co_return Ok(reply{std::move(*state->answer), state->answered_by});
+    }
+
+    task<Result<std::vector<sanify::u8>, int>> dns_resolver::ask_stream(const std::string &name, network::dns::QTYPE type, std::size_t server, bool edns) {
+        auto conn = streams[server];
+        co_await conn->lock.acquire();
+
+        const auto id = std::uniform_int_distribution<std::uint16_t>()(ids);
+
+        // the query goes after its length, the payload size of the OPT record means nothing over TCP
+        std::vector<sanify::u8> framed(2 + MAX_QUERY_MESSAGE);
+        const auto size = build_query(std::span(framed).subspan(2), id, name, type, edns ? opts.udp_payload_size : 0);
+        framed[0] = size >> 8;
+        framed[1] = size & 0xFF;
+        framed.resize(2 + size);
+
+        Result<std::vector<sanify::u8>, int> result = Err(ECONNRESET);
+
+        // a kept connection may have been closed by the server since, a new one gets a second try
+        for (int attempt = 0; attempt < 2; attempt++) {
+            const bool reused = conn->sock != nullptr;
+
+            if (!reused) {
+                auto sock = co_await socket::connect_tcp(true, opts.nameservers[server]);
+
+                if (sock.is_err()) {
+                    result = Err(sock.unwrap_err_unchecked());
+                    break;
+                }
+
+                conn->sock = std::move(sock.unwrap_unchecked());
+                stats.streams_opened++;
+            }
+
+            // the whole exchange, a server trickling the answer in cannot stretch it either
+            conn->sock->set_deadline(clock_type::now() + opts.timeout);
+            auto answer = co_await exchange_framed(*conn->sock, framed);
+            conn->sock->set_deadline(clock_type::time_point::max());
+
+            const bool timed_out = answer.is_err() && answer.unwrap_err_unchecked() == ETIMEDOUT;
+
+            int error = 0;
+            if (answer.is_ok() && is_answer(id, name, type, edns, answer.unwrap_unchecked(), error)) {
+                stats.stream_queries++;
+                result = std::move(answer);
+                break;
+            }
+
+            // whatever is left on the connection belongs to another question
+            conn->sock.reset();
+
+            if (answer.is_err())
+                result = Err(answer.unwrap_err_unchecked());
+            else
+                result = Err(error != 0 ? error : EPROTO);
+
+            if (!reused || timed_out)
+                break;
+        }
+
+        conn->lock.release();
+        co_return result;
+    }
+}
@@ -0,0 +1,281 @@
+#include <dwhbll/async/net/http_client.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/network/http/serialize.h>
+#include <dwhbll/sanify/coroutines.hpp>
+#include <dwhbll/sanify/stl_ext.h>
+
+namespace dwhbll::async::net {
+    /**
+     * @brief Whether sending the request twice does no more than sending it once (RFC 9110 9.2.2), so it can be
+     * resent when it is unknown whether the server got it.
+     */
+    static bool is_idempotent(network::http::HTTP_METHOD method) {
+        switch (method) {
+            case network::http::HTTP_METHOD::GET:
+            case network::http::HTTP_METHOD::HEAD:
+            case network::http::HTTP_METHOD::PUT:
+            case network::http::HTTP_METHOD::DELETE:
+            case network::http::HTTP_METHOD::OPTIONS:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    http_client::host_pool::host_pool(const network::address &endpoint, std::size_t max_connections)
+        : endpoint(endpoint), host_header(network::http::host_field(endpoint)), slots(static_cast<std::int32_t>(max_connections)) {
+    }
+
+    http_client::http_client(http_client_options options) : options_(options) {
+        if (options_.max_connections_per_host == 0 || options_.max_pipeline_depth == 0)
+            debug::panic("http_client needs at least one connection per host and a pipeline depth of one");
+    }
+
+    http_client::host_pool & http_client::pool_for(const network::address &endpoint) {
+        // the port is only left out for 80, so the field is unique per endpoint
+        auto key = network::http::host_field(endpoint);
+
+        auto it = hosts.find(key);
+        if (it == hosts.end())
+            it = hosts.emplace(std::move(key), std::make_unique<host_pool>(endpoint, options_.max_connections_per_host)).first;
+
+        return *it->second;
+    }
+
+    task<Result<std::unique_ptr<http_client::connection>, int>> http_client::checkout(host_pool &pool) {
+        co_await pool.slots.acquire();
+
+        const auto now = std::chrono::steady_clock::now();
+
+        while (!pool.idle.empty()) {
+            auto conn = std::move(pool.idle.back());
+            pool.idle.pop_back();
+
+            if (now - conn->last_used < options_.idle_timeout && conn->sock->has_socket()) {
+                conn->reused = true;
+                stats_.connections_reused++;
+                co_return Ok(std::move(conn));
+            }
+        }
+
+        auto sock = co_await socket::connect_tcp(false, pool.endpoint);
+
+        if (sock.is_err()) {
+            pool.slots.release();
+            co_return Err(sock.unwrap_err_unchecked());
+        }
+
+        auto conn = std::make_unique<connection>();
+        conn->sock = std::move(sock.unwrap_unchecked());
+        conn->sock->set_nodelay(true);
+        conn->inbound.resize(16 * 1024);
+        stats_.connections_opened++;
+
+        co_return Ok(std::move(conn));
+    }
+
+    void http_client::checkin(host_pool &pool, std::unique_ptr<connection> conn, bool reusable) {
+        if (reusable && conn->sock->has_socket()) {
+            conn->last_used = std::chrono::steady_clock::now();
+            pool.idle.push_back(std::move(conn));
+        }
+
+        pool.slots.release();
+    }
+
+    task<Result<UNIT, int>> http_client::read_response(connection &conn, bool head_request) {
+        conn.parser.reset(head_request, true, options_.max_response_size);
+
+        bool received = false;
+
+        while (true) {
+            if (conn.inbound_size != 0) {
+                received = true;
+
+                auto consumed = conn.parser.feed({conn.inbound.data() + conn.inbound_head, conn.inbound_size});
+                conn.inbound_head += consumed;
+                conn.inbound_size -= consumed;
+
+                if (conn.parser.done())
+                    co_return Ok();
+
+                if (conn.parser.failed())
+                    co_return Err(EPROTO);
+            }
+
+            // keep the unparsed head at the front, grow only if a single head does not fit
+            if (conn.inbound_head != 0) {
+                std::memmove(conn.inbound.data(), conn.inbound.data() + conn.inbound_head, conn.inbound_size);
+                conn.inbound_head = 0;
+            }
+
+            if (conn.inbound_size == conn.inbound.size())
+                conn.inbound.resize(conn.inbound.size() * 2);
+
+            auto r = co_await conn.sock->read_some({conn.inbound.data() + conn.inbound_size, conn.inbound.size() - conn.inbound_size});
+
+            if (r.is_err())
+                co_return Err(received ? r.unwrap_err_unchecked() : -1);
+
+            auto count = r.unwrap_unchecked();
+
+            if (count == 0) {
+                conn.parser.on_close();
+
+                if (conn.parser.done())
+                    co_return Ok();
+
+                co_return Err(received ? ECONNRESET : -1);
+            }
+
+            conn.inbound_size += count;
+        }
+    }
+
+    task<Result<UNIT, int>> http_client::exchange(host_pool &pool, std::span<const network::http_request> requests, std::vector<network::http_response> &responses) {
+        auto checked = co_await checkout(pool);
+
+        if (checked.is_err())
+            co_return Err(checked.unwrap_err_unchecked());
+
+        auto conn = std::move(checked.unwrap_unchecked());
+        const bool reused = conn->reused;
+        const auto first = responses.size();
+
+        conn->outbound.clear();
+        for (const auto &request : requests)
+            network::http::serialize_request(request, pool.host_header, conn->outbound);
+
+        // the whole batch goes out in one write, that is the point of pipelining
+        auto written = co_await conn->sock->write({reinterpret_cast<const std::uint8_t *>(conn->outbound.data()), conn->outbound.size()});
+
+        bool reusable = written.is_ok();
+        int error = written.is_ok() ? 0 : -1;
+
+        if (written.is_ok()) {
+            for (const auto &request : requests) {
+                auto read = co_await read_response(*conn, request.method == network::http::HTTP_METHOD::HEAD);
+
+                if (read.is_err()) {
+                    reusable = false;
+                    error = read.unwrap_err_unchecked();
+                    break;
+                }
+
+                responses.push_back(std::move(conn->parser.response()));
+                stats_.requests++;
+
+                if (!conn->parser.keep_alive()) {
+                    reusable = false;
+                    break;
+                }
+            }
+        }
+
+        checkin(pool, std::move(conn), reusable);
+
+        // stopping early without an error means the server closed after a response, it does not process the
+        // requests written after that one (RFC 9112 9.6)
+        if (error == 0)
+            co_return Ok();
+
+        const bool answered_some = responses.size() != first;
+
+        if (error == -1 && reused && !answered_some) {
+            // the peer closed it while idle, its siblings are probably gone too
+            pool.idle.clear();
+        }
+
+        if (error == -1 && (reused || answered_some))
+            co_return Err(-1);
+
+        co_return Err(error == -1 ? ECONNRESET : error);
+    }
+
+    task<Result<network::http_response, int>> http_client::request(network::address endpoint, network::http_request request) {
+        auto &pool = pool_for(endpoint);
+        std::vector<network::http_response> responses;
+
+        for (bool retried = false;; retried = true) {
+            auto r = co_await exchange(pool, std::span{&request, 1}, responses);
+
+            if (r.is_ok())
+                co_return Ok(std::move(responses.front()));
+
+            const int error = r.unwrap_err_unchecked();
+
+            if (error == -1 && !retried && is_idempotent(request.method)) {
+                stats_.retries++;
+                continue;
+            }
+
+            co_return Err(error == -1 ? ECONNRESET : error);
+        }
+    }
+
+    task<Result<std::vector<network::http_response>, int>> http_client::pipeline(network::address endpoint, std::vector<network::http_request> requests) {
+        auto &pool = pool_for(endpoint);
+        std::vector<network::http_response> responses;
+        responses.reserve(requests.size());
+
+        // once per call, a server that keeps dropping the connection gets its error reported
+        bool retried = false;
+
+        while (responses.size() < requests.size()) {
+            const auto start = responses.size();
+            const auto batch = std::span<const network::http_request>{requests}.subspan(start, std::min(options_.max_pipeline_depth, requests.size() - start));
+
+            auto r = co_await exchange(pool, batch, responses);
+
+            if (r.is_ok())
+                continue;
+
+            const int error = r.unwrap_err_unchecked();
+
+            // what is left of the batch was written already and the server may have acted on it
+            const auto unanswered = batch.subspan(responses.size() - start);
+            const bool idempotent = std::ranges::all_of(unanswered, [](const auto &request) { return is_idempotent(request.method); });
+
+            if (error == -1 && !retried && idempotent) {
+                retried = true;
+                stats_.retries++;
+                continue;
+            }
+
+            co_return Err(error == -1 ? ECONNRESET : error);
+        }
+
+        co_return Ok(std::move(responses));
+    }
+
+    std::size_t http_client::evict_idle() {
+        const auto now = std::chrono::steady_clock::now();
+        std::size_t evicted = 0;
+
+        for (auto &[_, pool] : hosts) {
+            evicted += std::erase_if(pool->idle, [&](const auto &conn) {
+                return now - conn->last_used >= options_.idle_timeout || !conn->sock->has_socket();
+            });
+        }
+
+        return evicted;
+    }
+
+    std::size_t http_client::idle_connections() const {
+        std::size_t count = 0;
+
+        for (const auto &[_, pool] : hosts)
+            count += pool->idle.size();
+
+        return count;
+    }
+
+    const http_client_stats & http_client::stats() const noexcept {
+        return stats_;
+    }
+}
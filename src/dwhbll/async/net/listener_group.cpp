@@ -0,0 +1,124 @@
+#include <dwhbll/async/net/listener_group.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/sanify/coroutines.hpp>
+#include <dwhbll/sanify/stl_ext.h>
+
+namespace dwhbll::async::net {
+    listener_group::listener_group() : listener_group(options{}) {}
+
+    listener_group::listener_group(options opts) : opts(opts) {
+        if (this->opts.threads == 0)
+            this->opts.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    listener_group::~listener_group() {
+        stop();
+    }
+
+    Result<UNIT, int> listener_group::listen(const network::address &endpoint) {
+        if (!listeners.empty())
+            debug::panic("listener_group is already listening.");
+
+        auto bound = endpoint;
+
+        // the kernel numbers the group in bind order, which is what the cpu steering relies on
+        for (std::size_t i = 0; i < opts.threads; i++) {
+            auto listener = std::make_unique<tcp_listener>();
+            listener->set_reuseaddr();
+            listener->set_reuseport();
+
+            auto r = listener->listen(bound, opts.backlog);
+
+            if (r.is_err()) {
+                listeners.clear();
+                return r;
+            }
+
+            // binding port 0 again would open a separate group on another port
+            if (i == 0) {
+                auto local = listener->local_address();
+
+                if (local.is_err()) {
+                    listeners.clear();
+                    return Err(local.unwrap_err_unchecked());
+                }
+
+                bound.port = local.unwrap_unchecked().port;
+            }
+
+            listeners.push_back(std::move(listener));
+        }
+
+        if (opts.steer_by_cpu) {
+            auto r = listeners.front()->attach_cpu_steering();
+
+            if (r.is_err()) {
+                listeners.clear();
+                return r;
+            }
+        }
+
+        return Ok();
+    }
+
+    task<> listener_group::accept_loop(tcp_listener &listener) {
+        while (running.load(std::memory_order_relaxed)) {
+            auto sock = co_await listener.accept();
+
+            if (sock.is_err()) {
+                // stop() shuts the listeners down, which fails the pending accept
+                if (!running.load(std::memory_order_relaxed))
+                    break;
+
+                console::warn("listener_group: accept failed with {}", sock.unwrap_err_unchecked());
+                continue;
+            }
+
+            reactor::get_thread_reactor()->spawn(on_connection(std::move(sock.unwrap_unchecked())));
+        }
+    }
+
+    void listener_group::start(handler on_connection) {
+        if (listeners.empty())
+            debug::panic("listener_group::start called before listen.");
+
+        if (running.exchange(true))
+            debug::panic("listener_group is already running.");
+
+        this->on_connection = std::move(on_connection);
+
+        for (std::size_t i = 0; i < listeners.size(); i++) {
+            workers.emplace_back([this, i] {
+                if (opts.steer_by_cpu) {
+                    cpu_set_t cpus;
+                    CPU_ZERO(&cpus);
+                    CPU_SET(i, &cpus);
+                    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+                }
+
+                reactor r;
+                r.spawn(accept_loop(*listeners[i]));
+                r.run();
+            });
+        }
+    }
+
+    void listener_group::stop() {
+        if (!running.exchange(false))
+            return;
+
+        for (auto &listener : listeners)
+            listener->stop_accepting();
+
+        for (auto &worker : workers)
+            worker.join();
+
+        workers.clear();
+        listeners.clear();
+    }
+}
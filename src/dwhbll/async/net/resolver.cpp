@@ -0,0 +1,15 @@
+#include <dwhbll/async/net/resolver.h>
+
+#include <dwhbll/async/net/dns_resolver.h>
+#include <dwhbll/sanify/coroutines.hpp>
+#include <dwhbll/sanify/stl_ext.h>
+
+namespace dwhbll::async::net {
+    task<Result<std::vector<network::address>, int>> resolve(std::string host, std::uint16_t port) {
+        co_return co_await dns_resolver::local().resolve(std::move(host), port);
+    }
+
+    void forget_resolved(const std::string &host) {
+        dns_resolver::local().forget(host);
+    }
+}
@@ -4,47 +4,219 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <dwhbll/async/net/resolver.h>
+#include <dwhbll/concurrency/coroutine/async_semaphore.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/sleep_task.h>
 #include <dwhbll/concurrency/coroutine/wrappers/syscall_wrappers.h>
 #include <dwhbll/network/address.h>
 #include <dwhbll/sanify/coroutines.hpp>
+#include <dwhbll/sanify/stl_ext.h>
+#include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
 #include <dwhbll/stl_ext/option.h>
 
 #include <netinet/tcp.h>
 
 namespace dwhbll::async::net {
-    task<stl_ext::Result<std::unique_ptr<socket>, int>> socket::connect_internal(bool use_ipv6, const network::address &endpoint, int socktype) {
-        sockaddr_storage addr{};
-        std::size_t addrlen{};
+    namespace {
+        using clock_type = std::chrono::steady_clock;
+
+        /**
+         * @brief RFC 8305 ordering, alternate between families starting with the one the resolver put first.
+         */
+        std::vector<network::address> interleave(std::vector<network::address> addresses) {
+            std::vector<network::address> preferred, other;
+            const auto family = addresses.front().type;
+
+            for (auto &addr : addresses)
+                (addr.type == family ? preferred : other).push_back(std::move(addr));
+
+            std::vector<network::address> ordered;
+            for (std::size_t i = 0; i < std::max(preferred.size(), other.size()); i++) {
+                if (i < preferred.size())
+                    ordered.push_back(std::move(preferred[i]));
+                if (i < other.size())
+                    ordered.push_back(std::move(other[i]));
+            }
+
+            return ordered;
+        }
+
+        task<Result<std::unique_ptr<socket>, int>> connect_one(network::address endpoint, int socktype) {
+            sockaddr_storage addr;
+            const auto addrlen = network::conv::to_sockaddr(endpoint, addr);
+
+            auto sock = ::socket(addr.ss_family, socktype, 0);
+
+            if (sock == -1)
+                co_return Err(errno);
+
+            auto r = co_await calls::connect(sock, reinterpret_cast<sockaddr *>(&addr), addrlen);
+
+            if (r.is_err()) {
+                ::close(sock);
+                co_return Err(r.unwrap_err_unchecked());
+            }
+
+            co_return Ok(std::make_unique<socket>(sock, std::move(endpoint)));
+        }
+
+        /**
+         * @brief State shared by the attempts of one happy eyeballs connect, outlives the connect for the losers.
+         */
+        struct race {
+            struct attempt {
+                network::address endpoint;
+                /// set while the connect is in flight, so the loser can be aborted
+                int fd = -1;
+            };
+
+            std::vector<attempt> attempts;
+            /// released once per finished attempt and per expired attempt delay
+            async_semaphore events{0};
+            std::unique_ptr<socket> winner;
+            std::optional<reactor::reactor_job> timer;
+            std::size_t next = 0;
+            std::size_t running = 0;
+            int last_error = ECONNREFUSED;
+            bool done = false;
+        };
+
+        task<> attempt_connect(std::shared_ptr<race> state, std::size_t index) {
+            auto &attempt = state->attempts[index];
+
+            sockaddr_storage addr;
+            const auto addrlen = network::conv::to_sockaddr(attempt.endpoint, addr);
+
+            const auto sock = ::socket(addr.ss_family, SOCK_STREAM, 0);
+
+            if (sock == -1) {
+                state->last_error = errno;
+                state->running--;
+                state->events.release();
+                co_return;
+            }
+
+            attempt.fd = sock;
+            auto r = co_await calls::connect(sock, reinterpret_cast<sockaddr *>(&addr), addrlen);
+            attempt.fd = -1;
+            state->running--;
+
+            if (r.is_ok() && !state->done) {
+                state->done = true;
+                state->winner = std::make_unique<socket>(sock, attempt.endpoint);
+            } else {
+                ::close(sock);
+
+                if (r.is_err() && !state->done)
+                    state->last_error = r.unwrap_err_unchecked();
+            }
+
+            state->events.release();
+        }
+
+        task<> attempt_delay(std::shared_ptr<race> state, clock_type::time_point due) {
+            co_await sleep_task{due};
+
+            // a cancelled delay never gets here
+            state->timer.reset();
+            state->events.release();
+        }
+
+        task<Result<std::unique_ptr<socket>, int>> race_connect(std::vector<network::address> candidates) {
+            auto state = std::make_shared<race>();
+            auto *r = reactor::get_thread_reactor();
+
+            for (auto &candidate : candidates)
+                state->attempts.push_back({std::move(candidate)});
+
+            // start the next attempt and give it the attempt delay before the one after starts anyway
+            auto launch = [&] {
+                if (state->timer) {
+                    state->timer->cancel();
+                    state->timer.reset();
+                }
+
+                state->running++;
+                r->spawn(attempt_connect(state, state->next++));
+
+                if (!state->done && state->next < state->attempts.size())
+                    state->timer = r->spawn(attempt_delay(state, clock_type::now() + socket::CONNECTION_ATTEMPT_DELAY));
+            };
+
+            launch();
+
+            while (true) {
+                co_await state->events.acquire();
+
+                if (state->winner)
+                    break;
+
+                if (state->next < state->attempts.size())
+                    launch();
+                else if (state->running == 0)
+                    break;
+            }
+
+            state->done = true;
+
+            if (state->timer) {
+                state->timer->cancel();
+                state->timer.reset();
+            }
+
+            // aborts the handshakes still in flight, their attempts close the sockets
+            for (auto &attempt : state->attempts) {
+                if (attempt.fd != -1)
+                    ::shutdown(attempt.fd, SHUT_RDWR);
+            }
+
+            if (!state->winner)
+                co_return Err(state->last_error);
+
+            co_return Ok(std::move(state->winner));
+        }
+    }
+
+    task<Result<std::unique_ptr<socket>, int>> socket::connect_internal(bool use_ipv6, network::address endpoint, int socktype) {
         switch (endpoint.type) {
-        case network::address::DOMAIN:
-            debug::todo();
-        case network::address::IPV4: {
-            use_ipv6 = false;
-            auto& v4addr = std::get<std::array<std::uint8_t, 4>>(endpoint.host);
-            auto* v4 = reinterpret_cast<sockaddr_in*>(&addr);
-            v4->sin_family = AF_INET;
-            v4->sin_addr.s_addr = v4addr[3] << 24 | v4addr[2] << 16 | v4addr[1] << 8 | v4addr[0];
-            v4->sin_port = htons(endpoint.port);
-            addrlen = sizeof(sockaddr_in);
-            break;
+        case network::address::DOMAIN: {
+            const auto host = std::get<std::string>(endpoint.host);
+            auto resolved = co_await resolve(host, endpoint.port);
+
+            if (resolved.is_err())
+                co_return Err(resolved.unwrap_err_unchecked());
+
+            auto candidates = std::move(resolved.unwrap_unchecked());
+
+            if (!use_ipv6)
+                std::erase_if(candidates, [](const auto &addr) { return addr.type == network::address::IPV6; });
+
+            if (candidates.empty())
+                co_return Err(EHOSTUNREACH);
+
+            // datagram sockets only pick a peer, there is no handshake to race
+            if (socktype != SOCK_STREAM || candidates.size() == 1)
+                co_return co_await connect_one(std::move(candidates.front()), socktype);
+
+            auto sock = co_await race_connect(interleave(std::move(candidates)));
+
+            // every address failed, they may have changed since they were cached
+            if (sock.is_err())
+                forget_resolved(host);
+
+            co_return sock;
         }
+        case network::address::IPV4:
         case network::address::IPV6:
-            use_ipv6 = true;
-            debug::todo();
-            break;
+            co_return co_await connect_one(std::move(endpoint), socktype);
         case network::address::EMPTY:
+        default:
             debug::panic();
         }
-
-        auto sock = ::socket(use_ipv6 ? AF_INET6 : AF_INET, socktype, 0);
-
-        if (sock == -1)
-            co_return stl_ext::Err(errno);
-
-        co_return (co_await calls::connect(sock, reinterpret_cast<sockaddr *>(&addr), addrlen)).map([sock, endpoint](auto) {
-            return std::make_unique<socket>(sock, endpoint);
-        });
     }
 
     socket::socket() = default;
@@ -60,7 +232,10 @@ namespace dwhbll::async::net {
     socket::socket(socket &&other) noexcept: fd(other.fd),
                                              addr(std::move(other.addr)),
                                              shutdown(other.shutdown),
-                                             nodelay_(other.nodelay_) {
+                                             nodelay_(other.nodelay_),
+                                             read_timeout(other.read_timeout),
+                                             write_timeout(other.write_timeout),
+                                             deadline_(other.deadline_) {
         other.fd = -1;
     }
 
@@ -72,6 +247,9 @@ namespace dwhbll::async::net {
         addr = std::move(other.addr);
         shutdown = other.shutdown;
         nodelay_ = other.nodelay_;
+        read_timeout = other.read_timeout;
+        write_timeout = other.write_timeout;
+        deadline_ = other.deadline_;
         return *this;
     }
 
@@ -109,6 +287,25 @@ namespace dwhbll::async::net {
         return addr;
     }
 
+    void socket::set_read_timeout(std::chrono::steady_clock::duration timeout) noexcept {
+        read_timeout = timeout;
+    }
+
+    void socket::set_write_timeout(std::chrono::steady_clock::duration timeout) noexcept {
+        write_timeout = timeout;
+    }
+
+    void socket::set_deadline(std::chrono::steady_clock::time_point deadline) noexcept {
+        deadline_ = deadline;
+    }
+
+    std::chrono::steady_clock::time_point socket::op_deadline(std::chrono::steady_clock::duration timeout) const noexcept {
+        if (timeout == std::chrono::steady_clock::duration::zero())
+            return deadline_;
+
+        return std::min(deadline_, clock_type::now() + timeout);
+    }
+
     task<stl_ext::Result<std::unique_ptr<socket>, int>> socket::connect_tcp(bool use_ipv6, const network::address &endpoint) {
         return connect_internal(use_ipv6, endpoint, SOCK_STREAM);
     }
@@ -162,7 +359,10 @@ namespace dwhbll::async::net {
         if (!has_socket())
             debug::panic();
 
-        auto r = co_await calls::recv(fd, buffer.data(), buffer.size(), 0);
+        const auto deadline = op_deadline(read_timeout);
+        auto r = deadline == clock_type::time_point::max()
+                     ? co_await calls::recv(fd, buffer.data(), buffer.size(), 0)
+                     : co_await calls::recv(fd, buffer.data(), buffer.size(), 0, deadline);
 
         if (r.is_ok() && r.ok().unwrap() == 0)
             close();
@@ -174,7 +374,13 @@ namespace dwhbll::async::net {
         if (!has_socket())
             debug::panic();
 
-        co_return co_await calls::send(fd, buffer.data(), buffer.size(), 0);
+        const auto deadline = op_deadline(write_timeout);
+
+        // a peer that went away must not take the whole process down with SIGPIPE
+        if (deadline == clock_type::time_point::max())
+            co_return co_await calls::send(fd, buffer.data(), buffer.size(), MSG_NOSIGNAL);
+
+        co_return co_await calls::send(fd, buffer.data(), buffer.size(), MSG_NOSIGNAL, deadline);
     }
 
     task<stl_ext::Result<stl_ext::UNIT, int>> socket::flush() {
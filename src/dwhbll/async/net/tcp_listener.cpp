@@ -1,9 +1,12 @@
 #include <dwhbll/async/net/tcp_listener.h>
 
+#include <linux/filter.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
 
+#include <iterator>
+
 #include <dwhbll/concurrency/coroutine/wrappers/syscall_wrappers.h>
 #include <dwhbll/network/address.h>
 #include <dwhbll/sanify/coroutines.hpp>
@@ -31,49 +34,45 @@ namespace dwhbll::async::net {
     }
 
     Result<UNIT, int> tcp_listener::listen(const network::address &endpoint, int backlog) {
-        sockaddr_storage addr{};
-        std::size_t addrlen{};
-        bool use_ipv6{};
-
-        switch (endpoint.type) {
-        case network::address::DOMAIN:
+        if (endpoint.type == network::address::DOMAIN)
             debug::panic("binding to domain is not allowed.");
-        case network::address::IPV4: {
-            use_ipv6 = false;
-            auto& v4addr = std::get<std::array<std::uint8_t, 4>>(endpoint.host);
-            auto* v4 = reinterpret_cast<sockaddr_in*>(&addr);
-            v4->sin_family = AF_INET;
-            v4->sin_addr.s_addr = v4addr[3] << 24 | v4addr[2] << 16 | v4addr[1] << 8 | v4addr[0];
-            v4->sin_port = htons(endpoint.port);
-            addrlen = sizeof(sockaddr_in);
-            break;
-        }
-        case network::address::IPV6:
-            use_ipv6 = true;
-            debug::todo();
-            break;
-        case network::address::EMPTY:
-            debug::panic();
-        }
 
-        auto sock = ::socket(use_ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
+        sockaddr_storage addr;
+        const auto addrlen = network::conv::to_sockaddr(endpoint, addr);
+
+        auto sock = ::socket(addr.ss_family, SOCK_STREAM, 0);
 
         if (sock < 0)
             return Err(errno);
 
+        // keeps errno intact across the close
+        auto fail = [sock] {
+            const int error = errno;
+            ::close(sock);
+            return Err(error);
+        };
+
         if (want_reuseaddr) {
             int one = 1;
             auto r = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
 
             if (r != 0)
-                return Err(errno);
+                return fail();
+        }
+
+        if (want_reuseport) {
+            int one = 1;
+            auto r = setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+            if (r != 0)
+                return fail();
         }
 
         if (bind(sock, reinterpret_cast<sockaddr*>(&addr), addrlen) < 0)
-            return Err(errno);
+            return fail();
 
         if (::listen(sock, backlog) < 0)
-            return Err(errno);
+            return fail();
 
         fd_ = sock;
 
@@ -92,26 +91,47 @@ namespace dwhbll::async::net {
         if (sock.is_err())
             co_return Err(sock.unwrap_err_unchecked());
 
-        co_return Ok(std::make_unique<socket>(sock.unwrap_unchecked(), [&] -> network::address {
-            switch (addr.ss_family) {
-                case AF_INET: {
-                    auto* a = reinterpret_cast<sockaddr_in*>(&addr);
-                    auto addr = a->sin_addr.s_addr;
-                    return network::address(std::array{
-                        static_cast<std::uint8_t>(addr & 0xFF),
-                        static_cast<std::uint8_t>((addr >> 8) & 0xFF),
-                        static_cast<std::uint8_t>((addr >> 16) & 0xFF),
-                        static_cast<std::uint8_t>((addr >> 24) & 0xFF)
-                    }, a->sin_port);
-                }
-                case AF_INET6:
-                default:
-                    debug::panic("Unrecognized sa_family type!");
-            }
-        }()));
+        co_return Ok(std::make_unique<socket>(sock.unwrap_unchecked(), network::conv::from_sockaddr(addr)));
+    }
+
+    Result<network::address, int> tcp_listener::local_address() const {
+        sockaddr_storage addr{};
+        socklen_t addrlen = sizeof(addr);
+
+        if (getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &addrlen) < 0)
+            return Err(errno);
+
+        return Ok(network::conv::from_sockaddr(addr));
     }
 
     void tcp_listener::set_reuseaddr() noexcept {
         want_reuseaddr = true;
     }
+
+    void tcp_listener::set_reuseport() noexcept {
+        want_reuseport = true;
+    }
+
+    Result<UNIT, int> tcp_listener::attach_cpu_steering() const noexcept {
+        if (fd_ < 0)
+            debug::panic("Socket not listening!");
+
+        // A = current cpu; return A
+        sock_filter code[] = {
+            {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<std::uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+            {BPF_RET | BPF_A, 0, 0, 0},
+        };
+
+        sock_fprog program{static_cast<unsigned short>(std::size(code)), code};
+
+        if (setsockopt(fd_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) != 0)
+            return Err(errno);
+
+        return Ok();
+    }
+
+    void tcp_listener::stop_accepting() const noexcept {
+        if (fd_ >= 0)
+            ::shutdown(fd_, SHUT_RDWR);
+    }
 }
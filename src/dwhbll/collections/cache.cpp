@@ -1,155 +1,62 @@
-#include <condition_variable>
+#include <bit>
 #include <dwhbll/collections/cache.h>
 
-#include <mutex>
-#include <thread>
-#include <unordered_set>
-
 namespace dwhbll::collections {
-    std::mutex caches_change;
-    std::condition_variable caches_cv;
-    bool updated = false;
-    std::unordered_set<generic_cache*> caches;
-
-    generic_cache* getNextExpire() {
-        generic_cache* next{nullptr};
-        {
-            std::chrono::system_clock::time_point point;
-            std::unique_lock lock(caches_change);
-            bool first = true;
-            for (auto* c : caches) {
-                if (first) {
-                    point = c->first_expire_time;
-                    next = c;
-                    first = false;
-                    continue;
-                }
-                if (point > c->first_expire_time) {
-                    point = c->first_expire_time;
-                    next = c;
-                }
-            }
+    namespace detail {
+        namespace {
+            constexpr std::uint64_t row_seeds[4] = {
+                0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL,
+            };
         }
-        return next;
-    }
 
-    void cacheCleanupWorker() {
-        while (true) {
-            generic_cache* wait_for = getNextExpire();
-
-            if (!wait_for) {
-                std::unique_lock lock(caches_change);
-                caches_cv.wait(lock);
-                continue;
-            } else {
-                std::unique_lock lock(caches_change);
-                while (!updated) {
-                    if (caches_cv.wait_until(lock, wait_for->first_expire_time) == std::cv_status::timeout)
-                        goto update_cache;
-                }
-                continue; // restart, waiting for the earliest possible expiry.
-            }
-        update_cache:
-            auto ctime = std::chrono::system_clock::now();
-            for (auto* c : caches) {
-                std::unique_lock _(c->cache_lock);
-                for (auto it = c->entries.begin(); it != c->entries.end();) {
-                    if (it->first < ctime) {
-                        // before erasing, release the memory pool data
-                        auto& [k, v] = it->second;
-                        c->return_values(k, v);
-                        c->entries.erase(it);
-                        it = c->entries.begin();
-                    } else
-                        ++it;
-                }
-            }
+        frequency_sketch::frequency_sketch(std::size_t capacity)
+            : sample_size(10 * std::max<std::size_t>(capacity, 1)) {
+            // about four counters per entry, so that collisions stay rare
+            const std::size_t counters = std::bit_ceil(std::max<std::size_t>(capacity * 4, 64));
+            table.assign(counters / 16, 0);
+            counter_mask = counters - 1;
         }
-    }
-
-    //std::thread worker;
-
-    generic_cache::generic_cache() {
-        std::unique_lock _(caches_change);
-        caches.insert(this);
-    }
-
-    generic_cache::~generic_cache() {
-        std::unique_lock _(caches_change);
-        caches.erase(this);
-    }
-
-    generic_cache::generic_cache(const generic_cache &other): entries(other.entries) {
-        std::unique_lock _(caches_change);
-        caches.insert(this);
-    }
-
-    generic_cache::generic_cache(generic_cache &&other) noexcept: entries(std::move(other.entries)) {
-        std::unique_lock _(caches_change);
-        caches.erase(&other);
-        caches.insert(this);
-    }
-
-    generic_cache &generic_cache::operator=(const generic_cache &other) {
-        if (this == &other)
-            return *this;
-        entries = other.entries;
-        return *this;
-    }
 
-    generic_cache &generic_cache::operator=(generic_cache &&other) noexcept {
-        std::unique_lock _(caches_change);
-        if (this == &other)
-            return *this;
-        entries = std::move(other.entries);
-        caches.erase(&other);
-        return *this;
-    }
+        std::uint64_t frequency_sketch::counter_of(std::uint64_t hash, int row) const noexcept {
+            const std::uint64_t h = (hash + row_seeds[row]) * row_seeds[row];
+            return (h >> 32) & counter_mask;
+        }
 
-    void generic_cache::addEntry(std::chrono::system_clock::time_point expire_time, void *key, void *value) {
-        std::unique_lock _(cache_lock);
+        void frequency_sketch::increment(std::uint64_t hash) noexcept {
+            bool added = false;
 
-        if (first_expire_time > expire_time)
-            first_expire_time = expire_time;
+            for (int row = 0; row < 4; row++) {
+                const auto counter = counter_of(hash, row);
+                auto& word = table[counter >> 4];
+                const auto shift = (counter & 15) * 4;
 
-        if (entries.empty()) {
-            // insert one before here
-            entries.push_back({expire_time, {key, value}});
+                if (((word >> shift) & 0xf) != 0xf) {
+                    word += std::uint64_t{1} << shift;
+                    added = true;
+                }
+            }
 
-            // flag the worker to let it know we potentially have a new most important
-            std::unique_lock lock(caches_change);
-            updated = true;
-            caches_cv.notify_one();
+            if (added && ++additions >= sample_size)
+                age();
         }
 
-        // iterate until we find one where the current one is > than expire_time
-        for (auto it = entries.begin(); it != entries.end(); ++it) {
-            if (it->first > expire_time) {
-                // if we are inserting before the first, this means we have a potentially new earliest cache expiry.
-                bool flagWorker = it == entries.begin();
-
-                // insert one before here
-                entries.insert(it, {expire_time, {key, value}});
+        std::uint32_t frequency_sketch::frequency(std::uint64_t hash) const noexcept {
+            std::uint32_t least = 0xf;
 
-                if (flagWorker) {
-                    // flag the worker to let it know we potentially have a new most important
-                    std::unique_lock lock(caches_change);
-                    updated = true;
-                    caches_cv.notify_one();
-                }
+            for (int row = 0; row < 4; row++) {
+                const auto counter = counter_of(hash, row);
+                least = std::min(least, static_cast<std::uint32_t>((table[counter >> 4] >> ((counter & 15) * 4)) & 0xf));
             }
+
+            return least;
         }
-    }
 
-    void * generic_cache::getEntry(void *key) {
-        std::unique_lock _(cache_lock);
-        auto expiry = std::chrono::system_clock::now();
-        for (auto& [expire, data] : entries) {
-            if (expiry > expire)
-                continue; // expired
-            if (auto& [k, v] = data; k == key)
-                return v;
+        void frequency_sketch::age() noexcept {
+            // halving every counter at once, the low bit of each moves into the top of its lower neighbour otherwise
+            for (auto& word : table)
+                word = (word >> 1) & 0x7777777777777777ULL;
+
+            additions /= 2;
         }
-        return nullptr;
     }
 }
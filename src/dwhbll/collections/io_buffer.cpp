@@ -0,0 +1,259 @@
+#include <dwhbll/collections/io_buffer.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <dwhbll/console/debug.hpp>
+
+namespace dwhbll::collections {
+    /**
+     * @brief Owns the calling thread's pool, which may outlive the thread if buffers still hold its segments.
+     */
+    struct local_pool_holder {
+        io_buffer_pool *pool = new io_buffer_pool();
+
+        ~local_pool_holder() {
+            pool->retire();
+        }
+    };
+
+    io_buffer_pool & io_buffer_pool::local() {
+        thread_local local_pool_holder holder;
+        return *holder.pool;
+    }
+
+    void io_buffer_pool::retire() {
+        {
+            auto guard = lock.lock();
+            orphaned = true;
+
+            if (outstanding != 0)
+                return;
+        }
+
+        delete this;
+    }
+
+    io_buffer_pool::segment * io_buffer_pool::acquire() {
+        auto guard = lock.lock();
+
+        if (free_list == nullptr) {
+            auto block = std::make_unique<slab>();
+            block->memory = std::make_unique_for_overwrite<sanify::u8[]>(SEGMENT_SIZE * SEGMENTS_PER_SLAB);
+
+            for (std::size_t i = 0; i < SEGMENTS_PER_SLAB; i++) {
+                auto &seg = block->segments[i];
+                seg.owner = this;
+                seg.data = block->memory.get() + i * SEGMENT_SIZE;
+                seg.next = free_list;
+                free_list = &seg;
+            }
+
+            slabs.push_back(std::move(block));
+        }
+
+        auto *seg = free_list;
+        free_list = seg->next;
+
+        seg->next = nullptr;
+        seg->head = 0;
+        seg->tail = 0;
+        outstanding++;
+
+        return seg;
+    }
+
+    void io_buffer_pool::release(segment *seg) {
+        {
+            auto guard = lock.lock();
+
+            seg->next = free_list;
+            free_list = seg;
+            outstanding--;
+
+            if (!orphaned || outstanding != 0)
+                return;
+        }
+
+        delete this;
+    }
+
+    std::size_t io_buffer_pool::in_use() {
+        auto guard = lock.lock();
+        return outstanding;
+    }
+
+    std::size_t io_buffer_pool::capacity() {
+        auto guard = lock.lock();
+        return slabs.size() * SEGMENTS_PER_SLAB;
+    }
+
+    io_buffer::io_buffer() : pool(nullptr) {}
+
+    io_buffer::io_buffer(io_buffer_pool &pool) : pool(&pool) {}
+
+    io_buffer::~io_buffer() {
+        clear();
+    }
+
+    io_buffer::io_buffer(io_buffer &&other) noexcept: pool(other.pool),
+                                                      head_(other.head_),
+                                                      tail_(other.tail_),
+                                                      size_(other.size_) {
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.size_ = 0;
+    }
+
+    io_buffer & io_buffer::operator=(io_buffer &&other) noexcept {
+        if (this == &other)
+            return *this;
+
+        clear();
+
+        pool = other.pool;
+        head_ = other.head_;
+        tail_ = other.tail_;
+        size_ = other.size_;
+
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.size_ = 0;
+
+        return *this;
+    }
+
+    void io_buffer::pop_front_segment() {
+        auto *seg = head_;
+        head_ = seg->next;
+
+        if (head_ == nullptr)
+            tail_ = nullptr;
+
+        // segments go home to the pool they came from, whichever buffer returns them
+        seg->owner->release(seg);
+    }
+
+    std::span<const sanify::u8> io_buffer::readable() const noexcept {
+        if (head_ == nullptr)
+            return {};
+
+        return {head_->data + head_->head, head_->tail - head_->head};
+    }
+
+    void io_buffer::consume(std::size_t count) {
+        if (count > size_)
+            debug::panic("io_buffer: consuming {} bytes out of {}", count, size_);
+
+        size_ -= count;
+
+        while (count != 0) {
+            const std::size_t available = head_->tail - head_->head;
+            const auto step = std::min(count, available);
+
+            head_->head += step;
+            count -= step;
+
+            if (head_->head == head_->tail) {
+                if (head_ == tail_) {
+                    // keep the last segment around, the next write will want it
+                    head_->head = 0;
+                    head_->tail = 0;
+                } else
+                    pop_front_segment();
+            }
+        }
+    }
+
+    std::span<sanify::u8> io_buffer::writable() {
+        auto &source = pool != nullptr ? *pool : io_buffer_pool::local();
+
+        if (tail_ == nullptr) {
+            head_ = tail_ = source.acquire();
+        } else if (tail_->tail == io_buffer_pool::SEGMENT_SIZE) {
+            tail_->next = source.acquire();
+            tail_ = tail_->next;
+        }
+
+        return {tail_->data + tail_->tail, io_buffer_pool::SEGMENT_SIZE - tail_->tail};
+    }
+
+    void io_buffer::commit(std::size_t count) {
+        if (tail_ == nullptr || count > io_buffer_pool::SEGMENT_SIZE - tail_->tail)
+            debug::panic("io_buffer: committing {} bytes past the writable span", count);
+
+        tail_->tail += count;
+        size_ += count;
+    }
+
+    void io_buffer::append(std::span<const sanify::u8> data) {
+        while (!data.empty()) {
+            auto space = writable();
+            const auto count = std::min(space.size(), data.size());
+
+            std::memcpy(space.data(), data.data(), count);
+            commit(count);
+            data = data.subspan(count);
+        }
+    }
+
+    std::size_t io_buffer::read(std::span<sanify::u8> out) {
+        const auto count = peek(out);
+        consume(count);
+        return count;
+    }
+
+    std::size_t io_buffer::peek(std::span<sanify::u8> out, std::size_t offset) const {
+        std::size_t copied = 0;
+
+        for (auto *seg = head_; seg != nullptr && copied < out.size(); seg = seg->next) {
+            std::size_t available = seg->tail - seg->head;
+
+            if (offset >= available) {
+                offset -= available;
+                continue;
+            }
+
+            const auto count = std::min(available - offset, out.size() - copied);
+            std::memcpy(out.data() + copied, seg->data + seg->head + offset, count);
+            copied += count;
+            offset = 0;
+        }
+
+        return copied;
+    }
+
+    sanify::u8 io_buffer::operator[](std::size_t index) const {
+        if (index >= size_)
+            debug::panic("io_buffer: index {} out of {} bytes", index, size_);
+
+        auto *seg = head_;
+
+        while (index >= seg->tail - seg->head) {
+            index -= seg->tail - seg->head;
+            seg = seg->next;
+        }
+
+        return seg->data[seg->head + index];
+    }
+
+    std::size_t io_buffer::gather(std::span<iovec> out) const noexcept {
+        std::size_t count = 0;
+
+        for (auto *seg = head_; seg != nullptr && count < out.size(); seg = seg->next) {
+            if (seg->head == seg->tail)
+                continue;
+
+            out[count++] = {seg->data + seg->head, seg->tail - seg->head};
+        }
+
+        return count;
+    }
+
+    void io_buffer::clear() {
+        while (head_ != nullptr)
+            pop_front_segment();
+
+        size_ = 0;
+    }
+}
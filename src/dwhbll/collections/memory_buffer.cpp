@@ -1,23 +1,23 @@
 #include <dwhbll/collections/memory_buffer.h>
+#include <dwhbll/console/debug.hpp>
 #include <dwhbll/exceptions/rt_exception_base.h>
 
 namespace dwhbll::collections {
     MemBuf::~MemBuf() = default;
 
     MemBuf::MemBuf(std::span<sanify::u8> buffer) {
-        this->buffer.assign(buffer.begin(), buffer.end());
+        this->buffer.append(buffer);
     }
 
     MemBuf::MemBuf(std::span<const sanify::u8> buffer) {
-        this->buffer.assign(buffer.begin(), buffer.end());
+        this->buffer.append(buffer);
     }
 
-    MemBuf::MemBuf(std::size_t reserved_size) : buffer(reserved_size) {}
+    MemBuf::MemBuf(std::size_t reserved_size) {}
 
     MemBuf::MemBuf(MemBuf &&other) noexcept: buffer(std::move(other.buffer)),
                                              _lock(std::move(other._lock)),
                                              big_endian(other.big_endian) {
-        other.buffer.clear();
     }
 
     MemBuf & MemBuf::operator=(MemBuf &&other) noexcept {
@@ -29,15 +29,15 @@ namespace dwhbll::collections {
         return *this;
     }
 
-    MemBuf::MemBuf() : buffer(1024) {}
+    MemBuf::MemBuf() = default;
 
     void MemBuf::set_big_endian(bool endian) {
         big_endian = endian;
     }
 
     sanify::u8 MemBuf::read_u8() {
-        sanify::u8 data = buffer.front();
-        buffer.pop_front();
+        sanify::u8 data = buffer[0];
+        buffer.consume(1);
         return data;
     }
 
@@ -63,18 +63,17 @@ namespace dwhbll::collections {
     }
 
     std::vector<sanify::u8> MemBuf::read_vector(std::size_t size) {
-        std::vector<sanify::u8> result(size);
+        if (size > buffer.size())
+            debug::panic("MemBuf: reading {} bytes out of {}", size, buffer.size());
 
-        // TODO: directly std::copy from the ring buffer!
-        for (std::size_t i = 0; i < size; ++i)
-            result[i] = read_u8();
+        std::vector<sanify::u8> result(size);
+        buffer.read(result);
 
         return result;
     }
 
     void MemBuf::skip(std::size_t count) {
-        for (std::size_t i = 0; i < count; ++i)
-            buffer.pop_front();
+        buffer.consume(count);
     }
 
     sanify::u8 MemBuf::peek_u8(std::size_t index) {
@@ -103,17 +102,18 @@ namespace dwhbll::collections {
     }
 
     std::vector<sanify::u8> MemBuf::peek_vector(std::size_t size, std::size_t index) {
-        std::vector<sanify::u8> result(size);
+        if (index + size > buffer.size())
+            debug::panic("MemBuf: peeking {} bytes at {} out of {}", size, index, buffer.size());
 
-        // TODO: directly std::copy from the ring buffer!
-        for (std::size_t i = 0; i < size; ++i)
-            result[i] = peek_u8(index + i);
+        std::vector<sanify::u8> result(size);
+        buffer.peek(result, index);
 
         return result;
     }
 
     void MemBuf::write_u8(sanify::u8 data) {
-        buffer.push_back(data);
+        buffer.writable()[0] = data;
+        buffer.commit(1);
     }
 
     void MemBuf::write_u16(sanify::u16 data) {
@@ -147,13 +147,11 @@ namespace dwhbll::collections {
     }
 
     void MemBuf::write_vector(const std::span<sanify::u8> &data) {
-        for (const auto& d : data)
-            write_u8(d);
+        buffer.append(data);
     }
 
     void MemBuf::write_string(const std::string &data) {
-        for (const auto& c : data)
-            write_u8(c);
+        buffer.append({reinterpret_cast<const sanify::u8 *>(data.data()), data.size()});
     }
 
     std::size_t MemBuf::size() const {
@@ -180,7 +178,7 @@ namespace dwhbll::collections {
         throw exceptions::rt_exception_base("MemoryBuffer::refill_buffer is not implemented by default!");
     }
 
-    Ring<sanify::u8> & MemBuf::get_raw_buffer() {
+    io_buffer & MemBuf::get_raw_buffer() {
         return buffer;
     }
 }
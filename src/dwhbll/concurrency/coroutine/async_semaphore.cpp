@@ -10,15 +10,16 @@ namespace dwhbll::concurrency::coroutine {
     }
 
     bool async_semaphore::semaphore_awaitable::await_ready() const noexcept {
-        return semaphore->permits_ > 0;
-    }
-
-    void async_semaphore::semaphore_awaitable::await_suspend(std::coroutine_handle<> h) {
+        // take the permit right away, otherwise several awaiters can see the same one
         if (semaphore->permits_ > 0) {
             semaphore->permits_--;
-            reactor::get_thread_reactor()->enqueue(this, h);
+            return true;
         }
 
+        return false;
+    }
+
+    void async_semaphore::semaphore_awaitable::await_suspend(std::coroutine_handle<> h) {
         semaphore->waiting.push_back({this, h});
     }
 
@@ -48,11 +49,14 @@ namespace dwhbll::concurrency::coroutine {
     }
 
     void async_semaphore::release() {
-        permits_++;
-        if (!waiting.empty()) {
-            auto front = waiting.front();
-            reactor::get_thread_reactor()->enqueue(front.first, front.second);
-            waiting.pop_front();
+        if (waiting.empty()) {
+            permits_++;
+            return;
         }
+
+        // hand the permit straight to the oldest waiter
+        auto front = waiting.front();
+        waiting.pop_front();
+        reactor::get_thread_reactor()->enqueue(front.first, front.second);
     }
 }
@@ -33,21 +33,17 @@ namespace dwhbll::concurrency::coroutine {
     }
 
     void reactor::update_timer_tasks() {
-        auto now = std::lower_bound(time_tasks.begin(), time_tasks.end(), timer_task{std::chrono::steady_clock::now()});
+        const auto now = std::chrono::steady_clock::now();
 
-        for (auto b = time_tasks.begin(); b != now; ++b)
-            ready_queue.push_back(b->data);
+        // cancelled sleepers are taken out by `cancel_job` as it goes
+        while (!time_tasks.empty() && time_tasks.front().time <= now) {
+            auto* data = time_tasks.front().data;
+            timer_erase(0);
 
-        time_tasks.erase(time_tasks.begin(), now);
-
-        // handle cancellations;
-        for (auto b = time_tasks.begin(); b != time_tasks.end();) {
-            if (b->data->parent->cancelled) {
-                b->data->promise->cancel();
-                ready_queue.push_back(b->data);
-                b = time_tasks.erase(b);
-            } else
-                ++b;
+            if (data->is_uring)
+                cancel_expired(data);
+            else
+                ready_queue.push_back(data);
         }
     }
 
@@ -57,6 +53,86 @@ namespace dwhbll::concurrency::coroutine {
         return time_tasks.front().time;
     }
 
+    void reactor::timer_insert(timer_task task) {
+        task.data->timer_slot = time_tasks.size();
+        time_tasks.push_back(task);
+        timer_sift_up(time_tasks.size() - 1);
+    }
+
+    void reactor::timer_erase(std::size_t slot) {
+        time_tasks[slot].data->timer_slot = NO_TIMER;
+
+        if (slot != time_tasks.size() - 1) {
+            time_tasks[slot] = time_tasks.back();
+            time_tasks[slot].data->timer_slot = slot;
+        }
+
+        time_tasks.pop_back();
+
+        // the moved timer can belong either above or below where it landed
+        if (slot < time_tasks.size()) {
+            auto* moved = time_tasks[slot].data;
+            timer_sift_up(slot);
+            timer_sift_down(moved->timer_slot);
+        }
+    }
+
+    void reactor::timer_sift_up(std::size_t slot) {
+        auto task = time_tasks[slot];
+
+        while (slot > 0) {
+            const std::size_t parent = (slot - 1) / 2;
+            if (time_tasks[parent].time <= task.time)
+                break;
+
+            time_tasks[slot] = time_tasks[parent];
+            time_tasks[slot].data->timer_slot = slot;
+            slot = parent;
+        }
+
+        time_tasks[slot] = task;
+        task.data->timer_slot = slot;
+    }
+
+    void reactor::timer_sift_down(std::size_t slot) {
+        auto task = time_tasks[slot];
+
+        while (true) {
+            std::size_t child = 2 * slot + 1;
+            if (child >= time_tasks.size())
+                break;
+
+            if (child + 1 < time_tasks.size() && time_tasks[child + 1].time < time_tasks[child].time)
+                child++;
+
+            if (task.time <= time_tasks[child].time)
+                break;
+
+            time_tasks[slot] = time_tasks[child];
+            time_tasks[slot].data->timer_slot = slot;
+            slot = child;
+        }
+
+        time_tasks[slot] = task;
+        task.data->timer_slot = slot;
+    }
+
+    void reactor::cancel_expired(user_data* data) {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+
+        if (!sqe) {
+            // the submission queue is full, try again on the next round
+            timer_insert({std::chrono::steady_clock::now() + std::chrono::milliseconds(1), data});
+            return;
+        }
+
+        io_uring_prep_cancel(sqe, data, 0);
+        // nobody waits for the cancellation itself, `process_cqe` drops its completion
+        io_uring_sqe_set_data(sqe, nullptr);
+
+        submit();
+    }
+
     __kernel_timespec reactor::to_ktimespec(std::chrono::steady_clock::time_point tp) {
         auto diff = tp - std::chrono::steady_clock::now();
 
@@ -142,6 +218,12 @@ namespace dwhbll::concurrency::coroutine {
         for (auto& completion : job->completions) {
             completion->promise->cancel();
 
+            // a sleeper is woken right away, it throws once resumed
+            if (!completion->is_uring && completion->timer_slot != NO_TIMER) {
+                timer_erase(completion->timer_slot);
+                ready_queue.push_back(completion);
+            }
+
             if (completion->is_uring) {
                 uring_promise promise;
                 co_await wait_for_sqe();
@@ -208,7 +290,7 @@ namespace dwhbll::concurrency::coroutine {
         if (resume < std::chrono::steady_clock::now())
             ready_queue.push_back(data);
         else
-            time_tasks.insert({resume, data});
+            timer_insert({resume, data});
     }
 
     void reactor::run() {
@@ -302,17 +384,36 @@ namespace dwhbll::concurrency::coroutine {
         return sqe;
     }
 
+    io_uring_sqe *reactor::get_sqe(uring_promise& h, std::chrono::steady_clock::time_point deadline) {
+        io_uring_sqe* sqe = get_sqe(h);
+
+        if (sqe)
+            timer_insert({deadline, reinterpret_cast<user_data *>(sqe->user_data)});
+
+        return sqe;
+    }
+
     void reactor::submit() {
         io_uring_submit(&ring);
     }
 
     void reactor::process_cqe(io_uring_cqe *cqe) {
-        inflight_completions--;
-
         auto* data = io_uring_cqe_get_data(cqe);
 
+        // the completion of a cancellation `cancel_expired` submitted
+        if (!data) {
+            io_uring_cqe_seen(&ring, cqe);
+            return;
+        }
+
+        inflight_completions--;
+
         auto* job_info = static_cast<user_data *>(data);
 
+        // completed before its deadline
+        if (job_info->timer_slot != NO_TIMER)
+            timer_erase(job_info->timer_slot);
+
         auto* promise = static_cast<uring_promise *>(job_info->promise);
 
         promise->cqe = cqe;
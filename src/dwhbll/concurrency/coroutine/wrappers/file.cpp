@@ -1,5 +1,7 @@
 #include <dwhbll/concurrency/coroutine/wrappers/file.h>
 
+#include <cerrno>
+#include <cstring>
 #include <fcntl.h>
 #include <version>
 #include <unistd.h>
@@ -27,6 +29,48 @@ namespace dwhbll::concurrency::coroutine::wrappers {
 
     file::file(const int fd) : fd(fd) {}
 
+    /**
+     * @brief Move everything buffered to the end of `out`.
+     */
+    static void drain_into(collections::io_buffer &buffer, std::vector<char> &out) {
+        const auto start = out.size();
+        out.resize(start + buffer.size());
+        buffer.read({reinterpret_cast<sanify::u8 *>(out.data() + start), out.size() - start});
+    }
+
+    /**
+     * @brief Read up to `count` bytes, waiting for `fd` to become readable if it would block.
+     * @return how many bytes were read, 0 at the end of the file.
+     */
+    static task<ssize_t> read_some(int fd, void *buf, uint32_t count, off_t offset) {
+        while (true) {
+            auto read = co_await calls::read(fd, buf, count, offset);
+
+            if (read >= 0)
+                co_return read;
+
+            if (read != -EAGAIN)
+                throw exceptions::rt_exception_base("reading fd {} failed ({})!", fd, strerror(-read));
+
+            co_await calls::poll(fd, POLLIN);
+        }
+    }
+
+    /**
+     * @return how many bytes were written, 0 if `fd` would block.
+     */
+    static task<ssize_t> write_some(int fd, void *buf, uint32_t count, off_t offset) {
+        auto wrote = co_await calls::write(fd, buf, count, offset);
+
+        if (wrote == -EAGAIN)
+            co_return 0;
+
+        if (wrote < 0)
+            throw exceptions::rt_exception_base("writing fd {} failed ({})!", fd, strerror(-wrote));
+
+        co_return wrote;
+    }
+
     task<bool> file::try_flush_wrbuf() {
         if (fd < 0)
             throw exceptions::rt_exception_base("writing to closed file!");
@@ -34,12 +78,13 @@ namespace dwhbll::concurrency::coroutine::wrappers {
         if (wrbuf.empty())
             co_return true;
 
-        wrbuf.get_raw_buffer().make_cont();
-        auto wrote = co_await calls::write(fd, wrbuf.get_raw_buffer().data().data(), wrbuf.get_raw_buffer().size(), write_head);
+        // one segment at a time, straight from the buffer
+        auto pending = wrbuf.readable();
+        auto wrote = co_await write_some(fd, const_cast<sanify::u8 *>(pending.data()), pending.size(), write_head);
 
         write_head += wrote;
 
-        wrbuf.skip(wrote);
+        wrbuf.consume(wrote);
 
         co_return wrbuf.empty();
     }
@@ -121,14 +166,14 @@ namespace dwhbll::concurrency::coroutine::wrappers {
             co_return {};
 
         if (n == -1) {
-            auto buf2 = rdbuf.read_vector(rdbuf.size());
-            std::vector<char> result = std::vector<char>{buf2.begin(), buf2.end()};
+            std::vector<char> result;
+            drain_into(rdbuf, result);
 
             char buffer[65536];
 
             int read;
 
-            while (read = co_await calls::read(fd, buffer, 65536, read_head), read != 0) {
+            while (read = co_await read_some(fd, buffer, 65536, read_head), read != 0) {
                 read_head += read;
                 result.insert(result.end(), buffer, buffer + read);
             }
@@ -140,17 +185,20 @@ namespace dwhbll::concurrency::coroutine::wrappers {
 
         if (rdbuf.size() > n) {
             // we already have enough data
-            auto buf2 = rdbuf.read_vector(n);
-            co_return std::vector<char>{buf2.begin(), buf2.end()};
+            std::vector<char> result(n);
+            rdbuf.read({reinterpret_cast<sanify::u8 *>(result.data()), result.size()});
+            co_return result;
         }
 
-        auto buf2 = rdbuf.read_vector(rdbuf.size());
-        auto b2s = buf2.size();
-        std::vector<char> result = std::vector<char>{buf2.begin(), buf2.end()};
+        std::vector<char> result;
+        drain_into(rdbuf, result);
+        auto b2s = result.size();
         result.resize(n);
 
-        if (n - b2s > batch_read_count) {
-            auto read = co_await calls::read(fd, result.data() + b2s, n - b2s, read_head);
+        auto space = rdbuf.writable();
+
+        if (n - b2s > space.size()) {
+            auto read = co_await read_some(fd, result.data() + b2s, n - b2s, read_head);
             read_head += read;
 
             if (read == 0)
@@ -160,17 +208,12 @@ namespace dwhbll::concurrency::coroutine::wrappers {
 
             co_return result;
         } else {
-            char buffer[batch_read_count];
-            auto read = co_await calls::read(fd, buffer, batch_read_count, read_head);
+            // read ahead into the buffer itself, what is not asked for now stays there for the next read
+            auto read = co_await read_some(fd, space.data(), space.size(), read_head);
             read_head += read;
+            rdbuf.commit(read);
 
-            if (n - b2s > read) {
-                std::memcpy(result.data() + b2s, buffer, read);
-            } else {
-                std::memcpy(result.data() + b2s, buffer, n - b2s);
-                auto consumed = n - b2s;
-                rdbuf.write_vector(std::span{(sanify::u8*)buffer + consumed, (sanify::u8*)buffer + read});
-            }
+            result.resize(b2s + rdbuf.read({reinterpret_cast<sanify::u8 *>(result.data() + b2s), n - b2s}));
 
             if (read == 0)
                 eof_ = true;
@@ -192,15 +235,15 @@ namespace dwhbll::concurrency::coroutine::wrappers {
         if (eof_)
             throw exceptions::rt_exception_base("file reached eof before finishing read!");
 
-        auto buf2 = rdbuf.read_vector(rdbuf.size());
-        std::vector<char> result = std::vector<char>{buf2.begin(), buf2.end()};
+        std::vector<char> result;
+        drain_into(rdbuf, result);
+        const auto buffered = result.size();
         result.resize(n);
 
-        int read = co_await calls::read(fd, result.data() + buf2.size(), n - buf2.size(), read_head);
-        if (read != 0)
-            read_head += read;
+        int read = co_await read_some(fd, result.data() + buffered, n - buffered, read_head);
+        read_head += read;
 
-        if (read != n - buf2.size())
+        if (read != n - buffered)
             throw exceptions::rt_exception_base("file reached eof before finishing the read!");
 
         co_return result;
@@ -213,14 +256,14 @@ namespace dwhbll::concurrency::coroutine::wrappers {
         auto result = co_await try_flush_wrbuf();
 
         if (result) {
-            int wrote = co_await calls::write(fd, data.data(), data.size(), write_head);
+            int wrote = co_await write_some(fd, data.data(), data.size(), write_head);
 
             write_head += wrote;
 
             if (wrote != data.size())
-                wrbuf.write_vector(std::span{(sanify::u8*)data.data() + wrote, (sanify::u8*)data.data() + data.size()});
+                wrbuf.append(std::span{(sanify::u8*)data.data() + wrote, (sanify::u8*)data.data() + data.size()});
         } else
-            wrbuf.write_vector(std::span{(sanify::u8*)data.data(), (sanify::u8*)data.data() + data.size()});
+            wrbuf.append(std::span{(sanify::u8*)data.data(), (sanify::u8*)data.data() + data.size()});
     }
 
     task<> file::drain() {
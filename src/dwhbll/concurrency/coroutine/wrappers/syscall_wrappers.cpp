@@ -4,6 +4,7 @@
 #include <dwhbll/concurrency/coroutine/reactor.h>
 #include <dwhbll/concurrency/coroutine/uring_sqe_awaitable.h>
 
+#include <cerrno>
 #include <sys/socket.h>
 
 #define MAKE_PROMISE \
@@ -11,6 +12,11 @@ uring_promise promise; \
 co_await wait_for_sqe(); \
 auto* sqe = reactor::get_thread_reactor()->get_sqe(promise);
 
+#define MAKE_PROMISE_UNTIL(deadline) \
+uring_promise promise; \
+co_await wait_for_sqe(); \
+auto* sqe = reactor::get_thread_reactor()->get_sqe(promise, deadline);
+
 #define SUBMIT reactor::get_thread_reactor()->submit();
 
 namespace dwhbll::concurrency::coroutine::wrappers::calls {
@@ -133,6 +139,69 @@ namespace dwhbll::concurrency::coroutine::wrappers::calls {
         co_return stl_ext::Ok(result->res);
     }
 
+    task<stl_ext::Result<ssize_t, int>> send(int fd, const void *buf, size_t len, int flags,
+                                             std::chrono::steady_clock::time_point deadline) {
+        MAKE_PROMISE_UNTIL(deadline)
+
+        io_uring_prep_send(sqe, fd, buf, len, flags);
+
+        SUBMIT
+
+        const auto result = co_await promise;
+
+        // a cancelled job throws from the await instead, so this was the deadline
+        if (result->res == -ECANCELED)
+            co_return stl_ext::Err(ETIMEDOUT);
+        if (result->res < 0)
+            co_return stl_ext::Err(-result->res);
+        co_return stl_ext::Ok(result->res);
+    }
+
+    task<stl_ext::Result<ssize_t, int>> recv(int fd, void *buf, size_t len, int flags,
+                                             std::chrono::steady_clock::time_point deadline) {
+        MAKE_PROMISE_UNTIL(deadline)
+
+        io_uring_prep_recv(sqe, fd, buf, len, flags);
+
+        SUBMIT
+
+        const auto result = co_await promise;
+
+        if (result->res == -ECANCELED)
+            co_return stl_ext::Err(ETIMEDOUT);
+        if (result->res < 0)
+            co_return stl_ext::Err(-result->res);
+        co_return stl_ext::Ok(result->res);
+    }
+
+    task<stl_ext::Result<ssize_t, int>> sendmsg(int fd, const ::msghdr *msg, int flags) {
+        MAKE_PROMISE
+
+        io_uring_prep_sendmsg(sqe, fd, msg, flags);
+
+        SUBMIT
+
+        const auto result = co_await promise;
+
+        if (result->res < 0)
+            co_return stl_ext::Err(-result->res);
+        co_return stl_ext::Ok(result->res);
+    }
+
+    task<stl_ext::Result<ssize_t, int>> recvmsg(int fd, ::msghdr *msg, int flags) {
+        MAKE_PROMISE
+
+        io_uring_prep_recvmsg(sqe, fd, msg, flags);
+
+        SUBMIT
+
+        const auto result = co_await promise;
+
+        if (result->res < 0)
+            co_return stl_ext::Err(-result->res);
+        co_return stl_ext::Ok(result->res);
+    }
+
     task<int> statx(int dirfd, const char *path, int flags, int mask, struct ::statx *statxbuf) {
         MAKE_PROMISE
 
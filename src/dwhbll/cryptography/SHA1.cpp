@@ -76,6 +76,10 @@ namespace dwhbll::cryptography {
         h[4] = 0xC3D2E1F0;
     }
 
+    void SHA1::reset() {
+        initialize();
+    }
+
     void SHA1::update(const std::span<const std::uint8_t> &in) {
         auto length = in.size();
         auto data = in.data();
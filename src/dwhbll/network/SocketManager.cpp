@@ -1,5 +1,6 @@
 #include <dwhbll/network/SocketManager.h>
 
+#include <cerrno>
 #include <cstring>
 #include <stdexcept>
 
@@ -135,16 +136,183 @@ namespace dwhbll::network {
         co_return std::move(Socket{f, CONNECT});
     }
 
+    namespace {
+        std::uint64_t endpoint_key(in_addr addr, unsigned short port) noexcept {
+            // the marker bit keeps 0.0.0.0:0 apart from a free row
+            return 1ull << 48 | static_cast<std::uint64_t>(port) << 32 | addr.s_addr;
+        }
+    }
+
+    SocketManager::SocketManager() : SocketManager(options{}) {}
+
+    SocketManager::SocketManager(options opts) : opts(opts),
+        idle(std::make_unique<std::atomic_uint64_t[]>(MAX_ENDPOINTS * opts.max_idle_per_endpoint)) {}
+
+    SocketManager::~SocketManager() {
+        for (std::size_t i = 0; i < MAX_ENDPOINTS * opts.max_idle_per_endpoint; i++) {
+            if (const auto slot = idle[i].exchange(0, std::memory_order_acquire); slot != 0)
+                close(static_cast<int>((slot & 0xFFFFFFFF) - 1));
+        }
+    }
+
+    SocketManager & SocketManager::shared() {
+        static SocketManager manager;
+        return manager;
+    }
+
+    std::uint32_t SocketManager::now_ms() const noexcept {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    std::size_t SocketManager::find_endpoint(std::uint64_t endpoint, bool claim) noexcept {
+        const auto start = std::hash<std::uint64_t>{}(endpoint) % MAX_ENDPOINTS;
+
+        for (std::size_t i = 0; i < MAX_ENDPOINTS; i++) {
+            auto &row = endpoints[(start + i) % MAX_ENDPOINTS];
+            auto owner = row.load(std::memory_order_acquire);
+
+            // rows are never given up, so the probing stops at the first free one
+            if (owner == 0) {
+                if (!claim)
+                    return MAX_ENDPOINTS;
+
+                if (row.compare_exchange_strong(owner, endpoint, std::memory_order_acq_rel))
+                    return (start + i) % MAX_ENDPOINTS;
+            }
+
+            if (owner == endpoint)
+                return (start + i) % MAX_ENDPOINTS;
+        }
+
+        return MAX_ENDPOINTS;
+    }
+
+    bool SocketManager::stale(std::uint64_t slot, std::uint32_t now) const noexcept {
+        // unsigned, so the wrap of the clock after 49 days does not matter
+        if (now - static_cast<std::uint32_t>(slot >> 32) > static_cast<std::uint64_t>(opts.idle_timeout.count()))
+            return true;
+
+        // an idle connection has nothing to read, end of stream or leftovers mean it cannot be used any more
+        char byte;
+        const auto peeked = ::recv(static_cast<int>((slot & 0xFFFFFFFF) - 1), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+        return peeked >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+    }
+
+    int SocketManager::checkout(in_addr addr, unsigned short port) noexcept {
+        const auto row = find_endpoint(endpoint_key(addr, port), false);
+        if (row == MAX_ENDPOINTS)
+            return -1;
+
+        const auto now = now_ms();
+
+        for (std::size_t i = 0; i < opts.max_idle_per_endpoint; i++) {
+            auto &slot = idle[row * opts.max_idle_per_endpoint + i];
+
+            // emptying the slot is what hands the connection to exactly one caller
+            if (slot.load(std::memory_order_relaxed) == 0)
+                continue;
+
+            const auto taken = slot.exchange(0, std::memory_order_acquire);
+            if (taken == 0)
+                continue;
+
+            if (stale(taken, now)) {
+                close(static_cast<int>((taken & 0xFFFFFFFF) - 1));
+                stats.discarded.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            return static_cast<int>((taken & 0xFFFFFFFF) - 1);
+        }
+
+        return -1;
+    }
+
+    void SocketManager::checkin(socket_t &&socket) {
+        socket_t owned = std::move(socket);
+
+        sockaddr_in peer{};
+        socklen_t length = sizeof(peer);
+
+        if (owned->mode != Socket::CONNECT || getpeername(owned->fd, reinterpret_cast<sockaddr *>(&peer), &length) != 0 ||
+            peer.sin_family != AF_INET)
+            return;
+
+        const auto row = find_endpoint(endpoint_key(peer.sin_addr, ntohs(peer.sin_port)), true);
+        if (row == MAX_ENDPOINTS) {
+            stats.discarded.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const int fd = owned->fd;
+        const std::uint64_t packed = static_cast<std::uint64_t>(now_ms()) << 32 | static_cast<std::uint32_t>(fd + 1);
+
+        // the fd belongs to the slot from here on, the socket must not close it
+        owned->fd = -1;
+        owned->mode = Socket::NONE;
+
+        for (std::size_t i = 0; i < opts.max_idle_per_endpoint; i++) {
+            std::uint64_t empty = 0;
+
+            if (idle[row * opts.max_idle_per_endpoint + i].compare_exchange_strong(empty, packed, std::memory_order_release,
+                                                                                  std::memory_order_relaxed))
+                return;
+        }
+
+        close(fd);
+        stats.discarded.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void SocketManager::prune() noexcept {
+        const auto now = now_ms();
+
+        for (std::size_t i = 0; i < MAX_ENDPOINTS * opts.max_idle_per_endpoint; i++) {
+            auto &slot = idle[i];
+
+            if (slot.load(std::memory_order_relaxed) == 0)
+                continue;
+
+            const auto taken = slot.exchange(0, std::memory_order_acquire);
+            if (taken == 0)
+                continue;
+
+            if (stale(taken, now)) {
+                close(static_cast<int>((taken & 0xFFFFFFFF) - 1));
+                stats.discarded.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // put back where it was, or closed if a checkin took the slot in the meantime
+            std::uint64_t empty = 0;
+            if (!slot.compare_exchange_strong(empty, taken, std::memory_order_release, std::memory_order_relaxed)) {
+                close(static_cast<int>((taken & 0xFFFFFFFF) - 1));
+                stats.discarded.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
     SocketManager::socket_t SocketManager::getIPv4TCPSocket(in_addr addr, unsigned short port) {
+        if (const int fd = checkout(addr, port); fd != -1) {
+            stats.reused.fetch_add(1, std::memory_order_relaxed);
+            return pool.acquire(fd, Socket::CONNECT);
+        }
+
         auto tcp = pool.acquire(::socket(AF_INET, SOCK_STREAM, 0), Socket::CONNECT);
         tcp->connect(addr, port);
+        stats.connected.fetch_add(1, std::memory_order_relaxed);
         return std::move(tcp);
     }
 
     task<SocketManager::socket_t> SocketManager::getIPv4TCPSocket_async(in_addr addr,
     unsigned short port) {
+        if (const int fd = checkout(addr, port); fd != -1) {
+            stats.reused.fetch_add(1, std::memory_order_relaxed);
+            co_return pool.acquire(fd, Socket::CONNECT);
+        }
+
         auto tcp = pool.acquire(::socket(AF_INET, SOCK_STREAM, 0), Socket::CONNECT);
         co_await tcp->connect_async(addr, port);
+        stats.connected.fetch_add(1, std::memory_order_relaxed);
         co_return std::move(tcp);
     }
 
@@ -168,7 +336,7 @@ namespace dwhbll::network {
         auto tcp = pool.acquire(i, Socket::LISTEN);
         struct sockaddr_in a = {
             .sin_family = AF_INET,
-            .sin_port   = htons(8080),
+            .sin_port   = htons(port),
             .sin_addr   = { .s_addr = addr }
         };
         ::bind(i, (struct sockaddr *)&a, sizeof(a));
@@ -1,5 +1,11 @@
 #include <dwhbll/network/address.h>
 
+#include <netinet/in.h>
+
+#include <cstring>
+
+#include <dwhbll/console/debug.hpp>
+
 namespace dwhbll::network {
     address::address() : type(EMPTY) {}
 
@@ -36,4 +42,57 @@ namespace dwhbll::network {
         port = other.port;
         return *this;
     }
+
+    namespace conv {
+        socklen_t to_sockaddr(const address &endpoint, sockaddr_storage &out) {
+            out = {};
+
+            switch (endpoint.type) {
+            case address::IPV4: {
+                auto &host = std::get<std::array<std::uint8_t, 4>>(endpoint.host);
+                auto *v4 = reinterpret_cast<sockaddr_in *>(&out);
+                v4->sin_family = AF_INET;
+                std::memcpy(&v4->sin_addr.s_addr, host.data(), host.size());
+                v4->sin_port = htons(endpoint.port);
+                return sizeof(sockaddr_in);
+            }
+            case address::IPV6: {
+                auto &host = std::get<std::array<std::uint16_t, 8>>(endpoint.host);
+                auto *v6 = reinterpret_cast<sockaddr_in6 *>(&out);
+                v6->sin6_family = AF_INET6;
+                for (std::size_t i = 0; i < host.size(); i++) {
+                    v6->sin6_addr.s6_addr[i * 2] = host[i] >> 8;
+                    v6->sin6_addr.s6_addr[i * 2 + 1] = host[i] & 0xFF;
+                }
+                v6->sin6_port = htons(endpoint.port);
+                return sizeof(sockaddr_in6);
+            }
+            case address::DOMAIN:
+                debug::panic("a domain has no socket address, resolve it first.");
+            case address::EMPTY:
+            default:
+                debug::panic("an empty address has no socket address.");
+            }
+        }
+
+        address from_sockaddr(const sockaddr_storage &addr) {
+            switch (addr.ss_family) {
+            case AF_INET: {
+                auto *v4 = reinterpret_cast<const sockaddr_in *>(&addr);
+                std::array<std::uint8_t, 4> host;
+                std::memcpy(host.data(), &v4->sin_addr.s_addr, host.size());
+                return {host, ntohs(v4->sin_port)};
+            }
+            case AF_INET6: {
+                auto *v6 = reinterpret_cast<const sockaddr_in6 *>(&addr);
+                std::array<std::uint16_t, 8> host;
+                for (std::size_t i = 0; i < host.size(); i++)
+                    host[i] = v6->sin6_addr.s6_addr[i * 2] << 8 | v6->sin6_addr.s6_addr[i * 2 + 1];
+                return {host, ntohs(v6->sin6_port)};
+            }
+            default:
+                return {};
+            }
+        }
+    }
 }
@@ -8,52 +8,60 @@ namespace dwhbll::network {
     inbound_network_buffer::inbound_network_buffer(memory::Pool<Socket>::ObjectWrapper &socket) : socket(socket), ParseUtils() {}
 
     void inbound_network_buffer::refill_buffer() {
-        // TODO: zero copy this part in the future
-        std::vector<char> buffer(1024);
+        // straight into the buffer's free space, no bounce buffer
+        auto space = buffer.writable();
+        std::span<char> target{reinterpret_cast<char *>(space.data()), space.size()};
 
-        auto recv_count = socket->read(buffer);
+        auto recv_count = socket->recv(target);
 
-        // TODO: what is this lmao
-        if ((recv_count == -1 && (errno != EAGAIN && errno != EWOULDBLOCK)) || recv_count == 0)
+        // nothing to read yet, the peer closed, or the socket broke: the parser sees an empty buffer either way
+        if (recv_count <= 0)
             return;
 
-        if (recv_count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
-            return;
-
-        buffer.resize(recv_count);
-        write_vector(std::span{*reinterpret_cast<std::vector<sanify::u8> *>(&buffer)});
+        buffer.commit(recv_count);
     }
 
     task<> inbound_network_buffer::refill_buffer_async() {
-        // TODO: zero copy this part in the future
-        std::vector<char> buffer(1024);
+        auto space = buffer.writable();
+        std::span<char> target{reinterpret_cast<char *>(space.data()), space.size()};
 
-        auto recv_count = co_await socket->read_async(buffer);
+        auto recv_count = co_await socket->recv_async(target);
 
-        // TODO: what is this lmao
-        if ((recv_count == -1 && (errno != EAGAIN && errno != EWOULDBLOCK)) || recv_count == 0)
+        if (recv_count.is_err() || recv_count.unwrap_unchecked() == 0)
             co_return;
 
-        if (recv_count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
-            co_return;
+        buffer.commit(recv_count.unwrap_unchecked());
     }
 
     outbound_network_buffer::outbound_network_buffer(memory::Pool<Socket>::ObjectWrapper &socket) : socket(socket) {}
 
     void outbound_network_buffer::flush() {
-        buffer.make_cont();
-
-        socket->send(std::span{reinterpret_cast<char *>(buffer.data().data()), buffer.size()});
-
-        buffer.clear();
+        // segment by segment, in place
+        while (!buffer.empty()) {
+            auto data = buffer.readable();
+            auto sent = socket->send(std::span{reinterpret_cast<char *>(const_cast<sanify::u8 *>(data.data())), data.size()});
+
+            if (sent <= 0) {
+                buffer.clear();
+                return;
+            }
+
+            buffer.consume(sent);
+        }
     }
 
     task<> outbound_network_buffer::flush_async() {
-        buffer.make_cont();
+        while (!buffer.empty()) {
+            auto data = buffer.readable();
+            auto sent = co_await socket->send_async(std::span{reinterpret_cast<char *>(const_cast<sanify::u8 *>(data.data())), data.size()});
 
-        co_await socket->send_async(std::span{reinterpret_cast<char *>(buffer.data().data()), buffer.size()});
+            if (sent.is_err() || sent.unwrap_unchecked() <= 0) {
+                buffer.clear();
+                co_return;
+            }
 
-        buffer.clear();
+            buffer.consume(sent.unwrap_unchecked());
+        }
     }
 
     buffered_socket::buffered_socket() : socket(nullptr, nullptr), inbound(this->socket), outbound(this->socket) {}
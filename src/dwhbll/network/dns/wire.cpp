@@ -0,0 +1,618 @@
+#include <dwhbll/network/dns/wire.h>
+
+#include <algorithm>
+
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/exceptions/rt_exception_base.h>
+
+namespace dwhbll::network::dns {
+    namespace {
+        /// largest offset a compression pointer can hold
+        constexpr std::size_t MAX_POINTER_OFFSET = 0x3FFF;
+
+        std::uint16_t read_u16(std::span<const std::uint8_t> packet, std::size_t pos) noexcept {
+            return packet[pos] << 8 | packet[pos + 1];
+        }
+
+        std::uint32_t read_u32(std::span<const std::uint8_t> packet, std::size_t pos) noexcept {
+            return static_cast<std::uint32_t>(read_u16(packet, pos)) << 16 | read_u16(packet, pos + 2);
+        }
+
+        char lower(char c) noexcept {
+            return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+        }
+
+        bool label_equals(std::string_view lhs, std::string_view rhs) noexcept {
+            return lhs.size() == rhs.size() && std::ranges::equal(lhs, rhs, {}, lower, lower);
+        }
+
+        /**
+         * @brief FNV-1a of every suffix of the lower cased name, in one pass from the back.
+         * @param hashes gets the hash of the suffix starting at each label.
+         * @return the number of labels.
+         */
+        std::size_t suffix_hashes(std::string_view dotted, std::span<std::uint32_t> hashes) noexcept {
+            std::size_t labels = 1 + std::ranges::count(dotted, '.');
+            std::size_t label = labels;
+            std::uint32_t hash = 2166136261u;
+
+            for (std::size_t i = dotted.size(); i-- > 0;) {
+                hash = (hash ^ static_cast<std::uint8_t>(lower(dotted[i]))) * 16777619u;
+
+                if (i == 0 || dotted[i - 1] == '.')
+                    hashes[--label] = hash;
+            }
+
+            return labels;
+        }
+
+        /**
+         * @brief Check the name at `pos` and find where it ends.
+         *
+         * Pointers have to point before the name they were reached from, which rules out loops without counting jumps.
+         * @return the position after the name, where the pointer ends if it is compressed.
+         */
+        std::size_t check_name(std::span<const std::uint8_t> packet, std::size_t pos) {
+            std::size_t end = 0;
+            std::size_t limit = pos;
+            std::size_t length = 1;
+            bool jumped = false;
+
+            while (true) {
+                if (pos >= packet.size())
+                    throw exceptions::rt_exception_base("dns name runs past the end of the message at {}", pos);
+
+                const auto len = packet[pos];
+
+                if ((len & 0xC0) == 0xC0) {
+                    if (pos + 1 >= packet.size())
+                        throw exceptions::rt_exception_base("dns name pointer cut off at {}", pos);
+
+                    const std::size_t target = read_u16(packet, pos) & MAX_POINTER_OFFSET;
+
+                    if (target >= limit)
+                        throw exceptions::rt_exception_base("dns name pointer at {} does not point backwards", pos);
+
+                    if (!jumped)
+                        end = pos + 2;
+
+                    jumped = true;
+                    limit = target;
+                    pos = target;
+                    continue;
+                }
+
+                if ((len & 0xC0) != 0)
+                    throw exceptions::rt_exception_base("dns label type {:#x} is not supported", len & 0xC0);
+
+                if (len == 0)
+                    return jumped ? end : pos + 1;
+
+                length += len + 1;
+                if (length > MAX_NAME_LENGTH)
+                    throw exceptions::rt_exception_base("dns name longer than {} bytes", MAX_NAME_LENGTH);
+
+                pos += 1 + len;
+            }
+        }
+
+        /**
+         * @brief Skip the checked name at `pos`.
+         */
+        std::size_t skip_name(std::span<const std::uint8_t> packet, std::size_t pos) noexcept {
+            while (packet[pos] != 0) {
+                if ((packet[pos] & 0xC0) == 0xC0)
+                    return pos + 2;
+                pos += 1 + packet[pos];
+            }
+            return pos + 1;
+        }
+
+        void require(std::span<const std::uint8_t> packet, std::size_t pos, std::size_t length) {
+            if (pos + length > packet.size())
+                throw exceptions::rt_exception_base("dns message truncated, {} bytes needed at {} of {}", length, pos, packet.size());
+        }
+
+        /**
+         * @brief Check the names inside the rdata of the record types that have them, so reading them cannot fail.
+         */
+        void check_rdata(std::span<const std::uint8_t> packet, QTYPE type, std::size_t start, std::size_t end) {
+            auto inside = [&](std::size_t pos) {
+                if (pos > end)
+                    throw exceptions::rt_exception_base("dns rdata of {} overflows its length", to_string(type));
+                return pos;
+            };
+
+            switch (type) {
+                case QTYPE::A:
+                    if (end - start != 4)
+                        throw exceptions::rt_exception_base("dns A record with {} bytes", end - start);
+                    break;
+                case QTYPE::AAAA:
+                    if (end - start != 16)
+                        throw exceptions::rt_exception_base("dns AAAA record with {} bytes", end - start);
+                    break;
+                case QTYPE::CNAME:
+                case QTYPE::NS:
+                case QTYPE::PTR:
+                    if (inside(check_name(packet, start)) != end)
+                        throw exceptions::rt_exception_base("dns {} record with trailing bytes", to_string(type));
+                    break;
+                case QTYPE::MX:
+                    inside(check_name(packet, inside(start + 2)));
+                    break;
+                case QTYPE::SOA: {
+                    auto pos = inside(check_name(packet, start));
+                    pos = inside(check_name(packet, pos));
+                    inside(pos + 20);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        void write_header(std::span<std::uint8_t> out, const MessageHeader &header) noexcept {
+            std::uint16_t flags = static_cast<std::uint16_t>(header.qr) << 15;
+            flags |= static_cast<std::uint16_t>(header.opcode) << 11;
+            flags |= static_cast<std::uint16_t>(header.aa) << 10;
+            flags |= static_cast<std::uint16_t>(header.tc) << 9;
+            flags |= static_cast<std::uint16_t>(header.rd) << 8;
+            flags |= static_cast<std::uint16_t>(header.ra) << 7;
+            flags |= static_cast<std::uint16_t>(header.z & 0x7) << 4;
+            flags |= static_cast<std::uint16_t>(header.rcode) & 0xF;
+
+            const std::array<std::uint16_t, 6> fields{
+                header.id, flags, header.qdcount, header.ancount, header.nscount, header.arcount
+            };
+
+            for (std::size_t i = 0; i < fields.size(); i++) {
+                out[i * 2] = fields[i] >> 8;
+                out[i * 2 + 1] = fields[i] & 0xFF;
+            }
+        }
+    }
+
+    bool NameView::equals(std::string_view dotted) const noexcept {
+        if (dotted.ends_with('.'))
+            dotted.remove_suffix(1);
+
+        bool same = true;
+        bool exhausted = dotted.empty();
+
+        for_each_label([&](std::string_view label) {
+            if (!same)
+                return;
+
+            // the name goes on where the dotted one ended
+            if (exhausted) {
+                same = false;
+                return;
+            }
+
+            const auto dot = dotted.find('.');
+            same = label_equals(label, dotted.substr(0, dot));
+
+            if (dot == std::string_view::npos)
+                exhausted = true;
+            else
+                dotted.remove_prefix(dot + 1);
+        });
+
+        return same && exhausted;
+    }
+
+    void NameView::append_to(std::string &out) const {
+        const auto start = out.size();
+
+        for_each_label([&](std::string_view label) {
+            out += label;
+            out += '.';
+        });
+
+        if (out.size() == start)
+            out += '.';
+    }
+
+    std::string NameView::to_string() const {
+        std::string result;
+        append_to(result);
+        return result;
+    }
+
+    bool operator==(const NameView &lhs, const NameView &rhs) noexcept {
+        auto pos_l = static_cast<std::size_t>(lhs.offset), pos_r = static_cast<std::size_t>(rhs.offset);
+
+        while (true) {
+            while ((lhs.packet[pos_l] & 0xC0) == 0xC0)
+                pos_l = read_u16(lhs.packet, pos_l) & MAX_POINTER_OFFSET;
+            while ((rhs.packet[pos_r] & 0xC0) == 0xC0)
+                pos_r = read_u16(rhs.packet, pos_r) & MAX_POINTER_OFFSET;
+
+            // the same suffix of the same packet, the rest is equal as well
+            if (pos_l == pos_r && lhs.packet.data() == rhs.packet.data())
+                return true;
+
+            const auto len = lhs.packet[pos_l];
+            if (len != rhs.packet[pos_r])
+                return false;
+
+            if (len == 0)
+                return true;
+
+            const std::string_view label_l(reinterpret_cast<const char *>(lhs.packet.data()) + pos_l + 1, len);
+            const std::string_view label_r(reinterpret_cast<const char *>(rhs.packet.data()) + pos_r + 1, len);
+
+            if (!label_equals(label_l, label_r))
+                return false;
+
+            pos_l += 1 + len;
+            pos_r += 1 + len;
+        }
+    }
+
+    QuestionView QuestionView::read(std::span<const std::uint8_t> packet, std::uint16_t pos, std::uint16_t &next) noexcept {
+        const auto after = skip_name(packet, pos);
+        next = after + 4;
+
+        return {
+            {packet, pos},
+            static_cast<QTYPE>(read_u16(packet, after)),
+            static_cast<QCLASS>(read_u16(packet, after + 2)),
+        };
+    }
+
+    RecordView RecordView::read(std::span<const std::uint8_t> packet, std::uint16_t pos, std::uint16_t &next) noexcept {
+        const auto after = skip_name(packet, pos);
+        const auto rdlength = read_u16(packet, after + 8);
+        next = after + 10 + rdlength;
+
+        return {
+            {packet, pos},
+            static_cast<QTYPE>(read_u16(packet, after)),
+            static_cast<QCLASS>(read_u16(packet, after + 2)),
+            read_u32(packet, after + 4),
+            packet.subspan(after + 10, rdlength),
+            packet,
+        };
+    }
+
+    std::optional<std::array<std::uint8_t, 4>> RecordView::a() const noexcept {
+        if (type != QTYPE::A)
+            return std::nullopt;
+
+        std::array<std::uint8_t, 4> address;
+        std::ranges::copy(rdata, address.begin());
+        return address;
+    }
+
+    std::optional<std::array<std::uint8_t, 16>> RecordView::aaaa() const noexcept {
+        if (type != QTYPE::AAAA)
+            return std::nullopt;
+
+        std::array<std::uint8_t, 16> address;
+        std::ranges::copy(rdata, address.begin());
+        return address;
+    }
+
+    std::optional<NameView> RecordView::target() const noexcept {
+        if (type != QTYPE::CNAME && type != QTYPE::NS && type != QTYPE::PTR)
+            return std::nullopt;
+
+        return NameView{packet, static_cast<std::uint16_t>(rdata.data() - packet.data())};
+    }
+
+    std::optional<SOAView> RecordView::soa() const noexcept {
+        if (type != QTYPE::SOA)
+            return std::nullopt;
+
+        const auto start = static_cast<std::size_t>(rdata.data() - packet.data());
+        const auto rname = skip_name(packet, start);
+        const auto fields = skip_name(packet, rname);
+
+        return SOAView{
+            {packet, static_cast<std::uint16_t>(start)},
+            {packet, static_cast<std::uint16_t>(rname)},
+            read_u32(packet, fields),
+            read_u32(packet, fields + 4),
+            read_u32(packet, fields + 8),
+            read_u32(packet, fields + 12),
+            read_u32(packet, fields + 16),
+        };
+    }
+
+    MessageView::MessageView(std::span<const std::uint8_t> packet) : packet(packet) {
+        if (packet.size() > 0xFFFF)
+            throw exceptions::rt_exception_base("dns message of {} bytes", packet.size());
+
+        require(packet, 0, HEADER_LENGTH);
+
+        const auto flags = read_u16(packet, 2);
+        header_.id = read_u16(packet, 0);
+        header_.qr = flags >> 15 & 0x1;
+        header_.opcode = static_cast<OPCODE>(flags >> 11 & 0xF);
+        header_.aa = flags >> 10 & 0x1;
+        header_.tc = flags >> 9 & 0x1;
+        header_.rd = flags >> 8 & 0x1;
+        header_.ra = flags >> 7 & 0x1;
+        header_.z = flags >> 4 & 0x7;
+        header_.rcode = static_cast<RCODE>(flags & 0xF);
+        header_.qdcount = read_u16(packet, 4);
+        header_.ancount = read_u16(packet, 6);
+        header_.nscount = read_u16(packet, 8);
+        header_.arcount = read_u16(packet, 10);
+
+        std::size_t pos = HEADER_LENGTH;
+        sections[0] = pos;
+
+        for (std::size_t i = 0; i < header_.qdcount; i++) {
+            pos = check_name(packet, pos);
+            require(packet, pos, 4);
+            pos += 4;
+        }
+
+        const std::array<std::uint16_t, 3> counts{header_.ancount, header_.nscount, header_.arcount};
+
+        for (std::size_t section = 0; section < counts.size(); section++) {
+            sections[section + 1] = pos;
+
+            for (std::size_t i = 0; i < counts[section]; i++) {
+                const auto name = pos;
+                pos = check_name(packet, pos);
+                require(packet, pos, 10);
+
+                const auto type = static_cast<QTYPE>(read_u16(packet, pos));
+                const auto rdlength = read_u16(packet, pos + 8);
+
+                // RFC 6891 section 6.1.1, one OPT record for the root in the additional section
+                if (type == QTYPE::OPT) {
+                    if (section != counts.size() - 1 || edns_ || packet[name] != 0)
+                        throw exceptions::rt_exception_base("dns OPT record out of place");
+
+                    edns_ = Edns::unpack(read_u16(packet, pos + 2), read_u32(packet, pos + 4));
+                }
+
+                pos += 10;
+
+                require(packet, pos, rdlength);
+                check_rdata(packet, type, pos, pos + rdlength);
+                pos += rdlength;
+            }
+        }
+    }
+
+    SectionView<QuestionView> MessageView::questions() const noexcept {
+        return {packet, sections[0], header_.qdcount};
+    }
+
+    SectionView<RecordView> MessageView::answers() const noexcept {
+        return {packet, sections[1], header_.ancount};
+    }
+
+    SectionView<RecordView> MessageView::authorities() const noexcept {
+        return {packet, sections[2], header_.nscount};
+    }
+
+    SectionView<RecordView> MessageView::additionals() const noexcept {
+        return {packet, sections[3], header_.arcount};
+    }
+
+    MessageBuilder::MessageBuilder(std::span<std::uint8_t> buffer, const MessageHeader &header) : buffer(buffer),
+        header_(header) {
+        if (buffer.size() < HEADER_LENGTH)
+            debug::panic("a dns message needs at least {} bytes, got {}", HEADER_LENGTH, buffer.size());
+
+        header_.qdcount = header_.ancount = header_.nscount = header_.arcount = 0;
+    }
+
+    bool MessageBuilder::write_u16(std::uint16_t value) noexcept {
+        if (size_ + 2 > buffer.size())
+            return false;
+
+        buffer[size_++] = value >> 8;
+        buffer[size_++] = value & 0xFF;
+        return true;
+    }
+
+    bool MessageBuilder::write_u32(std::uint32_t value) noexcept {
+        return write_u16(value >> 16) && write_u16(value & 0xFFFF);
+    }
+
+    bool MessageBuilder::written_name_equals(std::uint16_t offset, std::string_view dotted) const noexcept {
+        return NameView{std::span<const std::uint8_t>(buffer.data(), size_), offset}.equals(dotted);
+    }
+
+    bool MessageBuilder::write_name(std::string_view dotted) noexcept {
+        if (dotted.ends_with('.'))
+            dotted.remove_suffix(1);
+
+        if (dotted.size() + 2 > MAX_NAME_LENGTH)
+            return false;
+
+        std::array<std::uint32_t, MAX_NAME_LENGTH / 2> hashes;
+        if (!dotted.empty())
+            suffix_hashes(dotted, hashes);
+
+        // the suffixes of this name only become pointer targets once it is complete
+        std::array<compression_target, MAX_NAME_LENGTH / 2> written;
+        std::size_t written_count = 0;
+        bool compressed = false;
+
+        for (std::size_t label_index = 0; !dotted.empty(); label_index++) {
+            const auto hash = hashes[label_index];
+
+            // the longest suffix already written is one pointer
+            const auto known = std::ranges::find_if(targets.begin(), targets.begin() + target_count, [&](const auto &target) {
+                return target.length == dotted.size() && target.hash == hash && written_name_equals(target.offset, dotted);
+            });
+
+            if (known != targets.begin() + target_count) {
+                if (!write_u16(0xC000 | known->offset))
+                    return false;
+
+                compressed = true;
+                break;
+            }
+
+            const auto dot = dotted.find('.');
+            const auto label = dotted.substr(0, dot);
+
+            if (label.empty() || label.size() > 63 || size_ + 1 + label.size() > buffer.size())
+                return false;
+
+            if (size_ <= MAX_POINTER_OFFSET)
+                written[written_count++] = {static_cast<std::uint16_t>(size_), static_cast<std::uint16_t>(dotted.size()), hash};
+
+            buffer[size_++] = label.size();
+            std::ranges::copy(label, buffer.begin() + size_);
+            size_ += label.size();
+
+            dotted = dot == std::string_view::npos ? std::string_view{} : dotted.substr(dot + 1);
+        }
+
+        if (!compressed) {
+            if (size_ + 1 > buffer.size())
+                return false;
+
+            buffer[size_++] = 0;
+        }
+
+        for (std::size_t i = 0; i < written_count && target_count < targets.size(); i++)
+            targets[target_count++] = written[i];
+
+        return true;
+    }
+
+    bool MessageBuilder::enter(SECTION section) {
+        if (section < current)
+            debug::panic("dns message sections must be written in order");
+
+        current = section;
+        return true;
+    }
+
+    void MessageBuilder::rollback(std::size_t size, std::size_t targets) noexcept {
+        size_ = size;
+        target_count = targets;
+    }
+
+    bool MessageBuilder::add_question(std::string_view name, QTYPE type, QCLASS clazz) {
+        enter(SECTION::QUESTION);
+
+        const auto size = size_, targets = target_count;
+
+        if (!write_name(name) || !write_u16(static_cast<std::uint16_t>(type)) || !write_u16(static_cast<std::uint16_t>(clazz))) {
+            rollback(size, targets);
+            return false;
+        }
+
+        header_.qdcount++;
+        return true;
+    }
+
+    std::size_t MessageBuilder::begin_record(SECTION section, std::string_view name, QTYPE type, std::uint32_t ttl, QCLASS clazz) {
+        if (section == SECTION::QUESTION)
+            debug::panic("questions have no records, use add_question");
+
+        enter(section);
+
+        if (!write_name(name) || !write_u16(static_cast<std::uint16_t>(type)) ||
+            !write_u16(static_cast<std::uint16_t>(clazz)) || !write_u32(ttl) || !write_u16(0))
+            return 0;
+
+        return size_ - 2;
+    }
+
+    bool MessageBuilder::end_record(std::size_t length_at) noexcept {
+        const auto rdlength = size_ - length_at - 2;
+
+        if (rdlength > 0xFFFF)
+            return false;
+
+        buffer[length_at] = rdlength >> 8;
+        buffer[length_at + 1] = rdlength & 0xFF;
+
+        switch (current) {
+            case SECTION::ANSWER:
+                header_.ancount++;
+                break;
+            case SECTION::AUTHORITY:
+                header_.nscount++;
+                break;
+            case SECTION::ADDITIONAL:
+                header_.arcount++;
+                break;
+            case SECTION::QUESTION:
+                break;
+        }
+
+        return true;
+    }
+
+    bool MessageBuilder::add_record(SECTION section, std::string_view name, QTYPE type, std::uint32_t ttl,
+                                    std::span<const std::uint8_t> rdata, QCLASS clazz) {
+        const auto size = size_, targets = target_count;
+        const auto length_at = begin_record(section, name, type, ttl, clazz);
+
+        if (length_at == 0 || size_ + rdata.size() > buffer.size()) {
+            rollback(size, targets);
+            return false;
+        }
+
+        std::ranges::copy(rdata, buffer.begin() + size_);
+        size_ += rdata.size();
+
+        if (!end_record(length_at)) {
+            rollback(size, targets);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool MessageBuilder::add_a(SECTION section, std::string_view name, std::uint32_t ttl, std::array<std::uint8_t, 4> address) {
+        return add_record(section, name, QTYPE::A, ttl, address);
+    }
+
+    bool MessageBuilder::add_aaaa(SECTION section, std::string_view name, std::uint32_t ttl, std::array<std::uint8_t, 16> address) {
+        return add_record(section, name, QTYPE::AAAA, ttl, address);
+    }
+
+    bool MessageBuilder::add_name_record(SECTION section, std::string_view name, QTYPE type, std::uint32_t ttl, std::string_view target) {
+        const auto size = size_, targets = target_count;
+        const auto length_at = begin_record(section, name, type, ttl, QCLASS::IN);
+
+        if (length_at == 0 || !write_name(target) || !end_record(length_at)) {
+            rollback(size, targets);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool MessageBuilder::add_soa(SECTION section, std::string_view name, std::uint32_t ttl, std::string_view mname,
+                                 std::string_view rname, std::uint32_t serial, std::uint32_t refresh,
+                                 std::uint32_t retry, std::uint32_t expire, std::uint32_t minimum) {
+        const auto size = size_, targets = target_count;
+        const auto length_at = begin_record(section, name, QTYPE::SOA, ttl, QCLASS::IN);
+
+        if (length_at == 0 || !write_name(mname) || !write_name(rname) || !write_u32(serial) ||
+            !write_u32(refresh) || !write_u32(retry) || !write_u32(expire) || !write_u32(minimum) ||
+            !end_record(length_at)) {
+            rollback(size, targets);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool MessageBuilder::add_edns(const Edns &edns) {
+        return add_record(SECTION::ADDITIONAL, "", QTYPE::OPT, edns.packed_ttl(), {},
+                          static_cast<QCLASS>(edns.udp_payload_size));
+    }
+
+    std::span<const std::uint8_t> MessageBuilder::build() noexcept {
+        write_header(buffer, header_);
+        return {buffer.data(), size_};
+    }
+}
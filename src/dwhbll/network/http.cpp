@@ -8,7 +8,7 @@
 #define CRLF "\r\n"
 
 namespace dwhbll::network {
-    SocketManager HTTP::socketManager{};
+    SocketManager& HTTP::socketManager = SocketManager::shared();
 
     std::string http_response::status_line::to_string() const {
         return std::format("{}: {}, HTTP/{}.{}", status_code, status_info, http_major, http_minor);
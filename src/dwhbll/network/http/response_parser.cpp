@@ -0,0 +1,243 @@
+#include <dwhbll/network/http/response_parser.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <string_view>
+
+namespace dwhbll::network::http {
+    static char lower(char c) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    static std::string_view trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+            value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+            value.remove_suffix(1);
+        return value;
+    }
+
+    /**
+     * @brief Case insensitive search for `token` in a comma separated header value.
+     */
+    static bool has_token(std::string_view value, std::string_view token) {
+        while (!value.empty()) {
+            auto comma = value.find(',');
+            auto item = trim(value.substr(0, comma));
+            value = comma == std::string_view::npos ? std::string_view{} : value.substr(comma + 1);
+
+            if (std::ranges::equal(item, token, [](char a, char b) { return lower(a) == lower(b); }))
+                return true;
+        }
+
+        return false;
+    }
+
+    void response_parser::reset(bool head_request, bool keep_body, std::size_t max_body_size) {
+        response_.status = {};
+        response_.headers.clear();
+        response_.body.clear();
+        state_ = state::HEAD;
+        this->head_request = head_request;
+        this->keep_body = keep_body;
+        this->max_body_size = max_body_size;
+        keep_alive_ = true;
+        remaining = 0;
+        body_size_ = 0;
+        decoder.reset();
+    }
+
+    std::size_t response_parser::parse_head(std::span<const std::uint8_t> in) {
+        const std::string_view text{reinterpret_cast<const char*>(in.data()), in.size()};
+        const auto end = text.find("\r\n\r\n");
+
+        if (end == std::string_view::npos || end > MAX_HEAD_SIZE) {
+            if (in.size() > MAX_HEAD_SIZE)
+                state_ = state::ERROR;
+            return 0;
+        }
+
+        // keep the CRLF of the last field so every line ends the same way
+        auto head = text.substr(0, end + 2);
+
+        const auto status_end = head.find("\r\n");
+        const auto status = head.substr(0, status_end);
+        head.remove_prefix(status_end + 2);
+
+        // HTTP/x.y SSS[ reason]
+        if (status.size() < 12 || !status.starts_with("HTTP/") || status[6] != '.' || status[8] != ' ' ||
+            (status.size() > 12 && status[12] != ' ')) {
+            state_ = state::ERROR;
+            return 0;
+        }
+
+        response_.status.http_major = status[5] - '0';
+        response_.status.http_minor = status[7] - '0';
+
+        if (std::from_chars(status.data() + 9, status.data() + 12, response_.status.status_code).ptr != status.data() + 12) {
+            state_ = state::ERROR;
+            return 0;
+        }
+
+        response_.status.status_info = status.size() > 13 ? status.substr(13) : std::string_view{};
+
+        while (!head.empty()) {
+            const auto line_end = head.find("\r\n");
+            const auto line = head.substr(0, line_end);
+            head.remove_prefix(line_end + 2);
+
+            const auto colon = line.find(':');
+            if (colon == std::string_view::npos || colon == 0) {
+                state_ = state::ERROR;
+                return 0;
+            }
+
+            std::string name(line.substr(0, colon));
+            std::ranges::transform(name, name.begin(), lower);
+            const auto value = trim(line.substr(colon + 1));
+
+            // repeated fields fold into one list (RFC 9110 5.3)
+            auto [it, inserted] = response_.headers.try_emplace(std::move(name), value);
+            if (!inserted) {
+                it->second += ", ";
+                it->second += value;
+            }
+        }
+
+        const std::size_t consumed = end + 4;
+        const auto code = response_.status.status_code;
+
+        // interim responses are skipped, the real one follows
+        if (code >= 100 && code < 200 && code != 101) {
+            response_.status = {};
+            response_.headers.clear();
+            return consumed;
+        }
+
+        const auto field = [this](const std::string& name) -> std::string_view {
+            auto it = response_.headers.find(name);
+            return it == response_.headers.end() ? std::string_view{} : it->second;
+        };
+
+        const auto connection = field("connection");
+        if (response_.status.http_major == 1 && response_.status.http_minor == 0)
+            keep_alive_ = has_token(connection, "keep-alive");
+        else
+            keep_alive_ = !has_token(connection, "close");
+
+        if (head_request || code == 204 || code == 304) {
+            state_ = state::DONE;
+            return consumed;
+        }
+
+        if (const auto encoding = field("transfer-encoding"); !encoding.empty()) {
+            auto last = encoding.substr(encoding.rfind(',') == std::string_view::npos ? 0 : encoding.rfind(',') + 1);
+
+            if (has_token(last, "chunked")) {
+                state_ = state::BODY_CHUNKED;
+                return consumed;
+            }
+
+            // any other coding is delimited by the close
+            keep_alive_ = false;
+            state_ = state::BODY_UNTIL_CLOSE;
+            return consumed;
+        }
+
+        if (const auto length = field("content-length"); !length.empty()) {
+            auto result = std::from_chars(length.data(), length.data() + length.size(), remaining);
+
+            if (result.ec != std::errc() || result.ptr != length.data() + length.size() || remaining > max_body_size) {
+                state_ = state::ERROR;
+                return consumed;
+            }
+
+            if (keep_body)
+                response_.body.reserve(remaining);
+
+            state_ = remaining == 0 ? state::DONE : state::BODY_LENGTH;
+            return consumed;
+        }
+
+        keep_alive_ = false;
+        state_ = state::BODY_UNTIL_CLOSE;
+        return consumed;
+    }
+
+    void response_parser::append_body(std::span<const std::uint8_t> data) {
+        if (body_size_ + data.size() > max_body_size) {
+            state_ = state::ERROR;
+            return;
+        }
+
+        body_size_ += data.size();
+
+        if (keep_body)
+            response_.body.insert(response_.body.end(), data.begin(), data.end());
+    }
+
+    std::size_t response_parser::feed(std::span<const std::uint8_t> in) {
+        std::size_t consumed = 0;
+
+        while (state_ == state::HEAD) {
+            auto count = parse_head(in.subspan(consumed));
+
+            if (count == 0)
+                return consumed;
+
+            consumed += count;
+        }
+
+        in = in.subspan(consumed);
+
+        switch (state_) {
+        case state::BODY_LENGTH: {
+            auto count = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, in.size()));
+            append_body(in.first(count));
+            remaining -= count;
+            consumed += count;
+
+            if (remaining == 0 && state_ != state::ERROR)
+                state_ = state::DONE;
+            break;
+        }
+
+        case state::BODY_CHUNKED: {
+            std::array<std::uint8_t, 4096> scratch;
+
+            while (!in.empty() && !decoder.done() && !decoder.failed() && state_ != state::ERROR) {
+                auto [used, produced] = decoder.decode(std::as_bytes(in), std::as_writable_bytes(std::span{scratch}));
+                append_body(std::span{scratch}.first(produced));
+                in = in.subspan(used);
+                consumed += used;
+            }
+
+            if (decoder.failed())
+                state_ = state::ERROR;
+            else if (decoder.done() && state_ != state::ERROR)
+                state_ = state::DONE;
+            break;
+        }
+
+        case state::BODY_UNTIL_CLOSE:
+            append_body(in);
+            consumed += in.size();
+            break;
+
+        default:
+            break;
+        }
+
+        return consumed;
+    }
+
+    void response_parser::on_close() {
+        keep_alive_ = false;
+
+        if (state_ == state::BODY_UNTIL_CLOSE)
+            state_ = state::DONE;
+        else if (state_ != state::DONE)
+            state_ = state::ERROR;
+    }
+}
@@ -0,0 +1,90 @@
+#include <dwhbll/network/http/serialize.h>
+
+#include <format>
+
+#include <dwhbll/console/debug.hpp>
+
+namespace dwhbll::network::http {
+    std::string_view method_name(HTTP_METHOD method) {
+        switch (method) {
+        case HTTP_METHOD::CONNECT:
+            return "CONNECT";
+        case HTTP_METHOD::DELETE:
+            return "DELETE";
+        case HTTP_METHOD::GET:
+            return "GET";
+        case HTTP_METHOD::HEAD:
+            return "HEAD";
+        case HTTP_METHOD::OPTIONS:
+            return "OPTIONS";
+        case HTTP_METHOD::PATCH:
+            return "PATCH";
+        case HTTP_METHOD::POST:
+            return "POST";
+        case HTTP_METHOD::PUT:
+            return "PUT";
+        case HTTP_METHOD::TRACE:
+            return "TRACE";
+        }
+
+        debug::unreachable();
+    }
+
+    std::string host_field(const address &endpoint) {
+        std::string host;
+
+        switch (endpoint.type) {
+        case address::DOMAIN:
+            host = std::get<std::string>(endpoint.host);
+            break;
+        case address::IPV4: {
+            auto &v4 = std::get<std::array<std::uint8_t, 4>>(endpoint.host);
+            host = std::format("{}.{}.{}.{}", v4[0], v4[1], v4[2], v4[3]);
+            break;
+        }
+        case address::IPV6: {
+            auto &v6 = std::get<std::array<std::uint16_t, 8>>(endpoint.host);
+            host = std::format("[{:x}:{:x}:{:x}:{:x}:{:x}:{:x}:{:x}:{:x}]", v6[0], v6[1], v6[2], v6[3], v6[4], v6[5], v6[6], v6[7]);
+            break;
+        }
+        case address::EMPTY:
+            debug::panic("cannot send http requests to an empty address");
+        }
+
+        if (endpoint.port != 80)
+            host += std::format(":{}", endpoint.port);
+
+        return host;
+    }
+
+    void serialize_request(const http_request &request, std::string_view host, std::string &out) {
+        out += method_name(request.method);
+        out += ' ';
+        out += request.path.empty() ? "/" : request.path;
+        out += " HTTP/1.1\r\n";
+
+        bool has_host = false;
+        for (const auto &[key, value] : request.headers) {
+            has_host |= key.size() == 4 && (key[0] | 0x20) == 'h' && (key[1] | 0x20) == 'o' && (key[2] | 0x20) == 's' &&
+                        (key[3] | 0x20) == 't';
+
+            out += key;
+            out += ": ";
+            out += value;
+            out += "\r\n";
+        }
+
+        if (!has_host) {
+            out += "host: ";
+            out += host;
+            out += "\r\n";
+        }
+
+        if (!request.body.empty() || request.method == HTTP_METHOD::POST || request.method == HTTP_METHOD::PUT ||
+            request.method == HTTP_METHOD::PATCH)
+            out += std::format("content-length: {}\r\n", request.body.size());
+
+        out += "\r\n";
+        out.append(request.body.begin(), request.body.end());
+    }
+}
@@ -0,0 +1,182 @@
+#include <dwhbll/network/http_server/admission.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace dwhbll::network::http_server {
+bool TokenBucket::take(double rate, double burst,
+                       std::chrono::steady_clock::time_point now) noexcept {
+  const std::chrono::duration<double> elapsed = now - last;
+  tokens = std::min(burst, tokens + rate * elapsed.count());
+  last = now;
+
+  if (tokens < 1) {
+    return false;
+  }
+
+  tokens -= 1;
+  return true;
+}
+
+bool TokenBucket::full(double rate, double burst,
+                       std::chrono::steady_clock::time_point now) const noexcept {
+  const std::chrono::duration<double> elapsed = now - last;
+  return tokens + rate * elapsed.count() >= burst;
+}
+
+std::size_t ClientRateLimiter::AddressHash::operator()(
+    const Address &address) const noexcept {
+  return std::hash<std::string_view>{}(
+      {reinterpret_cast<const char *>(address.data()), address.size()});
+}
+
+ClientRateLimiter::ClientRateLimiter(double rate, double burst,
+                                     std::size_t max_clients)
+    : rate(rate), burst(std::max(burst, 1.0)),
+      max_clients_per_shard(std::max<std::size_t>(max_clients / SHARDS, 1)) {}
+
+bool ClientRateLimiter::admit(std::span<const std::byte> address,
+                              std::chrono::steady_clock::time_point now) {
+  if (address.empty()) {
+    return true;
+  }
+
+  Address key{};
+  std::copy_n(address.begin(), std::min(address.size(), key.size()),
+              key.begin());
+
+  const std::size_t hash = AddressHash{}(key);
+  Shard &shard = shards[hash % SHARDS];
+  std::lock_guard guard(shard.lock);
+
+  auto it = shard.buckets.find(key);
+
+  if (it == shard.buckets.end()) {
+    if (shard.buckets.size() >= max_clients_per_shard) {
+      std::erase_if(shard.buckets, [&](const auto &entry) {
+        return entry.second.full(rate, burst, now);
+      });
+    }
+
+    if (shard.buckets.size() >= max_clients_per_shard) {
+      return true;
+    }
+
+    it = shard.buckets.try_emplace(key, burst, now).first;
+  }
+
+  return it->second.take(rate, burst, now);
+}
+
+std::chrono::steady_clock::time_point
+CoDel::control_law(std::chrono::steady_clock::time_point t) const noexcept {
+  return t + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                 interval / std::sqrt(static_cast<double>(count)));
+}
+
+bool CoDel::should_drop(std::chrono::steady_clock::duration sojourn,
+                        std::chrono::steady_clock::time_point now) noexcept {
+  bool ok_to_drop = false;
+
+  if (sojourn < target) {
+    first_above = {};
+  } else if (first_above == std::chrono::steady_clock::time_point{}) {
+    first_above = now + interval;
+  } else if (now >= first_above) {
+    ok_to_drop = true;
+  }
+
+  if (dropping_) {
+    if (!ok_to_drop) {
+      dropping_ = false;
+      return false;
+    }
+
+    if (now < drop_next) {
+      return false;
+    }
+
+    count++;
+    drop_next = control_law(drop_next);
+    return true;
+  }
+
+  if (!ok_to_drop) {
+    return false;
+  }
+
+  dropping_ = true;
+
+  // coming back soon after the last drop state resumes near its drop rate
+  const std::uint32_t delta = count - last_count;
+  count = delta > 1 && now - drop_next < 16 * interval ? delta : 1;
+  drop_next = control_law(now);
+  last_count = count;
+  return true;
+}
+
+void Admission::configure(const Options &options) {
+  this->options = options;
+
+  in_flight = options.max_in_flight == 0
+                  ? nullptr
+                  : std::make_unique<ConcurrencyLimit>(options.max_in_flight);
+
+  clients = options.client_rate == 0
+                ? nullptr
+                : std::make_unique<ClientRateLimiter>(options.client_rate,
+                                                      options.client_burst);
+}
+
+void Admission::limit_route(std::size_t route, std::size_t max_in_flight) {
+  if (routes.size() <= route) {
+    routes.resize(route + 1);
+  }
+
+  routes[route] = max_in_flight == 0
+                      ? nullptr
+                      : std::make_unique<ConcurrencyLimit>(max_in_flight);
+}
+
+Admission::Verdict Admission::admit(CoDel &shedder,
+                                    std::chrono::steady_clock::duration sojourn,
+                                    std::span<const std::byte> client) {
+  if (!clients && !sheds() && !in_flight) {
+    return Verdict::ADMIT;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+
+  if (clients && !clients->admit(client, now)) {
+    return Verdict::RATE_LIMITED;
+  }
+
+  if (sheds() && shedder.should_drop(sojourn, now)) {
+    return Verdict::OVERLOADED;
+  }
+
+  if (in_flight && !in_flight->try_acquire()) {
+    return Verdict::OVERLOADED;
+  }
+
+  return Verdict::ADMIT;
+}
+
+void Admission::release() noexcept {
+  if (in_flight) {
+    in_flight->release();
+  }
+}
+
+bool Admission::enter_route(std::size_t route) noexcept {
+  return route >= routes.size() || !routes[route] ||
+         routes[route]->try_acquire();
+}
+
+void Admission::leave_route(std::size_t route) noexcept {
+  if (route < routes.size() && routes[route]) {
+    routes[route]->release();
+  }
+}
+} // namespace dwhbll::network::http_server
@@ -0,0 +1,137 @@
+#include <dwhbll/network/http_server/chunked.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace dwhbll::network::http_server {
+static int hex_value(const char c) noexcept {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+ChunkedDecoder::Result ChunkedDecoder::decode(std::span<const std::byte> in,
+                                              std::span<std::byte> out) noexcept {
+  std::size_t consumed = 0, produced = 0;
+
+  while (consumed < in.size() && state != State::DONE &&
+         state != State::ERROR) {
+    if (state == State::DATA) {
+      const std::size_t count =
+          std::min<std::uint64_t>({remaining, in.size() - consumed,
+                                   out.size() - produced});
+
+      // caller has no room left, keep the data for the next call
+      if (count == 0)
+        break;
+
+      std::memcpy(out.data() + produced, in.data() + consumed, count);
+      consumed += count;
+      produced += count;
+      remaining -= count;
+
+      if (remaining == 0)
+        state = State::DATA_CR;
+      continue;
+    }
+
+    const char c = static_cast<char>(in[consumed++]);
+
+    switch (state) {
+    case State::SIZE_START:
+    case State::SIZE: {
+      const int digit = hex_value(c);
+
+      if (digit >= 0) {
+        // refuse sizes that would not fit, nobody sends 2^60 byte chunks
+        if (remaining >> 60) {
+          state = State::ERROR;
+          break;
+        }
+        remaining = remaining << 4 | digit;
+        state = State::SIZE;
+      } else if (state == State::SIZE_START) {
+        state = State::ERROR;
+      } else if (c == '\r') {
+        state = State::SIZE_LF;
+      } else if (c == ';' || c == ' ' || c == '\t') {
+        state = State::EXTENSION;
+      } else {
+        state = State::ERROR;
+      }
+      break;
+    }
+
+    case State::EXTENSION:
+      if (c == '\r')
+        state = State::SIZE_LF;
+      break;
+
+    case State::SIZE_LF:
+      if (c != '\n')
+        state = State::ERROR;
+      else if (remaining == 0)
+        state = State::TRAILER_START;
+      else
+        state = State::DATA;
+      break;
+
+    case State::DATA_CR:
+      state = c == '\r' ? State::DATA_LF : State::ERROR;
+      break;
+
+    case State::DATA_LF:
+      state = c == '\n' ? State::SIZE_START : State::ERROR;
+      break;
+
+    case State::TRAILER_START:
+      state = c == '\r' ? State::FINAL_LF : State::TRAILER;
+      break;
+
+    case State::TRAILER:
+      if (c == '\r')
+        state = State::TRAILER_LF;
+      break;
+
+    case State::TRAILER_LF:
+      state = c == '\n' ? State::TRAILER_START : State::ERROR;
+      break;
+
+    case State::FINAL_LF:
+      state = c == '\n' ? State::DONE : State::ERROR;
+      break;
+
+    default:
+      state = State::ERROR;
+      break;
+    }
+  }
+
+  return {consumed, produced};
+}
+
+std::size_t encode_chunk_header(std::uint64_t size,
+                                std::span<char, MAX_CHUNK_HEADER> out) noexcept {
+  constexpr char digits[] = "0123456789abcdef";
+
+  char reversed[16];
+  std::size_t length = 0;
+
+  do {
+    reversed[length++] = digits[size & 0xF];
+    size >>= 4;
+  } while (size != 0);
+
+  for (std::size_t i = 0; i < length; i++)
+    out[i] = reversed[length - i - 1];
+
+  out[length++] = '\r';
+  out[length++] = '\n';
+
+  return length;
+}
+} // namespace dwhbll::network::http_server
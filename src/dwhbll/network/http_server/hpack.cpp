@@ -0,0 +1,513 @@
+#include <dwhbll/network/http_server/hpack.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace dwhbll::network::http_server::hpack {
+struct StaticEntry {
+  std::string_view name;
+  std::string_view value;
+};
+
+static constexpr std::array<StaticEntry, STATIC_TABLE_LENGTH> STATIC_TABLE = {{
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},}};
+
+struct HuffmanCode {
+  std::uint32_t code;
+  std::uint8_t length;
+};
+
+/// RFC 7541 appendix B, indexed by symbol, 256 is EOS
+static constexpr std::array<HuffmanCode, 257> HUFFMAN_CODES = {{
+    {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28},
+    {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+    {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+    {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+    {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+    {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+    {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28},
+    {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+    {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+    {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11},
+    {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11},
+    {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+    {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6},
+    {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6},
+    {0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8},
+    {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10},
+    {0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7},
+    {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+    {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7},
+    {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7},
+    {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7},
+    {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7},
+    {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13},
+    {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+    {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5},
+    {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6},
+    {0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7},
+    {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5},
+    {0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5},
+    {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+    {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15},
+    {0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28},
+    {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+    {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23},
+    {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23},
+    {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+    {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23},
+    {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23},
+    {0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23},
+    {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+    {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22},
+    {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+    {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24},
+    {0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23},
+    {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21},
+    {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23},
+    {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22},
+    {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+    {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19},
+    {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25},
+    {0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27},
+    {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+    {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27},
+    {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+    {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26},
+    {0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27},
+    {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21},
+    {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23},
+    {0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25},
+    {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+    {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26},
+    {0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+    {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+    {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26},
+    {0x3fffffff, 30},
+}};
+
+/**
+ * @brief What canonical decoding needs: the code is canonical, so the codes of
+ * one length are consecutive and ordered like their symbols.
+ */
+struct HuffmanDecodeTable {
+  /// symbols ordered by code
+  std::array<std::uint16_t, 257> symbols{};
+  /// first code of each length
+  std::array<std::uint32_t, 31> first{};
+  /// position of that code in `symbols`
+  std::array<std::uint16_t, 31> offset{};
+  /// the code after the last one of each length, left justified in 32 bits
+  std::array<std::uint64_t, 31> limit{};
+};
+
+static constexpr HuffmanDecodeTable make_decode_table() {
+  HuffmanDecodeTable table;
+  std::size_t count = 0;
+
+  for (std::uint8_t length = 1; length <= 30; length++) {
+    table.offset[length] = count;
+    table.limit[length] = table.limit[length - 1];
+
+    for (std::uint16_t symbol = 0; symbol < HUFFMAN_CODES.size(); symbol++) {
+      if (HUFFMAN_CODES[symbol].length != length)
+        continue;
+
+      if (count == table.offset[length])
+        table.first[length] = HUFFMAN_CODES[symbol].code;
+
+      table.symbols[count++] = symbol;
+      table.limit[length] = static_cast<std::uint64_t>(HUFFMAN_CODES[symbol].code + 1) << (32 - length);
+    }
+  }
+
+  return table;
+}
+
+static constexpr HuffmanDecodeTable HUFFMAN_DECODE = make_decode_table();
+
+static constexpr std::uint16_t HUFFMAN_EOS = 256;
+
+void encode_integer(std::uint64_t value, unsigned prefix_bits,
+                    std::uint8_t flags, std::vector<std::byte> &out) {
+  const std::uint64_t max = (1u << prefix_bits) - 1;
+
+  if (value < max) {
+    out.push_back(static_cast<std::byte>(flags | value));
+    return;
+  }
+
+  out.push_back(static_cast<std::byte>(flags | max));
+  value -= max;
+
+  while (value >= 128) {
+    out.push_back(static_cast<std::byte>(value % 128 + 128));
+    value /= 128;
+  }
+
+  out.push_back(static_cast<std::byte>(value));
+}
+
+bool decode_integer(std::span<const std::byte> in, std::size_t &pos,
+                    unsigned prefix_bits, std::uint64_t &value) noexcept {
+  if (pos >= in.size())
+    return false;
+
+  const std::uint64_t max = (1u << prefix_bits) - 1;
+  value = static_cast<std::uint8_t>(in[pos++]) & max;
+
+  if (value < max)
+    return true;
+
+  for (unsigned shift = 0; shift <= 28; shift += 7) {
+    if (pos >= in.size())
+      return false;
+
+    const auto next = static_cast<std::uint8_t>(in[pos++]);
+    value += static_cast<std::uint64_t>(next & 0x7F) << shift;
+
+    if (value > std::numeric_limits<std::uint32_t>::max())
+      return false;
+
+    if ((next & 0x80) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+std::size_t huffman_encoded_size(std::string_view text) noexcept {
+  std::size_t bits = 0;
+  for (const char c : text)
+    bits += HUFFMAN_CODES[static_cast<std::uint8_t>(c)].length;
+
+  return (bits + 7) / 8;
+}
+
+void huffman_encode(std::string_view text, std::vector<std::byte> &out) {
+  std::uint64_t bits = 0;
+  unsigned count = 0;
+
+  for (const char c : text) {
+    const auto &code = HUFFMAN_CODES[static_cast<std::uint8_t>(c)];
+    bits = bits << code.length | code.code;
+    count += code.length;
+
+    while (count >= 8) {
+      count -= 8;
+      out.push_back(static_cast<std::byte>(bits >> count));
+    }
+
+    bits &= (std::uint64_t{1} << count) - 1;
+  }
+
+  if (count != 0)
+    out.push_back(static_cast<std::byte>(bits << (8 - count) | 0xFF >> count));
+}
+
+bool huffman_decode(std::span<const std::byte> in, std::string &out) {
+  std::uint64_t bits = 0;
+  unsigned count = 0;
+  std::size_t pos = 0;
+
+  while (true) {
+    // a code is at most 30 bits, so past that one is always complete
+    while (count < 30 && pos < in.size()) {
+      bits = bits << 8 | static_cast<std::uint8_t>(in[pos++]);
+      count += 8;
+    }
+
+    const auto window = static_cast<std::uint32_t>(count >= 32 ? bits >> (count - 32) : bits << (32 - count));
+
+    std::uint8_t length = 5;
+    while (length <= 30 && window >= HUFFMAN_DECODE.limit[length])
+      length++;
+
+    if (length > count)
+      break;
+
+    const std::uint16_t symbol =
+        HUFFMAN_DECODE.symbols[HUFFMAN_DECODE.offset[length] + (window >> (32 - length)) - HUFFMAN_DECODE.first[length]];
+
+    if (symbol == HUFFMAN_EOS)
+      return false;
+
+    out.push_back(static_cast<char>(symbol));
+    count -= length;
+    bits &= (std::uint64_t{1} << count) - 1;
+  }
+
+  // whatever is left is padding, the most significant bits of EOS
+  return count <= 7 && bits == (std::uint64_t{1} << count) - 1;
+}
+
+void DynamicTable::evict(std::size_t room) noexcept {
+  while (!entries.empty() && size_ + room > max_size_) {
+    size_ -= entries.back().size();
+    entries.pop_back();
+  }
+}
+
+void DynamicTable::add(std::string_view name, std::string_view value) {
+  // copied first, the name may point into an entry about to be evicted
+  HeaderField field{std::string(name), std::string(value)};
+  const std::size_t size = field.size();
+
+  if (size > max_size_) {
+    entries.clear();
+    size_ = 0;
+    return;
+  }
+
+  evict(size);
+  entries.push_front(std::move(field));
+  size_ += size;
+}
+
+void DynamicTable::set_max_size(std::size_t size) noexcept {
+  max_size_ = size;
+  evict(0);
+}
+
+bool Decoder::lookup(std::uint64_t index, std::string_view &name,
+                     std::string_view &value) const noexcept {
+  if (index == 0)
+    return false;
+
+  if (index <= STATIC_TABLE_LENGTH) {
+    name = STATIC_TABLE[index - 1].name;
+    value = STATIC_TABLE[index - 1].value;
+    return true;
+  }
+
+  index -= STATIC_TABLE_LENGTH + 1;
+  if (index >= table.count())
+    return false;
+
+  name = table[index].name;
+  value = table[index].value;
+  return true;
+}
+
+bool Decoder::read_string(std::span<const std::byte> block, std::size_t &pos,
+                          std::string &out) {
+  if (pos >= block.size())
+    return false;
+
+  const bool huffman = static_cast<std::uint8_t>(block[pos]) & 0x80;
+  std::uint64_t length;
+
+  if (!decode_integer(block, pos, 7, length) || length > block.size() - pos)
+    return false;
+
+  const auto data = block.subspan(pos, length);
+  pos += length;
+
+  if (huffman)
+    return huffman_decode(data, out);
+
+  out.append(reinterpret_cast<const char *>(data.data()), data.size());
+  return true;
+}
+
+bool Decoder::decode(std::span<const std::byte> block,
+                     std::vector<HeaderField> &out, std::size_t max_list_size) {
+  out.clear();
+  std::size_t pos = 0, list_size = 0;
+
+  while (pos < block.size()) {
+    const auto first = static_cast<std::uint8_t>(block[pos]);
+    std::uint64_t index;
+
+    // dynamic table size update, only allowed before the first field
+    if ((first & 0xE0) == 0x20) {
+      if (!out.empty() || !decode_integer(block, pos, 5, index) || index > size_limit)
+        return false;
+
+      table.set_max_size(index);
+      continue;
+    }
+
+    std::string_view name, value;
+    HeaderField &field = out.emplace_back();
+
+    if (first & 0x80) {
+      // indexed field
+      if (!decode_integer(block, pos, 7, index) || !lookup(index, name, value))
+        return false;
+
+      field.name = name;
+      field.value = value;
+    } else {
+      // literal, with incremental indexing, without, or never indexed
+      const bool indexing = (first & 0xC0) == 0x40;
+
+      if (!decode_integer(block, pos, indexing ? 6 : 4, index))
+        return false;
+
+      if (index != 0) {
+        if (!lookup(index, name, value))
+          return false;
+        field.name = name;
+      } else if (!read_string(block, pos, field.name)) {
+        return false;
+      }
+
+      if (!read_string(block, pos, field.value))
+        return false;
+
+      if (indexing)
+        table.add(field.name, field.value);
+    }
+
+    list_size += field.size();
+    if (list_size > max_list_size)
+      return false;
+  }
+
+  return true;
+}
+
+void Encoder::write_string(std::string_view text, std::vector<std::byte> &out) {
+  const std::size_t huffman = huffman_encoded_size(text);
+
+  if (huffman < text.size()) {
+    encode_integer(huffman, 7, 0x80, out);
+    huffman_encode(text, out);
+    return;
+  }
+
+  encode_integer(text.size(), 7, 0x00, out);
+  const auto bytes = std::as_bytes(std::span{text.data(), text.size()});
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+void Encoder::set_max_table_size(std::size_t size) {
+  // a larger table than the default only costs this side memory
+  size = std::min(size, DEFAULT_TABLE_SIZE);
+
+  smallest_update = update_pending ? std::min(smallest_update, size) : size;
+  pending_update = size;
+  update_pending = true;
+}
+
+void Encoder::begin(std::vector<std::byte> &out) {
+  if (!update_pending)
+    return;
+
+  // a shrink in between has to be signalled too, the peer evicted for it
+  if (smallest_update < table.max_size()) {
+    encode_integer(smallest_update, 5, 0x20, out);
+    table.set_max_size(smallest_update);
+  }
+
+  if (pending_update != table.max_size()) {
+    encode_integer(pending_update, 5, 0x20, out);
+    table.set_max_size(pending_update);
+  }
+
+  update_pending = false;
+}
+
+void Encoder::encode(std::string_view name, std::string_view value,
+                     std::vector<std::byte> &out, bool index) {
+  std::size_t name_index = 0;
+
+  for (std::size_t i = 0; i < STATIC_TABLE.size(); i++) {
+    if (STATIC_TABLE[i].name != name)
+      continue;
+
+    if (STATIC_TABLE[i].value == value) {
+      encode_integer(i + 1, 7, 0x80, out);
+      return;
+    }
+
+    if (name_index == 0)
+      name_index = i + 1;
+  }
+
+  for (std::size_t i = 0; i < table.count(); i++) {
+    if (table[i].name != name)
+      continue;
+
+    if (table[i].value == value) {
+      encode_integer(STATIC_TABLE_LENGTH + 1 + i, 7, 0x80, out);
+      return;
+    }
+
+    if (name_index == 0)
+      name_index = STATIC_TABLE_LENGTH + 1 + i;
+  }
+
+  encode_integer(name_index, index ? 6 : 4, index ? 0x40 : 0x00, out);
+
+  if (name_index == 0)
+    write_string(name, out);
+
+  write_string(value, out);
+
+  if (index)
+    table.add(name, value);
+}
+} // namespace dwhbll::network::http_server::hpack
@@ -0,0 +1,91 @@
+#include <dwhbll/network/http_server/serializer.h>
+
+#include <algorithm>
+#include <charconv>
+
+namespace dwhbll::network::http_server {
+static char *write_two_digits(char *out, int value) {
+  *out++ = static_cast<char>('0' + value / 10);
+  *out++ = static_cast<char>('0' + value % 10);
+  return out;
+}
+
+void format_http_date(std::time_t time, std::span<char, HTTP_DATE_LENGTH> out) {
+  // strftime would follow the locale, the header has to be in english
+  constexpr std::string_view days[] = {"Sun", "Mon", "Tue", "Wed",
+                                       "Thu", "Fri", "Sat"};
+  constexpr std::string_view months[] = {"Jan", "Feb", "Mar", "Apr",
+                                         "May", "Jun", "Jul", "Aug",
+                                         "Sep", "Oct", "Nov", "Dec"};
+
+  std::tm parts;
+  ::gmtime_r(&time, &parts);
+
+  char *cursor = out.data();
+  const auto put = [&cursor](std::string_view text) {
+    cursor = std::copy(text.begin(), text.end(), cursor);
+  };
+
+  put(days[parts.tm_wday]);
+  put(", ");
+  cursor = write_two_digits(cursor, parts.tm_mday);
+  put(" ");
+  put(months[parts.tm_mon]);
+  put(" ");
+  const int year = parts.tm_year + 1900;
+  cursor = write_two_digits(cursor, year / 100 % 100);
+  cursor = write_two_digits(cursor, year % 100);
+  put(" ");
+  cursor = write_two_digits(cursor, parts.tm_hour);
+  put(":");
+  cursor = write_two_digits(cursor, parts.tm_min);
+  put(":");
+  cursor = write_two_digits(cursor, parts.tm_sec);
+  put(" GMT");
+}
+
+std::string_view DateCache::get() {
+  const std::time_t now = std::time(nullptr);
+
+  if (now == current) {
+    return {line.data(), length};
+  }
+
+  constexpr std::string_view prefix = "date: ";
+  std::copy(prefix.begin(), prefix.end(), line.begin());
+  format_http_date(
+      now, std::span<char, HTTP_DATE_LENGTH>{line.data() + prefix.size(),
+                                             HTTP_DATE_LENGTH});
+  line[prefix.size() + HTTP_DATE_LENGTH] = '\r';
+  line[prefix.size() + HTTP_DATE_LENGTH + 1] = '\n';
+
+  length = prefix.size() + HTTP_DATE_LENGTH + 2;
+  current = now;
+
+  return {line.data(), length};
+}
+
+void HeaderArena::status_line(std::string_view code, std::string_view reason) {
+  append("HTTP/1.1 ");
+  append(code);
+  append(" ");
+  append(reason);
+  append("\r\n");
+}
+
+void HeaderArena::field(std::string_view name, std::string_view value) {
+  append(name);
+  append(": ");
+  append(value);
+  append("\r\n");
+}
+
+void HeaderArena::content_length(std::uint64_t length) {
+  std::array<char, 20> digits;
+  auto result = std::to_chars(digits.begin(), digits.end(), length);
+
+  append("content-length: ");
+  append({digits.data(), static_cast<std::size_t>(result.ptr - digits.data())});
+  append("\r\n");
+}
+} // namespace dwhbll::network::http_server
@@ -0,0 +1,382 @@
+#include <dwhbll/network/http_server/static_files.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <array>
+#include <charconv>
+
+#include <dwhbll/network/http_server/serializer.h>
+
+namespace dwhbll::network::http_server {
+static std::string_view content_type_of(std::string_view path) {
+  constexpr std::pair<std::string_view, std::string_view> types[] = {
+      {".html", "text/html; charset=utf-8"},
+      {".htm", "text/html; charset=utf-8"},
+      {".css", "text/css; charset=utf-8"},
+      {".js", "text/javascript; charset=utf-8"},
+      {".mjs", "text/javascript; charset=utf-8"},
+      {".json", "application/json"},
+      {".txt", "text/plain; charset=utf-8"},
+      {".xml", "application/xml"},
+      {".svg", "image/svg+xml"},
+      {".png", "image/png"},
+      {".jpg", "image/jpeg"},
+      {".jpeg", "image/jpeg"},
+      {".gif", "image/gif"},
+      {".webp", "image/webp"},
+      {".ico", "image/x-icon"},
+      {".wasm", "application/wasm"},
+      {".woff", "font/woff"},
+      {".woff2", "font/woff2"},
+      {".pdf", "application/pdf"},
+  };
+
+  const auto dot = path.rfind('.');
+
+  if (dot != std::string_view::npos && path.find('/', dot) == std::string_view::npos) {
+    const auto extension = path.substr(dot);
+
+    for (const auto &[suffix, type] : types) {
+      if (extension == suffix) {
+        return type;
+      }
+    }
+  }
+
+  return "application/octet-stream";
+}
+
+static std::string hex(std::uint64_t value) {
+  std::array<char, 16> digits;
+  auto result = std::to_chars(digits.begin(), digits.end(), value, 16);
+  return {digits.data(), result.ptr};
+}
+
+static std::shared_ptr<const OpenFile> open_file(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (fd == -1) {
+    return nullptr;
+  }
+
+  auto file = std::make_shared<OpenFile>();
+  file->fd = fd;
+
+  struct stat info;
+  if (::fstat(fd, &info) == -1 || !S_ISREG(info.st_mode)) {
+    return nullptr;
+  }
+
+  file->size = info.st_size;
+  file->modified = info.st_mtim.tv_sec;
+  file->device = info.st_dev;
+  file->inode = info.st_ino;
+  // same shape as nginx: "<mtime>-<size>"
+  file->etag = '"' + hex(file->modified) + '-' + hex(file->size) + '"';
+
+  std::array<char, HTTP_DATE_LENGTH> date;
+  format_http_date(file->modified, date);
+  file->last_modified.assign(date.data(), date.size());
+
+  file->content_type = content_type_of(path);
+
+  return file;
+}
+
+FileCache::FileCache(std::size_t capacity,
+                     std::chrono::steady_clock::duration validity)
+    : capacity(capacity), validity(validity) {}
+
+void FileCache::insert(const std::string &path,
+                       std::shared_ptr<const OpenFile> file,
+                       std::chrono::steady_clock::time_point now) {
+  if (auto it = index.find(path); it != index.end()) {
+    it->second->file = std::move(file);
+    it->second->checked = now;
+    entries.splice(entries.begin(), entries, it->second);
+    return;
+  }
+
+  entries.push_front({path, std::move(file), now});
+  index.emplace(entries.front().path, entries.begin());
+
+  while (entries.size() > capacity) {
+    index.erase(entries.back().path);
+    entries.pop_back();
+  }
+}
+
+void FileCache::erase(const std::string &path) {
+  if (auto it = index.find(path); it != index.end()) {
+    auto entry = it->second;
+    index.erase(it);
+    entries.erase(entry);
+  }
+}
+
+std::shared_ptr<const OpenFile> FileCache::open(const std::string &path) {
+  const auto now = std::chrono::steady_clock::now();
+  std::shared_ptr<const OpenFile> cached;
+
+  {
+    std::lock_guard guard(lock);
+
+    if (auto it = index.find(path); it != index.end()) {
+      entries.splice(entries.begin(), entries, it->second);
+
+      if (now - it->second->checked < validity) {
+        return it->second->file;
+      }
+
+      cached = it->second->file;
+    }
+  }
+
+  // the syscalls run unlocked, racing executors at worst open the file twice
+  if (cached) {
+    struct stat info;
+
+    if (::stat(path.c_str(), &info) == -1 || !S_ISREG(info.st_mode)) {
+      std::lock_guard guard(lock);
+      erase(path);
+      return nullptr;
+    }
+
+    if (info.st_ino == cached->inode && info.st_dev == cached->device &&
+        static_cast<std::uint64_t>(info.st_size) == cached->size &&
+        info.st_mtim.tv_sec == cached->modified) {
+      std::lock_guard guard(lock);
+      insert(path, cached, now);
+      return cached;
+    }
+  }
+
+  auto file = open_file(path);
+
+  std::lock_guard guard(lock);
+
+  if (!file) {
+    erase(path);
+    return nullptr;
+  }
+
+  insert(path, file, now);
+  return file;
+}
+
+std::size_t FileCache::size() {
+  std::lock_guard guard(lock);
+  return entries.size();
+}
+
+RangeStatus parse_range(std::string_view header, std::uint64_t size,
+                        ByteRange &range) {
+  constexpr std::string_view unit = "bytes=";
+
+  if (!header.starts_with(unit) || header.find(',') != std::string_view::npos) {
+    return RangeStatus::IGNORED;
+  }
+
+  header.remove_prefix(unit.size());
+
+  const auto dash = header.find('-');
+  if (dash == std::string_view::npos) {
+    return RangeStatus::IGNORED;
+  }
+
+  const auto first_text = header.substr(0, dash);
+  const auto last_text = header.substr(dash + 1);
+
+  const auto parse = [](std::string_view text, std::uint64_t &value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && result.ec == std::errc() &&
+           result.ptr == text.data() + text.size();
+  };
+
+  std::uint64_t first, last;
+
+  if (first_text.empty()) {
+    // suffix range, the last n bytes
+    if (!parse(last_text, last)) {
+      return RangeStatus::IGNORED;
+    }
+
+    if (last == 0 || size == 0) {
+      return RangeStatus::UNSATISFIABLE;
+    }
+
+    last = std::min(last, size);
+    range = {size - last, last};
+    return RangeStatus::SATISFIABLE;
+  }
+
+  if (!parse(first_text, first)) {
+    return RangeStatus::IGNORED;
+  }
+
+  if (last_text.empty()) {
+    last = size - 1;
+  } else if (!parse(last_text, last) || last < first) {
+    return RangeStatus::IGNORED;
+  }
+
+  if (first >= size) {
+    return RangeStatus::UNSATISFIABLE;
+  }
+
+  last = std::min(last, size - 1);
+  range = {first, last - first + 1};
+  return RangeStatus::SATISFIABLE;
+}
+
+static bool etag_matches(std::string_view list, std::string_view etag) {
+  while (!list.empty()) {
+    const auto comma = list.find(',');
+    auto candidate = list.substr(0, comma);
+    list = comma == std::string_view::npos ? std::string_view{}
+                                           : list.substr(comma + 1);
+
+    candidate.remove_prefix(
+        std::min(candidate.find_first_not_of(' '), candidate.size()));
+    candidate = candidate.substr(0, candidate.find_last_not_of(' ') + 1);
+
+    // If-None-Match uses the weak comparison
+    if (candidate.starts_with("W/")) {
+      candidate.remove_prefix(2);
+    }
+
+    if (candidate == "*" || candidate == etag) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static std::string_view field_of(const Request &request,
+                                 const std::string &name) {
+  auto it = request.fields.find(name);
+  return it == request.fields.end() ? std::string_view{} : it->second;
+}
+
+StaticFiles::StaticFiles(const std::filesystem::path &root,
+                         std::size_t cache_capacity)
+    : root(std::filesystem::absolute(root).lexically_normal().string()),
+      cache(cache_capacity) {
+  while (this->root.size() > 1 && this->root.back() == '/') {
+    this->root.pop_back();
+  }
+}
+
+void StaticFiles::serve(const Request &request, Response &response,
+                        std::string_view relative) {
+  if (request.method != http::HTTP_METHOD::GET &&
+      request.method != http::HTTP_METHOD::HEAD) {
+    response.code = "405";
+    response.reason = "Method Not Allowed";
+    response.fields.emplace("allow", "GET, HEAD");
+    return;
+  }
+
+  std::string path = root;
+  path.reserve(root.size() + relative.size() + 11);
+
+  {
+    std::string_view rest = relative;
+
+    while (!rest.empty()) {
+      const auto slash = rest.find('/');
+      const auto segment = rest.substr(0, slash);
+      rest = slash == std::string_view::npos ? std::string_view{}
+                                             : rest.substr(slash + 1);
+
+      if (segment.empty() || segment == ".") {
+        continue;
+      }
+
+      if (segment == ".." || segment.find('\0') != std::string_view::npos) {
+        response.code = "404";
+        response.reason = "Not Found";
+        return;
+      }
+
+      path.push_back('/');
+      path.append(segment);
+    }
+  }
+
+  if (relative.empty() || relative.back() == '/') {
+    path.append("/index.html");
+  }
+
+  auto file = cache.open(path);
+
+  if (!file) {
+    response.code = "404";
+    response.reason = "Not Found";
+    return;
+  }
+
+  response.fields.emplace("etag", file->etag);
+  response.fields.emplace("last-modified", file->last_modified);
+  response.fields.emplace("accept-ranges", "bytes");
+  response.fields.emplace("content-type", file->content_type);
+
+  // If-None-Match takes precedence over If-Modified-Since (RFC 9110 13.2.2)
+  if (auto none_match = field_of(request, "if-none-match");
+      !none_match.empty()) {
+    if (etag_matches(none_match, file->etag)) {
+      response.code = "304";
+      response.reason = "Not Modified";
+      return;
+    }
+  } else if (field_of(request, "if-modified-since") == file->last_modified) {
+    response.code = "304";
+    response.reason = "Not Modified";
+    return;
+  }
+
+  response.file = file;
+  response.file_offset = 0;
+  response.file_length = file->size;
+  response.code = "200";
+  response.reason = "OK";
+
+  const auto range_field = field_of(request, "range");
+  const auto if_range = field_of(request, "if-range");
+
+  if (range_field.empty() ||
+      (!if_range.empty() && if_range != file->etag &&
+       if_range != file->last_modified)) {
+    return;
+  }
+
+  ByteRange range;
+  switch (parse_range(range_field, file->size, range)) {
+  case RangeStatus::IGNORED:
+    break;
+
+  case RangeStatus::SATISFIABLE:
+    response.code = "206";
+    response.reason = "Partial Content";
+    response.file_offset = range.first;
+    response.file_length = range.length;
+    response.fields.emplace("content-range",
+                            std::format("bytes {}-{}/{}", range.first,
+                                        range.first + range.length - 1,
+                                        file->size));
+    break;
+
+  case RangeStatus::UNSATISFIABLE:
+    response.code = "416";
+    response.reason = "Range Not Satisfiable";
+    response.file.reset();
+    response.file_length = 0;
+    response.fields.erase("content-type");
+    response.fields.emplace("content-range",
+                            std::format("bytes */{}", file->size));
+    break;
+  }
+}
+} // namespace dwhbll::network::http_server
@@ -0,0 +1,215 @@
+#include <dwhbll/network/http_server/websocket.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <dwhbll/cryptography/hash/SHA1.h>
+
+namespace dwhbll::network::http_server::websocket {
+static bool known_opcode(const std::uint8_t opcode) noexcept {
+  switch (static_cast<Opcode>(opcode)) {
+  case Opcode::CONTINUATION:
+  case Opcode::TEXT:
+  case Opcode::BINARY:
+  case Opcode::CLOSE:
+  case Opcode::PING:
+  case Opcode::PONG:
+    return true;
+  }
+
+  return false;
+}
+
+FrameHeader::Status FrameHeader::parse(std::span<const std::byte> in,
+                                       std::size_t &size) noexcept {
+  if (in.size() < 2)
+    return Status::INCOMPLETE;
+
+  const auto first = static_cast<std::uint8_t>(in[0]);
+  const auto second = static_cast<std::uint8_t>(in[1]);
+
+  // no extension is ever negotiated, so the reserved bits stay clear
+  if ((first & 0x70) != 0 || !known_opcode(first & 0x0F))
+    return Status::MALFORMED;
+
+  fin = first & 0x80;
+  opcode = static_cast<Opcode>(first & 0x0F);
+  masked = second & 0x80;
+
+  const std::uint8_t short_length = second & 0x7F;
+  const std::size_t length_size =
+      short_length == 126 ? 2 : short_length == 127 ? 8 : 0;
+  size = 2 + length_size + (masked ? 4 : 0);
+
+  if (in.size() < size)
+    return Status::INCOMPLETE;
+
+  if (length_size == 0) {
+    length = short_length;
+  } else {
+    length = 0;
+    for (std::size_t i = 0; i < length_size; i++)
+      length = length << 8 | static_cast<std::uint8_t>(in[2 + i]);
+
+    // the most significant bit of a 64-bit length must be 0
+    if (length >> 63)
+      return Status::MALFORMED;
+  }
+
+  if (is_control(opcode) && (!fin || length > MAX_CONTROL_PAYLOAD))
+    return Status::MALFORMED;
+
+  if (masked)
+    std::copy_n(in.begin() + 2 + length_size, 4, mask.begin());
+
+  return Status::DONE;
+}
+
+std::size_t
+FrameHeader::encode(std::span<std::byte, MAX_FRAME_HEADER> out) const noexcept {
+  std::size_t size = 0;
+  out[size++] = static_cast<std::byte>((fin ? 0x80 : 0) |
+                                       static_cast<std::uint8_t>(opcode));
+
+  const std::byte mask_bit{masked ? std::uint8_t{0x80} : std::uint8_t{0}};
+
+  if (length < 126) {
+    out[size++] = mask_bit | static_cast<std::byte>(length);
+  } else if (length <= 0xFFFF) {
+    out[size++] = mask_bit | std::byte{126};
+    out[size++] = static_cast<std::byte>(length >> 8);
+    out[size++] = static_cast<std::byte>(length);
+  } else {
+    out[size++] = mask_bit | std::byte{127};
+    for (int shift = 56; shift >= 0; shift -= 8)
+      out[size++] = static_cast<std::byte>(length >> shift);
+  }
+
+  if (masked) {
+    std::copy(mask.begin(), mask.end(), out.begin() + size);
+    size += 4;
+  }
+
+  return size;
+}
+
+void apply_mask(std::span<std::byte> data, std::array<std::byte, 4> mask,
+                std::size_t offset) noexcept {
+  // the key as it lines up with the first byte of `data`, every block below
+  // is a multiple of 4 bytes long so it stays lined up
+  std::array<std::uint8_t, 4> key;
+  for (std::size_t i = 0; i < 4; i++)
+    key[i] = static_cast<std::uint8_t>(mask[(offset + i) % 4]);
+
+  std::uint32_t key32;
+  std::memcpy(&key32, key.data(), sizeof(key32));
+
+  auto *bytes = reinterpret_cast<std::uint8_t *>(data.data());
+  const std::size_t size = data.size();
+  std::size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i key256 = _mm256_set1_epi32(static_cast<int>(key32));
+  for (; i + 32 <= size; i += 32) {
+    auto *block = reinterpret_cast<__m256i *>(bytes + i);
+    _mm256_storeu_si256(block, _mm256_xor_si256(_mm256_loadu_si256(block), key256));
+  }
+#endif
+
+#if defined(__SSE2__)
+  const __m128i key128 = _mm_set1_epi32(static_cast<int>(key32));
+  for (; i + 16 <= size; i += 16) {
+    auto *block = reinterpret_cast<__m128i *>(bytes + i);
+    _mm_storeu_si128(block, _mm_xor_si128(_mm_loadu_si128(block), key128));
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t key128 = vreinterpretq_u8_u32(vdupq_n_u32(key32));
+  for (; i + 16 <= size; i += 16)
+    vst1q_u8(bytes + i, veorq_u8(vld1q_u8(bytes + i), key128));
+#endif
+
+  const std::uint64_t key64 = static_cast<std::uint64_t>(key32) << 32 | key32;
+  for (; i + 8 <= size; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    word ^= key64;
+    std::memcpy(bytes + i, &word, sizeof(word));
+  }
+
+  for (; i < size; i++)
+    bytes[i] ^= key[i % 4];
+}
+
+void apply_mask_scalar(std::span<std::byte> data, std::array<std::byte, 4> mask,
+                       std::size_t offset) noexcept {
+  for (std::size_t i = 0; i < data.size(); i++)
+    data[i] ^= mask[(offset + i) % 4];
+}
+
+static constexpr std::string_view ACCEPT_GUID =
+    "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static constexpr std::string_view BASE64_ALPHABET =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string accept_key(std::string_view key) {
+  cryptography::SHA1 sha1;
+  sha1.update({reinterpret_cast<const std::uint8_t *>(key.data()), key.size()});
+  sha1.update({reinterpret_cast<const std::uint8_t *>(ACCEPT_GUID.data()),
+               ACCEPT_GUID.size()});
+
+  std::array<std::uint8_t, cryptography::SHA1::HLEN> digest;
+  sha1.finalize(digest);
+
+  // 20 bytes are six full groups of three and one group of two
+  std::string out;
+  out.reserve(28);
+
+  for (std::size_t i = 0; i < digest.size(); i += 3) {
+    const std::size_t left = digest.size() - i;
+    const std::uint32_t group = digest[i] << 16 |
+                                (left > 1 ? digest[i + 1] << 8 : 0) |
+                                (left > 2 ? digest[i + 2] : 0);
+
+    out.push_back(BASE64_ALPHABET[group >> 18 & 0x3F]);
+    out.push_back(BASE64_ALPHABET[group >> 12 & 0x3F]);
+    out.push_back(left > 1 ? BASE64_ALPHABET[group >> 6 & 0x3F] : '=');
+    out.push_back(left > 2 ? BASE64_ALPHABET[group & 0x3F] : '=');
+  }
+
+  return out;
+}
+
+Frame::Frame(Opcode opcode, std::span<const std::byte> payload, bool fin) {
+  FrameHeader header;
+  header.fin = fin;
+  header.opcode = opcode;
+  header.length = payload.size();
+
+  std::array<std::byte, MAX_FRAME_HEADER> encoded;
+  const std::size_t size = header.encode(encoded);
+
+  data.reserve(size + payload.size());
+  data.insert(data.end(), encoded.begin(), encoded.begin() + size);
+  data.insert(data.end(), payload.begin(), payload.end());
+}
+
+Frame Frame::close(CloseCode code, std::string_view reason) {
+  std::array<std::byte, MAX_CONTROL_PAYLOAD> payload;
+  const auto status = static_cast<std::uint16_t>(code);
+  payload[0] = static_cast<std::byte>(status >> 8);
+  payload[1] = static_cast<std::byte>(status);
+
+  const std::size_t length = std::min(reason.size(), payload.size() - 2);
+  const auto text = std::as_bytes(std::span{reason.data(), length});
+  std::copy(text.begin(), text.end(), payload.begin() + 2);
+
+  return {Opcode::CLOSE, std::span<const std::byte>{payload.data(), length + 2}};
+}
+} // namespace dwhbll::network::http_server::websocket
@@ -0,0 +1,116 @@
+#include <dwhbll/utils/latency_histogram.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+
+#include <dwhbll/console/debug.hpp>
+
+namespace dwhbll::utils {
+    latency_histogram::latency_histogram(std::uint64_t highest_trackable, int significant_digits)
+        : highest_trackable(highest_trackable) {
+        if (significant_digits < 1 || significant_digits > 5)
+            debug::panic("latency_histogram keeps 1 to 5 significant digits, not {}", significant_digits);
+
+        // every value below 2 * 10^digits must get its own sub-bucket
+        std::uint64_t single_unit = 2;
+        for (int i = 0; i < significant_digits; i++)
+            single_unit *= 10;
+
+        sub_bucket_bits = std::bit_width(single_unit - 1);
+        sub_bucket_half = std::uint64_t{1} << (sub_bucket_bits - 1);
+
+        if (highest_trackable < (std::uint64_t{1} << sub_bucket_bits))
+            debug::panic("latency_histogram needs a highest trackable value of at least {}", std::uint64_t{1} << sub_bucket_bits);
+
+        counts.resize(index_of(highest_trackable) + 1);
+    }
+
+    std::size_t latency_histogram::index_of(std::uint64_t value) const noexcept {
+        if (value < sub_bucket_half * 2)
+            return value;
+
+        // bucket `shift` holds [half << shift, half << (shift + 1)) in `half` steps of 1 << shift
+        const unsigned shift = std::bit_width(value) - sub_bucket_bits;
+        return shift * sub_bucket_half + (value >> shift);
+    }
+
+    std::uint64_t latency_histogram::lowest_of(std::size_t index) const noexcept {
+        if (index < sub_bucket_half * 2)
+            return index;
+
+        const std::uint64_t shift = index / sub_bucket_half - 1;
+        return (index - shift * sub_bucket_half) << shift;
+    }
+
+    void latency_histogram::record(std::uint64_t value, std::uint64_t count) noexcept {
+        value = std::min(value, highest_trackable);
+
+        counts[index_of(value)] += count;
+        total += count;
+        sum += static_cast<long double>(value) * count;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void latency_histogram::merge(const latency_histogram &other) {
+        if (other.counts.size() != counts.size() || other.sub_bucket_bits != sub_bucket_bits)
+            debug::panic("cannot merge latency histograms built with different parameters");
+
+        for (std::size_t i = 0; i < counts.size(); i++)
+            counts[i] += other.counts[i];
+
+        total += other.total;
+        sum += other.sum;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void latency_histogram::reset() noexcept {
+        std::ranges::fill(counts, 0);
+        total = 0;
+        sum = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+
+    double latency_histogram::mean() const noexcept {
+        return total == 0 ? 0.0 : static_cast<double>(sum / total);
+    }
+
+    std::uint64_t latency_histogram::value_at(double percentile) const noexcept {
+        if (total == 0)
+            return 0;
+
+        percentile = std::clamp(percentile, 0.0, 100.0);
+
+        const auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * total)));
+        std::uint64_t seen = 0;
+
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+
+            if (seen >= target)
+                return std::clamp(lowest_of(i + 1) - 1, min_, max_);
+        }
+
+        return max_;
+    }
+
+    std::string latency_histogram::summary(std::uint64_t scale, std::string_view unit) const {
+        const auto scaled = [&](double value) {
+            return value / static_cast<double>(scale);
+        };
+
+        return std::format("count={} mean={:.2f}{} p50={:.2f}{} p90={:.2f}{} p99={:.2f}{} p99.9={:.2f}{} max={:.2f}{}",
+            total,
+            scaled(mean()), unit,
+            scaled(value_at(50.0)), unit,
+            scaled(value_at(90.0)), unit,
+            scaled(value_at(99.0)), unit,
+            scaled(value_at(99.9)), unit,
+            scaled(max_), unit
+        );
+    }
+}
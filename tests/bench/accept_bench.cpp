@@ -0,0 +1,146 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dwhbll/async/net/listener_group.h>
+#include <dwhbll/async/net/tcp_listener.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/address.h>
+
+using dwhbll::async::net::listener_group;
+using dwhbll::async::net::tcp_listener;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::task;
+
+namespace {
+    constexpr auto duration = std::chrono::seconds(2);
+
+    struct alignas(64) counter {
+        std::atomic<std::size_t> value{0};
+    };
+
+    /**
+     * @brief Connect and reset from `clients` threads until the time is up.
+     */
+    void hammer(const dwhbll::network::address &target, std::size_t clients) {
+        sockaddr_storage addr;
+        const auto addrlen = dwhbll::network::conv::to_sockaddr(target, addr);
+        const auto deadline = std::chrono::steady_clock::now() + duration;
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < clients; i++) {
+            threads.emplace_back([&] {
+                // closing with a zero linger resets, so no TIME_WAIT eats the ephemeral ports
+                const linger reset{1, 0};
+
+                while (std::chrono::steady_clock::now() < deadline) {
+                    auto fd = ::socket(addr.ss_family, SOCK_STREAM, 0);
+                    setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+                    ::connect(fd, reinterpret_cast<sockaddr *>(&addr), addrlen);
+                    ::close(fd);
+                }
+            });
+        }
+
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    std::string spread(const std::vector<counter> &counters) {
+        std::string out;
+        for (auto &c : counters)
+            out += std::to_string(c.value.load()) + " ";
+        return out;
+    }
+
+    std::size_t total(const std::vector<counter> &counters) {
+        std::size_t sum = 0;
+        for (auto &c : counters)
+            sum += c.value.load();
+        return sum;
+    }
+
+    task<> shared_accept(const tcp_listener &listener, const std::atomic_bool &running, counter &accepted) {
+        while (running) {
+            auto sock = co_await listener.accept();
+
+            if (sock.is_ok())
+                accepted.value++;
+        }
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool accept_bench(std::optional<std::string> _) {
+    const std::size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    const std::size_t clients = threads * 2;
+
+    // every reactor accepts from the same queue
+    {
+        tcp_listener listener;
+        listener.set_reuseaddr();
+
+        if (listener.listen(dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 8093)).is_err())
+            dwhbll::debug::panic("[Accept] cannot listen on port 8093");
+
+        std::atomic_bool running{true};
+        std::vector<counter> counters(threads);
+        std::vector<std::thread> workers;
+
+        for (std::size_t i = 0; i < threads; i++) {
+            workers.emplace_back([&, i] {
+                reactor r;
+                r.spawn(shared_accept(listener, running, counters[i]));
+                r.run();
+            });
+        }
+
+        hammer(dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 8093), clients);
+
+        running = false;
+        listener.stop_accepting();
+        for (auto &worker : workers)
+            worker.join();
+
+        dwhbll::console::info("[Accept] shared listener, {} threads: {} accepts/s, per thread {}", threads,
+                              total(counters) / std::chrono::seconds(duration).count(), spread(counters));
+    }
+
+    // one SO_REUSEPORT listener per reactor, hashed and then steered by cpu
+    for (bool steer : {false, true}) {
+        std::vector<counter> counters(threads);
+        std::atomic<std::size_t> next{0};
+
+        listener_group group({.threads = threads, .steer_by_cpu = steer});
+
+        if (group.listen(dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 8094)).is_err())
+            dwhbll::debug::panic("[Accept] cannot listen on port 8094");
+
+        group.start([&](std::unique_ptr<dwhbll::async::net::socket> sock) -> task<> {
+            // one listener per thread, numbered by the first connection each one accepts
+            thread_local const std::size_t index = next++ % counters.size();
+            counters[index].value++;
+            co_return;
+        });
+
+        hammer(dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 8094), clients);
+        group.stop();
+
+        dwhbll::console::info("[Accept] listener group{}, {} threads: {} accepts/s, per thread {}",
+                              steer ? " with cpu steering" : "", threads,
+                              total(counters) / std::chrono::seconds(duration).count(), spread(counters));
+    }
+
+    return false;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+/**
+ * Timing shared by the collection benches.
+ */
+namespace bench_timing {
+    /**
+     * @brief Run `f` once.
+     * @return the nanoseconds it took, divided by `count`.
+     */
+    template <typename F>
+    double nanos_each(std::size_t count, F&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    }
+}
@@ -0,0 +1,120 @@
+#include "bench_timing.h"
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <dwhbll/collections/btree.h>
+#include <dwhbll/collections/sorted_linked_list.h>
+#include <dwhbll/console/Logging.h>
+
+namespace {
+    using bench_timing::nanos_each;
+
+    std::vector<std::uint64_t> shuffled(std::size_t count, std::uint64_t seed) {
+        std::vector<std::uint64_t> keys(count);
+        std::mt19937_64 rng(seed);
+        for (auto& key : keys)
+            key = rng();
+        return keys;
+    }
+
+    /**
+     * @brief Insert `keys` in their order, then walk the container in order.
+     */
+    template <typename Sorted>
+    void fill_and_walk(const char* what, const std::vector<std::uint64_t>& keys) {
+        Sorted sorted;
+        std::uint64_t sum = 0;
+
+        const auto insert = nanos_each(keys.size(), [&] {
+            for (const auto key : keys)
+                sorted.insert(key);
+        });
+
+        const auto walk = nanos_each(keys.size(), [&] {
+            for (const auto key : sorted)
+                sum += key;
+        });
+
+        dwhbll::console::info("[BTree] {}: insert {:.1f} ns, iterate {:.2f} ns ({})", what, insert, walk, sum & 1);
+    }
+
+    /**
+     * @brief Insert `keys`, look them and `absent` up, walk the set, then erase `keys`.
+     */
+    template <typename Set>
+    void run(const char* what, const std::vector<std::uint64_t>& keys, const std::vector<std::uint64_t>& absent) {
+        Set set;
+        std::uint64_t found = 0;
+
+        const auto insert = nanos_each(keys.size(), [&] {
+            for (const auto key : keys)
+                set.insert(key);
+        });
+
+        const auto hit = nanos_each(keys.size(), [&] {
+            for (const auto key : keys)
+                found += set.find(key) != set.end();
+        });
+
+        const auto miss = nanos_each(absent.size(), [&] {
+            for (const auto key : absent)
+                found += set.find(key) != set.end();
+        });
+
+        const auto walk = nanos_each(keys.size(), [&] {
+            for (const auto key : set)
+                found += key & 1;
+        });
+
+        const auto erase = nanos_each(keys.size(), [&] {
+            for (const auto key : keys)
+                found += set.erase(key);
+        });
+
+        dwhbll::console::info("[BTree] {}: insert {:.1f} ns, hit {:.1f} ns, miss {:.1f} ns, iterate {:.2f} ns, "
+                              "erase {:.1f} ns ({})", what, insert, hit, miss, walk, erase, found);
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool btree_bench(std::optional<std::string> _) {
+    // every sorted insert walks the list, so it only gets a small share
+    constexpr std::size_t few = 1 << 14;
+    const auto small = shuffled(few, 1);
+
+    dwhbll::console::info("[BTree] {} random keys, time per key", few);
+    fill_and_walk<dwhbll::collections::SortedLinkedList<std::uint64_t>>("SortedLinkedList", small);
+    fill_and_walk<std::multiset<std::uint64_t>>("std::multiset", small);
+    fill_and_walk<dwhbll::collections::btree_multiset<std::uint64_t>>("btree_multiset", small);
+
+    constexpr std::size_t many = 1 << 20;
+    const auto keys = shuffled(many, 2), absent = shuffled(many, 3);
+
+    dwhbll::console::info("[BTree] {} random keys, time per key", many);
+    run<std::set<std::uint64_t>>("std::set", keys, absent);
+    run<dwhbll::collections::btree_set<std::uint64_t>>("btree_set", keys, absent);
+
+    // building from sorted input against inserting it in order
+    std::vector<std::uint64_t> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+
+    const auto one_by_one = nanos_each(many, [&] {
+        dwhbll::collections::btree_set<std::uint64_t> set;
+        for (const auto key : sorted)
+            set.insert(key);
+    });
+
+    const auto bulk = nanos_each(many, [&] {
+        dwhbll::collections::btree_set<std::uint64_t> set(dwhbll::collections::sorted_input, sorted.begin(),
+                                                          sorted.end());
+    });
+
+    dwhbll::console::info("[BTree] from sorted input: inserting {:.1f} ns, bulk load {:.1f} ns", one_by_one, bulk);
+
+    return false;
+}
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <dwhbll/collections/cache.h>
+#include <dwhbll/console/Logging.h>
+
+namespace {
+    constexpr std::size_t keys = 1 << 18;
+    constexpr std::size_t capacity = keys / 16;
+    constexpr std::size_t lookups = 1 << 21;
+
+    /**
+     * @brief Draw `count` keys from a Zipfian distribution with exponent `s`, key 0 the most popular.
+     */
+    std::vector<std::uint64_t> zipfian(std::size_t count, double s, std::uint64_t seed) {
+        std::vector<double> cdf(keys);
+        double sum = 0;
+        for (std::size_t i = 0; i < keys; i++)
+            cdf[i] = sum += 1 / std::pow(static_cast<double>(i + 1), s);
+
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> uniform(0, sum);
+
+        // scattered, so that popular keys do not all hash next to each other
+        std::vector<std::uint64_t> drawn(count);
+        for (auto& key : drawn)
+            key = (std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin()) * 0x9e3779b97f4a7c15ULL;
+
+        return drawn;
+    }
+
+    /**
+     * @brief What the cache replaced, an LRU behind one lock.
+     */
+    class locked_lru {
+        std::mutex lock;
+        std::list<std::pair<std::uint64_t, std::uint64_t>> order;
+        std::unordered_map<std::uint64_t, decltype(order)::iterator> index;
+
+    public:
+        std::optional<std::uint64_t> findEntry(std::uint64_t key) {
+            std::unique_lock _(lock);
+            auto found = index.find(key);
+            if (found == index.end())
+                return std::nullopt;
+            order.splice(order.begin(), order, found->second);
+            return found->second->second;
+        }
+
+        void addEntry(std::uint64_t key, std::uint64_t value) {
+            std::unique_lock _(lock);
+            if (index.contains(key))
+                return;
+            order.emplace_front(key, value);
+            index.emplace(key, order.begin());
+            if (order.size() > capacity) {
+                index.erase(order.back().first);
+                order.pop_back();
+            }
+        }
+    };
+
+    struct result {
+        double mops;
+        double hit_ratio;
+    };
+
+    /**
+     * @brief Look up every drawn key, loading it on a miss, from `threads` threads at once.
+     */
+    template <typename Cache>
+    result run(Cache& cache, const std::vector<std::vector<std::uint64_t>>& streams, std::size_t threads) {
+        std::vector<std::thread> workers;
+        std::vector<std::uint64_t> hits(threads);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                for (const auto key : streams[t]) {
+                    if (cache.findEntry(key))
+                        hits[t]++;
+                    else
+                        cache.addEntry(key, key);
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::uint64_t total = 0;
+        for (const auto h : hits)
+            total += h;
+
+        return {threads * lookups / elapsed / 1e6, static_cast<double>(total) / (threads * lookups)};
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool cache_bench(std::optional<std::string> _) {
+    const std::size_t most = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::vector<std::uint64_t>> streams;
+    for (std::size_t t = 0; t < most; t++)
+        streams.push_back(zipfian(lookups, 0.99, t + 1));
+
+    dwhbll::console::info("[Cache] {} keys drawn Zipfian (s = 0.99), {} entries cached", keys, capacity);
+
+    for (std::size_t threads = 1; threads <= most; threads *= 2) {
+        locked_lru lru;
+        dwhbll::collections::cache<std::uint64_t, std::uint64_t> one_lock(capacity, 1);
+        dwhbll::collections::cache<std::uint64_t, std::uint64_t> sharded(capacity);
+
+        const auto a = run(lru, streams, threads);
+        const auto b = run(one_lock, streams, threads);
+        const auto c = run(sharded, streams, threads);
+
+        dwhbll::console::info("[Cache] {} threads: locked LRU {:.1f} Mops/s hit {:.3f}, TinyLFU one shard {:.1f} Mops/s "
+                              "hit {:.3f}, TinyLFU {} shards {:.1f} Mops/s hit {:.3f}", threads, a.mops, a.hit_ratio,
+                              b.mops, b.hit_ratio, sharded.shard_count(), c.mops, c.hit_ratio);
+
+        if (threads < most && threads * 2 > most)
+            threads = most / 2;
+    }
+
+    // expiry costs what expires, however long the entries that stay are kept
+    constexpr std::size_t expiring = 1 << 20;
+    dwhbll::collections::cache<std::uint64_t, std::uint64_t> timed(2 * expiring);
+    const auto now = std::chrono::system_clock::now();
+
+    for (std::uint64_t i = 0; i < expiring; i++) {
+        timed.addEntry(now + std::chrono::milliseconds(2000 + i % 300), i, i);
+        timed.addEntry(now + std::chrono::hours(1), expiring + i, i);
+    }
+
+    std::this_thread::sleep_until(now + std::chrono::milliseconds(2400));
+
+    // writes reclaim some of them already while filling
+    const auto before = timed.stats().expirations;
+    const auto start = std::chrono::steady_clock::now();
+    timed.cleanUp();
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto expired = timed.stats().expirations - before;
+
+    dwhbll::console::info("[Cache] clean up expired {} of {} entries in {:.1f} ms, {:.0f} ns each", expired,
+                          timed.size() + expired, elapsed * 1e3, elapsed * 1e9 / std::max<std::uint64_t>(expired, 1));
+
+    return false;
+}
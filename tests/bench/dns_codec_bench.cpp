@@ -0,0 +1,79 @@
+#include <array>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/dns/dns.h>
+#include <dwhbll/network/dns/wire.h>
+
+namespace dns = dwhbll::network::dns;
+
+namespace {
+    constexpr std::size_t messages = 1000000;
+
+    const dns::MessageHeader header{0x1234, true, dns::OPCODE::QUERY, false, false, true, true, 0, dns::RCODE::NONE, 0, 0, 0, 0};
+
+    /**
+     * @brief A typical resolver answer, a CNAME to a CDN name with four addresses.
+     */
+    std::span<const std::uint8_t> build(std::span<std::uint8_t> buffer) {
+        using SECTION = dns::MessageBuilder::SECTION;
+
+        dns::MessageBuilder builder(buffer, header);
+        bool ok = builder.add_question("www.example.com", dns::QTYPE::A);
+        ok &= builder.add_name_record(SECTION::ANSWER, "www.example.com", dns::QTYPE::CNAME, 300, "www.example.com.cdn.example.net");
+
+        for (std::uint8_t i = 1; i <= 4; i++)
+            ok &= builder.add_a(SECTION::ANSWER, "www.example.com.cdn.example.net", 60, {192, 0, 2, i});
+
+        if (!ok)
+            dwhbll::debug::panic("[DNS codec] the answer does not fit");
+
+        return builder.build();
+    }
+
+    void report(const char *what, std::chrono::steady_clock::time_point start, std::size_t checksum) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        dwhbll::console::info("[DNS codec] {}: {} messages/s (checksum {})", what,
+                              static_cast<std::size_t>(messages / std::chrono::duration<double>(elapsed).count()), checksum);
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool dns_codec_bench(std::optional<std::string> _) {
+    std::array<std::uint8_t, 512> buffer;
+    const auto packet = build(buffer);
+    const std::vector<std::uint8_t> wire(packet.begin(), packet.end());
+
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t checksum = 0;
+
+        for (std::size_t i = 0; i < messages; i++) {
+            const dns::MessageView msg(wire);
+
+            for (const auto &rr : msg.answers()) {
+                if (auto a = rr.a())
+                    checksum += (*a)[3];
+            }
+        }
+
+        report("parse with MessageView", start, checksum);
+    }
+
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t checksum = 0;
+
+        for (std::size_t i = 0; i < messages; i++)
+            checksum += build(buffer).size();
+
+        report("build with MessageBuilder", start, checksum);
+    }
+
+    return false;
+}
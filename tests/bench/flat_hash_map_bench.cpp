@@ -0,0 +1,76 @@
+#include "bench_timing.h"
+
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dwhbll/collections/flat_hash_map.h>
+#include <dwhbll/console/Logging.h>
+
+namespace {
+    using bench_timing::nanos_each;
+
+    constexpr std::size_t entries = 1 << 20;
+
+    /**
+     * @brief Insert `present`, look all of them up, look up `absent`, then erase `present`, in that order.
+     */
+    template <typename Map, typename Key>
+    void run(const char* what, const std::vector<Key>& present, const std::vector<Key>& absent) {
+        Map map;
+        std::size_t found = 0;
+
+        const auto insert = nanos_each(present.size(), [&] {
+            for (std::size_t i = 0; i < present.size(); i++)
+                map.emplace(present[i], i);
+        });
+
+        const auto hit = nanos_each(present.size(), [&] {
+            for (const auto& key : present)
+                found += map.find(key) != map.end();
+        });
+
+        const auto miss = nanos_each(absent.size(), [&] {
+            for (const auto& key : absent)
+                found += map.find(key) != map.end();
+        });
+
+        const auto erase = nanos_each(present.size(), [&] {
+            for (const auto& key : present)
+                found += map.erase(key);
+        });
+
+        dwhbll::console::info("[FlatHashMap] {}: insert {:.1f} ns, hit {:.1f} ns, miss {:.1f} ns, erase {:.1f} ns ({})",
+                              what, insert, hit, miss, erase, found);
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool flat_hash_map_bench(std::optional<std::string> _) {
+    std::mt19937_64 rng(7);
+
+    std::vector<std::uint64_t> present(entries), absent(entries);
+    for (auto& key : present)
+        key = rng() | 1;
+    for (auto& key : absent)
+        key = rng() & ~1ULL;
+
+    dwhbll::console::info("[FlatHashMap] {} entries, time per operation", entries);
+
+    run<std::unordered_map<std::uint64_t, std::uint64_t>>("std::unordered_map<u64>", present, absent);
+    run<dwhbll::collections::flat_hash_map<std::uint64_t, std::uint64_t>>("flat_hash_map<u64>", present, absent);
+
+    // short strings like header names
+    std::vector<std::string> names(entries / 4), missing(entries / 4);
+    for (std::size_t i = 0; i < names.size(); i++) {
+        names[i] = "x-header-" + std::to_string(present[i] % 1000000007);
+        missing[i] = "x-missing-" + std::to_string(absent[i] % 1000000007);
+    }
+
+    run<std::unordered_map<std::string, std::uint64_t>>("std::unordered_map<string>", names, missing);
+    run<dwhbll::collections::flat_hash_map<std::string, std::uint64_t>>("flat_hash_map<string>", names, missing);
+
+    return false;
+}
@@ -0,0 +1,188 @@
+#include "http_load_bench.h"
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/http_server.hpp>
+
+namespace http2 = dwhbll::network::http_server::http2;
+namespace hpack = dwhbll::network::http_server::hpack;
+
+namespace {
+    constexpr std::uint16_t port = 8093;
+    /// the blocking server serves one connection per worker
+    constexpr std::size_t workers = 4;
+    /// requests in flight per h2 connection, below the server's stream limit
+    constexpr std::size_t streams_in_flight = 64;
+    constexpr auto duration = std::chrono::seconds(3);
+
+    struct HelloHandler {
+        void handle(dwhbll::network::http_server::Request &request, dwhbll::network::http_server::Response &response) {
+            response.code = "200";
+            response.reason = "OK";
+            response.body.assign(128, std::byte{'x'});
+        }
+    };
+
+    struct HelloFactory {
+        HelloHandler operator()() { return {}; }
+    };
+
+    void frame(std::vector<std::byte> &wire, http2::FrameType type, std::uint8_t flags, std::uint32_t stream,
+               std::span<const std::byte> payload) {
+        std::array<std::byte, http2::FRAME_HEADER_LENGTH> header;
+        http2::FrameHeader{static_cast<std::uint32_t>(payload.size()), type, flags, stream}.encode(header);
+        wire.insert(wire.end(), header.begin(), header.end());
+        wire.insert(wire.end(), payload.begin(), payload.end());
+    }
+
+    /**
+     * @brief A blocking h2c client keeping `streams_in_flight` GET requests open until the deadline.
+     * @return the number of complete responses.
+     */
+    std::uint64_t h2_client(std::chrono::steady_clock::time_point deadline) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return 0;
+        }
+
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        hpack::Encoder encoder;
+        hpack::Decoder decoder;
+        std::vector<std::byte> out, block;
+        std::uint32_t next_stream = 1;
+        std::size_t in_flight = 0;
+        std::uint64_t completed = 0;
+
+        const auto preface = std::as_bytes(std::span{http2::CONNECTION_PREFACE});
+        out.insert(out.end(), preface.begin(), preface.end());
+        frame(out, http2::FrameType::SETTINGS, 0, 0, {});
+
+        const auto send_requests = [&] {
+            for (; in_flight < streams_in_flight && std::chrono::steady_clock::now() < deadline; in_flight++) {
+                block.clear();
+                encoder.begin(block);
+                encoder.encode(":method", "GET", block);
+                encoder.encode(":scheme", "http", block);
+                encoder.encode(":path", "/hello", block);
+                encoder.encode(":authority", "127.0.0.1", block);
+                frame(out, http2::FrameType::HEADERS, http2::flags::END_HEADERS | http2::flags::END_STREAM, next_stream, block);
+                next_stream += 2;
+            }
+
+            return write(fd, out.data(), out.size()) == static_cast<ssize_t>(out.size());
+        };
+
+        std::vector<std::byte> in(1 << 16);
+        std::size_t in_size = 0;
+        std::vector<hpack::HeaderField> fields;
+
+        while (send_requests() && in_flight != 0) {
+            out.clear();
+
+            const ssize_t count = read(fd, in.data() + in_size, in.size() - in_size);
+            if (count <= 0)
+                break;
+            in_size += count;
+
+            std::size_t pos = 0, data_received = 0;
+
+            while (in_size - pos >= http2::FRAME_HEADER_LENGTH) {
+                const auto header = http2::FrameHeader::parse(std::span{in}.subspan(pos).first<http2::FRAME_HEADER_LENGTH>());
+
+                if (in_size - pos < http2::FRAME_HEADER_LENGTH + header.length)
+                    break;
+
+                const auto payload = std::span{in}.subspan(pos + http2::FRAME_HEADER_LENGTH, header.length);
+                pos += http2::FRAME_HEADER_LENGTH + header.length;
+
+                if (header.type == http2::FrameType::HEADERS) {
+                    fields.clear();
+                    decoder.decode(payload, fields);
+                } else if (header.type == http2::FrameType::DATA) {
+                    data_received += header.length;
+                } else if (header.type == http2::FrameType::SETTINGS && !header.has(http2::flags::ACK)) {
+                    frame(out, http2::FrameType::SETTINGS, http2::flags::ACK, 0, {});
+                }
+
+                if ((header.type == http2::FrameType::HEADERS || header.type == http2::FrameType::DATA) &&
+                    header.has(http2::flags::END_STREAM)) {
+                    in_flight--;
+                    completed++;
+                }
+            }
+
+            std::copy(in.begin() + pos, in.begin() + in_size, in.begin());
+            in_size -= pos;
+
+            // give the connection window back, the streams never get near theirs
+            if (data_received != 0) {
+                std::array<std::byte, 4> increment;
+                http2::write_u32(data_received, increment);
+                frame(out, http2::FrameType::WINDOW_UPDATE, 0, 0, increment);
+            }
+        }
+
+        close(fd);
+        return completed;
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool http2_bench(std::optional<std::string> _) {
+    dwhbll::network::http_server::Server<HelloFactory> server;
+    server.add_route("/hello", HelloFactory());
+
+    if (server.listen_to(dwhbll::network::conv::make_ipv4(127, 0, 0, 1), port) || server.listen(workers))
+        dwhbll::debug::panic("[Http2] cannot start the server on port {}", port);
+
+    // HTTP/1.1 with as many requests in flight, pipelined
+    http_load::options opts;
+    opts.endpoint = dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, port);
+    opts.connections = workers;
+    opts.pipeline_depth = streams_in_flight;
+    opts.duration = duration;
+    opts.mix.push_back({{dwhbll::network::http::HTTP_METHOD::GET, "/hello"}, 1});
+
+    const auto pipelined = http_load::run(opts);
+    dwhbll::console::info("[Http2] HTTP/1.1, {} connections, pipeline depth {}:\n{}", workers, streams_in_flight,
+                          pipelined.report());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::uint64_t> completed = 0;
+    std::vector<std::thread> clients;
+
+    for (std::size_t i = 0; i < workers; i++)
+        clients.emplace_back([&] { completed += h2_client(start + duration); });
+
+    for (auto &client : clients)
+        client.join();
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    dwhbll::console::info("[Http2] h2c, {} connections, {} streams each: {} requests, {:.1f} req/s", workers,
+                          streams_in_flight, completed.load(), completed.load() / elapsed);
+
+    server.stop();
+
+    return false;
+}
@@ -0,0 +1,203 @@
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/address.h>
+#include <dwhbll/network/http_server.hpp>
+
+namespace http_server = dwhbll::network::http_server;
+
+using namespace std::chrono_literals;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+    constexpr std::size_t workers = 4;
+    constexpr std::size_t clients = 64;
+    /// a response later than this is as good as none to the client
+    constexpr auto deadline = 200ms;
+    constexpr auto work = 1ms;
+    constexpr auto duration = 3s;
+
+    struct BusyHandler {
+        void handle(http_server::Request &request, http_server::Response &response) {
+            // stands in for a backend call, the worker is taken for its duration
+            std::this_thread::sleep_for(work);
+
+            response.code = "200";
+            response.reason = "OK";
+            response.body.assign(64, std::byte{'x'});
+        }
+    };
+
+    struct BusyFactory {
+        BusyHandler operator()() { return {}; }
+    };
+
+    struct Tally {
+        std::atomic<std::uint64_t> good = 0, late = 0, rejected = 0, failed = 0;
+    };
+
+    int open_connection(std::uint16_t port) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        // a client gives up on a response after a second
+        const timeval timeout{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    /**
+     * @brief Read one response head and its content-length body.
+     * @return the status code, 0 if the connection broke.
+     */
+    int read_response(int fd, std::string &buffer, bool &keep) {
+        std::size_t end;
+        while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            char chunk[4096];
+            const ssize_t count = read(fd, chunk, sizeof(chunk));
+            if (count <= 0)
+                return 0;
+            buffer.append(chunk, count);
+        }
+
+        const std::string_view head{buffer.data(), end};
+        const int status = std::stoi(std::string(head.substr(9, 3)));
+        keep = head.find("connection: close") == std::string_view::npos;
+
+        std::size_t length = 0;
+        if (const auto at = head.find("content-length: "); at != std::string_view::npos)
+            length = std::stoul(std::string(head.substr(at + 16)));
+
+        while (buffer.size() < end + 4 + length) {
+            char chunk[4096];
+            const ssize_t count = read(fd, chunk, sizeof(chunk));
+            if (count <= 0)
+                return 0;
+            buffer.append(chunk, count);
+        }
+
+        buffer.erase(0, end + 4 + length);
+        return status;
+    }
+
+    /**
+     * @brief A client sending at `rate` on a keep-alive connection, reconnecting whenever the server closes it.
+     */
+    void client(std::uint16_t port, double rate, clock_type::time_point start, Tally &tally) {
+        const auto interval = std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(1 / rate));
+        constexpr std::string_view request = "GET /work HTTP/1.1\r\nhost: 127.0.0.1\r\n\r\n";
+
+        int fd = -1;
+        std::string buffer;
+
+        for (auto due = start; due < start + duration; due += interval) {
+            std::this_thread::sleep_until(due);
+
+            if (fd == -1 && (fd = open_connection(port)) == -1) {
+                tally.failed++;
+                continue;
+            }
+
+            bool keep = false;
+            const int status = write(fd, request.data(), request.size()) == static_cast<ssize_t>(request.size())
+                                   ? read_response(fd, buffer, keep)
+                                   : 0;
+
+            // counted from when the request was due, so queueing in the client counts too
+            const auto latency = clock_type::now() - due;
+
+            if (status == 200)
+                (latency <= deadline ? tally.good : tally.late)++;
+            else if (status != 0)
+                tally.rejected++;
+            else
+                tally.failed++;
+
+            if (status == 0 || !keep) {
+                close(fd);
+                fd = -1;
+                buffer.clear();
+            }
+
+            // a client that fell behind skips what it could not send
+            while (due + interval < clock_type::now())
+                due += interval;
+        }
+
+        if (fd != -1)
+            close(fd);
+    }
+
+    void overload(std::uint16_t port, double rate, Tally &tally) {
+        std::vector<std::thread> threads;
+        const auto start = clock_type::now() + 10ms;
+
+        for (std::size_t i = 0; i < clients; i++)
+            threads.emplace_back(client, port, rate / clients, start + i * 1ms, std::ref(tally));
+
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    void report(const char *what, const Tally &tally) {
+        const double seconds = std::chrono::duration<double>(duration).count();
+
+        dwhbll::console::info("[HttpAdmission] {}: goodput {:.0f} req/s, late {}, rejected {}, failed {}", what,
+                              tally.good.load() / seconds, tally.late.load(), tally.rejected.load(), tally.failed.load());
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool http_admission_bench(std::optional<std::string> _) {
+    // what the workers sustain without queueing, and twice that offered
+    const double capacity = workers * (1s / std::chrono::duration<double>(work));
+    const double offered = 2 * capacity;
+
+    dwhbll::console::info("[HttpAdmission] {} workers, {} clients offering {:.0f} req/s, twice the capacity",
+                          workers, clients, offered);
+
+    for (const bool admission : {false, true}) {
+        const std::uint16_t port = admission ? 8095 : 8094;
+
+        http_server::Server<BusyFactory> server;
+        server.add_route("/work", BusyFactory());
+
+        if (admission)
+            server.set_admission({.queue_target = 5ms, .queue_interval = 100ms});
+
+        if (server.listen_to(dwhbll::network::conv::make_ipv4(127, 0, 0, 1), port) || server.listen(workers))
+            dwhbll::debug::panic("[HttpAdmission] cannot start the server on port {}", port);
+
+        Tally tally;
+        overload(port, offered, tally);
+        report(admission ? "CoDel shedding" : "no admission control", tally);
+
+        server.stop();
+    }
+
+    return false;
+}
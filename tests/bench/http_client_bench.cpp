@@ -0,0 +1,112 @@
+#include <array>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dwhbll/async/net/http_client.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/address.h>
+#include <dwhbll/network/http_server.hpp>
+
+using dwhbll::async::net::http_client;
+using dwhbll::async::net::http_client_options;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::task;
+
+namespace {
+    struct HelloHandler {
+        void handle(dwhbll::network::http_server::Request &request, dwhbll::network::http_server::Response &response) {
+            response.code = "200";
+            response.reason = "OK";
+            response.body.assign(64, std::byte{'x'});
+        }
+    };
+
+    struct HelloFactory {
+        HelloHandler operator()() { return {}; }
+    };
+
+    constexpr std::uint16_t port = 8091;
+
+    dwhbll::network::http_request make_request() {
+        dwhbll::network::http_request request;
+        request.method = dwhbll::network::http::HTTP_METHOD::GET;
+        request.path = "/hello";
+        return request;
+    }
+
+    task<> sequential(http_client &client, std::size_t count) {
+        const dwhbll::network::address endpoint(std::array<std::uint8_t, 4>{127, 0, 0, 1}, port);
+
+        for (std::size_t i = 0; i < count; i++) {
+            auto response = co_await client.request(endpoint, make_request());
+
+            if (response.is_err())
+                dwhbll::debug::panic("[HttpClient] request failed with {}", response.unwrap_err_unchecked());
+        }
+    }
+
+    task<> pipelined(http_client &client, std::size_t count) {
+        const dwhbll::network::address endpoint(std::array<std::uint8_t, 4>{127, 0, 0, 1}, port);
+
+        auto responses = co_await client.pipeline(endpoint, std::vector(count, make_request()));
+
+        if (responses.is_err())
+            dwhbll::debug::panic("[HttpClient] pipeline failed with {}", responses.unwrap_err_unchecked());
+    }
+
+    template <typename Body>
+    std::chrono::nanoseconds timed(Body body) {
+        reactor r;
+        const auto start = std::chrono::steady_clock::now();
+        r.spawn(body());
+        r.run();
+        return std::chrono::steady_clock::now() - start;
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool http_client_bench(std::optional<std::string> _) {
+    constexpr std::size_t requests = 2000;
+
+    dwhbll::network::http_server::Server<HelloFactory> server;
+    server.add_route("/hello", HelloFactory());
+
+    if (server.listen_to(dwhbll::network::conv::make_ipv4(127, 0, 0, 1), port) || server.listen(2))
+        dwhbll::debug::panic("[HttpClient] cannot start the server on port {}", port);
+
+    const auto report = [&](std::string_view name, std::chrono::nanoseconds elapsed, const http_client &client) {
+        dwhbll::console::info("[HttpClient] {}: {} requests in {}, {} us/request, {} connections opened, {} reused",
+            name,
+            requests,
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed),
+            static_cast<double>(elapsed.count()) / 1000.0 / static_cast<double>(requests),
+            client.stats().connections_opened,
+            client.stats().connections_reused
+        );
+    };
+
+    {
+        // baseline: a connection per request, what the blocking HTTP client does
+        http_client client({.idle_timeout = std::chrono::seconds(0)});
+        report("fresh connections", timed([&] { return sequential(client, requests); }), client);
+    }
+
+    {
+        http_client client;
+        report("pooled keep-alive", timed([&] { return sequential(client, requests); }), client);
+    }
+
+    {
+        http_client client;
+        report("pipelined", timed([&] { return pipelined(client, requests); }), client);
+    }
+
+    server.stop();
+
+    return false;
+}
@@ -0,0 +1,296 @@
+#include "http_load_bench.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <memory>
+#include <optional>
+#include <random>
+
+#include <dwhbll/async/net/socket.h>
+#include <dwhbll/concurrency/coroutine/async_semaphore.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/sleep_task.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/http/response_parser.h>
+#include <dwhbll/network/http/serialize.h>
+#include <dwhbll/network/http_server.hpp>
+
+using dwhbll::concurrency::coroutine::async_semaphore;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::sleep_task;
+using dwhbll::concurrency::coroutine::task;
+using clock_type = std::chrono::steady_clock;
+
+namespace http_load {
+    namespace {
+        struct connection {
+            std::unique_ptr<dwhbll::async::net::socket> sock;
+            /// free pipeline slots, the sender takes one per request and the receiver gives it back per response
+            async_semaphore slots;
+            /// one permit per request sent, plus a last one once the sender is done
+            async_semaphore sent{0};
+            /// start of the latency measurement and whether it was a HEAD, oldest first
+            std::deque<std::pair<clock_type::time_point, bool>> outstanding;
+            std::size_t next;
+            bool broken = false;
+
+            connection(std::size_t depth, std::size_t first) : slots(static_cast<std::int32_t>(depth)), next(first) {}
+        };
+
+        struct load {
+            const options &opts;
+            result &out;
+            std::vector<std::string> wire;
+            std::vector<bool> head;
+            /// indices into `wire`, each request repeated by its weight and shuffled
+            std::vector<std::size_t> schedule;
+            clock_type::time_point deadline;
+        };
+
+        task<> receive(load &state, connection &conn) {
+            dwhbll::network::http::response_parser parser;
+            std::vector<std::uint8_t> inbound(64 * 1024);
+            std::size_t inbound_head = 0, inbound_size = 0;
+
+            while (true) {
+                co_await conn.sent.acquire();
+
+                if (conn.outstanding.empty())
+                    break;
+
+                parser.reset(conn.outstanding.front().second, false);
+
+                while (true) {
+                    if (inbound_size != 0) {
+                        auto consumed = parser.feed({inbound.data() + inbound_head, inbound_size});
+                        inbound_head += consumed;
+                        inbound_size -= consumed;
+
+                        if (parser.done() || parser.failed())
+                            break;
+                    }
+
+                    // responses are small, only a huge head needs more than the buffer
+                    if (inbound_head != 0) {
+                        std::memmove(inbound.data(), inbound.data() + inbound_head, inbound_size);
+                        inbound_head = 0;
+                    }
+
+                    if (inbound_size == inbound.size())
+                        inbound.resize(inbound.size() * 2);
+
+                    auto r = co_await conn.sock->read_some({inbound.data() + inbound_size, inbound.size() - inbound_size});
+
+                    if (r.is_err())
+                        break;
+
+                    if (r.unwrap_unchecked() == 0) {
+                        parser.on_close();
+                        break;
+                    }
+
+                    inbound_size += r.unwrap_unchecked();
+                }
+
+                if (!parser.done()) {
+                    state.out.read_errors++;
+                    conn.broken = true;
+                    conn.slots.release();
+                    break;
+                }
+
+                const auto latency = clock_type::now() - conn.outstanding.front().first;
+                conn.outstanding.pop_front();
+
+                state.out.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+                state.out.requests++;
+                state.out.bytes += parser.body_size();
+                if (parser.response().status.status_code >= 400)
+                    state.out.status_errors++;
+
+                if (!parser.keep_alive()) {
+                    conn.broken = true;
+                    conn.slots.release();
+                    break;
+                }
+
+                conn.slots.release();
+            }
+        }
+
+        task<> drive(load &state, connection &conn, clock_type::time_point due, clock_type::duration interval) {
+            auto sock = co_await dwhbll::async::net::socket::connect_tcp(false, state.opts.endpoint);
+
+            if (sock.is_err()) {
+                state.out.connect_errors++;
+                co_return;
+            }
+
+            conn.sock = std::move(sock.unwrap_unchecked());
+            conn.sock->set_nodelay(true);
+
+            reactor::get_thread_reactor()->spawn(receive(state, conn));
+
+            while (true) {
+                co_await conn.slots.acquire();
+
+                if (conn.broken)
+                    break;
+
+                const bool open_loop = interval != clock_type::duration::zero();
+
+                if (open_loop ? due >= state.deadline : clock_type::now() >= state.deadline)
+                    break;
+
+                if (open_loop)
+                    co_await sleep_task{due};
+
+                const auto index = state.schedule[conn.next++ % state.schedule.size()];
+                const auto &wire = state.wire[index];
+
+                conn.outstanding.emplace_back(open_loop ? due : clock_type::now(), state.head[index]);
+                conn.sent.release();
+
+                auto written = co_await conn.sock->write({reinterpret_cast<const std::uint8_t *>(wire.data()), wire.size()});
+
+                if (written.is_err()) {
+                    if (!conn.broken)
+                        state.out.write_errors++;
+                    conn.broken = true;
+                    break;
+                }
+
+                due += interval;
+            }
+
+            // wakes the receiver once it has drained what is in flight
+            conn.sent.release();
+        }
+    }
+
+    double result::requests_per_second() const {
+        const auto seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds == 0 ? 0.0 : static_cast<double>(requests) / seconds;
+    }
+
+    std::string result::report() const {
+        return std::format("{} requests in {}, {:.1f} req/s, {:.2f} MiB read\n"
+                           "  latency {}\n"
+                           "  errors: connect {}, read {}, write {}, status {}",
+            requests,
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed),
+            requests_per_second(),
+            static_cast<double>(bytes) / (1024.0 * 1024.0),
+            latency.summary(1000, "us"),
+            connect_errors, read_errors, write_errors, status_errors
+        );
+    }
+
+    result run(const options &opts) {
+        if (opts.connections == 0 || opts.pipeline_depth == 0)
+            dwhbll::debug::panic("http_load needs at least one connection and a pipeline depth of one");
+
+        result out;
+        load state{opts, out};
+
+        std::vector<request_spec> mix = opts.mix;
+        if (mix.empty())
+            mix.push_back({{dwhbll::network::http::HTTP_METHOD::GET, "/"}, 1});
+
+        const auto host = dwhbll::network::http::host_field(opts.endpoint);
+
+        for (std::size_t i = 0; i < mix.size(); i++) {
+            std::string wire;
+            dwhbll::network::http::serialize_request(mix[i].request, host, wire);
+            state.wire.push_back(std::move(wire));
+            state.head.push_back(mix[i].request.method == dwhbll::network::http::HTTP_METHOD::HEAD);
+            state.schedule.insert(state.schedule.end(), mix[i].weight, i);
+        }
+
+        if (state.schedule.empty())
+            dwhbll::debug::panic("http_load needs a request with a non zero weight");
+
+        // a fixed seed keeps runs comparable
+        std::ranges::shuffle(state.schedule, std::mt19937{42});
+
+        const clock_type::duration interval = opts.rate > 0
+            ? std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(static_cast<double>(opts.connections) / opts.rate))
+            : clock_type::duration::zero();
+
+        std::vector<std::unique_ptr<connection>> connections;
+        for (std::size_t i = 0; i < opts.connections; i++)
+            connections.push_back(std::make_unique<connection>(opts.pipeline_depth, i * state.schedule.size() / opts.connections));
+
+        reactor r;
+
+        const auto start = clock_type::now();
+        state.deadline = start + opts.duration;
+
+        for (std::size_t i = 0; i < connections.size(); i++) {
+            // stagger the paced connections so their requests do not all land together
+            const auto first_due = start + interval * i / connections.size();
+            r.spawn(drive(state, *connections[i], first_due, interval));
+        }
+
+        r.run();
+
+        out.elapsed = clock_type::now() - start;
+        return out;
+    }
+}
+
+namespace {
+    struct HelloHandler {
+        void handle(dwhbll::network::http_server::Request &request, dwhbll::network::http_server::Response &response) {
+            response.code = "200";
+            response.reason = "OK";
+            response.body.assign(128, std::byte{'x'});
+        }
+    };
+
+    struct HelloFactory {
+        HelloHandler operator()() { return {}; }
+    };
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool http_load_bench(std::optional<std::string> _) {
+    constexpr std::uint16_t port = 8092;
+
+    dwhbll::network::http_server::Server<HelloFactory> server;
+    server.add_route("/hello", HelloFactory());
+
+    // the blocking server serves one connection per worker
+    constexpr std::size_t workers = 4;
+
+    if (server.listen_to(dwhbll::network::conv::make_ipv4(127, 0, 0, 1), port) || server.listen(workers))
+        dwhbll::debug::panic("[HttpLoad] cannot start the server on port {}", port);
+
+    http_load::options opts;
+    opts.endpoint = dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, port);
+    opts.connections = workers;
+    opts.duration = std::chrono::seconds(3);
+    opts.mix.push_back({{dwhbll::network::http::HTTP_METHOD::GET, "/hello"}, 9});
+    opts.mix.push_back({{dwhbll::network::http::HTTP_METHOD::GET, "/missing"}, 1});
+
+    const auto closed = http_load::run(opts);
+    dwhbll::console::info("[HttpLoad] closed loop, {} connections:\n{}", opts.connections, closed.report());
+
+    opts.pipeline_depth = 8;
+    const auto pipelined = http_load::run(opts);
+    dwhbll::console::info("[HttpLoad] closed loop, pipeline depth {}:\n{}", opts.pipeline_depth, pipelined.report());
+
+    // half of what the closed loop reached, latency should stay near its floor
+    opts.pipeline_depth = 1;
+    opts.rate = closed.requests_per_second() / 2;
+    const auto paced = http_load::run(opts);
+    dwhbll::console::info("[HttpLoad] open loop at {:.0f} req/s:\n{}", opts.rate, paced.report());
+
+    server.stop();
+
+    return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <dwhbll/network/address.h>
+#include <dwhbll/network/http/message.h>
+#include <dwhbll/utils/latency_histogram.h>
+
+/**
+ * wrk style HTTP/1.1 load generator, shared by `bench/http_load` and the standalone `http_load` tool.
+ */
+namespace http_load {
+    struct request_spec {
+        dwhbll::network::http_request request;
+        /// share of the mix relative to the other requests
+        unsigned weight = 1;
+    };
+
+    struct options {
+        dwhbll::network::address endpoint;
+        std::size_t connections = 16;
+        /// requests in flight per connection
+        std::size_t pipeline_depth = 1;
+        std::chrono::steady_clock::duration duration = std::chrono::seconds(5);
+        /**
+         * 0 runs closed loop, every connection sends as soon as a response frees a slot. Otherwise the total
+         * requests per second, paced evenly over the connections (open loop). Latency then counts from when a
+         * request was due rather than when it went out, so a stalling server cannot hide its queueing delay.
+         */
+        double rate = 0;
+        /// GET / when empty
+        std::vector<request_spec> mix;
+    };
+
+    struct result {
+        /// nanoseconds
+        dwhbll::utils::latency_histogram latency;
+        std::uint64_t requests = 0;
+        /// responses with a 4xx or 5xx status, they still count as requests
+        std::uint64_t status_errors = 0;
+        std::uint64_t connect_errors = 0;
+        /// connections that broke mid-run, requests in flight on them are lost
+        std::uint64_t read_errors = 0, write_errors = 0;
+        /// response body bytes
+        std::uint64_t bytes = 0;
+        std::chrono::steady_clock::duration elapsed{};
+
+        [[nodiscard]] double requests_per_second() const;
+
+        [[nodiscard]] std::string report() const;
+    };
+
+    /**
+     * @brief Run the load on a reactor of its own until `duration` is over and every response in flight came back.
+     */
+    result run(const options &opts);
+}
@@ -0,0 +1,94 @@
+#include <chrono>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/http_server/router.h>
+
+using dwhbll::network::http::HTTP_METHOD;
+using dwhbll::network::http_server::MatchStatus;
+using dwhbll::network::http_server::RouteParams;
+using dwhbll::network::http_server::Router;
+
+// TODO: Make a benchmark harness and do this correctly!
+bool http_router_bench(std::optional<std::string> _) {
+    constexpr std::size_t resources = 400;
+    constexpr std::size_t lookups = 10000000;
+
+    Router<std::size_t> router;
+    std::unordered_map<std::string, std::size_t> exact;
+
+    std::vector<std::string> paths;
+    std::vector<std::string> static_paths;
+
+    // three routes per resource plus a wildcard every tenth, mirrors a typical REST api
+    for (std::size_t i = 0; i < resources; i++) {
+        const auto base = "/api/v1/resource" + std::to_string(i);
+
+        router.add(HTTP_METHOD::GET, base, i * 4);
+        router.add(HTTP_METHOD::GET, base + "/{id}", i * 4 + 1);
+        router.add(HTTP_METHOD::DELETE, base + "/{id}", i * 4 + 2);
+
+        if (i % 10 == 0)
+            router.add(base + "/static/*", i * 4 + 3);
+
+        exact.emplace(base, i * 4);
+        static_paths.push_back(base);
+        paths.push_back(base);
+        paths.push_back(base + "/" + std::to_string(i * 31));
+        if (i % 10 == 0)
+            paths.push_back(base + "/static/css/site.css");
+    }
+
+    router.compile();
+
+    RouteParams params;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::size_t checksum = 0;
+    for (std::size_t i = 0; i < lookups; i++) {
+        auto match = router.match(HTTP_METHOD::GET, paths[i % paths.size()], params);
+
+        if (match.status != MatchStatus::FOUND)
+            dwhbll::debug::panic("[Router] Failed to match {}", paths[i % paths.size()]);
+
+        checksum += *match.factory + params.size();
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start);
+
+    dwhbll::console::info("[Router] Ran for {}, {} routes, {} lookups, {} ns/lookup (checksum {})",
+        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed),
+        router.size(),
+        lookups,
+        static_cast<double>(elapsed.count()) / static_cast<double>(lookups),
+        checksum
+    );
+
+    // baseline: the exact match map the server used before, static paths only
+    const auto map_start = std::chrono::steady_clock::now();
+
+    checksum = 0;
+    for (std::size_t i = 0; i < lookups; i++) {
+        auto it = exact.find(static_paths[i % static_paths.size()]);
+        checksum += it->second;
+    }
+
+    const auto map_now = std::chrono::steady_clock::now();
+
+    const auto map_elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(map_now - map_start);
+
+    dwhbll::console::info("[Router] unordered_map baseline ran for {}, {} ns/lookup (checksum {})",
+        std::chrono::duration_cast<std::chrono::milliseconds>(map_elapsed),
+        static_cast<double>(map_elapsed.count()) / static_cast<double>(lookups),
+        checksum
+    );
+
+    return false;
+}
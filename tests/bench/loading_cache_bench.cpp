@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <string>
+
+#include <dwhbll/collections/cache.h>
+#include <dwhbll/concurrency/coroutine/loading_cache.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/sleep_task.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/console/Logging.h>
+
+using namespace std::chrono_literals;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::sleep_for;
+using dwhbll::concurrency::coroutine::task;
+
+namespace {
+    constexpr int clients = 1000;
+    constexpr auto duration = 1s;
+    constexpr auto ttl = 100ms;
+    /// what a backend call takes
+    constexpr auto latency = 10ms;
+
+    struct backend {
+        int calls = 0, running = 0, peak = 0;
+        std::chrono::steady_clock::duration slowest_read{};
+
+        task<std::optional<int>> fetch(const std::string &key) {
+            calls++;
+            peak = std::max(peak, ++running);
+            co_await sleep_for(latency);
+            running--;
+            co_return static_cast<int>(key.size());
+        }
+    };
+
+    /**
+     * @brief A client reading the one hot key every millisecond through `read`.
+     */
+    template <typename Read>
+    task<> client(backend &b, Read read) {
+        const auto end = std::chrono::steady_clock::now() + duration;
+        // the first reads find the cache cold whatever it does
+        bool warm = false;
+
+        while (std::chrono::steady_clock::now() < end) {
+            const auto start = std::chrono::steady_clock::now();
+            co_await read();
+            if (warm)
+                b.slowest_read = std::max(b.slowest_read, std::chrono::steady_clock::now() - start);
+            warm = true;
+
+            co_await sleep_for(1ms);
+        }
+    }
+
+    template <typename Read>
+    void herd(const char *what, backend &b, Read read) {
+        reactor r;
+        for (int i = 0; i < clients; i++)
+            r.spawn(client(b, read));
+        r.run();
+
+        dwhbll::console::info("[LoadingCache] {}: {} backend calls, {} at once at most, slowest read {} ms", what,
+                              b.calls, b.peak,
+                              std::chrono::duration_cast<std::chrono::milliseconds>(b.slowest_read).count());
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool loading_cache_bench(std::optional<std::string> _) {
+    dwhbll::console::info("[LoadingCache] {} clients reading one key every ms for {} ms, {} ms TTL, {} ms loads",
+                          clients, std::chrono::milliseconds(duration).count(), ttl.count(), latency.count());
+
+    {
+        // every client that misses goes to the backend itself
+        backend b;
+        dwhbll::collections::cache<std::string, int> plain(16);
+
+        herd("check then load", b, [&]() -> task<> {
+            if (plain.findEntry("hot"))
+                co_return;
+
+            auto value = co_await b.fetch("hot");
+            plain.addEntry(std::chrono::system_clock::now() + ttl, "hot", *value);
+        });
+    }
+
+    for (const auto refresh : {0ms, ttl * 3 / 4}) {
+        backend b;
+        dwhbll::concurrency::coroutine::loading_cache<std::string, int> cache({.capacity = 16, .ttl = ttl,
+                                                                               .refresh_after = refresh});
+
+        herd(refresh.count() == 0 ? "single flight" : "single flight, refreshed ahead", b, [&]() -> task<> {
+            co_await cache.get_or_load("hot", [&](const std::string &key) { return b.fetch(key); });
+        });
+    }
+
+    return false;
+}
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dwhbll/collections/ring.h>
+#include <dwhbll/console/Logging.h>
+
+namespace {
+    constexpr std::size_t total = std::size_t{1} << 30;
+    constexpr std::size_t chunk = 1500;
+
+    /**
+     * @brief Stream `total` bytes through `pass`, which moves one chunk from `in` to `out`.
+     * @return throughput in GiB/s.
+     */
+    template <typename Pass>
+    double measure(Pass pass) {
+        std::vector<std::uint8_t> in(chunk, 0x5a), out(chunk);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t moved = 0; moved < total; moved += chunk)
+            pass(in, out);
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // keeps the copies from being optimised out
+        if (out[chunk / 2] != 0x5a)
+            dwhbll::console::error("[Ring] bytes got lost");
+
+        return total / elapsed / (1 << 30);
+    }
+
+    constexpr std::size_t operations = 1 << 24;
+
+    /**
+     * @brief Keep `depth` elements queued while pushing `operations` through `queue`.
+     * @return millions of elements per second.
+     */
+    template <typename Queue, typename Make>
+    double fifo(Queue &queue, std::size_t depth, Make make) {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t seen = 0;
+
+        for (std::size_t i = 0; i < operations; i++) {
+            queue.push_back(make(i));
+            if (queue.size() > depth) {
+                seen += sizeof(queue.front());
+                queue.pop_front();
+            }
+        }
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seen == 0)
+            dwhbll::console::error("[Ring] nothing went through the queue");
+
+        return operations / elapsed / 1e6;
+    }
+
+    /**
+     * @brief Create many short lived queues of a handful of elements, like a waiter list per object.
+     * @return millions of queues per second.
+     */
+    template <typename Queue>
+    double tiny_queues() {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t sum = 0;
+
+        for (std::size_t i = 0; i < operations / 8; i++) {
+            Queue queue;
+            for (int j = 0; j < 4; j++)
+                queue.push_back(j);
+            sum += queue.front() + queue.back();
+        }
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (sum == 0)
+            dwhbll::console::error("[Ring] the queues stayed empty");
+
+        return operations / 8 / elapsed / 1e6;
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool ring_bench(std::optional<std::string> _) {
+    // the buffer holds a few chunks, so they keep wrapping around its end
+    dwhbll::collections::Ring<std::uint8_t> ring(4096);
+
+    const double baseline = measure([](auto &in, auto &out) {
+        std::memcpy(out.data(), in.data(), chunk);
+    });
+
+    const double per_byte = measure([&](auto &in, auto &out) {
+        for (const auto byte : in)
+            ring.push_back(byte);
+        for (auto &byte : out) {
+            byte = ring.front();
+            ring.pop_front();
+        }
+    });
+
+    const double spans = measure([&](auto &in, auto &out) {
+        ring.push_back(std::span<const std::uint8_t>{in});
+        ring.pop_front_into(out);
+    });
+
+    dwhbll::console::info("[Ring] {} byte chunks through a byte ring: memcpy {:.2f} GiB/s, per byte {:.2f} GiB/s, "
+                          "spans {:.2f} GiB/s", chunk, baseline, per_byte, spans);
+
+    // growing to the depth and then cycling through it, deque allocates a block every few hundred elements instead
+    for (const std::size_t depth : {64, 4096}) {
+        const auto number = [](std::size_t i) { return i; };
+        const auto text = [](std::size_t i) { return std::string(24, static_cast<char>('a' + i % 26)); };
+
+        dwhbll::collections::Ring<std::size_t> ints;
+        std::deque<std::size_t> int_deque;
+        dwhbll::collections::Ring<std::string> strings;
+        std::deque<std::string> string_deque;
+
+        const double ring_ints = fifo(ints, depth, number), deque_ints = fifo(int_deque, depth, number);
+        const double ring_strings = fifo(strings, depth, text), deque_strings = fifo(string_deque, depth, text);
+
+        dwhbll::console::info("[Ring] fifo at depth {}: ints ring {:.0f} M/s, deque {:.0f} M/s; strings ring {:.0f} M/s, "
+                              "deque {:.0f} M/s", depth, ring_ints, deque_ints, ring_strings, deque_strings);
+    }
+
+    dwhbll::console::info("[Ring] tiny queues: inline ring {:.1f} M/s, heap ring {:.1f} M/s, deque {:.1f} M/s",
+                          tiny_queues<dwhbll::collections::Ring<int, 8>>(), tiny_queues<dwhbll::collections::Ring<int>>(),
+                          tiny_queues<std::deque<int>>());
+
+    return false;
+}
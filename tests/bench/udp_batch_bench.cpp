@@ -0,0 +1,154 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dwhbll/async/net/datagram_socket.h>
+#include <dwhbll/async/net/socket.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/console/debug.hpp>
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/address.h>
+
+using dwhbll::async::net::datagram_batch;
+using dwhbll::async::net::datagram_socket;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::task;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+    constexpr std::size_t datagram_size = 64;
+    constexpr auto duration = std::chrono::seconds(2);
+
+    /**
+     * @brief Blasts small datagrams at `target` from its own thread with blocking sendmmsg until stopped.
+     */
+    std::thread flood(const dwhbll::network::address &target, const std::atomic_bool &stop) {
+        return std::thread([target, &stop] {
+            auto sock = ::socket(AF_INET, SOCK_DGRAM, 0);
+
+            sockaddr_storage addr;
+            const auto addrlen = dwhbll::network::conv::to_sockaddr(target, addr);
+
+            std::array<std::uint8_t, datagram_size> payload{};
+            std::array<iovec, 64> vectors;
+            std::array<mmsghdr, 64> headers{};
+
+            for (std::size_t i = 0; i < headers.size(); i++) {
+                vectors[i] = {payload.data(), payload.size()};
+                headers[i].msg_hdr.msg_iov = &vectors[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+                headers[i].msg_hdr.msg_name = &addr;
+                headers[i].msg_hdr.msg_namelen = addrlen;
+            }
+
+            while (!stop.load(std::memory_order_relaxed))
+                ::sendmmsg(sock, headers.data(), headers.size(), 0);
+
+            ::close(sock);
+        });
+    }
+
+    task<> single(dwhbll::async::net::socket &sock, std::size_t &received) {
+        std::array<std::uint8_t, 2048> buffer;
+        const auto deadline = clock_type::now() + duration;
+
+        while (clock_type::now() < deadline) {
+            auto r = co_await sock.read_some(buffer);
+
+            if (r.is_err())
+                dwhbll::debug::panic("[UdpBatch] recv failed with {}", r.unwrap_err_unchecked());
+
+            received++;
+        }
+    }
+
+    task<> batched(datagram_socket &sock, std::size_t &received) {
+        datagram_batch batch(64);
+        const auto deadline = clock_type::now() + duration;
+
+        while (clock_type::now() < deadline) {
+            auto r = co_await sock.receive(batch);
+
+            if (r.is_err())
+                dwhbll::debug::panic("[UdpBatch] recvmmsg failed with {}", r.unwrap_err_unchecked());
+
+            received += r.unwrap_unchecked();
+        }
+    }
+
+    template <typename Body>
+    double packets_per_second(const dwhbll::network::address &target, Body body) {
+        std::atomic_bool stop{false};
+        std::size_t received = 0;
+
+        auto sender = flood(target, stop);
+
+        reactor r;
+        const auto start = clock_type::now();
+        r.spawn(body(received));
+        r.run();
+        const auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        stop = true;
+        sender.join();
+
+        return static_cast<double>(received) / elapsed;
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool udp_batch_bench(std::optional<std::string> _) {
+    const dwhbll::network::address any(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 0);
+    constexpr int socket_buffer = 4 * 1024 * 1024;
+
+    // one datagram per io_uring recv, the path socket::connect_udp gives
+    {
+        auto receiver = datagram_socket::bind(any);
+        if (receiver.is_err())
+            dwhbll::debug::panic("[UdpBatch] cannot bind: {}", receiver.unwrap_err_unchecked());
+
+        const auto target = receiver.unwrap_unchecked()->local_address().unwrap_unchecked();
+
+        // hand the bound descriptor over to a stream style socket
+        sockaddr_storage addr;
+        const auto addrlen = dwhbll::network::conv::to_sockaddr(target, addr);
+        receiver.unwrap_unchecked()->close();
+
+        auto fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &socket_buffer, sizeof(socket_buffer));
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), addrlen) < 0)
+            dwhbll::debug::panic("[UdpBatch] cannot rebind port {}", target.port);
+
+        dwhbll::async::net::socket sock(fd, target);
+
+        const auto pps = packets_per_second(target, [&](std::size_t &received) { return single(sock, received); });
+        dwhbll::console::info("[UdpBatch] read_some: {:.0f} datagrams/s", pps);
+    }
+
+    // up to 64 datagrams per recvmmsg
+    {
+        auto receiver = datagram_socket::bind(any);
+        if (receiver.is_err())
+            dwhbll::debug::panic("[UdpBatch] cannot bind: {}", receiver.unwrap_err_unchecked());
+
+        auto &sock = *receiver.unwrap_unchecked();
+        if (sock.set_buffer_sizes(socket_buffer, socket_buffer).is_err())
+            dwhbll::debug::panic("[UdpBatch] cannot size the socket buffers");
+
+        const auto target = sock.local_address().unwrap_unchecked();
+
+        const auto pps = packets_per_second(target, [&](std::size_t &received) { return batched(sock, received); });
+        dwhbll::console::info("[UdpBatch] recvmmsg x64: {:.0f} datagrams/s", pps);
+    }
+
+    return false;
+}
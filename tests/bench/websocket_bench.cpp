@@ -0,0 +1,121 @@
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dwhbll/console/Logging.h>
+#include <dwhbll/network/http_server.hpp>
+
+namespace http_server = dwhbll::network::http_server;
+namespace websocket = dwhbll::network::http_server::websocket;
+
+namespace {
+    constexpr std::size_t connections = 10000;
+    constexpr std::size_t rounds = 100;
+    constexpr std::size_t unmask_bytes = 64 << 20;
+
+    /**
+     * @brief One upgraded server side connection, the client side is only drained.
+     */
+    struct peer {
+        int server = -1, client = -1;
+        http_server::detail::Socket socket;
+        std::unique_ptr<http_server::WebSocket> connection;
+
+        ~peer() {
+            connection.reset();
+            close(server);
+            close(client);
+        }
+    };
+
+    void drain(const std::vector<std::unique_ptr<peer>> &peers) {
+        std::array<char, 65536> sink;
+
+        for (const auto &p : peers) {
+            while (recv(p->client, sink.data(), sink.size(), MSG_DONTWAIT) > 0) {}
+        }
+    }
+
+    void report(const char *what, std::chrono::steady_clock::time_point start, std::size_t frames) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        dwhbll::console::info("[WebSocket] {}: {} frames/s", what,
+                              static_cast<std::size_t>(frames / std::chrono::duration<double>(elapsed).count()));
+    }
+}
+
+// TODO: Make a benchmark harness and do this correctly!
+bool websocket_bench(std::optional<std::string> _) {
+    // two descriptors per connection
+    rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    http_server::WebSocketGroup group;
+    std::vector<std::unique_ptr<peer>> peers;
+    peers.reserve(connections);
+
+    for (std::size_t i = 0; i < connections; i++) {
+        auto p = std::make_unique<peer>();
+        int fds[2];
+
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) != 0) {
+            dwhbll::console::warn("[WebSocket] out of descriptors after {} connections", i);
+            break;
+        }
+
+        p->server = fds[0];
+        p->client = fds[1];
+        p->socket.assign_socket(p->server);
+        p->connection = std::make_unique<http_server::WebSocket>(p->socket);
+        group.join(*p->connection);
+        peers.push_back(std::move(p));
+    }
+
+    const std::string payload(128, 'n');
+
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t round = 0; round < rounds; round++) {
+            for (const auto &p : peers)
+                p->connection->send_text(payload);
+        }
+
+        report("framed per connection", start, rounds * peers.size());
+        drain(peers);
+    }
+
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t sent = 0;
+
+        for (std::size_t round = 0; round < rounds; round++)
+            sent += group.broadcast(websocket::Frame(websocket::Opcode::TEXT, payload));
+
+        report("broadcast of one frame", start, sent);
+        drain(peers);
+    }
+
+    std::vector<std::byte> data(unmask_bytes);
+    const std::array<std::byte, 4> mask{std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+
+    for (const auto &[what, unmask] : {std::pair{"unmask byte by byte", &websocket::apply_mask_scalar},
+                                       std::pair{"unmask with SIMD", &websocket::apply_mask}}) {
+        const auto start = std::chrono::steady_clock::now();
+        unmask(data, mask, 0);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        dwhbll::console::info("[WebSocket] {}: {} MiB/s", what,
+                              static_cast<std::size_t>((unmask_bytes >> 20) / std::chrono::duration<double>(elapsed).count()));
+    }
+
+    return false;
+}
@@ -0,0 +1,245 @@
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <dwhbll/collections/btree.h>
+
+template <typename Tree, typename Expected>
+static bool same_contents(const Tree& tree, const Expected& expected) {
+    return tree.size() == expected.size() && std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()) &&
+           std::equal(tree.rbegin(), tree.rend(), expected.rbegin(), expected.rend());
+}
+
+static bool matches_multiset() {
+    dwhbll::collections::btree_multiset<int> tree;
+    std::multiset<int> expected;
+    std::mt19937 rng(7);
+
+    // grow past three levels, then shrink back, with duplicates throughout
+    for (const int target : {200000, 1000, 50000, 0}) {
+        while (expected.size() != static_cast<std::size_t>(target)) {
+            const int key = static_cast<int>(rng() % 20000);
+
+            if (expected.size() < static_cast<std::size_t>(target)) {
+                auto it = tree.insert(key);
+                expected.insert(key);
+                if (*it != key) {
+                    std::cerr << "[FAILED] btree_multiset insert of " << key << " returned " << *it << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            if (rng() % 8 == 0) {
+                if (tree.erase(key) != expected.erase(key)) {
+                    std::cerr << "[FAILED] btree_multiset erased a different number of " << key << std::endl;
+                    return false;
+                }
+            } else if (auto found = expected.lower_bound(key); found != expected.end()) {
+                auto it = tree.lower_bound(key);
+                if (it == tree.end() || *it != *found) {
+                    std::cerr << "[FAILED] btree_multiset lower_bound of " << key << " disagrees." << std::endl;
+                    return false;
+                }
+
+                auto next = tree.erase(it);
+                auto wanted = expected.erase(found);
+                if ((next == tree.end()) != (wanted == expected.end()) || (next != tree.end() && *next != *wanted)) {
+                    std::cerr << "[FAILED] btree_multiset erase returned the wrong successor." << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        if (!same_contents(tree, expected)) {
+            std::cerr << "[FAILED] btree_multiset holds different entries at " << target << std::endl;
+            return false;
+        }
+    }
+
+    if (!tree.empty() || tree.begin() != tree.end())
+        return false;
+
+    return true;
+}
+
+static bool set_bounds_and_ranges() {
+    dwhbll::collections::btree_set<int> tree;
+    std::set<int> expected;
+
+    for (int i = 0; i < 100000; i += 3) {
+        tree.insert(i);
+        expected.insert(i);
+    }
+
+    if (tree.insert(300).second || tree.size() != expected.size())
+        return false;
+
+    for (int key = -5; key < 100005; key += 7) {
+        auto lower = tree.lower_bound(key);
+        auto upper = tree.upper_bound(key);
+        auto want_lower = expected.lower_bound(key);
+        auto want_upper = expected.upper_bound(key);
+
+        if ((lower == tree.end()) != (want_lower == expected.end()) ||
+            (lower != tree.end() && *lower != *want_lower) ||
+            (upper == tree.end()) != (want_upper == expected.end()) ||
+            (upper != tree.end() && *upper != *want_upper) || tree.contains(key) != expected.contains(key)) {
+            std::cerr << "[FAILED] btree_set bounds of " << key << " disagree." << std::endl;
+            return false;
+        }
+    }
+
+    // erase a range out of the middle
+    tree.erase(tree.lower_bound(30000), tree.lower_bound(60000));
+    expected.erase(expected.lower_bound(30000), expected.lower_bound(60000));
+
+    // and every other entry of what is left
+    for (auto it = tree.begin(); it != tree.end();)
+        if ((it = tree.erase(it)) != tree.end())
+            ++it;
+    for (auto it = expected.begin(); it != expected.end();)
+        if ((it = expected.erase(it)) != expected.end())
+            ++it;
+
+    if (!same_contents(tree, expected)) {
+        std::cerr << "[FAILED] btree_set lost entries erasing ranges." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool bulk_load() {
+    for (const int n : {0, 1, 56, 57, 1000, 123457}) {
+        std::vector<int> sorted(n);
+        for (int i = 0; i < n; i++)
+            sorted[i] = i * 2;
+
+        dwhbll::collections::btree_set<int> tree(dwhbll::collections::sorted_input, sorted.begin(), sorted.end());
+        if (!same_contents(tree, sorted)) {
+            std::cerr << "[FAILED] btree_set built from " << n << " sorted entries differs." << std::endl;
+            return false;
+        }
+
+        // the built tree takes inserts and erases like any other
+        std::set<int> expected(sorted.begin(), sorted.end());
+        std::mt19937 rng(n);
+        for (int i = 0; i < 2 * n; i++) {
+            const int key = static_cast<int>(rng() % (2 * n + 1));
+            if (i < n) {
+                tree.insert(key);
+                expected.insert(key);
+            } else {
+                tree.erase(key);
+                expected.erase(key);
+            }
+        }
+
+        auto copy = tree;
+        if (!same_contents(tree, expected) || !(copy == tree)) {
+            std::cerr << "[FAILED] btree_set built from " << n << " sorted entries broke on updates." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool map_with_string_keys() {
+    dwhbll::collections::btree_map<std::string, std::shared_ptr<int>, std::less<>> tree;
+    std::map<std::string, int> expected;
+    auto tracked = std::make_shared<int>(0);
+
+    for (int i = 0; i < 20000; i++) {
+        // long enough to live on the heap, so moving them between nodes has to be right
+        auto key = "a key past the small string buffer " + std::to_string(i * 7919 % 20000);
+        tree.try_emplace(key, tracked);
+        expected.emplace(key, i);
+    }
+
+    if (tree.size() != expected.size() || tracked.use_count() != 20001)
+        return false;
+
+    const std::string_view probe = "a key past the small string buffer 42";
+    if (!tree.contains(probe) || tree.at(probe) != tracked || tree.find(std::string_view("nope")) != tree.end()) {
+        std::cerr << "[FAILED] btree_map lookup by string_view failed." << std::endl;
+        return false;
+    }
+
+    auto want = expected.begin();
+    for (const auto& [key, value] : tree) {
+        if (key != want->first) {
+            std::cerr << "[FAILED] btree_map iterates out of order at " << key << std::endl;
+            return false;
+        }
+        ++want;
+    }
+
+    for (int i = 0; i < 20000; i += 2)
+        tree.erase("a key past the small string buffer " + std::to_string(i));
+
+    if (tree.size() != 10000 || tracked.use_count() != 10001)
+        return false;
+
+    tree.clear();
+    if (tracked.use_count() != 1) {
+        std::cerr << "[FAILED] btree_map leaked " << tracked.use_count() - 1 << " values." << std::endl;
+        return false;
+    }
+
+    tree["b"] = tracked;
+    tree.insert_or_assign("b", nullptr);
+    return tree.size() == 1 && tree.at("b") == nullptr && tracked.use_count() == 1;
+}
+
+static bool sorted_linked_list_interface() {
+    dwhbll::collections::btree_multiset<int> tree{5, 3, 9, 3};
+    tree.insert(3, 7);
+    tree.insert({1, 11});
+
+    if (tree.front() != 1 || tree.back() != 11 || tree.count(3) != 2 || tree.count(7) != 3)
+        return false;
+
+    tree.pop_front();
+    tree.pop_back();
+    if (tree.remove(7) != 3 || tree.remove_if([](int v) { return v > 4; }) != 2 || tree.size() != 2 ||
+        tree.front() != 3 || tree.back() != 3) {
+        std::cerr << "[FAILED] btree_multiset list operations misbehave." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool insert_own_entries() {
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; i++)
+        keys.push_back("a key past the small string buffer " + std::to_string(1000 + i));
+
+    // full leaves, so inserting splits them and moves the entry being copied
+    dwhbll::collections::btree_multiset<std::string> tree;
+    tree.assign_sorted(keys.begin(), keys.end());
+
+    for (const auto& key : keys) {
+        tree.insert(*tree.find(key));
+        tree.insert(2, *tree.find(key));
+
+        if (tree.count(key) != 4) {
+            std::cerr << "[FAILED] btree_multiset has " << tree.count(key) << " copies of its own entry " << key << std::endl;
+            return false;
+        }
+    }
+
+    return tree.size() == 400;
+}
+
+bool btree_test(std::optional<std::string> test_to_run) {
+    return matches_multiset() && set_bounds_and_ranges() && bulk_load() && map_with_string_keys() &&
+           sorted_linked_list_interface() && insert_own_entries();
+}
@@ -1,30 +1,166 @@
 #include <iostream>
 #include <dwhbll/collections/cache.h>
+#include <string>
 #include <thread>
+#include <vector>
 
-bool cache_test(std::optional<std::string> test_to_run) {
-    dwhbll::collections::cache<std::string, std::string> cache;
+using namespace std::chrono_literals;
 
-    auto* k = cache.addEntry(std::chrono::system_clock::now() + std::chrono::seconds(1), "a", "b");
-    auto* k2 = cache.keys.find("a");
+static bool entries_expire() {
+    dwhbll::collections::cache<std::string, std::string> cache;
 
-    if (k2 != k)
-        return false; // broke something else
+    cache.addEntry(std::chrono::system_clock::now() + 100ms, "a", "b");
 
     try {
-        std::cout << cache.getEntry("a");
+        if (cache.getEntry("a") != "b")
+            return false;
     } catch (std::exception& e) {
+        std::cerr << "[FAILED] cache lost a fresh entry." << std::endl;
         return false;
     }
 
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+    std::this_thread::sleep_for(200ms);
 
     try {
-        std::cout << cache.getEntry("a");
-    } catch (std::out_of_range& e) {
-        std::cout << e.what();
-        return true;
+        cache.getEntry("a");
+        std::cerr << "[FAILED] cache returned an expired entry." << std::endl;
+        return false;
+    } catch (std::out_of_range& e) {}
+
+    const auto stats = cache.stats();
+    if (stats.hits != 1 || stats.misses != 1 || stats.expirations != 1 || cache.size() != 0) {
+        std::cerr << "[FAILED] cache expiry was not accounted for." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool unread_entries_expire() {
+    dwhbll::collections::cache<int, int> cache(100000, 1);
+    const auto now = std::chrono::system_clock::now();
+
+    // spread over many wheel buckets and a few levels, none of these is read again
+    for (int i = 0; i < 50000; i++)
+        cache.addEntry(now + std::chrono::milliseconds(i % 500), i, i);
+    for (int i = 50000; i < 51000; i++)
+        cache.addEntry(now + std::chrono::minutes(10), i, i);
+    cache.addEntry(-1, -1);
+
+    std::this_thread::sleep_for(600ms);
+
+    // a write advances the wheel of its shard
+    cache.addEntry(now + std::chrono::minutes(10), -2, -2);
+
+    if (cache.size() != 1002 || cache.stats().expirations != 50000) {
+        std::cerr << "[FAILED] cache holds " << cache.size() << " entries after 50000 of 51002 expired." << std::endl;
+        return false;
+    }
+
+    dwhbll::collections::cache<int, int> sharded(100000);
+    for (int i = 0; i < 10000; i++)
+        sharded.addEntry(now + 100ms, i, i);
+
+    std::this_thread::sleep_for(200ms);
+    sharded.cleanUp();
+
+    if (sharded.size() != 0) {
+        std::cerr << "[FAILED] cache clean up left " << sharded.size() << " expired entries." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool capacity_is_bounded() {
+    dwhbll::collections::cache<int, int> cache(1000);
+
+    for (int i = 0; i < 10000; i++)
+        cache.addEntry(i, i * 2);
+
+    const auto stats = cache.stats();
+    if (cache.size() > 1000 || stats.evictions != 10000 - cache.size()) {
+        std::cerr << "[FAILED] cache of 1000 holds " << cache.size() << " entries after " << stats.evictions
+                  << " evictions." << std::endl;
+        return false;
     }
 
-    return false;
+    // whatever survived still maps to its own value
+    for (int i = 0; i < 10000; i++) {
+        if (auto value = cache.findEntry(i); value && *value != i * 2) {
+            std::cerr << "[FAILED] cache mixed up entries while evicting." << std::endl;
+            return false;
+        }
+    }
+
+    cache.addEntry(-1, 1);
+    cache.addEntry(-1, 2);
+    if (cache.findEntry(-1) != 2 || !cache.removeEntry(-1) || cache.findEntry(-1)) {
+        std::cerr << "[FAILED] cache did not replace or remove an entry." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool scans_keep_popular_keys() {
+    dwhbll::collections::cache<int, int> cache(100, 1);
+
+    for (int round = 0; round < 10; round++) {
+        for (int hot = 0; hot < 50; hot++) {
+            if (!cache.findEntry(hot))
+                cache.addEntry(hot, hot);
+        }
+    }
+
+    // a scan of keys seen once, many times the capacity, would flush a plain LRU
+    for (int i = 0; i < 2000; i++) {
+        cache.findEntry(i % 50);
+        cache.addEntry(1000 + i, i);
+    }
+
+    int kept = 0;
+    for (int hot = 0; hot < 50; hot++)
+        kept += cache.findEntry(hot).has_value();
+
+    if (kept < 45) {
+        std::cerr << "[FAILED] a scan pushed out " << 50 - kept << " of 50 popular keys." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool shared_between_threads() {
+    dwhbll::collections::cache<int, int> cache(4096);
+    constexpr int per_thread = 100000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < per_thread; i++) {
+                const int key = (i * 7919 + t) % 8192;
+                if (auto value = cache.findEntry(key); !value)
+                    cache.addEntry(key, key);
+                else if (*value != key)
+                    std::terminate();
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    const auto stats = cache.stats();
+    if (stats.hits + stats.misses != 4 * per_thread || cache.size() > cache.capacity()) {
+        std::cerr << "[FAILED] cache counters are off after concurrent use." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool cache_test(std::optional<std::string> test_to_run) {
+    return entries_expire() && unread_entries_expire() && capacity_is_bounded() && scans_keep_popular_keys() &&
+           shared_between_threads();
 }
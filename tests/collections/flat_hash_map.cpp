@@ -0,0 +1,188 @@
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <dwhbll/collections/flat_hash_map.h>
+
+static bool matches_unordered_map() {
+    dwhbll::collections::flat_hash_map<std::uint64_t, std::uint64_t> map;
+    std::unordered_map<std::uint64_t, std::uint64_t> expected;
+    std::mt19937_64 rng(42);
+
+    // few enough keys that erases leave plenty of tombstones behind for the inserts to reuse
+    for (int i = 0; i < 200000; i++) {
+        const std::uint64_t key = rng() % 5000;
+
+        switch (rng() % 4) {
+            case 0:
+            case 1:
+                map[key] = i;
+                expected[key] = i;
+                break;
+            case 2:
+                if (map.erase(key) != expected.erase(key)) {
+                    std::cerr << "[FAILED] flat_hash_map erase disagrees on key " << key << std::endl;
+                    return false;
+                }
+                break;
+            default: {
+                auto found = map.find(key);
+                auto wanted = expected.find(key);
+                if ((found == map.end()) != (wanted == expected.end()) ||
+                    (found != map.end() && found->second != wanted->second)) {
+                    std::cerr << "[FAILED] flat_hash_map lookup disagrees on key " << key << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    std::size_t seen = 0;
+    for (const auto& [key, value] : map) {
+        seen++;
+        if (!expected.contains(key) || expected[key] != value) {
+            std::cerr << "[FAILED] flat_hash_map iterated over a stale entry." << std::endl;
+            return false;
+        }
+    }
+
+    if (seen != expected.size() || map.size() != expected.size() || map.load_factor() > map.max_load_factor()) {
+        std::cerr << "[FAILED] flat_hash_map holds " << map.size() << " entries, expected " << expected.size()
+                  << std::endl;
+        return false;
+    }
+
+    // erasing while iterating visits every entry once
+    for (auto it = map.begin(); it != map.end();)
+        it = it->first % 2 == 0 ? map.erase(it) : std::next(it);
+    for (const auto& [key, _] : map)
+        if (key % 2 == 0)
+            return false;
+
+    return true;
+}
+
+struct string_hash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+
+static bool heterogeneous_lookup() {
+    dwhbll::collections::flat_hash_map<std::string, int, string_hash, std::equal_to<>> map{
+        {"content-type", 1}, {"content-length", 2}};
+    map.try_emplace("a header name well past the small string buffer", 3);
+
+    const std::string_view key = "content-length";
+    if (!map.contains(key) || map.at(key) != 2 || map.find(std::string_view("host")) != map.end() ||
+        map.at("a header name well past the small string buffer") != 3) {
+        std::cerr << "[FAILED] flat_hash_map lookup by string_view failed." << std::endl;
+        return false;
+    }
+
+    try {
+        map.at(std::string_view("host"));
+        std::cerr << "[FAILED] flat_hash_map::at found a missing key." << std::endl;
+        return false;
+    } catch (std::out_of_range&) {}
+
+    // growing moves the long keys to their new slots intact
+    for (int i = 0; i < 1000; i++)
+        map.try_emplace(std::to_string(i), i);
+
+    if (map.erase(key) != 1 || map.contains(key) || map.size() != 1002 ||
+        map.at("a header name well past the small string buffer") != 3 || map.at("999") != 999) {
+        std::cerr << "[FAILED] flat_hash_map lost string keys while growing." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool values_are_destroyed() {
+    auto tracked = std::make_shared<int>(0);
+
+    {
+        dwhbll::collections::flat_hash_map<int, std::shared_ptr<int>> map;
+        for (int i = 0; i < 1000; i++)
+            map.try_emplace(i, tracked);
+
+        // a key already there constructs nothing
+        map.try_emplace(0, std::make_shared<int>(1));
+        for (int i = 0; i < 500; i++)
+            map.erase(i);
+
+        auto copy = map;
+        auto moved = std::move(copy);
+
+        if (tracked.use_count() != 1001 || !(moved == map) || *map[999] != 0) {
+            std::cerr << "[FAILED] flat_hash_map holds " << tracked.use_count() - 1 << " references, expected 1000"
+                      << std::endl;
+            return false;
+        }
+
+        map.clear();
+        if (tracked.use_count() != 501 || !map.empty()) {
+            std::cerr << "[FAILED] flat_hash_map clear leaked values." << std::endl;
+            return false;
+        }
+    }
+
+    if (tracked.use_count() != 1) {
+        std::cerr << "[FAILED] flat_hash_map leaked " << tracked.use_count() - 1 << " values." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool reserve_and_rehash() {
+    dwhbll::collections::flat_hash_map<int, int> map;
+    map.reserve(1000);
+    const auto reserved = map.capacity();
+
+    for (int i = 0; i < 1000; i++)
+        map.insert({i, i});
+
+    if (map.capacity() != reserved || reserved < 1000) {
+        std::cerr << "[FAILED] flat_hash_map rehashed within what was reserved." << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < 990; i++)
+        map.erase(i);
+    map.rehash(0);
+
+    if (map.capacity() >= reserved || map.size() != 10 || map.at(995) != 995) {
+        std::cerr << "[FAILED] flat_hash_map did not shrink, capacity " << map.capacity() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool set_operations() {
+    dwhbll::collections::flat_hash_set<int> set{1, 2, 3};
+
+    if (!set.insert(4).second || set.insert(4).second || set.count(4) != 1 || set.erase(2) != 1 || set.contains(2) ||
+        set.size() != 3) {
+        std::cerr << "[FAILED] flat_hash_set insert and erase misbehave." << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < 10000; i++)
+        set.emplace(i * 7);
+    for (int i = 0; i < 10000; i++)
+        if (!set.contains(i * 7))
+            return false;
+
+    return true;
+}
+
+bool flat_hash_map_test(std::optional<std::string> test_to_run) {
+    return matches_unordered_map() && heterogeneous_lookup() && values_are_destroyed() && reserve_and_rehash() &&
+           set_operations();
+}
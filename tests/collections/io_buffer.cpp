@@ -0,0 +1,113 @@
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dwhbll/collections/io_buffer.h>
+#include <dwhbll/collections/memory_buffer.h>
+
+using dwhbll::collections::io_buffer;
+using dwhbll::collections::io_buffer_pool;
+
+bool io_buffer_test(std::optional<std::string> test_to_run) {
+    io_buffer_pool pool;
+
+    {
+        io_buffer buffer(pool);
+
+        // three and a half segments, written in odd sized pieces
+        std::vector<std::uint8_t> data(io_buffer_pool::SEGMENT_SIZE * 7 / 2);
+        for (std::size_t i = 0; i < data.size(); i++)
+            data[i] = static_cast<std::uint8_t>(i * 7);
+
+        for (std::size_t written = 0; written < data.size(); written += 1000)
+            buffer.append(std::span{data}.subspan(written, std::min<std::size_t>(1000, data.size() - written)));
+
+        if (buffer.size() != data.size() || pool.in_use() != 4) {
+            std::cerr << "[FAILED] io_buffer holds " << buffer.size() << " bytes in " << pool.in_use() << " segments"
+                      << std::endl;
+            return false;
+        }
+
+        if (buffer[io_buffer_pool::SEGMENT_SIZE + 5] != data[io_buffer_pool::SEGMENT_SIZE + 5]) {
+            std::cerr << "[FAILED] io_buffer indexing across segments" << std::endl;
+            return false;
+        }
+
+        std::vector<std::uint8_t> peeked(100);
+        if (buffer.peek(peeked, io_buffer_pool::SEGMENT_SIZE - 50) != 100 ||
+            !std::equal(peeked.begin(), peeked.end(), data.begin() + io_buffer_pool::SEGMENT_SIZE - 50)) {
+            std::cerr << "[FAILED] io_buffer peek across a segment boundary" << std::endl;
+            return false;
+        }
+
+        iovec parts[8];
+        if (buffer.gather(parts) != 4 || parts[0].iov_len != io_buffer_pool::SEGMENT_SIZE ||
+            parts[3].iov_len != io_buffer_pool::SEGMENT_SIZE / 2) {
+            std::cerr << "[FAILED] io_buffer gather" << std::endl;
+            return false;
+        }
+
+        // drained segments go back to the pool as soon as they are consumed
+        buffer.consume(io_buffer_pool::SEGMENT_SIZE + 10);
+
+        if (pool.in_use() != 3 || buffer.readable().size() != io_buffer_pool::SEGMENT_SIZE - 10 ||
+            buffer.readable()[0] != data[io_buffer_pool::SEGMENT_SIZE + 10]) {
+            std::cerr << "[FAILED] io_buffer consume did not release the first segment" << std::endl;
+            return false;
+        }
+
+        std::vector<std::uint8_t> rest(data.size());
+        const auto count = buffer.read(rest);
+
+        if (count != data.size() - io_buffer_pool::SEGMENT_SIZE - 10 || !buffer.empty() ||
+            !std::equal(rest.begin(), rest.begin() + count, data.begin() + io_buffer_pool::SEGMENT_SIZE + 10)) {
+            std::cerr << "[FAILED] io_buffer read back the wrong bytes" << std::endl;
+            return false;
+        }
+
+        // direct writes into the free space
+        auto space = buffer.writable();
+        space[0] = 'h';
+        space[1] = 'i';
+        buffer.commit(2);
+
+        io_buffer moved(std::move(buffer));
+
+        if (moved.size() != 2 || moved[1] != 'i' || !buffer.empty()) {
+            std::cerr << "[FAILED] io_buffer move" << std::endl;
+            return false;
+        }
+    }
+
+    if (pool.in_use() != 0 || pool.capacity() != io_buffer_pool::SEGMENTS_PER_SLAB) {
+        std::cerr << "[FAILED] io_buffer leaked segments, " << pool.in_use() << " still in use" << std::endl;
+        return false;
+    }
+
+    // the same segments serve the next buffer
+    {
+        io_buffer buffer(pool);
+        std::vector<std::uint8_t> data(io_buffer_pool::SEGMENT_SIZE * 2, 1);
+        buffer.append(data);
+    }
+
+    if (pool.capacity() != io_buffer_pool::SEGMENTS_PER_SLAB) {
+        std::cerr << "[FAILED] io_buffer_pool allocated instead of recycling" << std::endl;
+        return false;
+    }
+
+    // MemBuf sits on top of io_buffer
+    dwhbll::collections::MemBuf membuf;
+    membuf.set_big_endian(true);
+    membuf.write_u32(0xDEADBEEF);
+    membuf.write_string("abc");
+
+    if (membuf.size() != 7 || membuf.peek_u8(4) != 'a' || membuf.read_u32() != 0xDEADBEEF ||
+        membuf.read_vector(3) != std::vector<std::uint8_t>{'a', 'b', 'c'} || !membuf.empty()) {
+        std::cerr << "[FAILED] MemBuf over io_buffer" << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -1,7 +1,212 @@
 #include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
 #include <dwhbll/collections/ring.h>
 
+static bool span_operations_behave() {
+    dwhbll::collections::Ring<int> ring(8);
+    std::vector<int> values(20);
+    std::iota(values.begin(), values.end(), 0);
+
+    // wrap the contents around the end of the buffer
+    ring.push_back(std::span{values}.first(6));
+    ring.discard(4);
+    ring.push_back(std::span{values}.subspan(6, 5));
+
+    auto [first, second] = ring.segments();
+    if (ring.size() != 7 || ring.capacity() != 8 || first.size() != 4 || second.size() != 3 || first[0] != 4 ||
+        second[2] != 10) {
+        std::cerr << "[FAILED] ring segments do not cover the wrapped contents." << std::endl;
+        return false;
+    }
+
+    // growing while wrapped keeps the order
+    ring.push_back(std::span{values}.subspan(11));
+
+    std::vector<int> out(32);
+    const std::size_t popped = ring.pop_front_into(out);
+
+    if (popped != 16 || !ring.empty() || !std::equal(out.begin(), out.begin() + 16, values.begin() + 4)) {
+        std::cerr << "[FAILED] ring span operations lost the order, popped " << popped << std::endl;
+        return false;
+    }
+
+    // a full wrapped ring grows one element at a time too
+    ring.push_back(std::span{values}.first(ring.capacity()));
+    ring.discard(3);
+    for (int i = 0; i < 4; i++)
+        ring.push_back(100 + i);
+
+    int expected = 3;
+    for (const int entry : ring) {
+        if (entry != (expected < 16 ? expected : 100 + expected - 16)) {
+            std::cerr << "[FAILED] ring growing a full wrapped buffer scrambled it." << std::endl;
+            return false;
+        }
+        expected++;
+    }
+
+    try {
+        ring.discard(ring.size() + 1);
+        std::cerr << "[FAILED] ring discarded more than it held." << std::endl;
+        return false;
+    } catch (const std::out_of_range &) {}
+
+    return true;
+}
+
+namespace {
+    int alive = 0;
+
+    /**
+     * @brief Counts the live instances, and is not trivially relocatable since it points into itself.
+     */
+    struct Tracked {
+        int value;
+        Tracked* self = this;
+
+        Tracked(int value) : value(value) { alive++; }
+        Tracked(const Tracked& other) : value(other.value) { alive++; }
+        Tracked(Tracked&& other) noexcept : value(other.value) { alive++; }
+        Tracked& operator=(const Tracked& other) { value = other.value; return *this; }
+        ~Tracked() { alive--; }
+
+        [[nodiscard]] bool intact() const { return self == this; }
+    };
+}
+
+static bool non_trivial_elements_behave() {
+    {
+        dwhbll::collections::Ring<Tracked> ring(4);
+
+        // wrap, then grow past the capacity twice
+        for (int i = 0; i < 3; i++)
+            ring.emplace_back(i);
+        ring.pop_front();
+        for (int i = 3; i < 12; i++)
+            ring.push_back(Tracked{i});
+        ring.push_front(Tracked{0});
+
+        int expected = 0;
+        for (const Tracked& entry : ring) {
+            if (!entry.intact() || entry.value != expected) {
+                std::cerr << "[FAILED] ring moved a non trivial element badly." << std::endl;
+                return false;
+            }
+            expected++;
+        }
+
+        if (alive != static_cast<int>(ring.size())) {
+            std::cerr << "[FAILED] ring holds " << ring.size() << " elements but " << alive << " are alive." << std::endl;
+            return false;
+        }
+
+        dwhbll::collections::Ring<Tracked> copy = ring;
+        ring.make_cont();
+        ring.resize(5);
+        copy.discard(3);
+
+        if (alive != static_cast<int>(ring.size() + copy.size()) || ring.back().value != 4 || copy.front().value != 3) {
+            std::cerr << "[FAILED] ring copies, resizes or discards leak elements." << std::endl;
+            return false;
+        }
+    }
+
+    if (alive != 0) {
+        std::cerr << "[FAILED] " << alive << " ring elements outlived their ring." << std::endl;
+        return false;
+    }
+
+    // strings are not trivially copyable, the old memcpy growth broke them
+    dwhbll::collections::Ring<std::string> strings(2);
+    for (int i = 0; i < 40; i++)
+        strings.push_back(std::string(32, static_cast<char>('a' + i % 26)));
+
+    for (std::size_t i = 0; i < strings.size(); i++) {
+        if (strings[i] != std::string(32, static_cast<char>('a' + i % 26))) {
+            std::cerr << "[FAILED] ring of strings lost its contents while growing." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool inline_storage_behaves() {
+    using Small = dwhbll::collections::Ring<std::string, 4>;
+
+    Small ring;
+    const auto in_ring = [&](const Small& r) {
+        const auto* at = reinterpret_cast<const std::byte*>(r.data());
+        return at >= reinterpret_cast<const std::byte*>(&r) && at < reinterpret_cast<const std::byte*>(&r) + sizeof(r);
+    };
+
+    for (int i = 0; i < 4; i++)
+        ring.push_back(std::to_string(i));
+
+    if (ring.capacity() != 4 || !in_ring(ring)) {
+        std::cerr << "[FAILED] a small ring allocated before outgrowing its inline storage." << std::endl;
+        return false;
+    }
+
+    // moving an inline ring moves the elements, not the buffer
+    Small moved = std::move(ring);
+    if (!ring.empty() || moved.size() != 4 || !in_ring(moved) || moved[3] != "3") {
+        std::cerr << "[FAILED] moving an inline ring lost its elements." << std::endl;
+        return false;
+    }
+
+    moved.push_back("4");
+    if (moved.capacity() <= 4 || in_ring(moved) || moved.front() != "0" || moved.back() != "4") {
+        std::cerr << "[FAILED] an inline ring did not move to the heap when it outgrew its storage." << std::endl;
+        return false;
+    }
+
+    // and back in once it is small enough again
+    moved.resize(3);
+    if (!in_ring(moved) || moved.size() != 3 || moved[2] != "2") {
+        std::cerr << "[FAILED] an inline ring did not move back into its storage." << std::endl;
+        return false;
+    }
+
+    ring = moved;
+    if (ring.size() != 3 || ring[0] != "0" || !in_ring(ring)) {
+        std::cerr << "[FAILED] copying into an inline ring lost elements." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool full_ring_iterates() {
+    dwhbll::collections::Ring<int> ring(4);
+    for (int i = 0; i < 4; i++)
+        ring.push_back(i);
+    ring.discard(2);
+    ring.push_back(4);
+    ring.push_back(5);
+
+    // full and wrapped, the end is where the beginning is in the buffer
+    if (ring.size() != ring.capacity() || std::distance(ring.begin(), ring.end()) != 4) {
+        std::cerr << "[FAILED] iterating a full ring does not cover it." << std::endl;
+        return false;
+    }
+
+    const std::vector<int> backwards(ring.rbegin(), ring.rend());
+    if (backwards != std::vector<int>{5, 4, 3, 2}) {
+        std::cerr << "[FAILED] reverse iterating a ring is out of order." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 bool ring_test(std::optional<std::string> test_to_run) {
+    if (!span_operations_behave() || !non_trivial_elements_behave() || !inline_storage_behaves() ||
+        !full_ring_iterates())
+        return false;
+
     dwhbll::collections::Ring<int> ringBuffer;
 
     std::size_t before = ringBuffer.size();
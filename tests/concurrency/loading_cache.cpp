@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dwhbll/concurrency/coroutine/loading_cache.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/sleep_task.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+
+using namespace std::chrono_literals;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::sleep_for;
+using dwhbll::concurrency::coroutine::task;
+
+namespace {
+    using cache_type = dwhbll::concurrency::coroutine::loading_cache<std::string, int>;
+
+    /**
+     * @brief Stands in for a backend, counting how often it is asked.
+     */
+    struct backend {
+        int calls = 0;
+        int value = 1;
+        bool fail = false;
+
+        auto loader() {
+            return [this](const std::string &key) -> task<std::optional<int>> {
+                calls++;
+                co_await sleep_for(20ms);
+
+                if (fail)
+                    throw std::runtime_error("backend down");
+                if (key == "missing")
+                    co_return std::nullopt;
+                co_return value;
+            };
+        }
+    };
+
+    task<> get_into(cache_type &cache, backend &b, std::string key, std::optional<int> &out, bool &threw) {
+        try {
+            out = co_await cache.get_or_load(std::move(key), b.loader());
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+    }
+
+    task<> herd(cache_type &cache, backend &b, bool &ok) {
+        constexpr int waiters = 100;
+        std::vector<std::optional<int>> got(waiters);
+        bool threw = false;
+
+        for (int i = 0; i < waiters; i++)
+            reactor::get_thread_reactor()->spawn(get_into(cache, b, "hot", got[i], threw));
+
+        // long enough for the load, too short for the value to be due for a refresh
+        co_await sleep_for(40ms);
+
+        for (const auto &value : got) {
+            if (value != 1) {
+                std::cerr << "[FAILED] a coroutine of the herd did not get the loaded value." << std::endl;
+                co_return;
+            }
+        }
+
+        if (b.calls != 1 || cache.stat().coalesced != waiters - 1 || threw) {
+            std::cerr << "[FAILED] " << waiters << " concurrent misses loaded " << b.calls << " times." << std::endl;
+            co_return;
+        }
+
+        if (co_await cache.get_or_load("hot", b.loader()) != 1 || b.calls != 1 || cache.stat().hits != 1) {
+            std::cerr << "[FAILED] a loaded value was not served from the cache." << std::endl;
+            co_return;
+        }
+
+        ok = true;
+    }
+
+    task<> negative_and_failures(cache_type &cache, backend &b, bool &ok) {
+        const int before = b.calls;
+
+        if (co_await cache.get_or_load("missing", b.loader()) || co_await cache.get_or_load("missing", b.loader()) ||
+            b.calls != before + 1 || cache.stat().negative_hits != 1) {
+            std::cerr << "[FAILED] a key without a value was not remembered." << std::endl;
+            co_return;
+        }
+
+        // every waiter sees the failure, and it is not remembered
+        b.fail = true;
+        std::array<std::optional<int>, 10> got;
+        std::array<bool, 10> threw{};
+        for (int i = 0; i < 10; i++)
+            reactor::get_thread_reactor()->spawn(get_into(cache, b, "flaky", got[i], threw[i]));
+
+        co_await sleep_for(100ms);
+
+        if (std::count(threw.begin(), threw.end(), true) != 10 || cache.stat().load_failures != 1) {
+            std::cerr << "[FAILED] a failed load did not reach every waiter." << std::endl;
+            co_return;
+        }
+
+        b.fail = false;
+        if (co_await cache.get_or_load("flaky", b.loader()) != 1) {
+            std::cerr << "[FAILED] a failed load was remembered." << std::endl;
+            co_return;
+        }
+
+        ok = true;
+    }
+
+    task<> refresh_ahead(cache_type &cache, backend &b, bool &ok) {
+        co_await cache.get_or_load("refreshed", b.loader());
+        const int before = b.calls;
+        b.value = 2;
+
+        co_await sleep_for(60ms);
+
+        // stale but not expired, served right away while it reloads
+        const auto start = std::chrono::steady_clock::now();
+        const auto stale = co_await cache.get_or_load("refreshed", b.loader());
+
+        if (stale != 1 || std::chrono::steady_clock::now() - start > 10ms) {
+            std::cerr << "[FAILED] a read due for a refresh waited for it." << std::endl;
+            co_return;
+        }
+
+        co_await sleep_for(50ms);
+
+        if (co_await cache.get_or_load("refreshed", b.loader()) != 2 || b.calls != before + 1 ||
+            cache.stat().refreshes != 1) {
+            std::cerr << "[FAILED] a value was not refreshed ahead of its expiry." << std::endl;
+            co_return;
+        }
+
+        ok = true;
+    }
+}
+
+bool loading_cache_test(std::optional<std::string> test_to_run) {
+    cache_type cache({.capacity = 1024, .ttl = 10s, .refresh_after = 50ms, .negative_ttl = 10s});
+    backend b;
+    bool herd_ok = false, negative_ok = false, refresh_ok = false;
+
+    reactor r;
+    r.spawn(herd(cache, b, herd_ok));
+    r.run();
+
+    r.spawn(negative_and_failures(cache, b, negative_ok));
+    r.run();
+
+    r.spawn(refresh_ahead(cache, b, refresh_ok));
+    r.run();
+
+    return herd_ok && negative_ok && refresh_ok;
+}
@@ -0,0 +1,154 @@
+#include "bench/http_load_bench.h"
+
+#include <charconv>
+#include <iostream>
+#include <string_view>
+
+#include <dwhbll/network/http_server.hpp>
+
+static void usage(const char *name) {
+  std::cerr << "Usage: " << name
+            << " [-c connections] [-p pipeline depth] [-d seconds]"
+               " [-R requests/s] [-r METHOD:/path[:weight]]... host:port\n"
+               "  -R runs open loop at the given total rate, closed loop "
+               "otherwise\n"
+               "  -r may be repeated to build a weighted request mix, GET / "
+               "by default\n";
+}
+
+template <typename T> static bool parse_number(std::string_view text, T &out) {
+  auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+  return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+static bool parse_endpoint(std::string_view text,
+                           dwhbll::network::address &endpoint) {
+  const auto colon = text.rfind(':');
+  std::uint16_t port;
+
+  if (colon == std::string_view::npos ||
+      !parse_number(text.substr(colon + 1), port)) {
+    return false;
+  }
+
+  const auto host = text.substr(0, colon);
+  std::array<std::uint8_t, 4> ipv4;
+  std::string_view rest = host;
+
+  for (std::size_t i = 0; i < ipv4.size(); i++) {
+    const auto dot = rest.find('.');
+
+    if ((dot == std::string_view::npos) != (i == ipv4.size() - 1) ||
+        !parse_number(rest.substr(0, dot), ipv4[i])) {
+      endpoint = dwhbll::network::address(std::string(host), port);
+      return !host.empty();
+    }
+
+    rest = dot == std::string_view::npos ? std::string_view{}
+                                         : rest.substr(dot + 1);
+  }
+
+  endpoint = dwhbll::network::address(ipv4, port);
+  return true;
+}
+
+static bool parse_request(std::string_view text, http_load::request_spec &spec) {
+  const auto colon = text.find(':');
+
+  if (colon == std::string_view::npos) {
+    return false;
+  }
+
+  const auto method = dwhbll::network::http_server::detail::method_map.find(
+      text.substr(0, colon));
+
+  if (method == dwhbll::network::http_server::detail::method_map.end()) {
+    return false;
+  }
+
+  spec.request.method = method->second;
+  text.remove_prefix(colon + 1);
+
+  // a path may contain ':' itself, only a numeric suffix is a weight
+  const auto weight = text.rfind(':');
+  if (weight != std::string_view::npos &&
+      parse_number(text.substr(weight + 1), spec.weight)) {
+    text = text.substr(0, weight);
+  }
+
+  spec.request.path = std::string(text);
+  return text.starts_with('/');
+}
+
+int main(int argc, char **argv) {
+  http_load::options opts;
+  bool has_endpoint = false;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+
+    if (arg.size() == 2 && arg[0] == '-' && i + 1 < argc) {
+      const std::string_view value = argv[++i];
+      bool ok;
+
+      switch (arg[1]) {
+      case 'c':
+        ok = parse_number(value, opts.connections);
+        break;
+
+      case 'p':
+        ok = parse_number(value, opts.pipeline_depth);
+        break;
+
+      case 'd': {
+        double seconds;
+        ok = parse_number(value, seconds);
+        opts.duration = std::chrono::duration_cast<
+            std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds));
+        break;
+      }
+
+      case 'R':
+        ok = parse_number(value, opts.rate);
+        break;
+
+      case 'r': {
+        http_load::request_spec spec;
+        ok = parse_request(value, spec);
+        opts.mix.push_back(std::move(spec));
+        break;
+      }
+
+      default:
+        ok = false;
+        break;
+      }
+
+      if (!ok) {
+        std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+        usage(argv[0]);
+        return 1;
+      }
+
+      continue;
+    }
+
+    if (has_endpoint || !parse_endpoint(arg, opts.endpoint)) {
+      usage(argv[0]);
+      return 1;
+    }
+
+    has_endpoint = true;
+  }
+
+  if (!has_endpoint || opts.connections == 0 || opts.pipeline_depth == 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  const auto result = http_load::run(opts);
+  std::cout << result.report() << std::endl;
+
+  return result.requests == 0 ? 1 : 0;
+}
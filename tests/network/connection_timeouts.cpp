@@ -0,0 +1,276 @@
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dwhbll/async/net/socket.h>
+#include <dwhbll/async/net/tcp_listener.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/sleep_task.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/network/address.h>
+#include <dwhbll/network/http_server.hpp>
+
+namespace http_server = dwhbll::network::http_server;
+
+using namespace std::chrono_literals;
+using clock_type = std::chrono::steady_clock;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::task;
+
+namespace {
+    constexpr std::uint16_t port = 8096;
+    constexpr std::size_t large_body = 4 << 20;
+
+    struct EchoHandler {
+        void handle(http_server::Request &request, http_server::Response &response) {
+            response.code = "200";
+            response.reason = "OK";
+
+            if (request.path == "/large") {
+                response.body.assign(large_body, std::byte{'x'});
+                return;
+            }
+
+            // a body that stops coming fails the read instead of blocking the worker
+            if (!request.read_body()) {
+                response.code = "400";
+                response.reason = "Bad Request";
+            }
+        }
+    };
+
+    struct EchoFactory {
+        EchoHandler operator()() { return {}; }
+    };
+
+    int open_connection() {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    void send_text(int fd, std::string_view text) {
+        (void)write(fd, text.data(), text.size());
+    }
+
+    /**
+     * @brief Read until the server closes the connection.
+     * @return everything read.
+     */
+    std::string read_to_close(int fd) {
+        std::string received;
+        char chunk[4096];
+        ssize_t count;
+
+        while ((count = read(fd, chunk, sizeof(chunk))) > 0)
+            received.append(chunk, count);
+
+        return received;
+    }
+
+    /**
+     * @brief Whether the server closed `fd` within `limit`.
+     */
+    bool closed_within(int fd, clock_type::duration limit) {
+        const timeval timeout{static_cast<time_t>(std::chrono::duration_cast<std::chrono::seconds>(limit).count()) + 1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        const auto start = clock_type::now();
+        char byte;
+        while (read(fd, &byte, 1) > 0) {}
+
+        return clock_type::now() - start <= limit;
+    }
+
+    bool slow_header_dropped() {
+        const int fd = open_connection();
+        const auto start = clock_type::now();
+
+        // a byte every 50ms never lets a per-read timeout of 200ms expire
+        for (const char byte : std::string_view("GET / HTTP/1.1\r\nhost: 127.0.0.1\r\n")) {
+            if (send(fd, &byte, 1, MSG_NOSIGNAL) != 1)
+                break;
+            std::this_thread::sleep_for(50ms);
+        }
+
+        const bool closed = closed_within(fd, 1s);
+        const auto took = clock_type::now() - start;
+        close(fd);
+
+        if (!closed || took > 1s) {
+            std::cerr << "[FAILED] a client trickling its header held the connection for "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(took).count() << "ms" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool idle_connection_dropped() {
+        const int fd = open_connection();
+        send_text(fd, "GET / HTTP/1.1\r\nhost: 127.0.0.1\r\n\r\n");
+
+        const auto start = clock_type::now();
+        const std::string received = read_to_close(fd);
+        const auto took = clock_type::now() - start;
+        close(fd);
+
+        if (!received.starts_with("HTTP/1.1 200") || took < 250ms || took > 2s) {
+            std::cerr << "[FAILED] idle keep-alive connection closed after "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(took).count() << "ms" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool stalled_body_dropped() {
+        const int fd = open_connection();
+        send_text(fd, "POST / HTTP/1.1\r\nhost: 127.0.0.1\r\ncontent-length: 10\r\n\r\nab");
+
+        const auto start = clock_type::now();
+        const std::string received = read_to_close(fd);
+        const auto took = clock_type::now() - start;
+        close(fd);
+
+        if (!received.starts_with("HTTP/1.1 400") || took > 2s) {
+            std::cerr << "[FAILED] stalled request body answered with " << received.substr(0, 12) << " after "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(took).count() << "ms" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool slow_reader_served() {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        const int small = 16 << 10;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+
+        send_text(fd, "GET /large HTTP/1.1\r\nhost: 127.0.0.1\r\nconnection: close\r\n\r\n");
+
+        // slower than the whole response can be sent in, but never quiet for the write timeout
+        std::string received;
+        std::array<char, 256 << 10> chunk;
+        ssize_t count;
+        while ((count = read(fd, chunk.data(), chunk.size())) > 0) {
+            received.append(chunk.data(), count);
+            std::this_thread::sleep_for(5ms);
+        }
+        close(fd);
+
+        const auto body = received.find("\r\n\r\n");
+        if (body == std::string::npos || received.size() - body - 4 != large_body) {
+            std::cerr << "[FAILED] slow reader got " << received.size() << " bytes of a " << large_body
+                      << " byte response" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    task<> stay_quiet(dwhbll::async::net::tcp_listener &listener) {
+        auto accepted = co_await listener.accept();
+        // holds the connection open without writing past the reader's timeout
+        co_await dwhbll::concurrency::coroutine::sleep_for(500ms);
+        (void)accepted;
+    }
+
+    task<> read_with_timeout(bool &ok) {
+        auto connected = co_await dwhbll::async::net::socket::connect_tcp(
+            false, dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, port + 1));
+
+        if (connected.is_err()) {
+            std::cerr << "[FAILED] cannot connect to the quiet listener" << std::endl;
+            co_return;
+        }
+
+        auto sock = std::move(connected.unwrap_unchecked());
+        sock->set_read_timeout(100ms);
+
+        std::array<std::uint8_t, 16> buffer;
+        const auto start = clock_type::now();
+        auto read = co_await sock->read_some(buffer);
+        const auto took = clock_type::now() - start;
+
+        if (!read.is_err() || read.unwrap_err_unchecked() != ETIMEDOUT || took < 100ms || took > 400ms) {
+            std::cerr << "[FAILED] async read of a quiet peer came back after "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(took).count() << "ms" << std::endl;
+            co_return;
+        }
+
+        // a deadline bounds a whole exchange, however much time each read gets
+        sock->set_read_timeout(1s);
+        sock->set_deadline(clock_type::now() + 50ms);
+        read = co_await sock->read_some(buffer);
+
+        if (!read.is_err() || read.unwrap_err_unchecked() != ETIMEDOUT || clock_type::now() - start > 400ms) {
+            std::cerr << "[FAILED] async read outlasted its deadline" << std::endl;
+            co_return;
+        }
+
+        ok = true;
+    }
+
+    bool async_read_times_out() {
+        dwhbll::async::net::tcp_listener listener;
+        listener.set_reuseaddr();
+
+        if (listener.listen(dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, port + 1)).is_err()) {
+            std::cerr << "[FAILED] cannot listen on port " << port + 1 << std::endl;
+            return false;
+        }
+
+        bool ok = false;
+
+        reactor r;
+        r.spawn(stay_quiet(listener));
+        r.spawn(read_with_timeout(ok));
+        r.run();
+
+        return ok;
+    }
+}
+
+bool connection_timeouts_test(std::optional<std::string> test_to_run) {
+    http_server::Server<EchoFactory> server;
+    server.add_route("/", EchoFactory());
+    server.add_route("/large", EchoFactory());
+    server.set_timeouts({.header = 200ms, .body = 200ms, .idle = 300ms, .write = 500ms});
+
+    // a single worker, a connection that held it would fail the checks after
+    if (server.listen_to(dwhbll::network::conv::make_ipv4(127, 0, 0, 1), port) || server.listen(1)) {
+        std::cerr << "[FAILED] cannot start the server on port " << port << std::endl;
+        return false;
+    }
+
+    const bool ok = slow_header_dropped() && idle_connection_dropped() && stalled_body_dropped() &&
+                    slow_reader_served();
+    server.stop();
+
+    return ok && async_read_times_out();
+}
@@ -0,0 +1,100 @@
+#include <array>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dwhbll/async/net/datagram_socket.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+
+using dwhbll::async::net::datagram_batch;
+using dwhbll::async::net::datagram_socket;
+using dwhbll::async::net::outgoing_datagram;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::task;
+
+namespace {
+    task<> exchange(datagram_socket &a, datagram_socket &b, bool &ok) {
+        const auto a_addr = a.local_address().unwrap_unchecked();
+        const auto b_addr = b.local_address().unwrap_unchecked();
+
+        // datagram i is i + 1 bytes of i
+        std::vector<std::vector<std::uint8_t>> payloads;
+        std::vector<outgoing_datagram> outgoing;
+
+        for (std::size_t i = 0; i < 100; i++)
+            payloads.emplace_back(i + 1, static_cast<std::uint8_t>(i));
+
+        for (auto &payload : payloads)
+            outgoing.push_back({payload, &b_addr});
+
+        if ((co_await a.send(outgoing)).is_err()) {
+            std::cerr << "[FAILED] datagram_socket batched send" << std::endl;
+            co_return;
+        }
+
+        // slots too small for the longer datagrams
+        datagram_batch batch(16, 64);
+        std::size_t received = 0;
+
+        while (received < payloads.size()) {
+            auto r = co_await b.receive(batch);
+
+            if (r.is_err()) {
+                std::cerr << "[FAILED] datagram_socket batched receive: " << r.unwrap_err_unchecked() << std::endl;
+                co_return;
+            }
+
+            for (std::size_t i = 0; i < batch.size(); i++, received++) {
+                const auto dgram = batch[i];
+                const auto expected = std::min<std::size_t>(received + 1, 64);
+
+                if (dgram.data.size() != expected || dgram.data[0] != received || dgram.source.port != a_addr.port ||
+                    batch.truncated(i) != (received + 1 > 64)) {
+                    std::cerr << "[FAILED] datagram " << received << " came back as " << dgram.data.size()
+                              << " bytes from port " << dgram.source.port << std::endl;
+                    co_return;
+                }
+            }
+        }
+
+        // single datagrams the other way round
+        const std::array<std::uint8_t, 3> reply{'a', 'c', 'k'};
+        if ((co_await b.send_to(reply, &a_addr)).is_err()) {
+            std::cerr << "[FAILED] datagram_socket send_to" << std::endl;
+            co_return;
+        }
+
+        std::array<std::uint8_t, 16> buffer;
+        dwhbll::network::address source;
+        auto r = co_await a.receive_from(buffer, source);
+
+        if (r.is_err() || r.unwrap_unchecked() != reply.size() || buffer[2] != 'k' || source.port != b_addr.port) {
+            std::cerr << "[FAILED] datagram_socket receive_from" << std::endl;
+            co_return;
+        }
+
+        ok = true;
+    }
+}
+
+bool datagram_socket_test(std::optional<std::string> test_to_run) {
+    const dwhbll::network::address any(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 0);
+
+    auto a = datagram_socket::bind(any);
+    auto b = datagram_socket::bind(any);
+
+    if (a.is_err() || b.is_err()) {
+        std::cerr << "[FAILED] datagram_socket cannot bind to the loopback" << std::endl;
+        return false;
+    }
+
+    bool ok = false;
+
+    reactor r;
+    r.spawn(exchange(*a.unwrap_unchecked(), *b.unwrap_unchecked(), ok));
+    r.run();
+
+    return ok;
+}
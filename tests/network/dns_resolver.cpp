@@ -0,0 +1,316 @@
+#include <array>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dwhbll/async/net/datagram_socket.h>
+#include <dwhbll/async/net/dns_resolver.h>
+#include <dwhbll/async/net/socket.h>
+#include <dwhbll/async/net/tcp_listener.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/network/dns/dns.h>
+#include <dwhbll/network/dns/wire.h>
+
+using dwhbll::async::net::datagram_socket;
+using dwhbll::async::net::dns_resolver;
+using dwhbll::async::net::tcp_listener;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::task;
+
+namespace dns = dwhbll::network::dns;
+
+// ::socket from the system headers is in the way of a using declaration
+using stream_socket = dwhbll::async::net::socket;
+
+namespace {
+    const dwhbll::network::address loopback(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 0);
+
+    /**
+     * @brief Answer `service.test.` with 127.0.0.2 and ::2, anything else with NXDOMAIN.
+     */
+    std::span<const std::uint8_t> answer(const dns::MessageView &query, std::span<std::uint8_t> out) {
+        using SECTION = dns::MessageBuilder::SECTION;
+
+        const auto question = *query.questions().begin();
+        const auto name = question.qname.to_string();
+        const bool found = question.qname.equals("service.test");
+
+        auto header = query.header();
+        header.qr = true;
+        header.ra = true;
+        header.rcode = found ? dns::RCODE::NONE : dns::RCODE::NAMEERR;
+
+        dns::MessageBuilder builder(out, header);
+        (void)builder.add_question(name, question.type);
+
+        if (!found)
+            (void)builder.add_soa(SECTION::AUTHORITY, "test", 60, "ns.test", "admin.test", 1, 60, 60, 60, 30);
+        else if (question.type == dns::QTYPE::A)
+            (void)builder.add_a(SECTION::ANSWER, name, 300, {127, 0, 0, 2});
+        else
+            (void)builder.add_aaaa(SECTION::ANSWER, name, 300, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2});
+
+        return builder.build();
+    }
+
+    /// addresses of `big.test.`, 60 A records take about 1 KiB
+    constexpr std::uint8_t big_count = 60;
+
+    /**
+     * @brief Answer a question for `big.test.` within `limit` bytes, truncated if it does not fit.
+     * @return the answer, empty for any other name.
+     */
+    std::span<const std::uint8_t> answer_big(std::span<const std::uint8_t> query, std::span<std::uint8_t> out) {
+        using SECTION = dns::MessageBuilder::SECTION;
+
+        const dns::MessageView msg(query);
+        const auto question = *msg.questions().begin();
+
+        if (!question.qname.equals("big.test"))
+            return {};
+
+        auto header = msg.header();
+        header.qr = true;
+        header.ra = true;
+
+        dns::MessageBuilder builder(out, header);
+        (void)builder.add_question("big.test", question.type);
+
+        // room for the OPT record is kept, RFC 6891 section 7
+        bool fits = true;
+        for (std::uint8_t i = 0; question.type == dns::QTYPE::A && i < big_count; i++)
+            fits = fits && builder.size() + 11 + 16 <= out.size() && builder.add_a(SECTION::ANSWER, "big.test", 300, {127, 0, 1, i});
+
+        builder.set_truncated(!fits);
+
+        if (msg.edns())
+            (void)builder.add_edns({});
+
+        return builder.build();
+    }
+
+    task<> serve(datagram_socket &server, std::size_t &queries) {
+        std::array<std::uint8_t, 4096> buffer;
+        std::array<std::uint8_t, 4096> reply;
+
+        while (true) {
+            dwhbll::network::address client;
+            auto r = co_await server.receive_from(buffer, client);
+
+            if (r.is_err() || r.unwrap_unchecked() == 0)
+                co_return;
+
+            const std::span packet(buffer.data(), r.unwrap_unchecked());
+            const dns::MessageView view(packet);
+            const std::size_t limit = view.edns() ? view.edns()->udp_payload_size : 512;
+
+            if (auto big = answer_big(packet, std::span(reply.data(), limit)); !big.empty()) {
+                queries++;
+                (void)co_await server.send_to(big, &client);
+                continue;
+            }
+
+            queries++;
+            (void)co_await server.send_to(answer(view, std::span(reply.data(), limit)), &client);
+        }
+    }
+
+    /**
+     * @brief Answer the questions for `big.test.` of one connection in full, until it is closed.
+     */
+    task<> serve_stream(std::unique_ptr<stream_socket> conn, std::vector<stream_socket *> &open) {
+        open.push_back(conn.get());
+
+        std::array<std::uint8_t, 2> length;
+        std::vector<std::uint8_t> query;
+        std::array<std::uint8_t, 4096> reply;
+
+        while ((co_await conn->read(length)).is_ok()) {
+            query.resize(length[0] << 8 | length[1]);
+
+            if ((co_await conn->read(query)).is_err())
+                break;
+
+            const auto big = answer_big(query, std::span(reply).subspan(2));
+            reply[0] = big.size() >> 8;
+            reply[1] = big.size() & 0xFF;
+
+            if ((co_await conn->write(std::span(reply.data(), big.size() + 2))).is_err())
+                break;
+        }
+
+        std::erase(open, conn.get());
+    }
+
+    task<> accept_streams(tcp_listener &listener, std::size_t &connections, std::vector<stream_socket *> &open) {
+        while (true) {
+            auto conn = co_await listener.accept();
+
+            if (conn.is_err())
+                co_return;
+
+            connections++;
+            reactor::get_thread_reactor()->spawn(serve_stream(std::move(conn.unwrap_unchecked()), open));
+        }
+    }
+
+    task<> resolve_into(dns_resolver &resolver, std::string host, std::optional<dwhbll::stl_ext::Result<std::vector<dwhbll::network::address>, int>> &out) {
+        out = co_await resolver.resolve(std::move(host), 80);
+    }
+
+    bool is_service(dwhbll::stl_ext::Result<std::vector<dwhbll::network::address>, int> result) {
+        if (result.is_err())
+            return false;
+
+        const auto &addresses = result.unwrap_unchecked();
+        return addresses.size() == 2 && addresses[0].type == dwhbll::network::address::IPV6 &&
+               addresses[1].type == dwhbll::network::address::IPV4 && addresses[0].port == 80 &&
+               std::get<std::array<std::uint8_t, 4>>(addresses[1].host) == std::array<std::uint8_t, 4>{127, 0, 0, 2};
+    }
+
+    task<bool> queries_behave(dns_resolver &resolver, const std::size_t &queries) {
+        // two lookups of the same name at once go out as one query per record type
+        std::optional<dwhbll::stl_ext::Result<std::vector<dwhbll::network::address>, int>> first, second;
+        reactor::get_thread_reactor()->spawn(resolve_into(resolver, "Service.Test", first));
+        co_await resolve_into(resolver, "service.test.", second);
+
+        // the silent nameserver is still asked, but the answer of the other one wins long before the timeout
+        if (!first || !second || !is_service(*first) || !is_service(*second) || queries != 2 || resolver.stat().coalesced != 2) {
+            std::cerr << "[FAILED] concurrent lookups, " << queries << " queries reached the server" << std::endl;
+            co_return false;
+        }
+
+        if (!is_service(co_await resolver.resolve("service.test", 80)) || queries != 2) {
+            std::cerr << "[FAILED] answer was not cached" << std::endl;
+            co_return false;
+        }
+
+        auto missing = co_await resolver.resolve("missing.test", 80);
+
+        if (missing.is_ok() || missing.unwrap_err_unchecked() != EHOSTUNREACH || queries != 4) {
+            std::cerr << "[FAILED] NXDOMAIN did not fail the lookup" << std::endl;
+            co_return false;
+        }
+
+        if ((co_await resolver.resolve("missing.test", 80)).is_ok() || queries != 4) {
+            std::cerr << "[FAILED] NXDOMAIN was not cached" << std::endl;
+            co_return false;
+        }
+
+        auto literal = co_await resolver.resolve("127.0.0.9", 80);
+
+        if (literal.is_err() || literal.unwrap_unchecked().size() != 1 || queries != 4) {
+            std::cerr << "[FAILED] IP literal went to the nameservers" << std::endl;
+            co_return false;
+        }
+
+        resolver.forget("service.test");
+
+        if (!is_service(co_await resolver.resolve("service.test", 80)) || queries != 6) {
+            std::cerr << "[FAILED] forgotten answer was served from the cache" << std::endl;
+            co_return false;
+        }
+
+        co_return true;
+    }
+
+    bool is_big(dwhbll::stl_ext::Result<std::vector<dwhbll::network::address>, int> result) {
+        return result.is_ok() && result.unwrap_unchecked().size() == big_count;
+    }
+
+    task<bool> large_answers_behave(dns_resolver &resolver, dns_resolver &plain, const std::size_t &connections) {
+        // with EDNS the whole answer comes in one datagram
+        if (!is_big(co_await resolver.resolve("big.test", 80)) || resolver.stat().truncated != 0 || resolver.stat().stream_queries != 0) {
+            std::cerr << "[FAILED] large answer with EDNS" << std::endl;
+            co_return false;
+        }
+
+        // without it the answer is truncated and asked again over TCP, on the same connection the second time
+        for (int i = 0; i < 2; i++) {
+            plain.forget("big.test");
+
+            if (!is_big(co_await plain.resolve("big.test", 80))) {
+                std::cerr << "[FAILED] large answer over TCP" << std::endl;
+                co_return false;
+            }
+        }
+
+        if (plain.stat().truncated != 2 || plain.stat().stream_queries != 2 || plain.stat().streams_opened != 1 || connections != 1) {
+            std::cerr << "[FAILED] TCP connection was not reused, " << connections << " connections" << std::endl;
+            co_return false;
+        }
+
+        co_return true;
+    }
+
+    struct stub_servers {
+        datagram_socket &server;
+        datagram_socket &silent;
+        tcp_listener &listener;
+        std::vector<stream_socket *> &open;
+    };
+
+    task<> run_queries(dns_resolver &resolver, dns_resolver &plain, stub_servers stubs, const std::size_t &queries,
+                       const std::size_t &connections, bool &ok) {
+        ok = co_await queries_behave(resolver, queries) && co_await large_answers_behave(resolver, plain, connections);
+
+        // ends the stub servers
+        stubs.server.shutdown();
+        stubs.silent.shutdown();
+        stubs.listener.stop_accepting();
+
+        for (auto *conn : std::vector(stubs.open))
+            conn->close();
+    }
+}
+
+bool dns_resolver_test(std::optional<std::string> test_to_run) {
+    auto server = datagram_socket::bind(loopback);
+    auto silent = datagram_socket::bind(loopback);
+
+    if (server.is_err() || silent.is_err()) {
+        std::cerr << "[FAILED] cannot bind the stub nameservers" << std::endl;
+        return false;
+    }
+
+    auto &server_sock = *server.unwrap_unchecked();
+    auto &silent_sock = *silent.unwrap_unchecked();
+    const auto server_address = server_sock.local_address().unwrap_unchecked();
+
+    // TCP on the port of the UDP server, like a nameserver does
+    tcp_listener listener;
+    listener.set_reuseaddr();
+
+    if (listener.listen(server_address).is_err()) {
+        std::cerr << "[FAILED] cannot listen on the port of the stub nameserver" << std::endl;
+        return false;
+    }
+
+    dns_resolver resolver({
+        .nameservers = {silent_sock.local_address().unwrap_unchecked(), server_address},
+        .timeout = std::chrono::milliseconds(2000),
+        .use_hosts_file = false,
+    });
+
+    dns_resolver plain({
+        .nameservers = {server_address},
+        .timeout = std::chrono::milliseconds(2000),
+        .use_hosts_file = false,
+        .udp_payload_size = 0,
+    });
+
+    std::size_t queries = 0;
+    std::size_t connections = 0;
+    std::vector<stream_socket *> open;
+    bool ok = false;
+
+    reactor r;
+    r.spawn(serve(server_sock, queries));
+    r.spawn(accept_streams(listener, connections, open));
+    r.spawn(run_queries(resolver, plain, {server_sock, silent_sock, listener, open}, queries, connections, ok));
+    r.run();
+
+    return ok;
+}
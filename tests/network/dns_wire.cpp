@@ -0,0 +1,175 @@
+#include <array>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dwhbll/exceptions/rt_exception_base.h>
+#include <dwhbll/network/dns/dns.h>
+#include <dwhbll/network/dns/wire.h>
+
+namespace dns = dwhbll::network::dns;
+
+using SECTION = dns::MessageBuilder::SECTION;
+
+namespace {
+    const dns::MessageHeader response_header{0xBEEF, true, dns::OPCODE::QUERY, false, false, true, true, 0, dns::RCODE::NONE, 0, 0, 0, 0};
+
+    std::span<const std::uint8_t> build_response(std::span<std::uint8_t> buffer) {
+        dns::MessageBuilder builder(buffer, response_header);
+
+        if (!builder.add_question("www.Example.com", dns::QTYPE::A) ||
+            !builder.add_name_record(SECTION::ANSWER, "www.example.com", dns::QTYPE::CNAME, 300, "web.example.com") ||
+            !builder.add_a(SECTION::ANSWER, "web.example.com.", 60, {192, 0, 2, 1}) ||
+            !builder.add_aaaa(SECTION::ANSWER, "web.example.com", 60, {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}) ||
+            !builder.add_soa(SECTION::AUTHORITY, "example.com", 3600, "ns.example.com", "hostmaster.example.com", 1, 7200, 900, 86400, 120))
+            return {};
+
+        return builder.build();
+    }
+
+    bool parse_response(std::span<const std::uint8_t> packet) {
+        const dns::MessageView msg(packet);
+
+        if (msg.header().id != 0xBEEF || !msg.header().qr || msg.questions().size() != 1 || msg.answers().size() != 3 ||
+            msg.authorities().size() != 1 || !msg.additionals().empty() || msg.edns()) {
+            std::cerr << "[FAILED] dns header or section counts" << std::endl;
+            return false;
+        }
+
+        const auto question = *msg.questions().begin();
+        if (!question.qname.equals("www.example.com.") || question.qname.to_string() != "www.Example.com." ||
+            question.type != dns::QTYPE::A) {
+            std::cerr << "[FAILED] dns question came back as " << question.qname.to_string() << std::endl;
+            return false;
+        }
+
+        auto rr = msg.answers().begin();
+
+        // compared without regard to case, like DNS does
+        if (!(rr->name == question.qname) || !rr->target() || !rr->target()->equals("WEB.example.com")) {
+            std::cerr << "[FAILED] dns CNAME record" << std::endl;
+            return false;
+        }
+
+        const auto target = *rr->target();
+        ++rr;
+
+        if (!(rr->name == target) || rr->ttl != 60 || rr->a() != std::array<std::uint8_t, 4>{192, 0, 2, 1} || rr->aaaa()) {
+            std::cerr << "[FAILED] dns A record" << std::endl;
+            return false;
+        }
+
+        ++rr;
+
+        if (!rr->aaaa() || (*rr->aaaa())[15] != 1 || rr->a()) {
+            std::cerr << "[FAILED] dns AAAA record" << std::endl;
+            return false;
+        }
+
+        const auto soa = msg.authorities().begin()->soa();
+        if (!soa || soa->minimum != 120 || soa->serial != 1 || !soa->rname.equals("hostmaster.example.com")) {
+            std::cerr << "[FAILED] dns SOA record" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool throws(std::vector<std::uint8_t> packet) {
+        try {
+            dns::MessageView msg(packet);
+            return false;
+        } catch (const dwhbll::exceptions::rt_exception_base &) {
+            return true;
+        }
+    }
+
+    bool edns_behaves() {
+        std::array<std::uint8_t, 512> buffer;
+        dns::MessageBuilder builder(buffer, {7, false, dns::OPCODE::QUERY, false, false, true, false, 0, dns::RCODE::NONE, 0, 0, 0, 0});
+
+        if (!builder.add_question("example.com", dns::QTYPE::TXT) || !builder.add_edns({4096, 0, 0, true})) {
+            std::cerr << "[FAILED] dns query with EDNS did not fit" << std::endl;
+            return false;
+        }
+
+        const auto query = builder.build();
+        const dns::MessageView msg(query);
+
+        // root name, type, payload size as class, flags as TTL and no options
+        if (query.size() != 12 + 17 + 11 || !msg.edns() || msg.edns()->udp_payload_size != 4096 || !msg.edns()->dnssec_ok ||
+            msg.edns()->version != 0 || msg.additionals().size() != 1) {
+            std::cerr << "[FAILED] dns OPT record written by the builder" << std::endl;
+            return false;
+        }
+
+        // senders asking for less than 512 bytes get 512
+        std::array<std::uint8_t, 512> small;
+        dns::MessageBuilder small_builder(small, {8, true, dns::OPCODE::QUERY, false, false, true, true, 0, dns::RCODE::NONE, 0, 0, 0, 0});
+
+        if (!small_builder.add_question("example.com", dns::QTYPE::TXT) || !small_builder.add_edns({100, 1, 0, false})) {
+            std::cerr << "[FAILED] dns answer with EDNS did not fit" << std::endl;
+            return false;
+        }
+
+        const dns::MessageView reread(small_builder.build());
+
+        if (!reread.edns() || reread.edns()->udp_payload_size != 512 || reread.edns()->extended_rcode != 1 || reread.edns()->dnssec_ok) {
+            std::cerr << "[FAILED] dns OPT record with a small payload size" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+}
+
+bool dns_wire_test(std::optional<std::string> test_to_run) {
+    std::array<std::uint8_t, 512> buffer;
+    const auto packet = build_response(buffer);
+
+    if (packet.empty() || !parse_response(packet))
+        return false;
+
+    // every repeated name is a pointer, 234 bytes without compression
+    if (packet.size() != 145) {
+        std::cerr << "[FAILED] dns names were not compressed, " << packet.size() << " bytes" << std::endl;
+        return false;
+    }
+
+    // entries that do not fit are left out whole
+    std::array<std::uint8_t, 50> small;
+    dns::MessageBuilder builder(small, response_header);
+
+    if (!builder.add_question("www.example.com", dns::QTYPE::A) || builder.add_aaaa(SECTION::ANSWER, "www.example.com", 1, {}) ||
+        !builder.add_a(SECTION::ADDITIONAL, "www.example.com", 1, {})) {
+        std::cerr << "[FAILED] dns builder did not stop at the end of its buffer" << std::endl;
+        return false;
+    }
+
+    builder.set_truncated();
+    const dns::MessageView cut(builder.build());
+
+    if (!cut.header().tc || cut.answers().size() != 0 || cut.additionals().size() != 1) {
+        std::cerr << "[FAILED] dns message cut short" << std::endl;
+        return false;
+    }
+
+    if (!edns_behaves())
+        return false;
+
+    std::vector<std::uint8_t> truncated(packet.begin(), packet.end() - 1);
+
+    // a name pointing at itself, and an A record of five bytes
+    std::vector<std::uint8_t> loop{0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0xC0, 12, 0, 1, 0, 1};
+    std::vector<std::uint8_t> long_a{0, 1, 0x80, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0, 5, 1, 2, 3, 4, 5};
+    // an OPT record among the answers
+    std::vector<std::uint8_t> stray_opt{0, 1, 0x80, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 41, 0x10, 0, 0, 0, 0, 0, 0};
+
+    if (!throws(truncated) || !throws(loop) || !throws(long_a) || !throws(stray_opt) || !throws({1, 2, 3})) {
+        std::cerr << "[FAILED] dns malformed messages were accepted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
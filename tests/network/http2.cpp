@@ -0,0 +1,371 @@
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dwhbll/network/http_server.hpp>
+
+namespace http_server = dwhbll::network::http_server;
+namespace hpack = dwhbll::network::http_server::hpack;
+namespace http2 = dwhbll::network::http_server::http2;
+
+namespace {
+    std::vector<std::byte> hex(std::string_view digits) {
+        std::vector<std::byte> out;
+        for (std::size_t i = 0; i + 1 < digits.size(); i += 2)
+            out.push_back(static_cast<std::byte>(std::stoi(std::string(digits.substr(i, 2)), nullptr, 16)));
+        return out;
+    }
+
+    std::string_view text(std::span<const std::byte> bytes) {
+        return {reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+    }
+
+    bool integers_behave() {
+        // RFC 7541 C.1
+        for (const auto &[value, prefix, encoded] : {std::tuple{10ull, 5u, "0a"}, {1337ull, 5u, "1f9a0a"}, {42ull, 8u, "2a"}}) {
+            std::vector<std::byte> out;
+            hpack::encode_integer(value, prefix, 0, out);
+
+            std::size_t pos = 0;
+            std::uint64_t decoded = 0;
+
+            if (out != hex(encoded) || !hpack::decode_integer(out, pos, prefix, decoded) || decoded != value || pos != out.size()) {
+                std::cerr << "[FAILED] hpack integer " << value << " with a " << prefix << " bit prefix" << std::endl;
+                return false;
+            }
+        }
+
+        // cut short, and continuing past 32 bits
+        std::size_t pos = 0;
+        std::uint64_t value;
+        if (hpack::decode_integer(hex("1f9a"), pos, 5, value) || (pos = 0, hpack::decode_integer(hex("1fffffffff7f"), pos, 5, value))) {
+            std::cerr << "[FAILED] hpack bad integer accepted" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool huffman_behaves() {
+        // RFC 7541 C.4.1 and C.6.1
+        for (const auto &[plain, encoded] : {std::pair{"www.example.com", "f1e3c2e5f23a6ba0ab90f4ff"},
+                                              {"no-cache", "a8eb10649cbf"},
+                                              {"Mon, 21 Oct 2013 20:13:21 GMT", "d07abe941054d444a8200595040b8166e082a62d1bff"}}) {
+            std::vector<std::byte> out;
+            hpack::huffman_encode(plain, out);
+            std::string decoded;
+
+            if (out != hex(encoded) || hpack::huffman_encoded_size(plain) != out.size() ||
+                !hpack::huffman_decode(out, decoded) || decoded != plain) {
+                std::cerr << "[FAILED] hpack huffman code of " << plain << std::endl;
+                return false;
+            }
+        }
+
+        std::string every;
+        for (int c = 0; c < 256; c++)
+            every.push_back(static_cast<char>(c));
+
+        std::vector<std::byte> out;
+        hpack::huffman_encode(every, out);
+        std::string decoded;
+
+        if (!hpack::huffman_decode(out, decoded) || decoded != every) {
+            std::cerr << "[FAILED] hpack huffman round trip of every byte" << std::endl;
+            return false;
+        }
+
+        // 'a' is 00011, padded with zeros instead of ones, then padded with a whole byte
+        for (const auto &bad : {hex("18"), hex("1fff")}) {
+            if (hpack::huffman_decode(bad, decoded)) {
+                std::cerr << "[FAILED] hpack huffman bad padding accepted" << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool blocks_behave() {
+        // RFC 7541 C.4, three requests sharing a dynamic table
+        hpack::Decoder decoder;
+        std::vector<hpack::HeaderField> fields;
+
+        const bool first = decoder.decode(hex("828684418cf1e3c2e5f23a6ba0ab90f4ff"), fields) && fields.size() == 4 &&
+                           fields[0].name == ":method" && fields[0].value == "GET" && fields[3].name == ":authority" &&
+                           fields[3].value == "www.example.com" && decoder.dynamic_table().size() == 57;
+
+        fields.clear();
+        const bool second = decoder.decode(hex("828684be5886a8eb10649cbf"), fields) && fields.size() == 5 &&
+                            fields[3].value == "www.example.com" && fields[4].name == "cache-control" &&
+                            fields[4].value == "no-cache" && decoder.dynamic_table().size() == 110;
+
+        fields.clear();
+        const bool third = decoder.decode(hex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf"), fields) && fields.size() == 5 &&
+                           fields[2].value == "/index.html" && fields[4].name == "custom-key" &&
+                           fields[4].value == "custom-value" && decoder.dynamic_table().size() == 164;
+
+        if (!first || !second || !third) {
+            std::cerr << "[FAILED] hpack request blocks decoded as " << first << second << third << std::endl;
+            return false;
+        }
+
+        // an index past both tables
+        fields.clear();
+        if (decoder.decode(hex("ff00"), fields)) {
+            std::cerr << "[FAILED] hpack unknown index accepted" << std::endl;
+            return false;
+        }
+
+        // what the encoder indexes the decoder has to find again, also after the table shrinks
+        hpack::Encoder encoder;
+        hpack::Decoder peer;
+
+        for (int round = 0; round < 3; round++) {
+            if (round == 2)
+                encoder.set_max_table_size(64);
+
+            std::vector<std::byte> block;
+            encoder.begin(block);
+            encoder.encode(":status", "200", block);
+            encoder.encode("content-type", "text/html", block);
+            encoder.encode("x-request", std::to_string(round), block, false);
+
+            fields.clear();
+            if (!peer.decode(block, fields) || fields.size() != 3 || fields[1].value != "text/html" ||
+                fields[2].value != std::to_string(round) ||
+                peer.dynamic_table().count() != encoder.dynamic_table().count()) {
+                std::cerr << "[FAILED] hpack round trip " << round << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    struct EchoHandler {
+        void handle(http_server::Request &request, http_server::Response &response) {
+            response.code = "200";
+            response.reason = "OK";
+            response.fields["X-Path"] = request.path;
+            response.body = request.body;
+
+            if (request.path == "/stream") {
+                response.body_producer = [](http_server::BodyWriter &writer) {
+                    writer.write("first ");
+                    writer.write("second");
+                };
+            }
+        }
+    };
+
+    struct EchoFactory {
+        EchoHandler operator()() { return {}; }
+    };
+
+    void frame(std::vector<std::byte> &wire, http2::FrameType type, std::uint8_t flags, std::uint32_t stream,
+               std::span<const std::byte> payload) {
+        std::array<std::byte, http2::FRAME_HEADER_LENGTH> header;
+        http2::FrameHeader{static_cast<std::uint32_t>(payload.size()), type, flags, stream}.encode(header);
+        wire.insert(wire.end(), header.begin(), header.end());
+        wire.insert(wire.end(), payload.begin(), payload.end());
+    }
+
+    void request(std::vector<std::byte> &wire, hpack::Encoder &encoder, std::uint32_t stream, std::string_view method,
+                 std::string_view path, bool end_stream) {
+        std::vector<std::byte> block;
+        encoder.begin(block);
+        encoder.encode(":method", method, block);
+        encoder.encode(":scheme", "http", block);
+        encoder.encode(":path", path, block);
+        encoder.encode(":authority", "localhost", block);
+
+        // split, so the block goes on in a CONTINUATION
+        const auto half = std::span{block}.first(block.size() / 2);
+        frame(wire, http2::FrameType::HEADERS, end_stream ? http2::flags::END_STREAM : 0, stream, half);
+        frame(wire, http2::FrameType::CONTINUATION, http2::flags::END_HEADERS, stream, std::span{block}.subspan(half.size()));
+    }
+
+    struct Answer {
+        std::vector<hpack::HeaderField> fields;
+        std::string body;
+        bool ended = false;
+    };
+
+    bool connection_behaves() {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            std::cerr << "[FAILED] cannot make a socket pair" << std::endl;
+            return false;
+        }
+
+        // three streams in flight, the second one's body arrives after the third request
+        std::vector<std::byte> wire;
+        const auto preface = std::as_bytes(std::span{http2::CONNECTION_PREFACE});
+        wire.insert(wire.end(), preface.begin(), preface.end());
+        frame(wire, http2::FrameType::SETTINGS, 0, 0, {});
+
+        hpack::Encoder encoder;
+        request(wire, encoder, 1, "GET", "/hello?x=1", true);
+        request(wire, encoder, 3, "POST", "/echo", false);
+        request(wire, encoder, 5, "GET", "/stream", true);
+        frame(wire, http2::FrameType::DATA, 0, 3, std::as_bytes(std::span{"ping ", 5}));
+        frame(wire, http2::FrameType::DATA, http2::flags::END_STREAM, 3, std::as_bytes(std::span{"pong", 4}));
+        frame(wire, http2::FrameType::PING, 0, 0, hex("0102030405060708"));
+        frame(wire, http2::FrameType::GOAWAY, 0, 0, hex("0000000000000000"));
+
+        if (write(fds[1], wire.data(), wire.size()) != static_cast<ssize_t>(wire.size())) {
+            std::cerr << "[FAILED] cannot write the client frames" << std::endl;
+            return false;
+        }
+
+        http_server::Router<EchoFactory> router;
+        router.add("/hello", EchoFactory());
+        router.add("/echo", EchoFactory());
+        router.add("/stream", EchoFactory());
+        router.compile();
+
+        const std::atomic_bool running = true;
+        http_server::Admission admission;
+        auto shedder = admission.make_shedder();
+        http_server::detail::Socket socket;
+        socket.assign_socket(fds[0]);
+
+        if (!http_server::detail::is_http2_preface(socket)) {
+            std::cerr << "[FAILED] http2 preface not recognised" << std::endl;
+            return false;
+        }
+
+        http_server::detail::Http2Connection<EchoFactory>(socket, router, admission, shedder, {}, running).serve();
+        close(fds[0]);
+
+        std::vector<std::byte> reply;
+        std::array<std::byte, 4096> chunk;
+        for (ssize_t size; (size = read(fds[1], chunk.data(), chunk.size())) > 0;)
+            reply.insert(reply.end(), chunk.begin(), chunk.begin() + size);
+        close(fds[1]);
+
+        hpack::Decoder decoder;
+        std::map<std::uint32_t, Answer> answers;
+        std::vector<http2::FrameType> control;
+        bool ping_acked = false, goaway = false;
+
+        for (std::size_t pos = 0; pos + http2::FRAME_HEADER_LENGTH <= reply.size();) {
+            const auto header = http2::FrameHeader::parse(std::span{reply}.subspan(pos).first<http2::FRAME_HEADER_LENGTH>());
+            pos += http2::FRAME_HEADER_LENGTH;
+            const auto payload = std::span{reply}.subspan(pos, header.length);
+            pos += header.length;
+
+            auto &answer = answers[header.stream];
+
+            switch (header.type) {
+            case http2::FrameType::HEADERS:
+                if (!header.has(http2::flags::END_HEADERS) || !decoder.decode(payload, answer.fields)) {
+                    std::cerr << "[FAILED] http2 response headers" << std::endl;
+                    return false;
+                }
+                answer.ended = header.has(http2::flags::END_STREAM);
+                break;
+            case http2::FrameType::DATA:
+                answer.body += text(payload);
+                answer.ended = header.has(http2::flags::END_STREAM);
+                break;
+            case http2::FrameType::PING:
+                ping_acked = header.has(http2::flags::ACK) && payload.size() == 8 && payload[7] == std::byte{8};
+                break;
+            case http2::FrameType::GOAWAY:
+                // last stream 5, no error
+                goaway = http2::read_u32(payload) == 5 && http2::read_u32(payload.subspan(4)) == 0;
+                break;
+            default:
+                control.push_back(header.type);
+                break;
+            }
+        }
+
+        const auto field = [&](std::uint32_t stream, std::string_view name) -> std::string {
+            for (const auto &f : answers[stream].fields) {
+                if (f.name == name)
+                    return f.value;
+            }
+            return "<none>";
+        };
+
+        if (!ping_acked || !goaway || control.size() < 2 || control[0] != http2::FrameType::SETTINGS) {
+            std::cerr << "[FAILED] http2 connection frames" << std::endl;
+            return false;
+        }
+
+        for (const auto &[stream, path, body] : {std::tuple{1u, "/hello", ""}, {3u, "/echo", "ping pong"}, {5u, "/stream", "first second"}}) {
+            if (!answers[stream].ended || field(stream, ":status") != "200" || field(stream, "x-path") != path ||
+                answers[stream].body != body || field(stream, "server") != "dwhbll") {
+                std::cerr << "[FAILED] http2 response on stream " << stream << ": " << field(stream, ":status") << " "
+                          << field(stream, "x-path") << " " << answers[stream].body << std::endl;
+                return false;
+            }
+        }
+
+        if (field(3, "content-length") != "9" || field(5, "content-length") != "<none>") {
+            std::cerr << "[FAILED] http2 response content-length" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool protocol_errors_go_away() {
+        // a HEADERS frame on stream 0 after the settings
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            return false;
+
+        std::vector<std::byte> wire;
+        const auto preface = std::as_bytes(std::span{http2::CONNECTION_PREFACE});
+        wire.insert(wire.end(), preface.begin(), preface.end());
+        frame(wire, http2::FrameType::SETTINGS, 0, 0, {});
+        frame(wire, http2::FrameType::HEADERS, http2::flags::END_HEADERS, 0, hex("82"));
+        write(fds[1], wire.data(), wire.size());
+
+        http_server::Router<EchoFactory> router;
+        router.compile();
+
+        const std::atomic_bool running = true;
+        http_server::Admission admission;
+        auto shedder = admission.make_shedder();
+        http_server::detail::Socket socket;
+        socket.assign_socket(fds[0]);
+
+        if (!http_server::detail::is_http2_preface(socket)) {
+            std::cerr << "[FAILED] http2 preface not recognised" << std::endl;
+            return false;
+        }
+
+        http_server::detail::Http2Connection<EchoFactory>(socket, router, admission, shedder, {}, running).serve();
+        close(fds[0]);
+
+        std::array<std::byte, 256> reply;
+        const ssize_t size = read(fds[1], reply.data(), reply.size());
+        close(fds[1]);
+
+        // the GOAWAY is last, its error code closes the reply
+        if (size < 17 || http2::read_u32(std::span{reply}.subspan(size - 4)) != static_cast<std::uint32_t>(http2::ErrorCode::PROTOCOL_ERROR) ||
+            reply[size - 17 + 3] != static_cast<std::byte>(http2::FrameType::GOAWAY)) {
+            std::cerr << "[FAILED] http2 protocol error was not answered with a GOAWAY" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+}
+
+bool http2_test(std::optional<std::string> test_to_run) {
+    return integers_behave() && huffman_behaves() && blocks_behave() && connection_behaves() && protocol_errors_go_away();
+}
@@ -0,0 +1,223 @@
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dwhbll/network/http_server.hpp>
+
+namespace http_server = dwhbll::network::http_server;
+
+using namespace std::chrono_literals;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+    bool limits_behave() {
+        http_server::ConcurrencyLimit limit(2);
+
+        if (!limit.try_acquire() || !limit.try_acquire() || limit.try_acquire() || limit.in_flight() != 2) {
+            std::cerr << "[FAILED] concurrency limit let a third request in" << std::endl;
+            return false;
+        }
+
+        limit.release();
+
+        if (!limit.try_acquire()) {
+            std::cerr << "[FAILED] concurrency limit did not take a released slot back" << std::endl;
+            return false;
+        }
+
+        // 10 per second with a burst of 3
+        const auto start = clock_type::now();
+        http_server::TokenBucket bucket(3, start);
+        int taken = 0;
+        while (bucket.take(10, 3, start))
+            taken++;
+
+        if (taken != 3 || bucket.take(10, 3, start + 50ms) || !bucket.take(10, 3, start + 100ms) ||
+            bucket.full(10, 3, start + 100ms) || !bucket.full(10, 3, start + 1s)) {
+            std::cerr << "[FAILED] token bucket took " << taken << " of a burst of 3" << std::endl;
+            return false;
+        }
+
+        http_server::ClientRateLimiter clients(1, 2);
+        const std::array<std::byte, 4> alice{std::byte{10}, std::byte{0}, std::byte{0}, std::byte{1}};
+        const std::array<std::byte, 4> bob{std::byte{10}, std::byte{0}, std::byte{0}, std::byte{2}};
+
+        if (!clients.admit(alice, start) || !clients.admit(alice, start) || clients.admit(alice, start) ||
+            !clients.admit(bob, start) || !clients.admit(alice, start + 1s) || !clients.admit({}, start)) {
+            std::cerr << "[FAILED] client rate limiter" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool codel_behaves() {
+        http_server::CoDel codel(5ms, 100ms);
+        auto now = clock_type::now();
+
+        // short spikes above target are a burst, not a standing queue
+        for (int i = 0; i < 50; i++, now += 1ms) {
+            if (codel.should_drop(i % 10 == 0 ? 1ms : 20ms, now)) {
+                std::cerr << "[FAILED] codel dropped during a burst" << std::endl;
+                return false;
+            }
+        }
+
+        // above target for longer than an interval, one request per millisecond
+        for (int i = 0; i < 10; i++, now += 1ms)
+            codel.should_drop(1ms, now);
+
+        std::vector<clock_type::time_point> drops;
+        for (int i = 0; i < 1000; i++, now += 1ms) {
+            if (codel.should_drop(20ms, now))
+                drops.push_back(now);
+        }
+
+        if (drops.size() < 4 || drops.front() - (now - 1000ms) < 100ms || !codel.dropping()) {
+            std::cerr << "[FAILED] codel did not shed a standing queue, dropped " << drops.size() << std::endl;
+            return false;
+        }
+
+        // drops come closer together the longer the queue stands
+        for (std::size_t i = 2; i < drops.size(); i++) {
+            if (drops[i] - drops[i - 1] > drops[i - 1] - drops[i - 2]) {
+                std::cerr << "[FAILED] codel drop rate did not increase" << std::endl;
+                return false;
+            }
+        }
+
+        if (codel.should_drop(1ms, now) || codel.dropping()) {
+            std::cerr << "[FAILED] codel kept dropping below target" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool admission_behaves() {
+        http_server::Admission admission;
+        auto shedder = admission.make_shedder();
+
+        // nothing configured admits everything
+        for (int i = 0; i < 100; i++) {
+            if (admission.admit(shedder, 1s, {}) != http_server::Admission::Verdict::ADMIT) {
+                std::cerr << "[FAILED] admission without limits turned a request away" << std::endl;
+                return false;
+            }
+            admission.release();
+        }
+
+        admission.configure({.max_in_flight = 1, .client_rate = 1, .client_burst = 1});
+        admission.limit_route(1, 1);
+        const std::array<std::byte, 4> client{std::byte{127}, std::byte{0}, std::byte{0}, std::byte{1}};
+        const std::array<std::byte, 4> other{std::byte{127}, std::byte{0}, std::byte{0}, std::byte{2}};
+
+        const auto first = admission.admit(shedder, 0ms, client);
+        const auto concurrent = admission.admit(shedder, 0ms, other);
+        admission.release();
+        const auto again = admission.admit(shedder, 0ms, client);
+
+        if (first != http_server::Admission::Verdict::ADMIT || concurrent != http_server::Admission::Verdict::OVERLOADED ||
+            again != http_server::Admission::Verdict::RATE_LIMITED) {
+            std::cerr << "[FAILED] admission verdicts" << std::endl;
+            return false;
+        }
+
+        if (!admission.enter_route(0) || !admission.enter_route(0) || !admission.enter_route(1) ||
+            admission.enter_route(1)) {
+            std::cerr << "[FAILED] admission route limits" << std::endl;
+            return false;
+        }
+
+        admission.leave_route(1);
+
+        if (!admission.enter_route(1)) {
+            std::cerr << "[FAILED] admission route limit not released" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool rejection_behaves() {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            return false;
+
+        http_server::detail::Socket socket;
+        socket.assign_socket(fds[0]);
+        http_server::DateCache date;
+        http_server::detail::reject(socket, date, http_server::Admission::Verdict::RATE_LIMITED);
+
+        std::array<char, 512> reply;
+        const ssize_t size = read(fds[1], reply.data(), reply.size());
+        close(fds[0]);
+        close(fds[1]);
+
+        const std::string_view text{reply.data(), static_cast<std::size_t>(std::max<ssize_t>(size, 0))};
+
+        if (!text.starts_with("HTTP/1.1 429 Too Many Requests\r\ndate: ") || text.find("\r\nretry-after: 1\r\n") == std::string_view::npos ||
+            !text.ends_with("connection: close\r\n\r\n")) {
+            std::cerr << "[FAILED] rejection sent as " << text << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool queueing_delay_measured() {
+        // a listening socket with timestamps, the accepted one inherits them
+        const int listener = socket(AF_INET, SOCK_STREAM, 0);
+        const int on = 1;
+        setsockopt(listener, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+
+        if (bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+            getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length) != 0 || listen(listener, 4) != 0) {
+            close(listener);
+            std::cerr << "[FAILED] cannot listen on loopback" << std::endl;
+            return false;
+        }
+
+        const int client = socket(AF_INET, SOCK_STREAM, 0);
+        connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        write(client, "GET / HTTP/1.1\r\n\r\n", 18);
+
+        // the request waits in the accept queue
+        std::this_thread::sleep_for(30ms);
+
+        const int accepted = accept(listener, nullptr, nullptr);
+        http_server::detail::Socket socket;
+        socket.assign_socket(accepted);
+        const bool read = socket.fill(1);
+        const auto waited = socket.since_arrival();
+
+        close(accepted);
+        close(client);
+        close(listener);
+
+        if (!read || waited < 30ms || waited > 10s) {
+            std::cerr << "[FAILED] queueing delay measured as "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(waited).count() << "ms" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+}
+
+bool http_admission_test(std::optional<std::string> test_to_run) {
+    return limits_behave() && codel_behaves() && admission_behaves() && rejection_behaves() && queueing_delay_measured();
+}
@@ -0,0 +1,91 @@
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dwhbll/network/http_server/chunked.h>
+
+using dwhbll::network::http_server::ChunkedDecoder;
+
+static std::optional<std::string> decode_split(const std::string &wire, std::size_t step, std::size_t out_size) {
+    ChunkedDecoder decoder;
+    std::string result;
+    std::vector<std::byte> out(out_size);
+
+    std::size_t pos = 0;
+    while (!decoder.done() && !decoder.failed() && pos < wire.size()) {
+        auto in = std::as_bytes(std::span{wire.data() + pos, std::min(step, wire.size() - pos)});
+
+        // drain one input slice completely, the output might need several rounds
+        while (!in.empty() && !decoder.done() && !decoder.failed()) {
+            auto [consumed, produced] = decoder.decode(in, out);
+            result.append(reinterpret_cast<const char *>(out.data()), produced);
+            in = in.subspan(consumed);
+            pos += consumed;
+        }
+    }
+
+    if (!decoder.done())
+        return std::nullopt;
+
+    return result;
+}
+
+bool http_chunked_test(std::optional<std::string> test_to_run) {
+    const std::string wire = "4\r\nWiki\r\n6;name=value\r\npedia \r\nE\r\nin \r\n\r\nchunks.\r\n0\r\nExpires: never\r\n\r\nNEXT";
+    const std::string expected = "Wikipedia in \r\n\r\nchunks.";
+
+    for (std::size_t step = 1; step <= wire.size(); step++) {
+        for (std::size_t out_size : {1ul, 3ul, 4096ul}) {
+            auto result = decode_split(wire, step, out_size);
+
+            if (!result.has_value() || result.value() != expected) {
+                std::cerr << "[FAILED] chunked decode mismatch with input step " << step << ", output size " << out_size << std::endl;
+                return false;
+            }
+        }
+    }
+
+    {
+        // the bytes after the body belong to the next request
+        ChunkedDecoder decoder;
+        std::vector<std::byte> out(64);
+        auto [consumed, produced] = decoder.decode(std::as_bytes(std::span{wire.data(), wire.size()}), out);
+
+        if (!decoder.done() || consumed != wire.size() - 4) {
+            std::cerr << "[FAILED] chunked decoder consumed past the end of the body." << std::endl;
+            return false;
+        }
+    }
+
+    for (const std::string bad : {"x\r\n", "4\r\nWikiX\r\n", "4\nWiki\r\n", "FFFFFFFFFFFFFFFFF\r\n"}) {
+        ChunkedDecoder decoder;
+        std::vector<std::byte> out(64);
+        decoder.decode(std::as_bytes(std::span{bad.data(), bad.size()}), out);
+
+        if (!decoder.failed()) {
+            std::cerr << "[FAILED] chunked decoder accepted malformed input." << std::endl;
+            return false;
+        }
+    }
+
+    {
+        std::array<char, dwhbll::network::http_server::MAX_CHUNK_HEADER> header;
+        auto length = dwhbll::network::http_server::encode_chunk_header(0x1a2b, header);
+
+        if (std::string(header.data(), length) != "1a2b\r\n") {
+            std::cerr << "[FAILED] chunk header encoding is wrong." << std::endl;
+            return false;
+        }
+
+        length = dwhbll::network::http_server::encode_chunk_header(0, header);
+
+        if (std::string(header.data(), length) != "0\r\n") {
+            std::cerr << "[FAILED] last chunk header encoding is wrong." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
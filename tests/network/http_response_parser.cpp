@@ -0,0 +1,103 @@
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <dwhbll/network/http/response_parser.h>
+
+using dwhbll::network::http::response_parser;
+
+static std::span<const std::uint8_t> bytes(const std::string &text) {
+    return {reinterpret_cast<const std::uint8_t *>(text.data()), text.size()};
+}
+
+static std::string body_of(response_parser &parser) {
+    auto &body = parser.response().body;
+    return {body.begin(), body.end()};
+}
+
+bool http_response_parser_test(std::optional<std::string> test_to_run) {
+    response_parser parser;
+
+    {
+        const std::string wire = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nX-A: 1\r\nx-a: 2\r\n\r\nhello";
+
+        // one byte at a time, the caller keeps whatever was not consumed
+        parser.reset();
+        std::size_t pos = 0, end = 0;
+        while (!parser.done() && !parser.failed() && end < wire.size()) {
+            end++;
+            pos += parser.feed(bytes(wire).subspan(pos, end - pos));
+        }
+
+        if (!parser.done() || pos != wire.size() || body_of(parser) != "hello" || !parser.keep_alive() ||
+            parser.response().status.status_code != 200 || parser.response().headers["x-a"] != "1, 2") {
+            std::cerr << "[FAILED] response parser failed on a byte-wise content-length response." << std::endl;
+            return false;
+        }
+    }
+
+    {
+        // pipelined: interim 100, a chunked response and a close-delimited one back to back
+        const std::string wire =
+            "HTTP/1.1 100 Continue\r\n\r\n"
+            "HTTP/1.1 201 Created\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n"
+            "HTTP/1.0 200 OK\r\n\r\nuntil close";
+
+        parser.reset();
+        auto consumed = parser.feed(bytes(wire));
+
+        if (!parser.done() || body_of(parser) != "abcde" || parser.response().status.status_code != 201) {
+            std::cerr << "[FAILED] response parser failed on an interim + chunked response." << std::endl;
+            return false;
+        }
+
+        parser.reset();
+        consumed += parser.feed(bytes(wire).subspan(consumed));
+        if (parser.done() || consumed != wire.size())
+            return false;
+
+        parser.on_close();
+        if (!parser.done() || parser.keep_alive() || body_of(parser) != "until close") {
+            std::cerr << "[FAILED] response parser failed on a close delimited response." << std::endl;
+            return false;
+        }
+    }
+
+    {
+        // a HEAD response announces a length but carries nothing
+        const std::string wire = "HTTP/1.1 200 OK\r\ncontent-length: 100\r\nconnection: close\r\n\r\n";
+        parser.reset(true);
+        if (parser.feed(bytes(wire)) != wire.size() || !parser.done() || parser.keep_alive()) {
+            std::cerr << "[FAILED] response parser expected a body after HEAD." << std::endl;
+            return false;
+        }
+    }
+
+    {
+        const std::string wire = "HTTP/1.1 200 OK\r\ncontent-length: 10\r\n\r\n0123456789";
+        parser.reset(false, false);
+        parser.feed(bytes(wire));
+        if (!parser.done() || parser.body_size() != 10 || !parser.response().body.empty()) {
+            std::cerr << "[FAILED] response parser kept a body it should only count." << std::endl;
+            return false;
+        }
+
+        parser.reset(false, true, 4);
+        parser.feed(bytes(wire));
+        if (!parser.failed()) {
+            std::cerr << "[FAILED] response parser accepted a body over the limit." << std::endl;
+            return false;
+        }
+    }
+
+    for (const std::string bad : {"HTTP/1.1 2x0 OK\r\n\r\n", "SMTP/1.1 200 OK\r\n\r\n", "HTTP/1.1 200 OK\r\nbroken\r\n\r\n"}) {
+        parser.reset();
+        parser.feed(bytes(bad));
+        if (!parser.failed()) {
+            std::cerr << "[FAILED] response parser accepted " << bad << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <dwhbll/network/http_server/router.h>
+
+using dwhbll::network::http::HTTP_METHOD;
+using dwhbll::network::http_server::MatchStatus;
+using dwhbll::network::http_server::RouteParams;
+using dwhbll::network::http_server::Router;
+
+bool http_router_test(std::optional<std::string> test_to_run) {
+    Router<int> router;
+
+    router.add(HTTP_METHOD::GET, "/users", 1);
+    router.add(HTTP_METHOD::GET, "/users/me", 2);
+    router.add(HTTP_METHOD::GET, "/users/{id}", 3);
+    router.add(HTTP_METHOD::DELETE, "/users/{id}", 4);
+    router.add(HTTP_METHOD::GET, "/users/{id}/posts/{post}", 5);
+    router.add("/static/{*path}", 6);
+    router.add(HTTP_METHOD::GET, "/users/{id}/files/*", 7);
+    router.add("/", 8);
+
+    router.compile();
+
+    RouteParams params;
+
+    struct Case {
+        HTTP_METHOD method;
+        std::string path;
+        MatchStatus status;
+        int route;
+    };
+
+    const Case cases[] = {
+        {HTTP_METHOD::GET, "/users", MatchStatus::FOUND, 1},
+        {HTTP_METHOD::GET, "/users/me", MatchStatus::FOUND, 2},
+        {HTTP_METHOD::GET, "/users/42", MatchStatus::FOUND, 3},
+        {HTTP_METHOD::DELETE, "/users/42", MatchStatus::FOUND, 4},
+        {HTTP_METHOD::POST, "/users/42", MatchStatus::METHOD_NOT_ALLOWED, 0},
+        {HTTP_METHOD::GET, "/users/42/posts/7", MatchStatus::FOUND, 5},
+        {HTTP_METHOD::PUT, "/static/css/site.css", MatchStatus::FOUND, 6},
+        {HTTP_METHOD::GET, "/static", MatchStatus::FOUND, 6},
+        {HTTP_METHOD::GET, "/users/me/files/a/b", MatchStatus::FOUND, 7},
+        {HTTP_METHOD::GET, "/", MatchStatus::FOUND, 8},
+        {HTTP_METHOD::GET, "/nope", MatchStatus::NOT_FOUND, 0},
+        {HTTP_METHOD::GET, "/users/42/posts", MatchStatus::NOT_FOUND, 0},
+    };
+
+    for (const auto &[method, path, status, route] : cases) {
+        auto match = router.match(method, path, params);
+
+        if (match.status != status || (status == MatchStatus::FOUND && *match.factory != route)) {
+            std::cerr << "[FAILED] router matched " << path << " wrongly." << std::endl;
+            return false;
+        }
+    }
+
+    router.match(HTTP_METHOD::GET, "/users/42/posts/7", params);
+    if (params.get("id") != "42" || params.get("post") != "7" || params.size() != 2) {
+        std::cerr << "[FAILED] router did not capture the path parameters." << std::endl;
+        return false;
+    }
+
+    // "me" is a literal under /users but /users/me/files only exists below {id}
+    router.match(HTTP_METHOD::GET, "/users/me/files/a/b", params);
+    if (params.get("id") != "me" || params.get("*") != "a/b") {
+        std::cerr << "[FAILED] router did not backtrack into the parameter branch." << std::endl;
+        return false;
+    }
+
+    router.match(HTTP_METHOD::GET, "/static/css/site.css", params);
+    if (params.get("path") != "css/site.css") {
+        std::cerr << "[FAILED] router did not capture the wildcard tail." << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,39 @@
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <dwhbll/network/http_server/serializer.h>
+
+using dwhbll::network::http_server::DateCache;
+using dwhbll::network::http_server::HeaderArena;
+
+bool http_serializer_test(std::optional<std::string> test_to_run) {
+    HeaderArena head;
+
+    for (int round = 0; round < 2; round++) {
+        head.clear();
+        head.status_line("200", "OK");
+        head.field("content-type", "text/plain");
+        head.content_length(1234567890123ull);
+        head.end();
+
+        const auto bytes = head.bytes();
+        const std::string serialized(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+
+        if (serialized != "HTTP/1.1 200 OK\r\ncontent-type: text/plain\r\ncontent-length: 1234567890123\r\n\r\n") {
+            std::cerr << "[FAILED] response head serialized wrongly: " << serialized << std::endl;
+            return false;
+        }
+    }
+
+    DateCache date;
+    const std::string line(date.get());
+
+    // "date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+    if (line.size() != 37 || !line.starts_with("date: ") || !line.ends_with(" GMT\r\n") || line[9] != ',') {
+        std::cerr << "[FAILED] date header has the wrong shape: " << line << std::endl;
+        return false;
+    }
+
+    return true;
+}
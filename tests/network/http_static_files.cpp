@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <dwhbll/network/http_server/static_files.h>
+
+using dwhbll::network::http_server::ByteRange;
+using dwhbll::network::http_server::FileCache;
+using dwhbll::network::http_server::RangeStatus;
+using dwhbll::network::http_server::parse_range;
+
+bool http_static_files_test(std::optional<std::string> test_to_run) {
+    struct Case {
+        std::string header;
+        RangeStatus status;
+        std::uint64_t first, length;
+    };
+
+    const Case cases[] = {
+        {"bytes=0-9", RangeStatus::SATISFIABLE, 0, 10},
+        {"bytes=10-", RangeStatus::SATISFIABLE, 10, 90},
+        {"bytes=-5", RangeStatus::SATISFIABLE, 95, 5},
+        {"bytes=-500", RangeStatus::SATISFIABLE, 0, 100},
+        {"bytes=90-200", RangeStatus::SATISFIABLE, 90, 10},
+        {"bytes=100-", RangeStatus::UNSATISFIABLE, 0, 0},
+        {"bytes=-0", RangeStatus::UNSATISFIABLE, 0, 0},
+        {"bytes=9-3", RangeStatus::IGNORED, 0, 0},
+        {"bytes=0-1,5-6", RangeStatus::IGNORED, 0, 0},
+        {"items=0-1", RangeStatus::IGNORED, 0, 0},
+        {"bytes=a-b", RangeStatus::IGNORED, 0, 0},
+    };
+
+    for (const auto &[header, status, first, length] : cases) {
+        ByteRange range{};
+        auto result = parse_range(header, 100, range);
+
+        if (result != status || (status == RangeStatus::SATISFIABLE && (range.first != first || range.length != length))) {
+            std::cerr << "[FAILED] range " << header << " parsed wrongly." << std::endl;
+            return false;
+        }
+    }
+
+    const auto path = std::filesystem::temp_directory_path() / "dwhbll_static_files_test.txt";
+    {
+        std::ofstream out(path);
+        out << "0123456789";
+    }
+
+    FileCache cache(1, std::chrono::seconds(0));
+
+    auto first = cache.open(path.string());
+    auto second = cache.open(path.string());
+
+    if (!first || first->size != 10 || first != second) {
+        std::cerr << "[FAILED] file cache did not reuse the unchanged file." << std::endl;
+        return false;
+    }
+
+    {
+        std::ofstream out(path, std::ios::app);
+        out << "abc";
+    }
+
+    auto changed = cache.open(path.string());
+    if (!changed || changed->size != 13 || changed == first) {
+        std::cerr << "[FAILED] file cache did not notice the file changed." << std::endl;
+        return false;
+    }
+
+    std::filesystem::remove(path);
+
+    if (cache.open(path.string()) != nullptr || cache.size() != 0) {
+        std::cerr << "[FAILED] file cache kept a deleted file." << std::endl;
+        return false;
+    }
+
+    return true;
+}
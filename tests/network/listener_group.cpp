@@ -0,0 +1,120 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dwhbll/async/net/listener_group.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+#include <dwhbll/network/address.h>
+
+using dwhbll::async::net::listener_group;
+using dwhbll::concurrency::coroutine::task;
+
+namespace {
+    constexpr std::size_t threads = 4;
+    constexpr std::size_t connections = 256;
+
+    bool connect_once(const dwhbll::network::address &target) {
+        sockaddr_storage addr;
+        const auto addrlen = dwhbll::network::conv::to_sockaddr(target, addr);
+
+        auto fd = ::socket(addr.ss_family, SOCK_STREAM, 0);
+        if (fd < 0)
+            return false;
+
+        const bool ok = ::connect(fd, reinterpret_cast<sockaddr *>(&addr), addrlen) == 0;
+        ::close(fd);
+
+        return ok;
+    }
+}
+
+bool listener_group_test(std::optional<std::string> test_to_run) {
+    listener_group group({.threads = threads});
+
+    // port 0, the group has to agree on the one the kernel picked
+    if (group.listen(dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, 0)).is_err()) {
+        std::cerr << "[FAILED] listener group cannot listen" << std::endl;
+        return false;
+    }
+
+    if (group.size() != threads) {
+        std::cerr << "[FAILED] listener group opened " << group.size() << " listeners" << std::endl;
+        return false;
+    }
+
+    auto first = group.listener(0).local_address();
+
+    if (first.is_err() || first.unwrap_unchecked().port == 0) {
+        std::cerr << "[FAILED] listener group has no port" << std::endl;
+        return false;
+    }
+
+    const auto target = first.unwrap_unchecked();
+
+    for (std::size_t i = 1; i < threads; i++) {
+        auto local = group.listener(i).local_address();
+
+        if (local.is_err() || local.unwrap_unchecked().port != target.port) {
+            std::cerr << "[FAILED] listener " << i << " is not on port " << target.port << std::endl;
+            return false;
+        }
+    }
+
+    std::array<std::atomic<std::size_t>, threads> accepted{};
+    std::atomic<std::size_t> next{0};
+
+    group.start([&](std::unique_ptr<dwhbll::async::net::socket> sock) -> task<> {
+        // one listener per thread, numbered by the first connection each one accepts
+        thread_local const std::size_t index = next++;
+        accepted[index]++;
+        co_return;
+    });
+
+    for (std::size_t i = 0; i < connections; i++) {
+        if (!connect_once(target)) {
+            std::cerr << "[FAILED] connection " << i << " was refused" << std::endl;
+            group.stop();
+            return false;
+        }
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    std::size_t total = 0, busy = 0;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        total = busy = 0;
+        for (auto &count : accepted) {
+            total += count;
+            busy += count != 0;
+        }
+
+        if (total == connections)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    group.stop();
+
+    if (total != connections) {
+        std::cerr << "[FAILED] accepted " << total << " of " << connections << " connections" << std::endl;
+        return false;
+    }
+
+    // the source ports differ, so the reuseport hash cannot send all of them to one listener
+    if (busy < 2) {
+        std::cerr << "[FAILED] all connections went to one listener" << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,83 @@
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <dwhbll/async/net/resolver.h>
+#include <dwhbll/async/net/socket.h>
+#include <dwhbll/async/net/tcp_listener.h>
+#include <dwhbll/concurrency/coroutine/reactor.h>
+#include <dwhbll/concurrency/coroutine/task.h>
+
+using dwhbll::async::net::socket;
+using dwhbll::async::net::tcp_listener;
+using dwhbll::concurrency::coroutine::reactor;
+using dwhbll::concurrency::coroutine::task;
+
+namespace {
+    constexpr std::uint16_t port = 8095;
+
+    task<> accept_one(tcp_listener &listener) {
+        auto sock = co_await listener.accept();
+        (void)sock;
+    }
+
+    task<> connect_by_name(bool &ok) {
+        // localhost usually resolves to ::1 as well, which nothing listens on and has to lose the race
+        const auto start = std::chrono::steady_clock::now();
+        auto sock = co_await socket::connect_tcp(true, dwhbll::network::address("localhost", port));
+
+        if (sock.is_err()) {
+            std::cerr << "[FAILED] connecting to localhost: " << sock.unwrap_err_unchecked() << std::endl;
+            co_return;
+        }
+
+        if (sock.unwrap_unchecked()->get_address().type != dwhbll::network::address::IPV4) {
+            std::cerr << "[FAILED] connected to localhost over something else than IPv4" << std::endl;
+            co_return;
+        }
+
+        // the refused attempt must not hold up the one that works
+        if (std::chrono::steady_clock::now() - start > socket::CONNECTION_ATTEMPT_DELAY * 2) {
+            std::cerr << "[FAILED] connecting to localhost took longer than the attempt delays" << std::endl;
+            co_return;
+        }
+
+        // served from the cache this time
+        auto cached = co_await dwhbll::async::net::resolve("localhost", 1234);
+
+        if (cached.is_err() || cached.unwrap_unchecked().front().port != 1234) {
+            std::cerr << "[FAILED] resolving localhost again" << std::endl;
+            co_return;
+        }
+
+        auto missing = co_await socket::connect_tcp(true, dwhbll::network::address("does-not-exist.invalid", port));
+
+        if (missing.is_ok()) {
+            std::cerr << "[FAILED] connected to a name that cannot resolve" << std::endl;
+            co_return;
+        }
+
+        ok = true;
+    }
+}
+
+bool socket_connect_test(std::optional<std::string> test_to_run) {
+    tcp_listener listener;
+    listener.set_reuseaddr();
+
+    if (listener.listen(dwhbll::network::address(std::array<std::uint8_t, 4>{127, 0, 0, 1}, port)).is_err()) {
+        std::cerr << "[FAILED] cannot listen on port " << port << std::endl;
+        return false;
+    }
+
+    bool ok = false;
+
+    reactor r;
+    r.spawn(accept_one(listener));
+    r.spawn(connect_by_name(ok));
+    r.run();
+
+    return ok;
+}
@@ -0,0 +1,177 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dwhbll/network/SocketManager.h>
+
+using dwhbll::network::SocketManager;
+
+namespace {
+    /**
+     * @brief Accepts connections and keeps them open without ever writing to them.
+     */
+    class stub_server {
+        int fd = -1;
+        std::thread acceptor;
+        std::mutex lock;
+        std::vector<int> connections;
+
+    public:
+        unsigned short port = 0;
+        std::atomic_size_t accepted{0};
+
+        bool start() {
+            fd = ::socket(AF_INET, SOCK_STREAM, 0);
+
+            sockaddr_in addr{AF_INET, 0, {htonl(INADDR_LOOPBACK)}};
+            socklen_t length = sizeof(addr);
+
+            if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(fd, 128) != 0 ||
+                getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &length) != 0)
+                return false;
+
+            port = ntohs(addr.sin_port);
+            acceptor = std::thread([this] {
+                int conn;
+                while ((conn = accept(fd, nullptr, nullptr)) != -1) {
+                    std::lock_guard guard(lock);
+                    connections.push_back(conn);
+                    accepted++;
+                }
+            });
+
+            return true;
+        }
+
+        void close_connections() {
+            std::lock_guard guard(lock);
+            for (const int conn : connections)
+                close(conn);
+            connections.clear();
+        }
+
+        ~stub_server() {
+            shutdown(fd, SHUT_RDWR);
+            if (acceptor.joinable())
+                acceptor.join();
+            close(fd);
+            close_connections();
+        }
+    };
+
+    const in_addr loopback{htonl(INADDR_LOOPBACK)};
+}
+
+bool socket_manager_test(std::optional<std::string> test_to_run) {
+    stub_server server;
+
+    if (!server.start()) {
+        std::cerr << "[FAILED] cannot listen for the socket manager" << std::endl;
+        return false;
+    }
+
+    SocketManager manager({.max_idle_per_endpoint = 4, .idle_timeout = std::chrono::milliseconds(200)});
+
+    {
+        auto first = manager.getIPv4TCPSocket(loopback, server.port);
+        const int fd = first->getNativeHandle();
+        manager.checkin(std::move(first));
+
+        auto again = manager.getIPv4TCPSocket(loopback, server.port);
+
+        if (again->getNativeHandle() != fd || manager.stat().reused != 1 || manager.stat().connected != 1) {
+            std::cerr << "[FAILED] idle connection was not reused" << std::endl;
+            return false;
+        }
+
+        // two users at once never share a connection
+        auto other = manager.getIPv4TCPSocket(loopback, server.port);
+
+        if (other->getNativeHandle() == again->getNativeHandle() || manager.stat().connected != 2) {
+            std::cerr << "[FAILED] one connection was handed out twice" << std::endl;
+            return false;
+        }
+
+        manager.checkin(std::move(again));
+        manager.checkin(std::move(other));
+    }
+
+    // connections the server closed are noticed before they are handed out, once it got to accept them
+    while (server.accepted < 2)
+        std::this_thread::yield();
+
+    server.close_connections();
+
+    {
+        auto fresh = manager.getIPv4TCPSocket(loopback, server.port);
+
+        if (manager.stat().reused != 1 || manager.stat().discarded != 2 || manager.stat().connected != 3) {
+            std::cerr << "[FAILED] closed idle connections were reused" << std::endl;
+            return false;
+        }
+
+        manager.checkin(std::move(fresh));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    {
+        auto fresh = manager.getIPv4TCPSocket(loopback, server.port);
+
+        if (manager.stat().reused != 1 || manager.stat().discarded != 3) {
+            std::cerr << "[FAILED] expired idle connection was reused" << std::endl;
+            return false;
+        }
+
+        manager.checkin(std::move(fresh));
+    }
+
+    // every thread checks connections out and in, no connection may be in two hands at once
+    std::mutex lock;
+    std::set<int> in_use;
+    std::atomic_bool shared = false;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 2000; i++) {
+                auto socket = manager.getIPv4TCPSocket(loopback, server.port);
+                const int fd = socket->getNativeHandle();
+
+                {
+                    std::lock_guard guard(lock);
+                    if (!in_use.insert(fd).second)
+                        shared = true;
+                }
+
+                {
+                    std::lock_guard guard(lock);
+                    in_use.erase(fd);
+                }
+
+                manager.checkin(std::move(socket));
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    // at most one connection per thread plus the one left idle before
+    if (shared || server.accepted > 4 + 4) {
+        std::cerr << "[FAILED] concurrent checkouts, " << server.accepted << " connections" << std::endl;
+        return false;
+    }
+
+    return true;
+}
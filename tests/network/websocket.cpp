@@ -0,0 +1,223 @@
+#include <array>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dwhbll/network/http_server.hpp>
+
+namespace http_server = dwhbll::network::http_server;
+namespace websocket = dwhbll::network::http_server::websocket;
+
+namespace {
+    const std::array<std::byte, 4> mask{std::byte{0x37}, std::byte{0xfa}, std::byte{0x21}, std::byte{0x3d}};
+
+    /**
+     * @brief A frame the way a client sends it, masked.
+     */
+    std::vector<std::byte> client_frame(websocket::Opcode opcode, std::string_view payload, bool fin = true) {
+        websocket::FrameHeader header;
+        header.fin = fin;
+        header.opcode = opcode;
+        header.masked = true;
+        header.mask = mask;
+        header.length = payload.size();
+
+        std::array<std::byte, websocket::MAX_FRAME_HEADER> encoded;
+        const std::size_t size = header.encode(encoded);
+
+        std::vector<std::byte> frame(encoded.begin(), encoded.begin() + size);
+        const auto bytes = std::as_bytes(std::span{payload.data(), payload.size()});
+        frame.insert(frame.end(), bytes.begin(), bytes.end());
+        websocket::apply_mask(std::span{frame}.subspan(size), mask);
+
+        return frame;
+    }
+
+    bool codec_behaves() {
+        // the example handshake of RFC 6455 1.3
+        if (websocket::accept_key("dGhlIHNhbXBsZSBub25jZQ==") != "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") {
+            std::cerr << "[FAILED] websocket accept key" << std::endl;
+            return false;
+        }
+
+        for (std::uint64_t length : {0ull, 125ull, 126ull, 65535ull, 65536ull, 1ull << 40}) {
+            websocket::FrameHeader header;
+            header.opcode = websocket::Opcode::BINARY;
+            header.masked = length & 1;
+            header.mask = mask;
+            header.length = length;
+
+            std::array<std::byte, websocket::MAX_FRAME_HEADER> encoded;
+            const std::size_t size = header.encode(encoded);
+
+            websocket::FrameHeader parsed;
+            std::size_t parsed_size = 0;
+
+            if (parsed.parse(std::span{encoded}.first(size - 1), parsed_size) != websocket::FrameHeader::Status::INCOMPLETE ||
+                parsed.parse(std::span{encoded}.first(size), parsed_size) != websocket::FrameHeader::Status::DONE ||
+                parsed_size != size || parsed.length != length || parsed.masked != header.masked || (header.masked && parsed.mask != header.mask)) {
+                std::cerr << "[FAILED] websocket header of a " << length << " byte frame" << std::endl;
+                return false;
+            }
+        }
+
+        // a reserved bit, a fragmented ping, a 126 byte close and opcode 3
+        for (const std::array<std::uint8_t, 4> bad : {std::array<std::uint8_t, 4>{0xC1, 0x00, 0, 0}, {0x09, 0x00, 0, 0},
+                                                        {0x88, 0x7E, 0, 126}, {0x83, 0x00, 0, 0}}) {
+            websocket::FrameHeader parsed;
+            std::size_t size;
+
+            if (parsed.parse(std::as_bytes(std::span{bad}), size) != websocket::FrameHeader::Status::MALFORMED) {
+                std::cerr << "[FAILED] websocket malformed header accepted" << std::endl;
+                return false;
+            }
+        }
+
+        // every length and starting offset, so each vector width and tail is hit
+        std::vector<std::byte> data(300);
+        for (std::size_t i = 0; i < data.size(); i++)
+            data[i] = static_cast<std::byte>(i * 7);
+
+        for (std::size_t start = 0; start < 5; start++) {
+            for (std::size_t length = 0; length + start <= data.size(); length++) {
+                auto vector = data, scalar = data;
+                websocket::apply_mask(std::span{vector}.subspan(start, length), mask, start);
+                websocket::apply_mask_scalar(std::span{scalar}.subspan(start, length), mask, start);
+
+                if (vector != scalar) {
+                    std::cerr << "[FAILED] websocket unmasking " << length << " bytes from " << start << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool upgrade_behaves() {
+        http_server::Request request;
+        http_server::Response response;
+        request.method = dwhbll::network::http::HTTP_METHOD::GET;
+        request.fields = {{"upgrade", "WebSocket"}, {"connection", "keep-alive, Upgrade"},
+                          {"sec-websocket-key", "dGhlIHNhbXBsZSBub25jZQ=="}};
+
+        if (http_server::upgrade_to_websocket(request, response, [](http_server::WebSocket &) {}) ||
+            response.code != "426" || response.fields["sec-websocket-version"] != "13") {
+            std::cerr << "[FAILED] websocket upgrade without a version" << std::endl;
+            return false;
+        }
+
+        response.reset();
+        request.fields["sec-websocket-version"] = "13";
+
+        if (!http_server::upgrade_to_websocket(request, response, [](http_server::WebSocket &) {}) ||
+            response.code != "101" || response.fields["sec-websocket-accept"] != "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=" ||
+            !response.websocket_session) {
+            std::cerr << "[FAILED] websocket upgrade" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool session_behaves() {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            std::cerr << "[FAILED] cannot make a socket pair" << std::endl;
+            return false;
+        }
+
+        // a text message in three fragments with a ping in between, a binary one bigger than the receive buffer, then a close
+        std::vector<std::byte> wire;
+        const std::string big(10000, 'x');
+
+        for (const auto &frame : {client_frame(websocket::Opcode::TEXT, "Hel", false),
+                                  client_frame(websocket::Opcode::PING, "are you there"),
+                                  client_frame(websocket::Opcode::CONTINUATION, "lo ", false),
+                                  client_frame(websocket::Opcode::CONTINUATION, "world"),
+                                  client_frame(websocket::Opcode::BINARY, big),
+                                  client_frame(websocket::Opcode::CLOSE, "\x03\xe8")})
+            wire.insert(wire.end(), frame.begin(), frame.end());
+
+        if (write(fds[1], wire.data(), wire.size()) != static_cast<ssize_t>(wire.size())) {
+            std::cerr << "[FAILED] cannot write the client frames" << std::endl;
+            return false;
+        }
+
+        http_server::detail::Socket socket;
+        socket.assign_socket(fds[0]);
+        http_server::WebSocket connection(socket);
+        http_server::WebSocket::Message message;
+
+        const bool text = connection.receive(message) && message.opcode == websocket::Opcode::TEXT && message.text() == "Hello world";
+        const bool binary = connection.receive(message) && message.opcode == websocket::Opcode::BINARY && message.text() == big;
+        const bool closed = !connection.receive(message) && connection.is_closed() && !connection.send_text("late");
+
+        // the pong and the echoed close come back unmasked
+        std::array<std::byte, 64> reply;
+        const ssize_t size = read(fds[1], reply.data(), reply.size());
+        const std::vector<std::byte> expected = [] {
+            const websocket::Frame pong(websocket::Opcode::PONG, "are you there");
+            const auto close = websocket::Frame::close(websocket::CloseCode::NORMAL);
+            std::vector<std::byte> bytes(pong.bytes().begin(), pong.bytes().end());
+            bytes.insert(bytes.end(), close.bytes().begin(), close.bytes().end());
+            return bytes;
+        }();
+
+        close(fds[0]);
+        close(fds[1]);
+
+        if (!text || !binary || !closed) {
+            std::cerr << "[FAILED] websocket messages received as " << text << binary << closed << std::endl;
+            return false;
+        }
+
+        if (size != static_cast<ssize_t>(expected.size()) || !std::equal(expected.begin(), expected.end(), reply.begin())) {
+            std::cerr << "[FAILED] websocket pong and close" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool protocol_errors_close() {
+        // a continuation out of nowhere, then an unmasked frame
+        for (const auto &frame : {client_frame(websocket::Opcode::CONTINUATION, "stray"),
+                                  std::vector<std::byte>{std::byte{0x81}, std::byte{0x01}, std::byte{'a'}}}) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+                return false;
+
+            write(fds[1], frame.data(), frame.size());
+
+            http_server::detail::Socket socket;
+            socket.assign_socket(fds[0]);
+            http_server::WebSocket connection(socket);
+            http_server::WebSocket::Message message;
+
+            const bool received = connection.receive(message);
+
+            std::array<std::byte, 16> reply;
+            const ssize_t size = read(fds[1], reply.data(), reply.size());
+
+            close(fds[0]);
+            close(fds[1]);
+
+            // close frame with status 1002
+            if (received || size != 4 || reply[0] != std::byte{0x88} || reply[2] != std::byte{0x03} || reply[3] != std::byte{0xea}) {
+                std::cerr << "[FAILED] websocket protocol error was not answered with a close" << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+bool websocket_test(std::optional<std::string> test_to_run) {
+    return codec_behaves() && upgrade_behaves() && session_behaves() && protocol_errors_close();
+}
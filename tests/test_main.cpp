@@ -8,10 +8,34 @@ extern bool pool_test(std::optional<std::string> test_to_run);
 extern bool matrix_test(std::optional<std::string> test_to_run);
 extern bool ring_test(std::optional<std::string> test_to_run);
 extern bool cache_test(std::optional<std::string> test_to_run);
+extern bool flat_hash_map_test(std::optional<std::string> test_to_run);
+extern bool btree_test(std::optional<std::string> test_to_run);
+extern bool io_buffer_test(std::optional<std::string> test_to_run);
 extern bool stream_test(std::optional<std::string> test_to_run);
+extern bool loading_cache_test(std::optional<std::string> test_to_run);
 extern bool bitmap_test(std::optional<std::string> test_to_run);
 extern bool c_lang_test(std::optional<std::string> test_to_run);
 
+// network
+extern bool datagram_socket_test(std::optional<std::string> test_to_run);
+extern bool dns_resolver_test(std::optional<std::string> test_to_run);
+extern bool dns_wire_test(std::optional<std::string> test_to_run);
+extern bool http_chunked_test(std::optional<std::string> test_to_run);
+extern bool http_response_parser_test(std::optional<std::string> test_to_run);
+extern bool http_router_test(std::optional<std::string> test_to_run);
+extern bool http_serializer_test(std::optional<std::string> test_to_run);
+extern bool http_static_files_test(std::optional<std::string> test_to_run);
+extern bool socket_connect_test(std::optional<std::string> test_to_run);
+extern bool listener_group_test(std::optional<std::string> test_to_run);
+extern bool socket_manager_test(std::optional<std::string> test_to_run);
+extern bool websocket_test(std::optional<std::string> test_to_run);
+extern bool http2_test(std::optional<std::string> test_to_run);
+extern bool http_admission_test(std::optional<std::string> test_to_run);
+extern bool connection_timeouts_test(std::optional<std::string> test_to_run);
+
+// utils
+extern bool latency_histogram_test(std::optional<std::string> test_to_run);
+
 // cryptography
 extern bool crypto_arc4_test(std::optional<std::string> test_to_run);
 
@@ -19,6 +43,20 @@ extern bool crypto_arc4_test(std::optional<std::string> test_to_run);
 extern bool bounded_spsc_int_bench(std::optional<std::string> test_to_run);
 extern bool bounded_mpsc_int_bench(std::optional<std::string> test_to_run);
 extern bool recycling_concurrent_stack_bench(std::optional<std::string> test_to_run);
+extern bool http_router_bench(std::optional<std::string> test_to_run);
+extern bool http_client_bench(std::optional<std::string> test_to_run);
+extern bool http_load_bench(std::optional<std::string> test_to_run);
+extern bool udp_batch_bench(std::optional<std::string> test_to_run);
+extern bool accept_bench(std::optional<std::string> test_to_run);
+extern bool dns_codec_bench(std::optional<std::string> test_to_run);
+extern bool websocket_bench(std::optional<std::string> test_to_run);
+extern bool http2_bench(std::optional<std::string> test_to_run);
+extern bool http_admission_bench(std::optional<std::string> test_to_run);
+extern bool ring_bench(std::optional<std::string> test_to_run);
+extern bool cache_bench(std::optional<std::string> test_to_run);
+extern bool loading_cache_bench(std::optional<std::string> test_to_run);
+extern bool flat_hash_map_bench(std::optional<std::string> test_to_run);
+extern bool btree_bench(std::optional<std::string> test_to_run);
 
 // The optional string argument is for the subtests to run
 using TestFunc = std::function<bool(std::optional<std::string>)>;
@@ -28,14 +66,48 @@ std::unordered_map<std::string, TestFunc> module_dispatch{
     {"matrix", matrix_test},
     {"collections/ring", ring_test},
     {"collections/cache", cache_test},
+    {"collections/flat_hash_map", flat_hash_map_test},
+    {"collections/btree", btree_test},
+    {"collections/io_buffer", io_buffer_test},
     {"collections/streams", stream_test},
+    {"concurrency/loading_cache", loading_cache_test},
     {"graphics/bitmap", bitmap_test},
     {"bench/bounded_spsc_int", bounded_spsc_int_bench},
     {"bench/bounded_mpsc_int", bounded_mpsc_int_bench},
     {"bench/recycling_concurrent_stack", recycling_concurrent_stack_bench},
+    {"bench/http_router", http_router_bench},
+    {"bench/http_client", http_client_bench},
+    {"bench/http_load", http_load_bench},
+    {"bench/udp_batch", udp_batch_bench},
+    {"bench/accept", accept_bench},
+    {"bench/dns_codec", dns_codec_bench},
+    {"bench/websocket", websocket_bench},
+    {"bench/http2", http2_bench},
+    {"bench/http_admission", http_admission_bench},
+    {"bench/ring", ring_bench},
+    {"bench/cache", cache_bench},
+    {"bench/loading_cache", loading_cache_bench},
+    {"bench/flat_hash_map", flat_hash_map_bench},
+    {"bench/btree", btree_bench},
 
     {"crypto/arc4", crypto_arc4_test},
     {"lang/c", c_lang_test},
+    {"network/datagram_socket", datagram_socket_test},
+    {"network/dns_resolver", dns_resolver_test},
+    {"network/dns_wire", dns_wire_test},
+    {"network/http_chunked", http_chunked_test},
+    {"network/http_response_parser", http_response_parser_test},
+    {"network/http_router", http_router_test},
+    {"network/http_serializer", http_serializer_test},
+    {"network/http_static_files", http_static_files_test},
+    {"network/socket_connect", socket_connect_test},
+    {"network/listener_group", listener_group_test},
+    {"network/socket_manager", socket_manager_test},
+    {"network/websocket", websocket_test},
+    {"network/http2", http2_test},
+    {"network/http_admission", http_admission_test},
+    {"network/connection_timeouts", connection_timeouts_test},
+    {"utils/latency_histogram", latency_histogram_test},
 };
 
 int main(int argc, char **argv) {
@@ -0,0 +1,78 @@
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <dwhbll/utils/latency_histogram.h>
+
+using dwhbll::utils::latency_histogram;
+
+static bool close_to(std::uint64_t value, double expected, double tolerance) {
+    return std::abs(static_cast<double>(value) - expected) <= expected * tolerance;
+}
+
+bool latency_histogram_test(std::optional<std::string> test_to_run) {
+    latency_histogram histogram;
+
+    for (std::uint64_t value = 1; value <= 1000000; value++)
+        histogram.record(value);
+
+    if (histogram.count() != 1000000 || histogram.min() != 1 || histogram.max() != 1000000) {
+        std::cerr << "[FAILED] count/min/max are " << histogram.count() << "/" << histogram.min() << "/"
+                  << histogram.max() << std::endl;
+        return false;
+    }
+
+    // three significant digits
+    for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+        if (!close_to(histogram.value_at(percentile), percentile * 10000, 0.001)) {
+            std::cerr << "[FAILED] p" << percentile << " is " << histogram.value_at(percentile) << std::endl;
+            return false;
+        }
+    }
+
+    if (histogram.value_at(100.0) != 1000000 || histogram.value_at(0.0) != 1) {
+        std::cerr << "[FAILED] p0/p100 are " << histogram.value_at(0.0) << "/" << histogram.value_at(100.0)
+                  << std::endl;
+        return false;
+    }
+
+    if (!close_to(static_cast<std::uint64_t>(histogram.mean()), 500000.5, 0.0001)) {
+        std::cerr << "[FAILED] mean is " << histogram.mean() << std::endl;
+        return false;
+    }
+
+    // small values are exact
+    latency_histogram small;
+    for (std::uint64_t value : {3, 3, 7, 1500})
+        small.record(value);
+
+    if (small.value_at(50.0) != 3 || small.value_at(75.0) != 7 || small.value_at(100.0) != 1500) {
+        std::cerr << "[FAILED] small values are not exact" << std::endl;
+        return false;
+    }
+
+    small.merge(histogram);
+
+    if (small.count() != 1000004 || small.max() != 1000000) {
+        std::cerr << "[FAILED] merge lost counts" << std::endl;
+        return false;
+    }
+
+    latency_histogram bounded(10000, 2);
+    bounded.record(1000000);
+
+    if (bounded.max() != 10000 || bounded.value_at(50.0) != 10000) {
+        std::cerr << "[FAILED] values past the highest trackable one are not clamped" << std::endl;
+        return false;
+    }
+
+    bounded.reset();
+
+    if (bounded.count() != 0 || bounded.value_at(99.0) != 0) {
+        std::cerr << "[FAILED] reset kept counts" << std::endl;
+        return false;
+    }
+
+    return true;
+}